@@ -1297,6 +1297,9 @@ SkyPage {
             }
             else {
                 linksToGet.push([postIndex, webLink])
+
+                // Fetch concurrently, the card is taken from the cache when its turn comes.
+                prefetchLinkCard(webLink)
             }
         }
 
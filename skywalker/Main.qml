@@ -942,8 +942,7 @@ ApplicationWindow {
                     if (profile.did === skywalker.getUserDid())
                         signOutCurrentUser()
 
-                    let userSettings = skywalker.getUserSettings()
-                    userSettings.removeUser(profile.did)
+                    skywalker.removeUser(profile.did)
                 }
 
                 if (!skywalker.isSignedIn())
@@ -62,6 +62,8 @@ SkyListView {
         // Adding/removing content changes the indices.
         if (!isView)
             skywalker.timelineMovementEnded(firstVisibleIndex, lastVisibleIndex)
+        else if (model)
+            model.setVisibleRange(firstVisibleIndex, lastVisibleIndex)
 
         updateUnreadPosts(firstVisibleIndex)
 
@@ -80,6 +82,8 @@ SkyListView {
 
         if (!isView)
             skywalker.timelineMovementEnded(firstVisibleIndex, lastVisibleIndex)
+        else if (model)
+            model.setVisibleRange(firstVisibleIndex, lastVisibleIndex)
 
         setAnchorItem(lastVisibleIndex + 1)
         updateUnreadPosts(firstVisibleIndex)
@@ -5,6 +5,8 @@
 #include "content_filter.h"
 #include "focus_hashtags.h"
 #include <atproto/lib/post_master.h>
+#include <QTimer>
+#include <map>
 
 namespace Skywalker {
 
@@ -28,7 +30,38 @@ AbstractPostFeedModel::AbstractPostFeedModel(const QString& userDid, const IProf
 {
     connect(&mBookmarks, &Bookmarks::sizeChanged, this, [this]{ postBookmarkedChanged(); });
     connect(&AuthorCache::instance(), &AuthorCache::profileAdded, this,
-            [this]{ changeData({ int(Role::PostReplyToAuthor), int(Role::PostRecord), int(Role::PostRecordWithMedia) }); });
+            [this](const QString& did){ profileAdded(did); });
+    connect(&AuthorCache::instance(), &AuthorCache::profileFailed, this,
+            [this](const QString& did){ mCidsWaitingForProfile.erase(did); });
+
+    // Any change in the rows invalidates the row index
+    const auto invalidateKeyRowIndex = [this]{ mKeyRowIndexValid = false; };
+    connect(this, &QAbstractItemModel::rowsInserted, this, invalidateKeyRowIndex);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, invalidateKeyRowIndex);
+    connect(this, &QAbstractItemModel::rowsMoved, this, invalidateKeyRowIndex);
+    connect(this, &QAbstractItemModel::modelReset, this, invalidateKeyRowIndex);
+    connect(this, &QAbstractItemModel::layoutChanged, this, invalidateKeyRowIndex);
+
+    // Checking for unused entries takes a rebuild of the row index. The check is
+    // done once for all removals in an event loop iteration.
+    connect(this, &QAbstractItemModel::rowsRemoved, this, [this]{ scheduleRemoveUnusedEntries(); });
+
+    // An inserted post may have been fetched again with new labels.
+    connect(this, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex&, int first, int last){ removeViewRecords(first, last); });
+    connect(this, &QAbstractItemModel::modelReset, this, [this]{ mViewRecords.clear(); });
+
+    // New rows may be younger than the rows that were visible.
+    const auto reschedule = []{ RelativeTimeService::instance().reschedule(); };
+    connect(this, &QAbstractItemModel::rowsInserted, this, reschedule);
+    connect(this, &QAbstractItemModel::modelReset, this, reschedule);
+
+    RelativeTimeService::instance().addClient(this);
+}
+
+AbstractPostFeedModel::~AbstractPostFeedModel()
+{
+    RelativeTimeService::instance().removeClient(this);
 }
 
 void AbstractPostFeedModel::clearFeed()
@@ -37,6 +70,14 @@ void AbstractPostFeedModel::clearFeed()
     mStoredCids.clear();
     mStoredCidQueue = {};
     mEndOfFeed = false;
+    mKeyRowIndex.clear();
+    mKeyRowIndexValid = false;
+    mPendingRowChanges.clear();
+    mCidsWaitingForProfile.clear();
+    mFormattedTextCache.clear();
+    mViewRecords.clear();
+    mFirstVisibleIndex = -1;
+    mLastVisibleIndex = -1;
     clearLocalChanges();
     clearLocalProfileChanges();
 }
@@ -79,6 +120,12 @@ void AbstractPostFeedModel::cleanupStoredCids()
 }
 
 bool AbstractPostFeedModel::mustHideContent(const Post& post) const
+{
+    return mustHideContent(post, mContentFilter, mMutedReposts, mMutedWords);
+}
+
+bool AbstractPostFeedModel::mustHideContent(const Post& post, const IContentFilter& contentFilter,
+                                            const IProfileStore& mutedReposts, const IMatchWords& mutedWords)
 {
     if (post.getAuthor().getViewer().isMuted())
     {
@@ -86,7 +133,7 @@ bool AbstractPostFeedModel::mustHideContent(const Post& post) const
         return true;
     }
 
-    const auto [visibility, warning] = mContentFilter.getVisibilityAndWarning(post.getLabelsIncludingAuthorLabels());
+    const auto [visibility, warning] = contentFilter.getVisibilityAndWarning(post.getLabelsIncludingAuthorLabels());
 
     if (visibility == QEnums::CONTENT_VISIBILITY_HIDE_POST)
     {
@@ -94,13 +141,13 @@ bool AbstractPostFeedModel::mustHideContent(const Post& post) const
         return true;
     }
 
-    if (post.isRepost() && mMutedReposts.contains(post.getRepostedBy()->getDid()))
+    if (post.isRepost() && mutedReposts.contains(post.getRepostedBy()->getDid()))
     {
         qDebug() << "Mute repost, did:" << post.getRepostedBy()->getDid();
         return true;
     }
 
-    if (mMutedWords.match(post))
+    if (mutedWords.match(post))
     {
         qDebug() << "Hide post due to muted words" << post.getCid();
         return true;
@@ -109,6 +156,64 @@ bool AbstractPostFeedModel::mustHideContent(const Post& post) const
     return false;
 }
 
+const AbstractPostFeedModel::ViewRecord& AbstractPostFeedModel::getViewRecord(const Post& post) const
+{
+    const QString& cid = post.getCid();
+
+    if (cid.isEmpty())
+    {
+        buildViewRecord(mUncachedViewRecord, post);
+        return mUncachedViewRecord;
+    }
+
+    auto it = mViewRecords.find(cid);
+
+    if (it != mViewRecords.end())
+    {
+        const ViewRecord& record = it->second;
+
+        if (record.mContentFilterVersion == mContentFilter.getVersion() &&
+            record.mMutedWordsVersion == mMutedWords.getVersion() &&
+            record.mFocusHashtagsVersion == mFocusHashtags.getVersion())
+        {
+            return record;
+        }
+
+        buildViewRecord(it->second, post);
+        return it->second;
+    }
+
+    ViewRecord& record = mViewRecords[cid];
+    buildViewRecord(record, post);
+    return record;
+}
+
+void AbstractPostFeedModel::buildViewRecord(ViewRecord& record, const Post& post) const
+{
+    const auto author = post.getAuthor();
+    const BasicProfile* profileChange = getProfileChange(author.getDid());
+    record.mAuthor = profileChange ? *profileChange : author;
+    record.mLabels = ContentFilter::getContentLabels(post.getLabels());
+
+    const auto [visibility, warning] = mContentFilter.getVisibilityAndWarning(post.getLabelsIncludingAuthorLabels());
+    record.mContentVisibility = visibility;
+    record.mContentWarning = warning;
+
+    if (author.getViewer().isMuted())
+        record.mMutedReason = QEnums::MUTED_POST_AUTHOR;
+    else if (mMutedWords.match(post))
+        record.mMutedReason = QEnums::MUTED_POST_WORDS;
+    else
+        record.mMutedReason = QEnums::MUTED_POST_NONE;
+
+    const QColor color = mFocusHashtags.highlightColor(post);
+    record.mHighlightColor = color.isValid() ? color.name() : "transparent";
+
+    record.mContentFilterVersion = mContentFilter.getVersion();
+    record.mMutedWordsVersion = mMutedWords.getVersion();
+    record.mFocusHashtagsVersion = mFocusHashtags.getVersion();
+}
+
 void AbstractPostFeedModel::preprocess(const Post& post)
 {
     const auto hashtags = post.getHashtags();
@@ -148,22 +253,18 @@ int AbstractPostFeedModel::rowCount(const QModelIndex& parent) const
 
 QVariant AbstractPostFeedModel::data(const QModelIndex& index, int role) const
 {
-    if (index.row() < 0 || index.row() >= (int)mFeed.size())
+    if (index.row() < 0 || index.row() >= rowCount())
         return {};
 
-    const auto& post = mFeed[index.row()];
+    const auto& post = getPost(index.row());
     const auto* change = getLocalChange(post.getCid());
 
     switch (Role(role))
     {
     case Role::Author:
-    {
-        const auto author = post.getAuthor();
-        const BasicProfile* profileChange = getProfileChange(author.getDid());
-        return QVariant::fromValue(profileChange ? *profileChange : author);
-    }
+        return QVariant::fromValue(getViewRecord(post).mAuthor);
     case Role::PostText:
-        return post.getFormattedText(mFocusHashtags.getNormalizedMatchHashtags(post));
+        return mFormattedTextCache.getFormattedText(post, mFocusHashtags);
     case Role::PostPlainText:
         return post.getText();
     case Role::PostLanguages:
@@ -219,7 +320,10 @@ QVariant AbstractPostFeedModel::data(const QModelIndex& index, int role) const
             const QString did = record->getReplyToAuthorDid();
 
             if (!did.isEmpty() && !AuthorCache::instance().contains(did))
+            {
+                mCidsWaitingForProfile[did].insert(post.getCid());
                 AuthorCache::instance().putProfile(did);
+            }
         }
 
         const auto [visibility, warning] = mContentFilter.getVisibilityAndWarning(record->getLabelsIncludingAuthorLabels());
@@ -250,7 +354,10 @@ QVariant AbstractPostFeedModel::data(const QModelIndex& index, int role) const
             const QString did = record.getReplyToAuthorDid();
 
             if (!did.isEmpty() && !AuthorCache::instance().contains(did))
+            {
+                mCidsWaitingForProfile[did].insert(post.getCid());
                 AuthorCache::instance().putProfile(did);
+            }
         }
 
         const auto [visibility, warning] = mContentFilter.getVisibilityAndWarning(record.getLabelsIncludingAuthorLabels());
@@ -297,7 +404,10 @@ QVariant AbstractPostFeedModel::data(const QModelIndex& index, int role) const
             const QString did = post.getReplyToAuthorDid();
 
             if (!did.isEmpty())
+            {
+                mCidsWaitingForProfile[did].insert(post.getCid());
                 AuthorCache::instance().putProfile(did);
+            }
 
             return {};
         }
@@ -386,32 +496,15 @@ QVariant AbstractPostFeedModel::data(const QModelIndex& index, int role) const
     case Role::PostBookmarkNotFound:
         return post.isBookmarkNotFound();
     case Role::PostLabels:
-        return QVariant::fromValue(ContentFilter::getContentLabels(post.getLabels()));
+        return QVariant::fromValue(getViewRecord(post).mLabels);
     case Role::PostContentVisibility:
-    {
-        const auto [visibility, _] = mContentFilter.getVisibilityAndWarning(post.getLabelsIncludingAuthorLabels());
-        return visibility;
-    }
+        return getViewRecord(post).mContentVisibility;
     case Role::PostContentWarning:
-    {
-        const auto [_, warning] = mContentFilter.getVisibilityAndWarning(post.getLabelsIncludingAuthorLabels());
-        return warning;
-    }
+        return getViewRecord(post).mContentWarning;
     case Role::PostMutedReason:
-    {
-        if (post.getAuthor().getViewer().isMuted())
-            return QEnums::MUTED_POST_AUTHOR;
-
-        if (mMutedWords.match(post))
-            return QEnums::MUTED_POST_WORDS;
-
-        return QEnums::MUTED_POST_NONE;
-    }
+        return getViewRecord(post).mMutedReason;
     case Role::PostHighlightColor:
-    {
-        const QColor color = mFocusHashtags.highlightColor(post);
-        return color.isValid() ? color.name() : "transparent";
-    }
+        return getViewRecord(post).mHighlightColor;
     case Role::PostIsPinned:
         return post.isPinned();
     case Role::PostLocallyDeleted:
@@ -509,96 +602,166 @@ QHash<int, QByteArray> AbstractPostFeedModel::roleNames() const
 
 void AbstractPostFeedModel::postIndexedSecondsAgoChanged()
 {
-    changeData({ int(Role::PostIndexedSecondsAgo) });
+    // Models that get refreshed by the RelativeTimeService only refresh their
+    // visible rows. The others get all rows refreshed by the timeline update timer.
+    if (hasVisibleRange())
+    {
+        refreshRelativeTime();
+        return;
+    }
+
+    if (rowCount() > 0)
+        emit dataChanged(createIndex(0, 0), createIndex(rowCount() - 1, 0), { int(Role::PostIndexedSecondsAgo) });
+}
+
+void AbstractPostFeedModel::setVisibleRange(int firstVisibleIndex, int lastVisibleIndex)
+{
+    if (firstVisibleIndex == mFirstVisibleIndex && lastVisibleIndex == mLastVisibleIndex)
+        return;
+
+    mFirstVisibleIndex = firstVisibleIndex;
+    mLastVisibleIndex = lastVisibleIndex;
+
+    // Rows that scrolled into view may show a stale time.
+    refreshRelativeTime();
+    RelativeTimeService::instance().reschedule();
+}
+
+// Must only be called with a visible range.
+std::pair<int, int> AbstractPostFeedModel::getVisibleRows() const
+{
+    Q_ASSERT(hasVisibleRange());
+    const int lastRow = rowCount() - 1;
+    return { std::min(mFirstVisibleIndex, lastRow), std::min(mLastVisibleIndex, lastRow) };
+}
+
+bool AbstractPostFeedModel::hasVisibleRange() const
+{
+    return mFirstVisibleIndex >= 0 && mLastVisibleIndex >= 0;
+}
+
+void AbstractPostFeedModel::refreshRelativeTime()
+{
+    // Without a visible range, the timeline update timer refreshes the rows.
+    if (!hasVisibleRange())
+        return;
+
+    const auto [first, last] = getVisibleRows();
+
+    if (first < 0 || first > last)
+        return;
+
+    emit dataChanged(createIndex(first, 0), createIndex(last, 0), { int(Role::PostIndexedSecondsAgo) });
+}
+
+QDateTime AbstractPostFeedModel::getYoungestVisibleTimestamp() const
+{
+    // Views that do not report their visible range get refreshed by the
+    // timeline update timer only.
+    if (!hasVisibleRange())
+        return {};
+
+    const auto [first, last] = getVisibleRows();
+    QDateTime youngest;
+
+    for (int row = first; row <= last; ++row)
+    {
+        const QDateTime timestamp = getPost(row).getIndexedAt();
+
+        // Place holders have no timestamp
+        if (timestamp.isValid() && (!youngest.isValid() || timestamp > youngest))
+            youngest = timestamp;
+    }
+
+    return youngest;
 }
 
-// For a change on a single post a single row change would be sufficient.
-// However the model may have changed while waiting for a confirmation from the
-// network about the change, so we don't know which row this CID is anymore.
-// Also for reposts a CID may apply to multiple rows. Therefor all rows
-// are marked as change. Performance seems not an issue.
-void AbstractPostFeedModel::likeCountChanged()
+// The model may have changed while waiting for a confirmation from the network
+// about the change, so the rows of a CID are looked up when the change gets
+// signalled. For reposts a CID may apply to multiple rows.
+void AbstractPostFeedModel::likeCountChanged(const QString& cid)
 {
-    changeData({ int(Role::PostLikeCount) });
+    changeData(cid, { int(Role::PostLikeCount) });
 }
 
-void AbstractPostFeedModel::likeUriChanged()
+void AbstractPostFeedModel::likeUriChanged(const QString& cid)
 {
-    changeData({ int(Role::PostLikeUri) });
+    changeData(cid, { int(Role::PostLikeUri) });
 }
 
-void AbstractPostFeedModel::likeTransientChanged()
+void AbstractPostFeedModel::likeTransientChanged(const QString& cid)
 {
-    changeData({ int(Role::PostLikeTransient) });
+    changeData(cid, { int(Role::PostLikeTransient) });
 }
 
-void AbstractPostFeedModel::replyCountChanged()
+void AbstractPostFeedModel::replyCountChanged(const QString& cid)
 {
-    changeData({ int(Role::PostReplyCount) });
+    changeData(cid, { int(Role::PostReplyCount) });
 }
 
-void AbstractPostFeedModel::repostCountChanged()
+void AbstractPostFeedModel::repostCountChanged(const QString& cid)
 {
-    changeData({ int(Role::PostRepostCount) });
+    changeData(cid, { int(Role::PostRepostCount) });
 }
 
-void AbstractPostFeedModel::quoteCountChanged()
+void AbstractPostFeedModel::quoteCountChanged(const QString& cid)
 {
-    changeData({ int(Role::PostQuoteCount) });
+    changeData(cid, { int(Role::PostQuoteCount) });
 }
 
-void AbstractPostFeedModel::repostUriChanged()
+void AbstractPostFeedModel::repostUriChanged(const QString& cid)
 {
-    changeData({ int(Role::PostRepostUri), int(Role::PostLocallyDeleted) });
+    changeData(cid, { int(Role::PostRepostUri), int(Role::PostLocallyDeleted) });
 }
 
-void AbstractPostFeedModel::threadgateUriChanged()
+void AbstractPostFeedModel::threadgateUriChanged(const QString& cid)
 {
-    changeData({ int(Role::PostThreadgateUri) });
+    changeData(cid, { int(Role::PostThreadgateUri) });
 }
 
-void AbstractPostFeedModel::replyRestrictionChanged()
+void AbstractPostFeedModel::replyRestrictionChanged(const QString& cid)
 {
-    changeData({ int(Role::PostReplyRestriction) });
+    changeData(cid, { int(Role::PostReplyRestriction) });
 }
 
-void AbstractPostFeedModel::replyRestrictionListsChanged()
+void AbstractPostFeedModel::replyRestrictionListsChanged(const QString& cid)
 {
-    changeData({ int(Role::PostReplyRestrictionLists) });
+    changeData(cid, { int(Role::PostReplyRestrictionLists) });
 }
 
-void AbstractPostFeedModel::hiddenRepliesChanged()
+void AbstractPostFeedModel::hiddenRepliesChanged(const QString& cid)
 {
-    changeData({ int(Role::PostHiddenReplies), int(Role::PostIsHiddenReply) });
+    changeData(cid, { int(Role::PostHiddenReplies), int(Role::PostIsHiddenReply) });
 }
 
-void AbstractPostFeedModel::threadMutedChanged()
+void AbstractPostFeedModel::threadMutedChanged(const QString& uri)
 {
-    changeData({ int(Role::PostThreadMuted) });
+    changeData(uri, { int(Role::PostThreadMuted) });
 }
 
-void AbstractPostFeedModel::detachedRecordChanged()
+void AbstractPostFeedModel::detachedRecordChanged(const QString& cid)
 {
-    changeData({ int(Role::PostRecord), int(Role::PostRecordWithMedia) });
+    changeData(cid, { int(Role::PostRecord), int(Role::PostRecordWithMedia) });
 }
 
-void AbstractPostFeedModel::reAttachedRecordChanged()
+void AbstractPostFeedModel::reAttachedRecordChanged(const QString& cid)
 {
-    changeData({ int(Role::PostRecord), int(Role::PostRecordWithMedia) });
+    changeData(cid, { int(Role::PostRecord), int(Role::PostRecordWithMedia) });
 }
 
-void AbstractPostFeedModel::viewerStatePinnedChanged()
+void AbstractPostFeedModel::viewerStatePinnedChanged(const QString& cid)
 {
-    changeData({ int(Role::PostViewerStatePinned) });
+    changeData(cid, { int(Role::PostViewerStatePinned) });
 }
 
-void AbstractPostFeedModel::postDeletedChanged()
+void AbstractPostFeedModel::postDeletedChanged(const QString& cid)
 {
-    changeData({ int(Role::PostLocallyDeleted) });
+    changeData(cid, { int(Role::PostLocallyDeleted) });
 }
 
 void AbstractPostFeedModel::profileChanged()
 {
+    mViewRecords.clear();
     changeData({ int(Role::Author), int(Role::PostReplyToAuthor), int(Role::PostRepostedByAuthor) });
 }
 
@@ -607,9 +770,171 @@ void AbstractPostFeedModel::postBookmarkedChanged()
     changeData({ int(Role::PostBookmarked) });
 }
 
+void AbstractPostFeedModel::profileAdded(const QString& did)
+{
+    auto it = mCidsWaitingForProfile.find(did);
+
+    if (it == mCidsWaitingForProfile.end())
+        return;
+
+    for (const auto& cid : it->second)
+        changeData(cid, { int(Role::PostReplyToAuthor), int(Role::PostRecord), int(Role::PostRecordWithMedia) });
+
+    mCidsWaitingForProfile.erase(it);
+}
+
+void AbstractPostFeedModel::scheduleRemoveUnusedEntries()
+{
+    if (mRemoveUnusedScheduled)
+        return;
+
+    mRemoveUnusedScheduled = true;
+
+    QTimer::singleShot(0, this, [this]{
+        mRemoveUnusedScheduled = false;
+        removeUnusedCidsWaitingForProfile();
+        removeUnusedViewRecords();
+    });
+}
+
+void AbstractPostFeedModel::removeViewRecords(int firstRow, int lastRow)
+{
+    if (mViewRecords.empty())
+        return;
+
+    for (int row = firstRow; row <= lastRow; ++row)
+        mViewRecords.erase(getPost(row).getCid());
+}
+
+void AbstractPostFeedModel::removeUnusedViewRecords()
+{
+    if (mViewRecords.empty())
+        return;
+
+    std::erase_if(mViewRecords, [this](const auto& keyValue){ return getRowsForKey(keyValue.first).empty(); });
+    qDebug() << "View records:" << mViewRecords.size();
+}
+
+void AbstractPostFeedModel::removeUnusedCidsWaitingForProfile()
+{
+    if (mCidsWaitingForProfile.empty())
+        return;
+
+    for (auto it = mCidsWaitingForProfile.begin(); it != mCidsWaitingForProfile.end(); )
+    {
+        std::erase_if(it->second, [this](const QString& cid){ return getRowsForKey(cid).empty(); });
+
+        if (it->second.empty())
+            it = mCidsWaitingForProfile.erase(it);
+        else
+            ++it;
+    }
+
+    qDebug() << "DIDs waiting for profile:" << mCidsWaitingForProfile.size();
+}
+
 void AbstractPostFeedModel::changeData(const QList<int>& roles)
 {
-    emit dataChanged(createIndex(0, 0), createIndex(mFeed.size() - 1, 0), roles);
+    emit dataChanged(createIndex(0, 0), createIndex(rowCount() - 1, 0), roles);
+}
+
+void AbstractPostFeedModel::changeData(const QString& key, const QList<int>& roles)
+{
+    if (key.isEmpty())
+        return;
+
+    mPendingRowChanges[key].insert(roles.begin(), roles.end());
+
+    if (!mFlushScheduled)
+    {
+        mFlushScheduled = true;
+        QTimer::singleShot(0, this, [this]{ flushChangedRows(); });
+    }
+}
+
+static void addRowKey(std::unordered_map<QString, std::vector<int>>& index, const QString& key, int row)
+{
+    if (key.isEmpty())
+        return;
+
+    auto& rows = index[key];
+
+    // Avoid duplicates, e.g. the root of a thread has the same key as a reply's root.
+    if (rows.empty() || rows.back() != row)
+        rows.push_back(row);
+}
+
+void AbstractPostFeedModel::buildKeyRowIndex()
+{
+    mKeyRowIndex.clear();
+
+    for (int row = 0; row < rowCount(); ++row)
+    {
+        const Post& post = getPost(row);
+        addRowKey(mKeyRowIndex, post.getCid(), row);
+        addRowKey(mKeyRowIndex, post.getUri(), row);
+
+        if (post.isReply())
+        {
+            addRowKey(mKeyRowIndex, post.getReplyRootCid(), row);
+            addRowKey(mKeyRowIndex, post.getReplyRootUri(), row);
+        }
+    }
+
+    mKeyRowIndexValid = true;
+    qDebug() << "Built row index, rows:" << rowCount() << "keys:" << mKeyRowIndex.size();
+}
+
+const std::vector<int>& AbstractPostFeedModel::getRowsForKey(const QString& key)
+{
+    static const std::vector<int> NO_ROWS;
+
+    if (!mKeyRowIndexValid)
+        buildKeyRowIndex();
+
+    const auto it = mKeyRowIndex.find(key);
+    return it != mKeyRowIndex.end() ? it->second : NO_ROWS;
+}
+
+void AbstractPostFeedModel::flushChangedRows()
+{
+    mFlushScheduled = false;
+
+    if (mPendingRowChanges.empty())
+        return;
+
+    std::map<int, std::set<int>> rowRoles;
+
+    for (const auto& [key, roles] : mPendingRowChanges)
+    {
+        for (int row : getRowsForKey(key))
+        {
+            if (row < rowCount())
+                rowRoles[row].insert(roles.begin(), roles.end());
+        }
+    }
+
+    mPendingRowChanges.clear();
+
+    // Signal consecutive rows with the same role changes at once.
+    auto it = rowRoles.begin();
+
+    while (it != rowRoles.end())
+    {
+        const int firstRow = it->first;
+        const auto& roles = it->second;
+        int lastRow = firstRow;
+        auto next = std::next(it);
+
+        while (next != rowRoles.end() && next->first == lastRow + 1 && next->second == roles)
+        {
+            lastRow = next->first;
+            ++next;
+        }
+
+        emit dataChanged(createIndex(firstRow, 0), createIndex(lastRow, 0), QList<int>(roles.begin(), roles.end()));
+        it = next;
+    }
 }
 
 }
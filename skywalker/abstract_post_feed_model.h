@@ -3,14 +3,18 @@
 #pragma once
 #include "bookmarks.h"
 #include "content_filter.h"
+#include "formatted_text_cache.h"
 #include "hashtag_index.h"
 #include "local_post_model_changes.h"
 #include "local_profile_changes.h"
 #include "post.h"
 #include "profile_store.h"
+#include "relative_time_service.h"
 #include <QAbstractListModel>
 #include <deque>
 #include <queue>
+#include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace Skywalker {
@@ -19,7 +23,8 @@ class FocusHashtags;
 
 class AbstractPostFeedModel : public QAbstractListModel,
                               public LocalPostModelChanges,
-                              public LocalProfileChanges
+                              public LocalProfileChanges,
+                              public RelativeTimeService::Client
 {
     Q_OBJECT
     QML_ELEMENT
@@ -95,14 +100,25 @@ public:
                           const IMatchWords& mutedWords, const FocusHashtags& focusHashtags,
                           HashtagIndex& hashtags,
                           QObject* parent = nullptr);
+    ~AbstractPostFeedModel();
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 
-    const Post& getPost(int index) const { return mFeed.at(index); }
+    // A model showing posts stored elsewhere overrides getPost and rowCount.
+    virtual const Post& getPost(int index) const { return mFeed.at(index); }
     void preprocess(const Post& post);
 
-    Q_INVOKABLE void unfoldPosts(int startIndex);
+    Q_INVOKABLE virtual void unfoldPosts(int startIndex);
+
+    // Rows shown by the view. Only these rows get their relative time refreshed.
+    // An index of -1 means unknown, the range then extends to the start or end
+    // of the feed.
+    Q_INVOKABLE void setVisibleRange(int firstVisibleIndex, int lastVisibleIndex);
+
+    // RelativeTimeService::Client
+    virtual void refreshRelativeTime() override;
+    virtual QDateTime getYoungestVisibleTimestamp() const override;
 
 protected:
     QHash<int, QByteArray> roleNames() const override;
@@ -116,30 +132,40 @@ protected:
     void setEndOfFeed(bool endOfFeed) { mEndOfFeed = endOfFeed; }
     virtual bool mustHideContent(const Post& post) const;
 
+    // Can be called on a worker thread when the filters are immutable snapshots.
+    static bool mustHideContent(const Post& post, const IContentFilter& contentFilter,
+                                const IProfileStore& mutedReposts, const IMatchWords& mutedWords);
+
     // LocalPostModelChanges
     virtual void postIndexedSecondsAgoChanged() override;
-    virtual void likeCountChanged() override;
-    virtual void likeUriChanged() override;
-    virtual void likeTransientChanged() override;
-    virtual void replyCountChanged() override;
-    virtual void repostCountChanged() override;
-    virtual void quoteCountChanged() override;
-    virtual void repostUriChanged() override;
-    virtual void threadgateUriChanged() override;
-    virtual void replyRestrictionChanged() override;
-    virtual void replyRestrictionListsChanged() override;
-    virtual void hiddenRepliesChanged() override;
-    virtual void threadMutedChanged() override;
-    virtual void detachedRecordChanged() override;
-    virtual void reAttachedRecordChanged() override;
-    virtual void viewerStatePinnedChanged() override;
-    virtual void postDeletedChanged() override;
+    virtual void likeCountChanged(const QString& cid) override;
+    virtual void likeUriChanged(const QString& cid) override;
+    virtual void likeTransientChanged(const QString& cid) override;
+    virtual void replyCountChanged(const QString& cid) override;
+    virtual void repostCountChanged(const QString& cid) override;
+    virtual void quoteCountChanged(const QString& cid) override;
+    virtual void repostUriChanged(const QString& cid) override;
+    virtual void threadgateUriChanged(const QString& cid) override;
+    virtual void replyRestrictionChanged(const QString& cid) override;
+    virtual void replyRestrictionListsChanged(const QString& cid) override;
+    virtual void hiddenRepliesChanged(const QString& cid) override;
+    virtual void threadMutedChanged(const QString& uri) override;
+    virtual void detachedRecordChanged(const QString& cid) override;
+    virtual void reAttachedRecordChanged(const QString& cid) override;
+    virtual void viewerStatePinnedChanged(const QString& cid) override;
+    virtual void postDeletedChanged(const QString& cid) override;
 
     // LocalProfileChanges
     virtual void profileChanged() override;
 
+    // Change all rows.
     void changeData(const QList<int>& roles);
 
+    // Change the rows of posts with this CID or URI, or replies in the thread of a
+    // root post with this CID or URI. The changes are signalled at the next event
+    // loop iteration, such that multiple changes are coalesced.
+    void changeData(const QString& key, const QList<int>& roles);
+
     using TimelineFeed = std::deque<Post>;
     TimelineFeed mFeed;
 
@@ -153,11 +179,66 @@ protected:
     HashtagIndex& mHashtags;
 
 private:
+    // Values of a post that take filtering or lookups to compute. The record is
+    // built on the first access of a post and rebuilt after a change of the
+    // filters it depends on.
+    struct ViewRecord
+    {
+        BasicProfile mAuthor; // with local profile change
+        ContentLabelList mLabels;
+        QEnums::ContentVisibility mContentVisibility = QEnums::CONTENT_VISIBILITY_SHOW;
+        QString mContentWarning;
+        QEnums::MutedPostReason mMutedReason = QEnums::MUTED_POST_NONE;
+        QString mHighlightColor;
+        quint64 mContentFilterVersion = 0;
+        quint64 mMutedWordsVersion = 0;
+        quint64 mFocusHashtagsVersion = 0;
+    };
+
+    const ViewRecord& getViewRecord(const Post& post) const;
+    void buildViewRecord(ViewRecord& record, const Post& post) const;
     void postBookmarkedChanged();
+    void profileAdded(const QString& did);
+
+    // Remove the CIDs of posts that are not in the model anymore.
+    void scheduleRemoveUnusedEntries();
+    void removeUnusedCidsWaitingForProfile();
+    void removeViewRecords(int firstRow, int lastRow);
+    void removeUnusedViewRecords();
+    void flushChangedRows();
+    const std::vector<int>& getRowsForKey(const QString& key);
+    void buildKeyRowIndex();
+    std::pair<int, int> getVisibleRows() const;
+    bool hasVisibleRange() const;
 
     std::unordered_set<QString> mStoredCids;
     std::queue<QString> mStoredCidQueue;
 
+    // CID's and URI's of the posts (and their thread roots) -> rows
+    // The index is rebuilt lazily after rows have been inserted or removed.
+    std::unordered_map<QString, std::vector<int>> mKeyRowIndex;
+    bool mKeyRowIndexValid = false;
+
+    // CID or URI -> changed roles
+    std::unordered_map<QString, std::set<int>> mPendingRowChanges;
+    bool mFlushScheduled = false;
+    bool mRemoveUnusedScheduled = false;
+
+    // DID of profile requested from the author cache -> CID's of posts showing it
+    // An entry is removed when the profile gets added, the request fails or the
+    // posts are removed from the model.
+    mutable std::unordered_map<QString, std::unordered_set<QString>> mCidsWaitingForProfile;
+
+    mutable FormattedTextCache mFormattedTextCache{MAX_TIMELINE_SIZE};
+
+    // CID -> view record. A record is erased when a row of its post gets inserted,
+    // or the last row of its post gets removed.
+    mutable std::unordered_map<QString, ViewRecord> mViewRecords;
+    mutable ViewRecord mUncachedViewRecord; // for posts without CID
+
+    int mFirstVisibleIndex = -1;
+    int mLastVisibleIndex = -1;
+
     bool mEndOfFeed = false;
 };
 
@@ -19,13 +19,14 @@ ATProtoImageProvider* ATProtoImageProvider::getProvider(const QString& name)
 }
 
 ATProtoImageProvider::ATProtoImageProvider(const QString& name) :
-    mName(name)
+    mName(name),
+    mImages(name, MAX_CACHE_BYTES)
 {
 }
 
 ATProtoImageProvider::~ATProtoImageProvider()
 {
-    Q_ASSERT(mImages.empty());
+    mImages.logStats();
 }
 
 QString ATProtoImageProvider::createImageSource(const QString& host, const QString& did, const QString& cid) const
@@ -55,21 +56,17 @@ QString ATProtoImageProvider::sourceToId(const QString& source) const
 void ATProtoImageProvider::addImage(const QString& id, const QImage& img)
 {
     const QString source = idToSource(id);
-
-    QMutexLocker locker(&mMutex);
-    mImages[source] = img;
+    mImages.put(source, img);
 }
 
 QImage ATProtoImageProvider::getImage(const QString& source)
 {
-    QMutexLocker locker(&mMutex);
-    auto it = mImages.find(source);
-    return it != mImages.end() ? it->second : QImage();
+    return mImages.get(source);
 }
 
 void ATProtoImageProvider::clear()
 {
-    QMutexLocker locker(&mMutex);
+    mImages.logStats();
     mImages.clear();
 }
 
@@ -84,6 +81,7 @@ void ATProtoImageProvider::asyncAddImage(const QString& source, const std::funct
         return;
     }
 
+    pinImage(source);
     auto* response = requestImageResponse(id, {});
     connect(response, &QQuickImageResponse::finished, this, [cb, response]{
         cb();
@@ -112,6 +110,15 @@ ATProtoImageResponse::ATProtoImageResponse(const QString& providerName, const QS
         return;
     }
 
+    auto* provider = ATProtoImageProvider::getProvider(mProviderName);
+    const QImage img = provider->getImage(provider->idToSource(id));
+
+    if (!img.isNull())
+    {
+        QTimer::singleShot(0, this, [this, img]{ handleDone(img); });
+        return;
+    }
+
     const QString& host = idParts[0];
     const QString& did = idParts[1];
     const QString& cid = idParts[2];
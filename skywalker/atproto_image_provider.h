@@ -1,9 +1,9 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "image_cache.h"
 #include <atproto/lib/client.h>
 #include <QHashFunctions>
-#include <QMutex>
 #include <QQuickImageProvider>
 #include <unordered_map>
 
@@ -13,6 +13,7 @@ class ATProtoImageProvider : public QQuickAsyncImageProvider
 {
 public:
     static constexpr char const* DRAFT_IMAGE = "draftimage";
+    static constexpr qint64 MAX_CACHE_BYTES = 32 * 1024 * 1024;
     static ATProtoImageProvider* getProvider(const QString& name);
 
     explicit ATProtoImageProvider(const QString& name);
@@ -24,7 +25,16 @@ public:
     void addImage(const QString& id, const QImage& img);
     QImage getImage(const QString& source);
     void clear();
+    void logStats() const { mImages.logStats(); }
 
+    // Pinned images are not evicted, such that they can be retrieved with
+    // getImage, e.g. images of a draft that is open or being posted. A source
+    // can be pinned before its image is added.
+    void pinImage(const QString& source) { mImages.pin(source); }
+    void unpinImage(const QString& source) { mImages.unpin(source); }
+
+    // Images added this way are pinned in the cache till they get unpinned or the
+    // provider gets cleared.
     void asyncAddImage(const QString& source, const std::function<void()>& cb);
 
     // id = <host>/<did>/<cid>
@@ -33,8 +43,8 @@ public:
 private:
     QString mName;
 
-    QMutex mMutex;
-    std::unordered_map<QString, QImage> mImages; // source -> image
+    // Images can be loaded again from the network, so unpinned images can be evicted.
+    ImageCache mImages; // source -> image
 
     static std::unordered_map<QString, ATProtoImageProvider*> sProviders; // name -> provider
 };
@@ -2,6 +2,7 @@
 // License: GPLv3
 #include "author_cache.h"
 #include "skywalker.h"
+#include <QThread>
 
 namespace Skywalker {
 
@@ -14,17 +15,43 @@ AuthorCache::Entry::Entry(const BasicProfile& profile) :
 
 AuthorCache::AuthorCache(QObject* parent) :
     WrappedSkywalker(parent),
-    mCache(1000)
+    mCache(1000),
+    mProfileBatcher([this](const auto& dids, const auto& successCb, const auto& errorCb){
+                        getProfiles(dids, successCb, errorCb); })
 {
+    connect(&mProfileBatcher, &ProfileBatcher::profileReceived, this,
+            [this](auto profile){
+                mFailedDids.erase(profile->mDid);
+                put(BasicProfile(profile));
+                emit profileAdded(profile->mDid);
+            });
+    connect(&mProfileBatcher, &ProfileBatcher::profileFailed, this,
+            [this](const QString& did, const QString& error, const QString& msg){
+                handleProfileFailed(did, error, msg);
+            });
+    connect(&mProfileBatcher, &ProfileBatcher::requestFailed, this,
+            [this](const QString& did, const QString& error, const QString& msg){
+                // Not counted as a failure of the DID, it will be requested again when needed.
+                qDebug() << "putProfile request failed:" << did << error << " - " << msg;
+                emit profileFailed(did);
+            });
 }
 
 void AuthorCache::clear()
 {
     mCache.clear();
+    mProfileBatcher.clear();
 }
 
 void AuthorCache::put(const BasicProfile& author)
 {
+    // Posts get created on worker threads when feed pages are prepared.
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, [this, author]{ put(author); }, Qt::QueuedConnection);
+        return;
+    }
+
     const QString& did = author.getDid();
     Q_ASSERT(!did.isEmpty());
     if (did.isEmpty())
@@ -50,35 +77,43 @@ void AuthorCache::putProfile(const QString& did)
         return;
     }
 
-    if (mFetchingDids.contains(did))
+    if (mIgnoredDids.contains(did))
         return;
 
     if (!bskyClient())
         return;
 
-    mFetchingDids.insert(did);
-
-    bskyClient()->getProfile(did,
-        [this](auto profile){
-            mFetchingDids.erase(profile->mDid);
-            mFailedDids.erase(profile->mDid);
-            put(BasicProfile(profile));
-            emit profileAdded(profile->mDid);
-        },
-        [this, did](const QString& error, const QString& msg){
-            qDebug() << "putProfile failed:" << did << error << " - " << msg;
-
-            if (!mFailedDids.contains(did))
-            {
-                mFetchingDids.erase(did);
-                mFailedDids.insert(did);
-            }
-            else
-            {
-                qWarning() << "Failed to get DID for the second time:" << did << error << " - " << msg;
-                // Do not remove from mFetchingDids, so we will not try to get it again
-            }
-        });
+    // Authors shown together (notifications, threads) get fetched in one request.
+    mProfileBatcher.request(did);
+}
+
+void AuthorCache::getProfiles(const std::vector<QString>& dids, const ProfileBatcher::SuccessCb& successCb,
+                              const ProfileBatcher::ErrorCb& errorCb)
+{
+    if (!bskyClient())
+    {
+        errorCb("NoClient", "Not logged in");
+        return;
+    }
+
+    bskyClient()->getProfiles(dids, successCb, errorCb);
+}
+
+void AuthorCache::handleProfileFailed(const QString& did, const QString& error, const QString& msg)
+{
+    qDebug() << "putProfile failed:" << did << error << " - " << msg;
+
+    if (!mFailedDids.contains(did))
+    {
+        mFailedDids.insert(did);
+    }
+    else
+    {
+        qWarning() << "Failed to get DID for the second time:" << did << error << " - " << msg;
+        mIgnoredDids.insert(did); // do not try to get it again
+    }
+
+    emit profileFailed(did);
 }
 
 const BasicProfile* AuthorCache::get(const QString& did) const
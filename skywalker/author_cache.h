@@ -2,6 +2,7 @@
 // License: GPLv3
 #pragma once
 #include "profile.h"
+#include "profile_batcher.h"
 #include "profile_store.h"
 #include "wrapped_skywalker.h"
 #include <QCache>
@@ -29,6 +30,7 @@ public:
     static AuthorCache& instance();
 
     void clear();
+    // Can be called from any thread. The author gets added on the GUI thread.
     void put(const BasicProfile& author);
     void putProfile(const QString& did);
     const BasicProfile* get(const QString& did) const;
@@ -37,20 +39,26 @@ public:
     const BasicProfile& getUser() const { return mUser; }
     void setUser(const BasicProfile& user);
     void addProfileStore(const IProfileStore* store);
+    void logStats() const { mProfileBatcher.logStats(); }
 
 signals:
     void profileAdded(const QString& did);
+    void profileFailed(const QString& did);
 
 private:
     explicit AuthorCache(QObject* parent = nullptr);
 
     const BasicProfile* getFromStores(const QString& did) const;
+    void getProfiles(const std::vector<QString>& dids, const ProfileBatcher::SuccessCb& successCb,
+                     const ProfileBatcher::ErrorCb& errorCb);
+    void handleProfileFailed(const QString& did, const QString& error, const QString& msg);
 
     QCache<QString, Entry> mCache; // key is did
     std::unordered_set<const IProfileStore*> mProfileStores;
     BasicProfile mUser;
-    std::unordered_set<QString> mFetchingDids;
+    ProfileBatcher mProfileBatcher;
     std::unordered_set<QString> mFailedDids;
+    std::unordered_set<QString> mIgnoredDids; // failed twice, will not be requested again
 
     static std::unique_ptr<AuthorCache> sInstance;
 };
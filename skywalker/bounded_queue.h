@@ -0,0 +1,99 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <optional>
+
+namespace Skywalker {
+
+// Thread safe FIFO queue with a maximum size. Push blocks while the queue is full,
+// pop blocks while the queue is empty. After close, push fails and pop returns
+// the remaining items, then nullopt.
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t maxSize) : mMaxSize(maxSize)
+    {
+        Q_ASSERT(mMaxSize > 0);
+    }
+
+    // Returns false if the queue is closed.
+    bool push(T item)
+    {
+        QMutexLocker locker(&mMutex);
+
+        while (mItems.size() >= mMaxSize && !mClosed)
+            mNotFull.wait(&mMutex);
+
+        if (mClosed)
+            return false;
+
+        mItems.push_back(std::move(item));
+        mPeakSize = std::max(mPeakSize, mItems.size());
+        mNotEmpty.wakeOne();
+        return true;
+    }
+
+    // Returns nullopt if the queue is closed and empty.
+    std::optional<T> pop()
+    {
+        QMutexLocker locker(&mMutex);
+
+        while (mItems.empty() && !mClosed)
+            mNotEmpty.wait(&mMutex);
+
+        if (mItems.empty())
+            return {};
+
+        T item = std::move(mItems.front());
+        mItems.pop_front();
+        mNotFull.wakeOne();
+        return item;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&mMutex);
+        mClosed = true;
+        mNotEmpty.wakeAll();
+        mNotFull.wakeAll();
+    }
+
+    // Close and drop all items.
+    void cancel()
+    {
+        QMutexLocker locker(&mMutex);
+        mClosed = true;
+        mItems.clear();
+        mNotEmpty.wakeAll();
+        mNotFull.wakeAll();
+    }
+
+    size_t size() const
+    {
+        QMutexLocker locker(&mMutex);
+        return mItems.size();
+    }
+
+    size_t getPeakSize() const
+    {
+        QMutexLocker locker(&mMutex);
+        return mPeakSize;
+    }
+
+    size_t getMaxSize() const { return mMaxSize; }
+
+private:
+    const size_t mMaxSize;
+    mutable QMutex mMutex;
+    QWaitCondition mNotEmpty;
+    QWaitCondition mNotFull;
+    std::deque<T> mItems;
+    size_t mPeakSize = 0;
+    bool mClosed = false;
+};
+
+}
@@ -126,6 +126,9 @@ ContentFilter::ContentFilter(const ATProto::UserPreferences& userPreferences, Us
     mUserPreferences(userPreferences),
     mUserSettings(userSettings)
 {
+    // The signals are emitted by the owner after changing the settings.
+    connect(this, &ContentFilter::contentGroupsChanged, this, [this]{ ++mVersion; });
+    connect(this, &ContentFilter::subscribedLabelersChanged, this, [this]{ ++mVersion; });
 }
 
 void ContentFilter::clear()
@@ -350,6 +353,74 @@ bool ContentFilter::isFixedLabelerSubscription(const QString& did)
     return did == BLUESKY_MODERATOR_DID;
 }
 
+ContentFilterSnapshot::SharedPtr ContentFilter::createSnapshot() const
+{
+    ContentFilterSnapshot::SettingMap globalSettings;
+
+    for (const auto& [labelId, group] : getGlobalContentGroups())
+        globalSettings[labelId] = { getGroupVisibility(*group), getGroupWarning(*group) };
+
+    std::unordered_map<QString, ContentFilterSnapshot::SettingMap> labelerSettings;
+
+    for (const auto& [did, groupMap] : mLabelerGroupMap)
+    {
+        auto& settings = labelerSettings[did];
+
+        for (const auto& [labelId, group] : groupMap)
+            settings[labelId] = { getGroupVisibility(group), getGroupWarning(group) };
+    }
+
+    return std::make_shared<ContentFilterSnapshot>(std::move(globalSettings), std::move(labelerSettings));
+}
+
+ContentFilterSnapshot::ContentFilterSnapshot(SettingMap globalSettings, std::unordered_map<QString, SettingMap> labelerSettings) :
+    mGlobalSettings(std::move(globalSettings)),
+    mLabelerSettings(std::move(labelerSettings))
+{
+}
+
+const ContentFilterSnapshot::Setting* ContentFilterSnapshot::getSetting(const ContentLabel& label) const
+{
+    // Same lookup order as ContentFilter::getContentGroup
+    auto itGlobal = mGlobalSettings.find(label.getLabelId());
+
+    if (itGlobal != mGlobalSettings.end())
+        return &itGlobal->second;
+
+    auto itDid = mLabelerSettings.find(label.getDid());
+
+    if (itDid == mLabelerSettings.end())
+        return nullptr;
+
+    auto itLabel = itDid->second.find(label.getLabelId());
+    return itLabel != itDid->second.end() ? &itLabel->second : nullptr;
+}
+
+std::tuple<QEnums::ContentVisibility, QString> ContentFilterSnapshot::getVisibilityAndWarning(const ATProto::ComATProtoLabel::LabelList& labels) const
+{
+    const auto contentLabels = ContentFilter::getContentLabels(labels);
+    return getVisibilityAndWarning(contentLabels);
+}
+
+std::tuple<QEnums::ContentVisibility, QString> ContentFilterSnapshot::getVisibilityAndWarning(const ContentLabelList& contentLabels) const
+{
+    QEnums::ContentVisibility visibility = QEnums::CONTENT_VISIBILITY_SHOW;
+    QString warning;
+
+    for (const auto& label : contentLabels)
+    {
+        const auto* setting = getSetting(label);
+
+        if (!setting || setting->mVisibility <= visibility)
+            continue;
+
+        visibility = setting->mVisibility;
+        warning = setting->mWarning;
+    }
+
+    return {visibility, warning};
+}
+
 void ContentFilter::addContentGroupMap(const QString& did, const ContentGroupMap& contentGroupMap)
 {
     Q_ASSERT(!did.isEmpty());
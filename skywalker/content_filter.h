@@ -15,6 +15,38 @@ public:
     virtual ~IContentFilter() = default;
     virtual std::tuple<QEnums::ContentVisibility, QString> getVisibilityAndWarning(const ATProto::ComATProtoLabel::LabelList& labels) const = 0;
     virtual std::tuple<QEnums::ContentVisibility, QString> getVisibilityAndWarning(const ContentLabelList& contentLabels) const = 0;
+
+    // The version changes when the filter settings change. A filter that cannot
+    // change always has version 0.
+    virtual quint64 getVersion() const { return 0; }
+};
+
+// Immutable copy of the content filter settings that can be read from any thread.
+// The visibility and warning of each content group are resolved when the snapshot
+// is created.
+class ContentFilterSnapshot : public IContentFilter
+{
+public:
+    using SharedPtr = std::shared_ptr<const ContentFilterSnapshot>;
+
+    struct Setting
+    {
+        QEnums::ContentVisibility mVisibility = QEnums::CONTENT_VISIBILITY_SHOW;
+        QString mWarning;
+    };
+
+    using SettingMap = std::unordered_map<QString, Setting>; // label id -> setting
+
+    ContentFilterSnapshot(SettingMap globalSettings, std::unordered_map<QString, SettingMap> labelerSettings);
+
+    std::tuple<QEnums::ContentVisibility, QString> getVisibilityAndWarning(const ATProto::ComATProtoLabel::LabelList& labels) const override;
+    std::tuple<QEnums::ContentVisibility, QString> getVisibilityAndWarning(const ContentLabelList& contentLabels) const override;
+
+private:
+    const Setting* getSetting(const ContentLabel& label) const;
+
+    const SettingMap mGlobalSettings;
+    const std::unordered_map<QString, SettingMap> mLabelerSettings; // labeler DID -> settings
 };
 
 class ContentFilter : public QObject, public IContentFilter
@@ -77,6 +109,10 @@ public:
 
     static bool isFixedLabelerSubscription(const QString& did);
 
+    ContentFilterSnapshot::SharedPtr createSnapshot() const;
+
+    quint64 getVersion() const override { return mVersion; }
+
 signals:
     void contentGroupsChanged();
     void subscribedLabelersChanged();
@@ -88,6 +124,7 @@ private:
     const ATProto::UserPreferences& mUserPreferences;
     UserSettings* mUserSettings;
     std::unordered_map<QString, ContentGroupMap> mLabelerGroupMap; // labeler DID -> group map
+    quint64 mVersion = 0;
 };
 
 class ContentFilterShowAll : public IContentFilter
@@ -513,6 +513,10 @@ QList<DraftPostData*> DraftPosts::getDraftPostData(int index)
         if (post.hasLanguage())
             data->setLanguage(post.getLanguages().front().getShortCode());
 
+        // Images from the repo are only in the image provider.
+        if (mStorageType == STORAGE_REPO)
+            pinImages(data->images());
+
         setLabels(data, post);
         setReplyRestrictions(data, post);
 
@@ -553,6 +557,7 @@ void DraftPosts::removeDraftPost(int index)
 
 void DraftPosts::removeDraftPostsModel()
 {
+    unpinImages();
     mDraftPostsModel = nullptr;
 }
 
@@ -1626,4 +1631,30 @@ void DraftPosts::addImagesToPost(ATProto::AppBskyFeed::Record::Post& post,
         });
 }
 
+void DraftPosts::pinImages(const QList<ImageView>& images)
+{
+    auto* imgProvider = ATProtoImageProvider::getProvider(ATProtoImageProvider::DRAFT_IMAGE);
+
+    for (const auto& image : images)
+    {
+        const QString source = image.getFullSizeUrl();
+
+        if (!source.startsWith(QString("image://") + ATProtoImageProvider::DRAFT_IMAGE))
+            continue;
+
+        imgProvider->pinImage(source);
+        mPinnedImages.push_back(source);
+    }
+}
+
+void DraftPosts::unpinImages()
+{
+    auto* imgProvider = ATProtoImageProvider::getProvider(ATProtoImageProvider::DRAFT_IMAGE);
+
+    for (const auto& source : mPinnedImages)
+        imgProvider->unpinImage(source);
+
+    mPinnedImages.clear();
+}
+
 }
@@ -156,9 +156,15 @@ private:
     void addImagesToPost(ATProto::AppBskyFeed::Record::Post& post,
                          const QList<ImageView>& images,
                          const std::function<void()>& continueCb, int imgSeq = 1);
+    void pinImages(const QList<ImageView>& images);
+    void unpinImages();
 
     DraftPostsModel::Ptr mDraftPostsModel;
 
+    // Images of the opened draft, they must stay in the image provider till the
+    // draft is posted or closed.
+    QStringList mPinnedImages;
+
     StorageType mStorageType = STORAGE_REPO;
 };
 
@@ -2,7 +2,6 @@
 // License: GPLv3
 #include "emoji_fix_highlighter.h"
 #include "font_downloader.h"
-#include "unicode_fonts.h"
 
 namespace Skywalker {
 
@@ -37,23 +36,45 @@ void EmojiFixHighlighter::setEmojiFixDocument(QQuickTextDocument* doc, int maxLe
 void EmojiFixHighlighter::addFormat(int start, int sz, const QTextCharFormat& fmt)
 {
     const int end = start + sz;
+    int runStart = start;
 
-    for (int i = start; i < end; ++i)
+    // Merge the format once per run of characters with the same format.
+    while (runStart < end)
     {
-        auto f = format(i);
+        auto f = format(runStart);
+        int runEnd = runStart + 1;
+
+        while (runEnd < end && format(runEnd) == f)
+            ++runEnd;
+
         f.merge(fmt);
-        setFormat(i, 1, f);
+        setFormat(runStart, runEnd - runStart, f);
+        runStart = runEnd;
     }
 }
 
 void EmojiFixHighlighter::highlightBlock(const QString& text)
 {
-    highlightLengthExceeded(text);
-    setEmojiFontKeycaps(text);
-    setEmojiFontCombinedEmojis(text);
+    const auto* graphemes = updateGraphemeBlockData(text);
+    highlightLengthExceeded(text, *graphemes);
+    setEmojiFont(*graphemes);
+}
+
+GraphemeBlockData* EmojiFixHighlighter::updateGraphemeBlockData(const QString& text)
+{
+    auto* graphemes = dynamic_cast<GraphemeBlockData*>(currentBlockUserData());
+
+    if (!graphemes)
+    {
+        graphemes = new GraphemeBlockData;
+        setCurrentBlockUserData(graphemes);
+    }
+
+    graphemes->update(text);
+    return graphemes;
 }
 
-void EmojiFixHighlighter::highlightLengthExceeded(const QString& text)
+void EmojiFixHighlighter::highlightLengthExceeded(const QString& text, const GraphemeBlockData& graphemes)
 {
     if (mMaxLength == -1)
         return;
@@ -69,8 +90,7 @@ void EmojiFixHighlighter::highlightLengthExceeded(const QString& text)
         totalLength = prevLength + 1; // +1 for newline
     }
 
-    const auto graphemeInfo = UnicodeFonts::getGraphemeInfo(text);
-    const int blockLength = graphemeInfo.getLength();
+    const int blockLength = graphemes.getLength();
     totalLength += blockLength;
     setCurrentBlockState(totalLength);
 
@@ -88,7 +108,7 @@ void EmojiFixHighlighter::highlightLengthExceeded(const QString& text)
     {
         const int inMaxGraphemes = mMaxLength - prevLength;
         Q_ASSERT(inMaxGraphemes > 0);
-        const int charPos = graphemeInfo.getCharPos(inMaxGraphemes - 1);
+        const int charPos = graphemes.getCharPos(inMaxGraphemes - 1);
         QTextCharFormat fmt;
         fmt.setFont(document()->defaultFont());
         setFormat(0, charPos, fmt);
@@ -98,48 +118,34 @@ void EmojiFixHighlighter::highlightLengthExceeded(const QString& text)
     }
 }
 
-void EmojiFixHighlighter::setEmojiFontKeycaps(const QString& text)
+void EmojiFixHighlighter::setEmojiFont(const GraphemeBlockData& graphemes)
 {
-    static const QRegularExpression enclosingKeycapRE("(.\uFE0F\u20E3)");
-    auto i = text.indexOf(enclosingKeycapRE);
+    // Keycaps and long emoji graphemes, e.g. ZWJ sequences, are not always
+    // correctly rendered by the primary font. Adjacent emoji's are formatted
+    // as one range.
+    int rangeStart = -1;
+    int rangeEnd = -1;
 
-    while (i != -1)
+    for (const auto& grapheme : graphemes.getGraphemes())
     {
-        addFormat(i, 3, mEmojiFormat);
-        i = text.indexOf(enclosingKeycapRE, i + 3);
-    }
-}
+        if (grapheme.mEmojiLength == 0)
+            continue;
 
-void EmojiFixHighlighter::setEmojiFontCombinedEmojis(const QString& text)
-{
-    // ZWJ Emoji's are not always correctly rendered. Somehow the primary font
-    // renders them as 2 separate emoji's.
-    //
-    // Example: the rainbow flag: \U0001F3F3\uFE0F\u200D\U0001F308"
-    //          \U0001F3F3\uFE0F = white flag
-    //          \u200D =           ZWJ
-    //          \U0001F308 =       rainbow
-    //
-    // Explicity set emoji font for long emoji graphemes.
-
-    QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, text);
-    int prev = 0;
-    int next;
-
-    while ((next = boundaryFinder.toNextBoundary()) != -1)
-    {
-        const int len = next - prev;
+        const int emojiStart = grapheme.mEnd - grapheme.mEmojiLength;
 
-        if (len > 2)
+        if (emojiStart != rangeEnd)
         {
-            const QString grapheme = text.sliced(prev, len);
+            if (rangeStart != -1)
+                addFormat(rangeStart, rangeEnd - rangeStart, mEmojiFormat);
 
-            if (UnicodeFonts::onlyEmojis(grapheme))
-                addFormat(prev, len, mEmojiFormat);
+            rangeStart = emojiStart;
         }
 
-        prev = next;
+        rangeEnd = grapheme.mEnd;
     }
+
+    if (rangeStart != -1)
+        addFormat(rangeStart, rangeEnd - rangeStart, mEmojiFormat);
 }
 
 }
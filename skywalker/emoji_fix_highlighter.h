@@ -1,6 +1,7 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "grapheme_block_data.h"
 #include <QSyntaxHighlighter>
 #include <QQuickTextDocument>
 #include <QtQmlIntegration>
@@ -24,9 +25,9 @@ protected:
     void addFormat(int start, int sz, const QTextCharFormat& fmt);
 
 private:
-    void highlightLengthExceeded(const QString& text);
-    void setEmojiFontKeycaps(const QString& text);
-    void setEmojiFontCombinedEmojis(const QString& text);
+    GraphemeBlockData* updateGraphemeBlockData(const QString& text);
+    void highlightLengthExceeded(const QString& text, const GraphemeBlockData& graphemes);
+    void setEmojiFont(const GraphemeBlockData& graphemes);
 
     int mMaxLength = -1;
     QTextCharFormat mLengthExceededFormat;
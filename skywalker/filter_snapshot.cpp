@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "filter_snapshot.h"
+#include <QTimer>
+
+namespace Skywalker {
+
+FilterSnapshotPublisher::FilterSnapshotPublisher(const ContentFilter& contentFilter, const MutedWords& mutedWords,
+                                                 const FocusHashtags& focusHashtags, const ProfileStore& following,
+                                                 const ProfileStore& mutedReposts, QObject* parent) :
+    QObject(parent),
+    mContentFilter(contentFilter),
+    mMutedWords(mutedWords),
+    mFocusHashtags(focusHashtags),
+    mFollowing(following),
+    mMutedReposts(mutedReposts)
+{
+    connect(&mContentFilter, &ContentFilter::contentGroupsChanged, this, &FilterSnapshotPublisher::invalidate);
+    connect(&mContentFilter, &ContentFilter::subscribedLabelersChanged, this, &FilterSnapshotPublisher::invalidate);
+    connect(&mMutedWords, &MutedWords::entriesChanged, this, &FilterSnapshotPublisher::invalidate);
+    connect(&mFocusHashtags, &FocusHashtags::entriesChanged, this, [this]{
+        connectFocusHashtagEntries();
+        invalidate();
+    });
+
+    connectFocusHashtagEntries();
+    publish();
+}
+
+void FilterSnapshotPublisher::connectFocusHashtagEntries()
+{
+    // Hashtags and colors of an entry change without a change of the entry list.
+    for (const auto* entry : mFocusHashtags.getEntries())
+    {
+        connect(entry, &FocusHashtagEntry::hashtagsChanged, this, &FilterSnapshotPublisher::invalidate, Qt::UniqueConnection);
+        connect(entry, &FocusHashtagEntry::highlightColorChanged, this, &FilterSnapshotPublisher::invalidate, Qt::UniqueConnection);
+    }
+}
+
+FilterSnapshot::SharedPtr FilterSnapshotPublisher::getSnapshot() const
+{
+    QMutexLocker locker(&mMutex);
+    return mSnapshot;
+}
+
+void FilterSnapshotPublisher::invalidate()
+{
+    if (mPublishScheduled)
+        return;
+
+    mPublishScheduled = true;
+    QTimer::singleShot(0, this, [this]{ publish(); });
+}
+
+void FilterSnapshotPublisher::publish()
+{
+    mPublishScheduled = false;
+    const auto oldSnapshot = getSnapshot();
+    auto snapshot = std::make_shared<FilterSnapshot>();
+
+    snapshot->mVersion = oldSnapshot ? oldSnapshot->mVersion + 1 : 1;
+    snapshot->mContentFilter = mContentFilter.createSnapshot();
+    snapshot->mMutedWords = mMutedWords.getMatcher();
+    snapshot->mFocusHashtags = mFocusHashtags.createMatcher();
+
+    if (oldSnapshot && mFollowingVersion == mFollowing.getVersion())
+    {
+        snapshot->mFollowing = oldSnapshot->mFollowing;
+    }
+    else
+    {
+        snapshot->mFollowing = mFollowing.createSnapshot();
+        mFollowingVersion = mFollowing.getVersion();
+    }
+
+    if (oldSnapshot && mMutedRepostsVersion == mMutedReposts.getVersion())
+    {
+        snapshot->mMutedReposts = oldSnapshot->mMutedReposts;
+    }
+    else
+    {
+        snapshot->mMutedReposts = mMutedReposts.createSnapshot();
+        mMutedRepostsVersion = mMutedReposts.getVersion();
+    }
+
+    const quint64 version = snapshot->mVersion;
+
+    {
+        QMutexLocker locker(&mMutex);
+        mSnapshot = std::move(snapshot);
+    }
+
+    qDebug() << "Published filter snapshot:" << version;
+    emit snapshotPublished(version);
+}
+
+}
@@ -0,0 +1,74 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "content_filter.h"
+#include "focus_hashtags.h"
+#include "muted_words.h"
+#include "profile_store.h"
+#include <QMutex>
+#include <QObject>
+
+namespace Skywalker {
+
+// Immutable copy of the filter configuration. Feed processing on a worker thread
+// can hold on to a snapshot while the GUI thread keeps editing the configuration.
+struct FilterSnapshot
+{
+    using SharedPtr = std::shared_ptr<const FilterSnapshot>;
+
+    quint64 mVersion = 0;
+    ContentFilterSnapshot::SharedPtr mContentFilter;
+    MutedWords::Matcher::SharedPtr mMutedWords;
+    FocusHashtags::Matcher::SharedPtr mFocusHashtags;
+    ProfileStoreSnapshot::SharedPtr mFollowing;
+    ProfileStoreSnapshot::SharedPtr mMutedReposts;
+};
+
+// Publishes a new snapshot when the filter configuration changes. The current
+// snapshot can be taken from any thread. Publishing is done on the GUI thread.
+class FilterSnapshotPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    FilterSnapshotPublisher(const ContentFilter& contentFilter, const MutedWords& mutedWords,
+                            const FocusHashtags& focusHashtags, const ProfileStore& following,
+                            const ProfileStore& mutedReposts, QObject* parent = nullptr);
+
+    // Thread safe
+    FilterSnapshot::SharedPtr getSnapshot() const;
+
+    // Publish a new snapshot at the next event loop iteration. Changes of the
+    // content filter, muted words and focus hashtags are signalled by these
+    // objects. Profile store changes must be signalled by calling this function,
+    // e.g. from the changed callback of the store.
+    void invalidate();
+
+    // Publish a new snapshot now.
+    void publish();
+
+signals:
+    void snapshotPublished(quint64 version);
+
+private:
+    void connectFocusHashtagEntries();
+
+    const ContentFilter& mContentFilter;
+    const MutedWords& mMutedWords;
+    const FocusHashtags& mFocusHashtags;
+    const ProfileStore& mFollowing;
+    const ProfileStore& mMutedReposts;
+
+    // Only the shared pointer is guarded, a snapshot itself never changes.
+    mutable QMutex mMutex;
+    FilterSnapshot::SharedPtr mSnapshot;
+
+    // Profile store versions in the snapshot. The follows can be large, so a
+    // store is only copied when it changed.
+    quint64 mFollowingVersion = 0;
+    quint64 mMutedRepostsVersion = 0;
+
+    bool mPublishScheduled = false;
+};
+
+}
@@ -1,11 +1,13 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #include "filtered_post_feed_model.h"
+#include <algorithm>
 #include <ranges>
 
 namespace Skywalker {
 
 FilteredPostFeedModel::FilteredPostFeedModel(IPostFilter::Ptr postFilter,
+                                             const TimelineFeed& timeline,
                                              const QString& userDid, const IProfileStore& following,
                                              const IProfileStore& mutedReposts,
                                              const IContentFilter& contentFilter,
@@ -16,18 +18,49 @@ FilteredPostFeedModel::FilteredPostFeedModel(IPostFilter::Ptr postFilter,
                                              QObject* parent) :
     AbstractPostFeedModel(userDid, following, mutedReposts, contentFilter, bookmarks, mutedWords,
                   focusHashtags, hashtags, parent),
-    mPostFilter(std::move(postFilter))
+    mPostFilter(std::move(postFilter)),
+    mTimeline(timeline)
 {
     Q_ASSERT(mPostFilter);
 }
 
+int FilteredPostFeedModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return mTimelineRows.size();
+}
+
+const Post& FilteredPostFeedModel::getPost(int index) const
+{
+    return mTimeline.at(mTimelineRows.at(index) + mTimelineOffset);
+}
+
+void FilteredPostFeedModel::unfoldPosts(int startIndex)
+{
+    qDebug() << "Unfold posts:" << getFeedName() << startIndex;
+
+    if (startIndex < 0 || startIndex >= rowCount())
+    {
+        qWarning() << "Invalid index:" << startIndex << "size:" << rowCount();
+        return;
+    }
+
+    emit unfoldTimelinePosts(getTimelineRow(startIndex));
+}
+
+void FilteredPostFeedModel::timelinePostsUnfolded()
+{
+    changeData({ int(Role::PostFoldedType) });
+}
+
 void FilteredPostFeedModel::clear()
 {
-    if (!mFeed.empty())
+    if (!mTimelineRows.empty())
     {
-        beginRemoveRows({}, 0, mFeed.size() - 1);
+        beginRemoveRows({}, 0, mTimelineRows.size() - 1);
         clearFeed();
-        mGapIdIndexMap.clear();
+        mTimelineRows.clear();
+        mTimelineOffset = 0;
         endRemoveRows();
     }
 
@@ -36,28 +69,29 @@ void FilteredPostFeedModel::clear()
     qDebug() << "All posts removed";
 }
 
-void FilteredPostFeedModel::setPosts(const TimelineFeed& posts, size_t numPosts)
+void FilteredPostFeedModel::setPosts()
 {
-    Q_ASSERT(numPosts <= posts.size());
     clear();
-    addPosts(posts, numPosts);
+    addPosts(0, mTimeline.size());
 }
 
-void FilteredPostFeedModel::addPosts(const TimelineFeed& posts, size_t numPosts)
+void FilteredPostFeedModel::addPosts(size_t startIndex, size_t numPosts)
 {
-    Q_ASSERT(numPosts <= posts.size());
-    qDebug() << "Add posts:" << getFeedName() << "posts:" << numPosts;
-    auto page = createPage(posts, 0, numPosts);
+    Q_ASSERT(startIndex + numPosts <= mTimeline.size());
+    qDebug() << "Add posts:" << getFeedName() << "start:" << startIndex << "posts:" << numPosts;
+    auto page = createPage(startIndex, numPosts);
 
-    if (page->mFeed.empty())
+    if (page->mTimelineRows.empty())
         setNumPostsChecked(mNumPostsChecked + numPosts);
     else
-        setNumPostsChecked(numPosts - page->mFeed.size());
+        setNumPostsChecked(numPosts - page->mTimelineRows.size());
 
     addPage(std::move(page));
 
-    for (const auto& post : posts | std::ranges::views::reverse)
+    for (size_t i = startIndex + numPosts; i > startIndex; --i)
     {
+        const auto& post = mTimeline[i - 1];
+
         if (!post.isPlaceHolder())
         {
             setCheckedTillTimestamp(post.getTimelineTimestamp());
@@ -66,77 +100,74 @@ void FilteredPostFeedModel::addPosts(const TimelineFeed& posts, size_t numPosts)
     }
 }
 
-void FilteredPostFeedModel::prependPosts(const TimelineFeed& posts, size_t numPosts)
+void FilteredPostFeedModel::prependPosts(size_t numPosts)
 {
-    Q_ASSERT(numPosts <= posts.size());
+    Q_ASSERT(numPosts <= mTimeline.size());
     qDebug() << "Prepend posts:" << getFeedName() << "posts:" << numPosts;
-    auto page = createPage(posts, 0, numPosts);
+    mTimelineOffset += qint64(numPosts);
+    auto page = createPage(0, numPosts);
     prependPage(std::move(page));
 }
 
-void FilteredPostFeedModel::gapFill(const TimelineFeed& posts, size_t numPosts, int gapId)
+void FilteredPostFeedModel::gapFill(size_t gapIndex, size_t numPosts, int gapId)
 {
-    qDebug() << "Fill gap:" << getFeedName() << gapId << "posts:" << numPosts;
+    Q_ASSERT(gapIndex + numPosts <= mTimeline.size());
+    qDebug() << "Fill gap:" << getFeedName() << gapId << "index:" << gapIndex << "posts:" << numPosts;
 
-    if (!mGapIdIndexMap.count(gapId))
-    {
-        qWarning() << "Gap does not exist:" << gapId;
-        return;
-    }
+    // The timeline rows after the gap moved by the size of the fill minus the place holder.
+    const qint64 gapRow = qint64(gapIndex) - mTimelineOffset;
+    auto gapIt = std::lower_bound(mTimelineRows.begin(), mTimelineRows.end(), gapRow);
+    const size_t index = gapIt - mTimelineRows.begin();
+    const bool gapFound = gapIt != mTimelineRows.end() && *gapIt == gapRow;
 
-    const int gapIndex = mGapIdIndexMap[gapId];
-    mGapIdIndexMap.erase(gapId);
+    for (auto it = gapFound ? gapIt + 1 : gapIt; it != mTimelineRows.end(); ++it)
+        *it += qint64(numPosts) - 1;
 
-    if (gapIndex > (int)mFeed.size() - 1)
+    if (gapFound)
     {
-        qWarning() << "Gap:" << getFeedName() << gapId << "index:" << gapIndex << "beyond feed size" << mFeed.size();
-        return;
+        // Remove gap place holder
+        removePosts(index, 1);
+        qDebug() << "Removed place holder gap post:" << getFeedName() << index;
+    }
+    else
+    {
+        qWarning() << "Gap does not exist:" << getFeedName() << gapId << "index:" << gapIndex;
     }
 
-    qDebug() << "Gap id:" << gapId << "index:" << gapIndex << "post.gapId:" << mFeed[gapIndex].getGapId();
-    Q_ASSERT(mFeed[gapIndex].getGapId() == gapId);
-
-    // Remove gap place holder
-    beginRemoveRows({}, gapIndex, gapIndex);
-    mFeed.erase(mFeed.begin() + gapIndex);
-    addToIndices(-1, gapIndex);
-    endRemoveRows();
-
-    qDebug() << "Removed place holder gap post:" << getFeedName() << gapIndex;
-    auto page = createPage(posts, 0, numPosts);
+    auto page = createPage(gapIndex, numPosts);
 
-    if (page->mFeed.empty())
+    if (page->mTimelineRows.empty())
     {
         qDebug() << "All posts have been filtered:" << getFeedName();
         return;
     }
 
-    beginInsertRows({}, gapIndex, gapIndex + page->mFeed.size() - 1);
-    insertPage(mFeed.begin() + gapIndex, *page);
+    beginInsertRows({}, index, index + page->mTimelineRows.size() - 1);
+    insertPage(index, *page);
     endInsertRows();
 }
 
-void FilteredPostFeedModel::removeHeadPosts(const TimelineFeed& posts, size_t numPosts)
+void FilteredPostFeedModel::removeHeadPosts(size_t numPosts)
 {
-    Q_ASSERT(numPosts <= posts.size());
     qDebug() << "Remove head posts:" << getFeedName() << "posts:" << numPosts;
-    auto page = createPage(posts, 0, numPosts);
-    const size_t removeCount = page->mFeed.size();
+    const qint64 endRow = qint64(numPosts) - mTimelineOffset;
+    const size_t removeCount = std::lower_bound(mTimelineRows.begin(), mTimelineRows.end(), endRow) - mTimelineRows.begin();
     qDebug() << "Remove filtered head posts:" << getFeedName() << "num:" << removeCount;
+    mTimelineOffset -= qint64(numPosts);
     removePosts(0, removeCount);
 }
 
-void FilteredPostFeedModel::removeTailPosts(const TimelineFeed& posts, size_t numPosts)
+void FilteredPostFeedModel::removeTailPosts()
 {
-    Q_ASSERT(numPosts <= posts.size());
-    qDebug() << "Remove tail posts:" << getFeedName() << "posts:" << numPosts;
-    auto page = createPage(posts, posts.size() - numPosts, numPosts);
-    const size_t removeCount = page->mFeed.size();
+    qDebug() << "Remove tail posts:" << getFeedName() << "timeline size:" << mTimeline.size();
+    const qint64 endRow = qint64(mTimeline.size()) - mTimelineOffset;
+    const size_t removeIndex = std::lower_bound(mTimelineRows.begin(), mTimelineRows.end(), endRow) - mTimelineRows.begin();
+    const size_t removeCount = mTimelineRows.size() - removeIndex;
     qDebug() << "Remove filtered tail posts:" << getFeedName() << "num:" << removeCount;
-    removePosts(mFeed.size() - removeCount, removeCount);
+    removePosts(removeIndex, removeCount);
     setNumPostsChecked(0);
 
-    for (const auto& post : posts)
+    for (const auto& post : mTimeline)
     {
         if (!post.isPlaceHolder())
         {
@@ -164,14 +195,6 @@ void FilteredPostFeedModel::setCheckedTillTimestamp(QDateTime timestamp)
     }
 }
 
-void FilteredPostFeedModel::Page::addPost(const Post* post)
-{
-    mFeed.push_back(post);
-
-    if (post->getGapId() != 0)
-        mGapIdIndexMap[post->getGapId()] = mFeed.size() - 1;
-}
-
 int FilteredPostFeedModel::Page::addThread(const TimelineFeed& posts, int startIndex, size_t numPosts, int matchedPostIndex)
 {
     Q_ASSERT(startIndex >= 0);
@@ -212,25 +235,25 @@ int FilteredPostFeedModel::Page::addThread(const TimelineFeed& posts, int startI
         endThread = endIndex;
 
     for (int j = startThread; j <= endThread; ++j)
-        addPost(&posts[j]);
+        mTimelineRows.push_back(j);
 
     return endThread;
 }
 
-FilteredPostFeedModel::Page::Ptr FilteredPostFeedModel::createPage(const TimelineFeed& posts, int startIndex, size_t numPosts)
+FilteredPostFeedModel::Page::Ptr FilteredPostFeedModel::createPage(size_t startIndex, size_t numPosts) const
 {
-    Q_ASSERT(startIndex + numPosts <= posts.size());
+    Q_ASSERT(startIndex + numPosts <= mTimeline.size());
     auto page = std::make_unique<Page>();
 
-    for (int i = startIndex; i < startIndex + (int)numPosts; ++i)
+    for (int i = startIndex; i < int(startIndex + numPosts); ++i)
     {
-        const auto& post = posts[i];
+        const auto& post = mTimeline[i];
 
-        // By copying all gaps from the full time line, we can fill them in when they
+        // By adding all gaps from the full time line, we can fill them in when they
         // get filled in the full timeline.
         if (post.isGap())
         {
-            page->addPost(&post);
+            page->mTimelineRows.push_back(i);
             continue;
         }
 
@@ -239,73 +262,64 @@ FilteredPostFeedModel::Page::Ptr FilteredPostFeedModel::createPage(const Timelin
 
         if (post.getPostType() == QEnums::POST_STANDALONE)
         {
-            page->addPost(&post);
+            page->mTimelineRows.push_back(i);
             continue;
         }
 
-        i = page->addThread(posts, startIndex, numPosts, i);
+        i = page->addThread(mTimeline, startIndex, numPosts, i);
     }
 
     return page;
 }
 
-void FilteredPostFeedModel::insertPage(const TimelineFeed::iterator& feedInsertIt, const Page& page)
+void FilteredPostFeedModel::insertPage(size_t index, const Page& page)
 {
-    if (page.mFeed.empty())
+    if (page.mTimelineRows.empty())
     {
         qDebug() << "Nothing to insert:" << getFeedName();
         return;
     }
 
-    if (feedInsertIt != mFeed.end())
-        addToIndices(page.mFeed.size(), feedInsertIt - mFeed.begin());
-
-    auto posts = page.mFeed | std::views::transform([](const Post* p){ return *p; });
-    const auto insertIt = mFeed.insert(feedInsertIt, posts.begin(), posts.end());
-    const int insertIndex = insertIt - mFeed.begin();
-
-    for (const auto& [gapId, gapIndex] : page.mGapIdIndexMap)
-    {
-        mGapIdIndexMap[gapId] = insertIndex + gapIndex;
-    }
+    auto rows = page.mTimelineRows | std::views::transform([this](size_t row){ return qint64(row) - mTimelineOffset; });
+    mTimelineRows.insert(mTimelineRows.begin() + index, rows.begin(), rows.end());
 }
 
 void FilteredPostFeedModel::addPage(Page::Ptr page)
 {
-    if (page->mFeed.empty())
+    if (page->mTimelineRows.empty())
     {
         qDebug() << "All posts have been filtered:" << getFeedName();
         return;
     }
 
-    const size_t newRowCount = mFeed.size() + page->mFeed.size();
+    const size_t newRowCount = mTimelineRows.size() + page->mTimelineRows.size();
 
-    beginInsertRows({}, mFeed.size(), newRowCount - 1);
-    insertPage(mFeed.end(), *page);
+    beginInsertRows({}, mTimelineRows.size(), newRowCount - 1);
+    insertPage(mTimelineRows.size(), *page);
     endInsertRows();
 
-    qDebug() << "Added filtered posts:" << page->mFeed.size() << getFeedName() << mFeed.size();
+    qDebug() << "Added filtered posts:" << page->mTimelineRows.size() << getFeedName() << mTimelineRows.size();
 }
 
 void FilteredPostFeedModel::prependPage(Page::Ptr page)
 {
-    if (page->mFeed.empty())
+    if (page->mTimelineRows.empty())
     {
         qDebug() << "All posts have been filtered:" << getFeedName();
         return;
     }
 
-    beginInsertRows({}, 0, page->mFeed.size() - 1);
-    insertPage(mFeed.begin(), *page);
+    beginInsertRows({}, 0, page->mTimelineRows.size() - 1);
+    insertPage(0, *page);
     endInsertRows();
 
-    qDebug() << "Prepended filtered posts:" << page->mFeed.size() << getFeedName() << mFeed.size();
+    qDebug() << "Prepended filtered posts:" << page->mTimelineRows.size() << getFeedName() << mTimelineRows.size();
 }
 
 void FilteredPostFeedModel::removePosts(size_t startIndex, size_t count)
 {
-    qDebug() << "Remove posts, start:" << startIndex << "count:" << count << "feedSize:" << mFeed.size();
-    Q_ASSERT(startIndex + count <= mFeed.size());
+    qDebug() << "Remove posts, start:" << startIndex << "count:" << count << "size:" << mTimelineRows.size();
+    Q_ASSERT(startIndex + count <= mTimelineRows.size());
 
     if (count == 0)
     {
@@ -313,34 +327,11 @@ void FilteredPostFeedModel::removePosts(size_t startIndex, size_t count)
         return;
     }
 
-    const size_t endIndex = startIndex + count - 1;
-
-    beginRemoveRows({}, startIndex, endIndex);
-
-    for (auto it = mGapIdIndexMap.begin(); it != mGapIdIndexMap.end(); )
-    {
-        if (it->second >= startIndex && it->second <= endIndex)
-            it = mGapIdIndexMap.erase(it);
-        else
-            ++it;
-    }
-
-    if (endIndex < mFeed.size() - 1)
-        addToIndices(-count, endIndex + 1);
-
-    mFeed.erase(mFeed.begin() + startIndex, mFeed.begin() + startIndex + count);
+    beginRemoveRows({}, startIndex, startIndex + count - 1);
+    mTimelineRows.erase(mTimelineRows.begin() + startIndex, mTimelineRows.begin() + startIndex + count);
     endRemoveRows();
 
-    qDebug() << "Removed posts:" << count << getFeedName() << mFeed.size();
-}
-
-void FilteredPostFeedModel::addToIndices(int offset, size_t startAtIndex)
-{
-    for (auto& [gapId, index] : mGapIdIndexMap)
-    {
-        if (index >= startAtIndex)
-            index += offset;
-    }
+    qDebug() << "Removed posts:" << count << getFeedName() << mTimelineRows.size();
 }
 
 }
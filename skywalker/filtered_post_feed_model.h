@@ -18,7 +18,10 @@ class FilteredPostFeedModel : public AbstractPostFeedModel
 public:
     using Ptr = std::unique_ptr<FilteredPostFeedModel>;
 
+    // The model shows posts from the timeline without copying them. The owner
+    // of the timeline must call the functions below after changing it.
     explicit FilteredPostFeedModel(IPostFilter::Ptr postFilter,
+                                   const TimelineFeed& timeline,
                                    const QString& userDid, const IProfileStore& following,
                                    const IProfileStore& mutedReposts,
                                    const IContentFilter& contentFilter,
@@ -32,13 +35,31 @@ public:
     QColor getBackgroundColor() const { return mPostFilter->getBackgroundColor(); }
     BasicProfile getProfile() const { return mPostFilter->getAuthor(); }
 
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    const Post& getPost(int index) const override;
+    void unfoldPosts(int startIndex) override;
+
     void clear();
-    void setPosts(const TimelineFeed& posts, size_t numPosts);
-    void addPosts(const TimelineFeed& posts, size_t numPosts);
-    void prependPosts(const TimelineFeed& posts, size_t numPosts);
-    void gapFill(const TimelineFeed& posts, size_t numPosts, int gapId);
-    void removeHeadPosts(const TimelineFeed& posts, size_t numPosts);
-    void removeTailPosts(const TimelineFeed& posts, size_t numPosts);
+    void setPosts();
+
+    // numPosts have been added to the timeline at startIndex
+    void addPosts(size_t startIndex, size_t numPosts);
+
+    // numPosts have been added to the head of the timeline
+    void prependPosts(size_t numPosts);
+
+    // The gap place holder at gapIndex in the timeline has been replaced by numPosts
+    void gapFill(size_t gapIndex, size_t numPosts, int gapId);
+
+    // numPosts have been removed from the head of the timeline
+    void removeHeadPosts(size_t numPosts);
+
+    // Posts have been removed from the tail of the timeline
+    void removeTailPosts();
+
+    // Posts in the timeline have been unfolded
+    void timelinePostsUnfolded();
+
     void setCheckedTillTimestamp(QDateTime timestamp);
     QDateTime getCheckedTillTimestamp() const { return mCheckedTillTimestamp; }
     void setNumPostsChecked(int numPostsChecked);
@@ -48,30 +69,35 @@ signals:
     void checkedTillTimestampChanged();
     void numPostsCheckedChanged();
 
+    // Folding is a property of the posts in the timeline, so the timeline must unfold.
+    void unfoldTimelinePosts(int timelineIndex);
+
 private:
     struct Page
     {
         using Ptr = std::unique_ptr<Page>;
-        std::vector<const Post*> mFeed;
-        std::unordered_map<int, size_t> mGapIdIndexMap;
+        std::vector<size_t> mTimelineRows;
 
-        void addPost(const Post* post);
         int addThread(const TimelineFeed& posts, int startIndex, size_t numPosts, int matchedPostIndex);
     };
 
-    Page::Ptr createPage(const TimelineFeed& posts, int startIndex, size_t numPosts);
-    void insertPage(const TimelineFeed::iterator& feedInsertIt, const Page& page);
+    Page::Ptr createPage(size_t startIndex, size_t numPosts) const;
+    void insertPage(size_t index, const Page& page);
     void addPage(Page::Ptr page);
     void prependPage(Page::Ptr page);
     void removePosts(size_t startIndex, size_t count);
-    void addToIndices(int offset, size_t startAtIndex);
+    size_t getTimelineRow(size_t index) const { return size_t(mTimelineRows[index] + mTimelineOffset); }
 
     IPostFilter::Ptr mPostFilter;
+    const TimelineFeed& mTimeline;
     QDateTime mCheckedTillTimestamp{QDateTime::currentDateTimeUtc()};
     int mNumPostsChecked = 0;
 
-    // Index of each gap
-    std::unordered_map<int, size_t> mGapIdIndexMap;
+    // Timeline rows of the posts in this model, in order. The rows are stored
+    // relative to mTimelineOffset, such that adding or removing posts at the head
+    // of the timeline does not change the stored rows.
+    std::deque<qint64> mTimelineRows;
+    qint64 mTimelineOffset = 0;
 };
 
 }
@@ -9,6 +9,11 @@
 
 namespace Skywalker {
 
+static WordToken normalizedHashtagToken(const QString& hashtag)
+{
+    return WordTokenInterner::instance().intern(SearchUtils::normalizeText(hashtag));
+}
+
 int FocusHashtagEntry::sNextId = 1;
 
 FocusHashtagEntry::FocusHashtagEntry(QObject* parent) :
@@ -117,6 +122,7 @@ void FocusHashtags::setEntries(const QJsonDocument& json)
 void FocusHashtags::clear()
 {
     mAllHashtags.clear();
+    ++mVersion;
 
     if (!mEntries.empty())
     {
@@ -139,10 +145,12 @@ void FocusHashtags::addEntry(FocusHashtagEntry* entry)
     const auto& hashtags = entry->getHashtags();
 
     for (const auto& tag : hashtags)
-    {
-        const QString normalizedTag = SearchUtils::normalizeText(tag);
-        mAllHashtags[normalizedTag].insert(entry);
-    }
+        mAllHashtags[normalizedHashtagToken(tag)].insert(entry);
+
+    // Hashtags and colors of an entry can be changed directly on the entry.
+    connect(entry, &FocusHashtagEntry::hashtagsChanged, this, [this]{ ++mVersion; });
+    connect(entry, &FocusHashtagEntry::highlightColorChanged, this, [this]{ ++mVersion; });
+    ++mVersion;
 
     for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
     {
@@ -160,7 +168,7 @@ void FocusHashtags::addEntry(FocusHashtagEntry* entry)
 
 void FocusHashtags::addEntry(const QString& hashtag, QColor highlightColor)
 {
-    if (mAllHashtags.contains(hashtag))
+    if (mAllHashtags.contains(normalizedHashtagToken(hashtag)))
         return;
 
     auto* entry = new FocusHashtagEntry(this);
@@ -184,7 +192,7 @@ void FocusHashtags::removeEntry(int entryId)
 
             for (const auto& tag : hashtags)
             {
-                const QString normalizedTag = SearchUtils::normalizeText(tag);
+                const WordToken normalizedTag = normalizedHashtagToken(tag);
                 mAllHashtags[normalizedTag].erase(entry);
 
                 if (mAllHashtags[normalizedTag].empty())
@@ -193,6 +201,7 @@ void FocusHashtags::removeEntry(int entryId)
 
             mEntries.remove(i);
             delete entry;
+            ++mVersion;
             emit entriesChanged();
 
             break;
@@ -204,8 +213,7 @@ void FocusHashtags::addHashtagToEntry(FocusHashtagEntry* entry, const QString ha
 {
     if (entry->addHashtag(hashtag))
     {
-        const QString normalizedTag = SearchUtils::normalizeText(hashtag);
-        mAllHashtags[normalizedTag].insert(entry);
+        mAllHashtags[normalizedHashtagToken(hashtag)].insert(entry);
     }
 }
 
@@ -213,7 +221,7 @@ void FocusHashtags::removeHashtagFromEntry(FocusHashtagEntry* entry, const QStri
 {
     if (entry->removeHashtag(hashtag))
     {
-        const QString normalizedTag = SearchUtils::normalizeText(hashtag);
+        const WordToken normalizedTag = normalizedHashtagToken(hashtag);
         mAllHashtags[normalizedTag].erase(entry);
 
         if (mAllHashtags[normalizedTag].empty())
@@ -226,38 +234,60 @@ void FocusHashtags::removeHashtagFromEntry(FocusHashtagEntry* entry, const QStri
 
 bool FocusHashtags::match(const NormalizedWordIndex& post) const
 {
-    const std::vector<QString> hashtags = post.getHashtags();
+    return createMatcher()->match(post);
+}
 
-    for (const auto& tag : hashtags)
-    {
-        const QString normalizedTag = SearchUtils::normalizeText(tag);
+QColor FocusHashtags::highlightColor(const NormalizedWordIndex& post) const
+{
+    return createMatcher()->highlightColor(post);
+}
 
-        if (mAllHashtags.contains(normalizedTag))
-            return true;
+FocusHashtags::Matcher::SharedPtr FocusHashtags::createMatcher() const
+{
+    if (mMatcher && mMatcherVersion == mVersion)
+        return mMatcher;
+
+    std::unordered_map<WordToken, QColor> hashtagColors;
+
+    for (const auto& [normalizedTag, entries] : mAllHashtags)
+    {
+        if (!entries.empty())
+            hashtagColors[normalizedTag] = (*entries.begin())->getHightlightColor();
     }
 
-    return false;
+    mMatcher = std::make_shared<Matcher>(std::move(hashtagColors));
+    mMatcherVersion = mVersion;
+    return mMatcher;
 }
 
-QColor FocusHashtags::highlightColor(const NormalizedWordIndex& post) const
+FocusHashtags::Matcher::Matcher(std::unordered_map<WordToken, QColor> hashtagColors) :
+    mHashtagColors(std::move(hashtagColors))
 {
-    const std::vector<QString> hashtags = post.getHashtags();
+}
 
-    for (const auto& tag : hashtags)
+bool FocusHashtags::Matcher::match(const NormalizedWordIndex& post) const
+{
+    if (mHashtagColors.empty())
+        return false;
+
+    for (const WordToken normalizedTag : post.getUniqueHashtags())
     {
-        const QString normalizedTag = SearchUtils::normalizeText(tag);
-        auto it = mAllHashtags.find(normalizedTag);
+        if (mHashtagColors.contains(normalizedTag))
+            return true;
+    }
 
-        if (it == mAllHashtags.end())
-            continue;
+    return false;
+}
 
-        const std::unordered_set<FocusHashtagEntry*>& entries = it->second;
+QColor FocusHashtags::Matcher::highlightColor(const NormalizedWordIndex& post) const
+{
+    // The color of the first focus hashtag in the text
+    for (const WordToken normalizedTag : post.getHashtagsInTextOrder())
+    {
+        auto it = mHashtagColors.find(normalizedTag);
 
-        if (!entries.empty())
-        {
-            const FocusHashtagEntry* entry = *entries.begin();
-            return entry->getHightlightColor();
-        }
+        if (it != mHashtagColors.end())
+            return it->second;
     }
 
     return {};
@@ -266,11 +296,9 @@ QColor FocusHashtags::highlightColor(const NormalizedWordIndex& post) const
 FocusHashtagEntryList FocusHashtags::getMatchEntries(const NormalizedWordIndex& post) const
 {
     std::unordered_set<FocusHashtagEntry*> matchEntries;
-    const std::vector<QString> hashtags = post.getHashtags();
 
-    for (const auto& tag : hashtags)
+    for (const WordToken normalizedTag : post.getUniqueHashtags())
     {
-        const QString normalizedTag = SearchUtils::normalizeText(tag);
         auto it = mAllHashtags.find(normalizedTag);
 
         if (it == mAllHashtags.end())
@@ -8,6 +8,8 @@
 #include <QObject>
 #include <QString>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Skywalker {
 
@@ -64,6 +66,24 @@ class FocusHashtags : public QObject, public IMatchWords
 public:
     static constexpr int MAX_ENTRIES = 100;
 
+    // Immutable copy of the hashtags and their highlight colors that can be
+    // used from any thread.
+    class Matcher : public IMatchWords
+    {
+    public:
+        using SharedPtr = std::shared_ptr<const Matcher>;
+
+        explicit Matcher(std::unordered_map<WordToken, QColor> hashtagColors);
+
+        bool match(const NormalizedWordIndex& post) const override;
+
+        // Returns invalid color when no match is found
+        QColor highlightColor(const NormalizedWordIndex& post) const;
+
+    private:
+        const std::unordered_map<WordToken, QColor> mHashtagColors; // normalized hashtag -> color
+    };
+
     explicit FocusHashtags(QObject* parent = nullptr);
 
     QJsonDocument toJson() const;
@@ -85,6 +105,13 @@ public:
     FocusHashtagEntryList getMatchEntries(const NormalizedWordIndex& post) const;
     std::set<QString> getNormalizedMatchHashtags(const NormalizedWordIndex& post) const;
 
+    // The matcher is rebuilt only after a modification.
+    Matcher::SharedPtr createMatcher() const;
+
+    // The version changes with every modification of the entries, their
+    // hashtags or their colors.
+    quint64 getVersion() const override { return mVersion; }
+
     Q_INVOKABLE void save(const QString& did, UserSettings* settings) const;
     Q_INVOKABLE void load(const QString& did, const UserSettings* settings);
 
@@ -93,7 +120,12 @@ signals:
 
 private:
     FocusHashtagEntryList mEntries;
-    std::unordered_map<QString, std::unordered_set<FocusHashtagEntry*>> mAllHashtags;
+    // Normalized hashtag -> entries
+    std::unordered_map<WordToken, std::unordered_set<FocusHashtagEntry*>> mAllHashtags;
+    quint64 mVersion = 0;
+
+    mutable Matcher::SharedPtr mMatcher;
+    mutable quint64 mMatcherVersion = 0;
 };
 
 }
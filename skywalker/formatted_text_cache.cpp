@@ -0,0 +1,41 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "formatted_text_cache.h"
+#include "focus_hashtags.h"
+#include "user_settings.h"
+
+namespace Skywalker {
+
+FormattedTextCache::FormattedTextCache(int maxSize) :
+    mCache(maxSize)
+{
+}
+
+QString FormattedTextCache::getFormattedText(const Post& post, const FocusHashtags& focusHashtags)
+{
+    const QString& cid = post.getCid();
+
+    if (cid.isEmpty())
+    {
+        ++mFormatCount;
+        return post.getFormattedText(focusHashtags.getNormalizedMatchHashtags(post));
+    }
+
+    const QString linkColor = UserSettings::getCurrentLinkColor();
+    const Entry* entry = mCache.object(cid);
+
+    if (entry && entry->mFocusHashtagsVersion == focusHashtags.getVersion() && entry->mLinkColor == linkColor)
+        return entry->mText;
+
+    ++mFormatCount;
+    const QString text = post.getFormattedText(focusHashtags.getNormalizedMatchHashtags(post));
+    mCache.insert(cid, new Entry{ focusHashtags.getVersion(), linkColor, text });
+    return text;
+}
+
+void FormattedTextCache::clear()
+{
+    mCache.clear();
+}
+
+}
@@ -0,0 +1,42 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "post.h"
+#include <QCache>
+
+namespace Skywalker {
+
+class FocusHashtags;
+
+// Cache of the formatted text of posts. The text depends on the focus hashtags,
+// emphasized in the text, and the link color. An entry is only used when both
+// are the same as when the text was formatted.
+//
+// The record of a post cannot change without changing its CID. Posts without a
+// CID, e.g. drafts, are not cached.
+class FormattedTextCache
+{
+public:
+    explicit FormattedTextCache(int maxSize);
+
+    QString getFormattedText(const Post& post, const FocusHashtags& focusHashtags);
+    void clear();
+
+    int size() const { return (int)mCache.size(); }
+
+    // Number of times a text was formatted, i.e. not found in the cache.
+    int getFormatCount() const { return mFormatCount; }
+
+private:
+    struct Entry
+    {
+        quint64 mFocusHashtagsVersion;
+        QString mLinkColor;
+        QString mText;
+    };
+
+    QCache<QString, Entry> mCache; // key is CID
+    int mFormatCount = 0;
+};
+
+}
@@ -3,11 +3,13 @@
 #include "gif_to_video_converter.h"
 #include "file_utils.h"
 #include "temp_file_holder.h"
+#include <QtConcurrent>
 
 namespace Skywalker {
 
 constexpr int VIDEO_BIT_RATE_SD = 4'000'000;
 constexpr int VIDEO_BIT_RATE_HD = 8'000'000;
+constexpr int MAX_FRAMES_IN_FLIGHT_PER_THREAD = 2;
 
 void GifToVideoConverter::convert(const QString& gifFileName)
 {
@@ -23,7 +25,7 @@ void GifToVideoConverter::convert(const QString& gifFileName)
     }
 
     qDebug() << "Format:" << mGif->format() << "supported:" << mGif->supportedFormats();
-    mVideoFile = FileUtils::makeTempFile("mp4");
+    mVideoFile = FileUtils::makeTempFile(VideoEncoder::getFileExtension());
 
     if (!mVideoFile)
     {
@@ -95,7 +97,7 @@ void GifToVideoConverter::convert(const QString& gifFileName)
         return;
     }
 
-    startThread();
+    startThreads();
 }
 
 void GifToVideoConverter::cancel()
@@ -104,34 +106,82 @@ void GifToVideoConverter::cancel()
     mCanceled = true;
 }
 
-void GifToVideoConverter::startThread()
+void GifToVideoConverter::startThreads()
 {
     mCanceled = false;
-    QThread* thread = QThread::create([this]{ mConversionDone = pushFrames(); });
+    mDecodeDone = false;
+    mEncodeDone = false;
+    mFramesEncoded = 0;
+    mFrameQueue = std::make_unique<FrameQueue>(
+        std::max(1, mPreparePool.maxThreadCount()) * MAX_FRAMES_IN_FLIGHT_PER_THREAD);
 
-    if (!thread)
+    // The decoder drives the movie, so the encoder must not read from it.
+    const int frameCount = mGif->frameCount();
+
+    QThread* decodeThread = QThread::create([this, frameCount]{
+        mDecodeDone = decodeFrames(frameCount);
+
+        // Let the encoder finish the frames in the queue
+        mFrameQueue->close();
+    });
+
+    QThread* encodeThread = QThread::create([this, frameCount]{
+        mEncodeDone = encodeFrames(frameCount);
+
+        // Unblock the decoder
+        if (!mEncodeDone)
+            mFrameQueue->cancel();
+    });
+
+    if (!decodeThread || !encodeThread)
     {
-        qWarning() << "Failed to start thread";
+        qWarning() << "Failed to start threads";
+        delete decodeThread;
+        delete encodeThread;
         emit conversionFailed("Failed to start thread");
         return;
     }
 
-    mThread.reset(thread);
-    connect(thread, &QThread::finished, this, [this]{ finished(); }, Qt::SingleShotConnection);
-    mThread->start();
+    mDecodeThread.reset(decodeThread);
+    mEncodeThread.reset(encodeThread);
+    mRunningThreads = 2;
+    connect(decodeThread, &QThread::finished, this, [this]{ threadFinished(); }, Qt::SingleShotConnection);
+    connect(encodeThread, &QThread::finished, this, [this]{ threadFinished(); }, Qt::SingleShotConnection);
+    qDebug() << "Start conversion, prepare threads:" << mPreparePool.maxThreadCount()
+             << "max frames in flight:" << mFrameQueue->getMaxSize();
+    mTimer.start();
+    mDecodeThread->start();
+    mEncodeThread->start();
+}
+
+void GifToVideoConverter::threadFinished()
+{
+    if (--mRunningThreads > 0)
+        return;
+
+    finished();
 }
 
 void GifToVideoConverter::finished()
 {
+    mDecodeThread->wait();
+    mDecodeThread = nullptr;
+    mEncodeThread->wait();
+    mEncodeThread = nullptr;
+
+    // Frames that were still being prepared when the conversion stopped
+    mPreparePool.waitForDone();
+
+    qDebug() << "Conversion time ms:" << mTimer.elapsed() << "frames:" << mFramesEncoded
+             << "peak frames in flight:" << mFrameQueue->getPeakSize();
+    mFrameQueue = nullptr;
     mVideoEncoder->close();
     mVideoEncoder = nullptr;
-    mThread->wait();
-    mThread = nullptr;
 
     if (mCanceled)
         return;
 
-    if (!mConversionDone)
+    if (!mDecodeDone || !mEncodeDone)
     {
         emit conversionFailed("Conversion failed");
         return;
@@ -145,16 +195,15 @@ void GifToVideoConverter::finished()
     emit conversionOk(fileName);
 }
 
-bool GifToVideoConverter::pushFrames()
+bool GifToVideoConverter::decodeFrames(int frameCount)
 {
-    qDebug() << "Push frames to video encoder";
+    qDebug() << "Decode frames";
     mGif->jumpToFrame(0);
-    const int frameCount = mGif->frameCount();
     int frameIndex = 0;
 
     do {
-        qDebug() << "Push frame:" << frameIndex << "/" << frameCount << "next frame delay:" << mGif->nextFrameDelay();
-        QImage frame = mGif->currentImage();
+        qDebug() << "Decode frame:" << frameIndex << "/" << frameCount << "next frame delay:" << mGif->nextFrameDelay();
+        const QImage frame = mGif->currentImage();
 
         if (frame.isNull())
         {
@@ -162,26 +211,59 @@ bool GifToVideoConverter::pushFrames()
             return false;
         }
 
-        frame.convertTo(QImage::Format_RGBA8888); // must match format in QVideoEncoder.java
+        if (mCanceled)
+        {
+            qDebug() << "Canceled";
+            return false;
+        }
+
+        auto prepared = QtConcurrent::run(&mPreparePool, [frame]{ return VideoEncoder::prepareFrame(frame); });
+
+        // Blocks while the maximum number of frames is in flight
+        if (!mFrameQueue->push(prepared))
+        {
+            qDebug() << "Encoder stopped";
+            return false;
+        }
+    } while (mGif->jumpToNextFrame() && ++frameIndex <= frameCount);
+    // Frames start counting at zero still there is a frame at index frameCount.
+    // Seems frame 0 is not counted in the count??
+
+    qDebug() << "All frames decoded";
+    return true;
+}
+
+bool GifToVideoConverter::encodeFrames(int frameCount)
+{
+    qDebug() << "Encode frames";
+
+    while (auto prepared = mFrameQueue->pop())
+    {
+        const QByteArray frame = prepared->result();
+
+        if (frame.isEmpty())
+        {
+            qWarning() << "Failed to prepare frame:" << mFramesEncoded;
+            return false;
+        }
 
         if (!mVideoEncoder->push(frame))
         {
-            qWarning() << "Failed to push frame to video enoder:" << frameIndex;
+            qWarning() << "Failed to push frame to video enoder:" << mFramesEncoded;
             return false;
         }
 
-        emit conversionProgress(frameIndex / double(frameCount));
+        ++mFramesEncoded;
+        emit conversionProgress(std::min(mFramesEncoded / double(frameCount), 1.0));
 
         if (mCanceled)
         {
             qDebug() << "Canceled";
             return false;
         }
-    } while (mGif->jumpToNextFrame() && ++frameIndex <= frameCount);
-    // Frames start counting at zero still there is a frame at index frameCount.
-    // Seems frame 0 is not counted in the count??
+    }
 
-    qDebug() << "All frames pushed";
+    qDebug() << "All frames encoded:" << mFramesEncoded;
     return true;
 }
 
@@ -1,16 +1,25 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "bounded_queue.h"
 #include "video_encoder.h"
 #include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QMovie>
 #include <QObject>
 #include <QTemporaryFile>
 #include <QThread>
+#include <QThreadPool>
 #include <QtQmlIntegration>
 
 namespace Skywalker {
 
+// Conversion is a pipeline of 3 stages:
+// 1. decode: a thread reads the GIF frames in order
+// 2. prepare: frames are converted to encoder input in parallel on a thread pool
+// 3. encode: a thread pushes the prepared frames in order to the encoder
+// The number of frames in flight is bounded by the queue between decode and encode.
 class GifToVideoConverter : public QObject
 {
     Q_OBJECT
@@ -26,15 +35,26 @@ signals:
     void conversionProgress(double progress); // 0.0 => 1.0
 
 private:
-    void startThread();
+    using FrameQueue = BoundedQueue<QFuture<QByteArray>>;
+
+    void startThreads();
+    void threadFinished();
     void finished();
-    bool pushFrames();
+    bool decodeFrames(int frameCount);
+    bool encodeFrames(int frameCount);
 
     std::unique_ptr<VideoEncoder> mVideoEncoder;
     std::unique_ptr<QMovie> mGif;
     std::unique_ptr<QTemporaryFile> mVideoFile;
-    std::unique_ptr<QThread> mThread;
-    bool mConversionDone = false;
+    std::unique_ptr<FrameQueue> mFrameQueue;
+    QThreadPool mPreparePool;
+    std::unique_ptr<QThread> mDecodeThread;
+    std::unique_ptr<QThread> mEncodeThread;
+    int mRunningThreads = 0;
+    bool mDecodeDone = false;
+    bool mEncodeDone = false;
+    int mFramesEncoded = 0;
+    QElapsedTimer mTimer;
     QAtomicInteger<bool> mCanceled = false;
 };
 
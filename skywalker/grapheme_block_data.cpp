@@ -0,0 +1,127 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "grapheme_block_data.h"
+#include "unicode_fonts.h"
+#include <QTextBoundaryFinder>
+
+namespace Skywalker {
+
+// Number of characters after a change segmented in the first attempt to find a
+// boundary that did not move.
+static constexpr int RESYNC_WINDOW = 16;
+
+int GraphemeBlockData::getCharPos(int graphemeIndex) const
+{
+    Q_ASSERT(graphemeIndex >= 0 && graphemeIndex <= getLength());
+    return graphemeIndex == 0 ? 0 : mGraphemes[graphemeIndex - 1].mEnd;
+}
+
+int GraphemeBlockData::getEmojiLength(QStringView grapheme)
+{
+    // ZWJ Emoji's are not always correctly rendered. Somehow the primary font
+    // renders them as 2 separate emoji's. Long emoji graphemes get the emoji font.
+    if (grapheme.size() > 2 && UnicodeFonts::onlyEmojis(grapheme.toString()))
+        return grapheme.size();
+
+    if (grapheme.size() >= 3 && grapheme.endsWith(u"\uFE0F\u20E3"))
+        return 3;
+
+    return 0;
+}
+
+int GraphemeBlockData::findGraphemeEndingAt(int position) const
+{
+    auto it = std::lower_bound(mGraphemes.begin(), mGraphemes.end(), position,
+        [](const Grapheme& grapheme, int pos){ return grapheme.mEnd < pos; });
+
+    if (it == mGraphemes.end() || it->mEnd != position)
+        return -1;
+
+    return it - mGraphemes.begin() + 1;
+}
+
+int GraphemeBlockData::update(const QString& text)
+{
+    const int minSize = std::min(mText.size(), text.size());
+    int prefix = 0;
+
+    while (prefix < minSize && mText[prefix] == text[prefix])
+        ++prefix;
+
+    if (prefix == mText.size() && prefix == text.size())
+        return 0;
+
+    int suffix = 0;
+
+    while (suffix < minSize - prefix && mText[mText.size() - 1 - suffix] == text[text.size() - 1 - suffix])
+        ++suffix;
+
+    const int changeEnd = text.size() - suffix;
+    const int delta = text.size() - mText.size();
+
+    // A changed character may join the grapheme before it, so the grapheme ending
+    // at the change is segmented again too.
+    auto firstAffected = std::lower_bound(mGraphemes.begin(), mGraphemes.end(), prefix,
+        [](const Grapheme& grapheme, int pos){ return grapheme.mEnd < pos; });
+    const int startIndex = firstAffected - mGraphemes.begin();
+    const int start = getCharPos(startIndex);
+
+    std::vector<Grapheme> segmented;
+    int resyncIndex = -1;
+    int windowEnd = std::min((int)text.size(), changeEnd + RESYNC_WINDOW);
+    int segmentedChars = 0;
+
+    while (true)
+    {
+        segmented.clear();
+        segmentedChars += windowEnd - start;
+        const QStringView window = QStringView(text).sliced(start, windowEnd - start);
+        QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, window.data(), window.size());
+        int prev = 0;
+        int next;
+
+        while ((next = boundaryFinder.toNextBoundary()) != -1)
+        {
+            const int end = start + next;
+
+            // The end of the window cuts a grapheme unless it is the end of the text.
+            if (end == windowEnd && windowEnd < text.size())
+                break;
+
+            segmented.push_back({ end, getEmojiLength(window.sliced(prev, next - prev)) });
+            prev = next;
+
+            // Beyond the change the boundaries are the same as before once a
+            // boundary did not move.
+            if (end >= changeEnd)
+            {
+                resyncIndex = findGraphemeEndingAt(end - delta);
+
+                if (resyncIndex != -1)
+                    break;
+            }
+        }
+
+        if (resyncIndex != -1 || windowEnd == text.size())
+            break;
+
+        windowEnd = std::min((int)text.size(), start + 2 * (windowEnd - start));
+    }
+
+    std::vector<Grapheme> graphemes;
+    graphemes.reserve(startIndex + segmented.size() + (resyncIndex == -1 ? 0 : mGraphemes.size() - resyncIndex));
+    graphemes.insert(graphemes.end(), mGraphemes.begin(), mGraphemes.begin() + startIndex);
+    graphemes.insert(graphemes.end(), segmented.begin(), segmented.end());
+
+    if (resyncIndex != -1)
+    {
+        for (int i = resyncIndex; i < (int)mGraphemes.size(); ++i)
+            graphemes.push_back({ mGraphemes[i].mEnd + delta, mGraphemes[i].mEmojiLength });
+    }
+
+    mGraphemes = std::move(graphemes);
+    mText = text;
+    return segmentedChars;
+}
+
+}
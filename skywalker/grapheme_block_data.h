@@ -0,0 +1,39 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QTextBlockUserData>
+
+namespace Skywalker {
+
+// Grapheme boundaries of a text block, kept with the block between highlights.
+// On a change, only the graphemes around the changed characters are segmented
+// again.
+class GraphemeBlockData : public QTextBlockUserData
+{
+public:
+    struct Grapheme
+    {
+        int mEnd = 0; // position after the last character
+        int mEmojiLength = 0; // number of characters at the end to render with the emoji font
+    };
+
+    // Returns the number of characters segmented.
+    int update(const QString& text);
+
+    const QString& getText() const { return mText; }
+    const std::vector<Grapheme>& getGraphemes() const { return mGraphemes; }
+    int getLength() const { return (int)mGraphemes.size(); }
+    int getCharPos(int graphemeIndex) const;
+
+    static int getEmojiLength(QStringView grapheme);
+
+private:
+    // Returns the index of the first old grapheme after position, or -1 if
+    // there is no old grapheme ending at position.
+    int findGraphemeEndingAt(int position) const;
+
+    QString mText;
+    std::vector<Grapheme> mGraphemes;
+};
+
+}
@@ -0,0 +1,243 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "hls_segment_loader.h"
+#include <limits>
+
+namespace Skywalker {
+
+HlsSegmentLoader::HlsSegmentLoader(QNetworkAccessManager& network, QObject* parent) :
+    QObject(parent),
+    mNetwork(network)
+{
+}
+
+void HlsSegmentLoader::setMaxConcurrent(int maxConcurrent)
+{
+    Q_ASSERT(maxConcurrent > 0);
+    mMaxConcurrent = std::max(1, maxConcurrent);
+}
+
+void HlsSegmentLoader::setMaxBufferedBytes(qint64 maxBytes)
+{
+    Q_ASSERT(maxBytes > 0);
+    mMaxBufferedBytes = maxBytes;
+}
+
+bool HlsSegmentLoader::start(const VariantList& variants, int variantIndex, QIODevice* output)
+{
+    Q_ASSERT(output);
+
+    if (isActive())
+    {
+        qWarning() << "Loader already active";
+        return false;
+    }
+
+    if (variants.empty() || variantIndex < 0 || variantIndex >= (int)variants.size())
+    {
+        qWarning() << "Invalid variant:" << variantIndex << "variants:" << variants.size();
+        return false;
+    }
+
+    const auto segmentCount = variants.front().mSegmentUrls.size();
+
+    for (const auto& variant : variants)
+    {
+        if (variant.mSegmentUrls.size() != segmentCount)
+        {
+            qWarning() << "Variants are not aligned:" << variant.mSegmentUrls.size() << segmentCount;
+            return false;
+        }
+    }
+
+    reset();
+    mPeakBufferedBytes = 0;
+    mMeasuredKbps = 0;
+    mSampleCount = 0;
+    mVariants = variants;
+    mVariantIndex = variantIndex;
+    mSegmentCount = segmentCount;
+    mOutput = output;
+    qDebug() << "Start loading segments:" << mSegmentCount << "variant:" << mVariantIndex
+             << "variants:" << mVariants.size() << "concurrent:" << mMaxConcurrent;
+
+    if (mSegmentCount == 0)
+    {
+        reset();
+        emit finished();
+        return true;
+    }
+
+    scheduleDownloads();
+    return true;
+}
+
+void HlsSegmentLoader::abort()
+{
+    if (!isActive())
+        return;
+
+    qDebug() << "Abort loading segments, written:" << mNextToWrite << "total:" << mSegmentCount;
+    reset();
+}
+
+// The statistics are kept till the next start.
+void HlsSegmentLoader::reset()
+{
+    // Move the downloads out first, abort() emits finished synchronously.
+    auto downloads = std::move(mDownloads);
+    mDownloads.clear();
+
+    for (auto& [reply, _] : downloads)
+    {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+    }
+
+    mVariants.clear();
+    mVariantIndex = 0;
+    mSegmentCount = 0;
+    mOutput = nullptr;
+    mNextToRequest = 0;
+    mNextToWrite = 0;
+    mCompleted.clear();
+    mBufferedBytes = 0;
+}
+
+void HlsSegmentLoader::scheduleDownloads()
+{
+    // The segment to write next has always been requested, as segments are
+    // requested in order. Limiting new requests cannot block the stream.
+    while (mNextToRequest < mSegmentCount &&
+           (int)mDownloads.size() < mMaxConcurrent &&
+           mBufferedBytes < mMaxBufferedBytes)
+    {
+        requestSegment(mNextToRequest++);
+    }
+}
+
+void HlsSegmentLoader::requestSegment(int segment)
+{
+    const QUrl url(mVariants[mVariantIndex].mSegmentUrls[segment]);
+    qDebug() << "Request segment:" << segment << "variant:" << mVariantIndex << url;
+
+    QNetworkRequest request(url);
+    QNetworkReply* reply = mNetwork.get(request);
+
+    Download& download = mDownloads[reply];
+    download.mSegment = segment;
+    download.mVariant = mVariantIndex;
+    download.mConcurrent = (int)mDownloads.size();
+    download.mTimer.start();
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply]{ segmentFinished(reply); });
+}
+
+void HlsSegmentLoader::segmentFinished(QNetworkReply* reply)
+{
+    auto it = mDownloads.find(reply);
+
+    if (it == mDownloads.end())
+        return;
+
+    const Download download = it->second;
+    mDownloads.erase(it);
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        qWarning() << "Failed to load segment:" << download.mSegment << reply->request().url()
+                   << "error:" << reply->error() << reply->errorString();
+        fail(reply->errorString());
+        return;
+    }
+
+    QByteArray data = reply->readAll();
+    qDebug() << "Loaded segment:" << download.mSegment << "variant:" << download.mVariant
+             << "bytes:" << data.size() << "ms:" << download.mTimer.elapsed();
+
+    measureThroughput(download, data.size());
+    selectVariant();
+
+    mBufferedBytes += data.size();
+    mPeakBufferedBytes = std::max(mPeakBufferedBytes, mBufferedBytes);
+    mCompleted[download.mSegment] = std::move(data);
+
+    if (!writeSegments())
+        return;
+
+    if (mNextToWrite >= mSegmentCount)
+    {
+        qDebug() << "All segments loaded:" << mSegmentCount << "peak buffered bytes:" << mPeakBufferedBytes
+                 << "measured kbps:" << mMeasuredKbps;
+        reset();
+        emit finished();
+        return;
+    }
+
+    scheduleDownloads();
+}
+
+void HlsSegmentLoader::measureThroughput(const Download& download, qint64 bytes)
+{
+    // The concurrent downloads share the bandwidth.
+    const qint64 nsecs = std::max(qint64(1), download.mTimer.nsecsElapsed());
+    const qint64 kbps = bytes * 8'000'000 / nsecs * download.mConcurrent;
+    const int sample = (int)std::min(kbps, qint64(std::numeric_limits<int>::max()));
+
+    if (mSampleCount == 0)
+        mMeasuredKbps = sample;
+    else
+        mMeasuredKbps = (int)((7 * qint64(mMeasuredKbps) + 3 * qint64(sample)) / 10);
+
+    ++mSampleCount;
+}
+
+void HlsSegmentLoader::selectVariant()
+{
+    if (mVariants.size() < 2 || mSampleCount < MIN_SAMPLES_FOR_SWITCH)
+        return;
+
+    int index = 0;
+
+    for (int i = 1; i < (int)mVariants.size(); ++i)
+    {
+        if (mVariants[i].mMinBandwidthKbps <= mMeasuredKbps)
+            index = i;
+    }
+
+    if (index == mVariantIndex)
+        return;
+
+    qDebug() << "Switch variant:" << mVariantIndex << "->" << index << "measured kbps:" << mMeasuredKbps
+             << "next segment:" << mNextToRequest;
+    mVariantIndex = index;
+    emit variantSwitched(mVariantIndex);
+}
+
+bool HlsSegmentLoader::writeSegments()
+{
+    for (auto it = mCompleted.begin(); it != mCompleted.end() && it->first == mNextToWrite; it = mCompleted.erase(it))
+    {
+        const QByteArray& data = it->second;
+
+        if (mOutput->write(data) != data.size())
+        {
+            qWarning() << "Failed to write segment:" << mNextToWrite << mOutput->errorString();
+            fail(tr("Failed to write video"));
+            return false;
+        }
+
+        mBufferedBytes -= data.size();
+        ++mNextToWrite;
+    }
+
+    return true;
+}
+
+void HlsSegmentLoader::fail(const QString& error)
+{
+    reset();
+    emit failed(error);
+}
+
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <map>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Downloads the segments of an HLS stream with multiple concurrent requests and
+// writes them in order to an output device.
+//
+// The throughput of each segment download is measured. When the stream has multiple
+// variants with aligned segments, the variant for the next segments is selected on
+// the measured bandwidth.
+//
+// Segments that are downloaded ahead of the segment to write next are buffered. No
+// new downloads are started while the buffer is over its maximum.
+class HlsSegmentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_MAX_CONCURRENT = 3;
+    static constexpr qint64 DEFAULT_MAX_BUFFERED_BYTES = 8 * 1024 * 1024;
+    static constexpr int MIN_SAMPLES_FOR_SWITCH = 2;
+
+    struct Variant
+    {
+        int mMinBandwidthKbps = 0; // bandwidth needed to select this variant
+        QStringList mSegmentUrls;
+    };
+
+    // Variants must be ordered on bandwidth, lowest first.
+    using VariantList = std::vector<Variant>;
+
+    explicit HlsSegmentLoader(QNetworkAccessManager& network, QObject* parent = nullptr);
+
+    void setMaxConcurrent(int maxConcurrent);
+    int getMaxConcurrent() const { return mMaxConcurrent; }
+    void setMaxBufferedBytes(qint64 maxBytes);
+    qint64 getMaxBufferedBytes() const { return mMaxBufferedBytes; }
+
+    // All variants must have the same number of segments. The output must be open.
+    // Returns false if the loader is already active or the variants are invalid.
+    bool start(const VariantList& variants, int variantIndex, QIODevice* output);
+
+    void abort();
+    bool isActive() const { return mOutput != nullptr; }
+
+    int getVariantIndex() const { return mVariantIndex; }
+    int getMeasuredKbps() const { return mMeasuredKbps; }
+    qint64 getBufferedBytes() const { return mBufferedBytes; }
+    qint64 getPeakBufferedBytes() const { return mPeakBufferedBytes; }
+
+signals:
+    void finished();
+    void failed(const QString& error);
+    void variantSwitched(int variantIndex);
+
+private:
+    struct Download
+    {
+        int mSegment;
+        int mVariant;
+        int mConcurrent; // number of downloads in flight at the start
+        QElapsedTimer mTimer;
+    };
+
+    void scheduleDownloads();
+    void requestSegment(int segment);
+    void segmentFinished(QNetworkReply* reply);
+    void measureThroughput(const Download& download, qint64 bytes);
+    void selectVariant();
+    bool writeSegments();
+    void fail(const QString& error);
+    void reset();
+
+    QNetworkAccessManager& mNetwork;
+    int mMaxConcurrent = DEFAULT_MAX_CONCURRENT;
+    qint64 mMaxBufferedBytes = DEFAULT_MAX_BUFFERED_BYTES;
+
+    VariantList mVariants;
+    int mVariantIndex = 0;
+    int mSegmentCount = 0;
+    QIODevice* mOutput = nullptr;
+
+    int mNextToRequest = 0;
+    int mNextToWrite = 0;
+    std::unordered_map<QNetworkReply*, Download> mDownloads;
+    std::map<int, QByteArray> mCompleted; // segment -> data, not yet written
+    qint64 mBufferedBytes = 0;
+    qint64 mPeakBufferedBytes = 0;
+
+    int mMeasuredKbps = 0;
+    int mSampleCount = 0;
+};
+
+}
@@ -0,0 +1,198 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "image_cache.h"
+#include <QDebug>
+
+namespace Skywalker {
+
+ImageCache::ImageCache(const QString& name, qint64 maxBytes) :
+    mName(name),
+    mMaxBytes(maxBytes)
+{
+    Q_ASSERT(mMaxBytes > 0);
+}
+
+void ImageCache::put(const QString& key, const QImage& image)
+{
+    Q_ASSERT(!key.isEmpty());
+    QMutexLocker locker(&mMutex);
+    auto it = mEntries.find(key);
+
+    if (it != mEntries.end())
+    {
+        mBytes -= it->second->mBytes;
+        mLru.erase(it->second);
+        mEntries.erase(it);
+    }
+
+    const qint64 bytes = image.sizeInBytes();
+    mLru.push_front({ key, image, bytes });
+    mEntries[key] = mLru.begin();
+    mBytes += bytes;
+    evict();
+}
+
+QImage ImageCache::get(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    auto it = mEntries.find(key);
+
+    if (it == mEntries.end())
+    {
+        ++mMisses;
+        return {};
+    }
+
+    ++mHits;
+    mLru.splice(mLru.begin(), mLru, it->second);
+    return it->second->mImage;
+}
+
+bool ImageCache::contains(const QString& key) const
+{
+    QMutexLocker locker(&mMutex);
+    return mEntries.contains(key);
+}
+
+void ImageCache::remove(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    mPinCounts.erase(key);
+    auto it = mEntries.find(key);
+
+    if (it == mEntries.end())
+        return;
+
+    mBytes -= it->second->mBytes;
+    mLru.erase(it->second);
+    mEntries.erase(it);
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mLru.clear();
+    mEntries.clear();
+    mPinCounts.clear();
+    mBytes = 0;
+}
+
+void ImageCache::pin(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    ++mPinCounts[key];
+}
+
+void ImageCache::unpin(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    auto it = mPinCounts.find(key);
+
+    if (it == mPinCounts.end())
+    {
+        qWarning() << "Image not pinned:" << key << "cache:" << mName;
+        return;
+    }
+
+    if (--it->second <= 0)
+    {
+        mPinCounts.erase(it);
+        evict();
+    }
+}
+
+bool ImageCache::isPinned(const QString& key) const
+{
+    QMutexLocker locker(&mMutex);
+    return isPinnedLocked(key);
+}
+
+bool ImageCache::isPinnedLocked(const QString& key) const
+{
+    return mPinCounts.contains(key);
+}
+
+void ImageCache::evict()
+{
+    auto it = mLru.end();
+
+    while (mBytes > mMaxBytes && it != mLru.begin())
+    {
+        --it;
+
+        if (isPinnedLocked(it->mKey))
+            continue;
+
+        qDebug() << "Evict image:" << it->mKey << "bytes:" << it->mBytes << "cache:" << mName;
+        mBytes -= it->mBytes;
+        mEntries.erase(it->mKey);
+        it = mLru.erase(it);
+        ++mEvictions;
+    }
+
+    if (mBytes > mMaxBytes)
+        qWarning() << "Pinned images exceed budget:" << mBytes << "max:" << mMaxBytes << "cache:" << mName;
+}
+
+void ImageCache::setMaxBytes(qint64 maxBytes)
+{
+    Q_ASSERT(maxBytes > 0);
+    QMutexLocker locker(&mMutex);
+    mMaxBytes = maxBytes;
+    evict();
+}
+
+qint64 ImageCache::getMaxBytes() const
+{
+    QMutexLocker locker(&mMutex);
+    return mMaxBytes;
+}
+
+qint64 ImageCache::getBytes() const
+{
+    QMutexLocker locker(&mMutex);
+    return mBytes;
+}
+
+size_t ImageCache::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEntries.size();
+}
+
+qint64 ImageCache::getHits() const
+{
+    QMutexLocker locker(&mMutex);
+    return mHits;
+}
+
+qint64 ImageCache::getMisses() const
+{
+    QMutexLocker locker(&mMutex);
+    return mMisses;
+}
+
+qint64 ImageCache::getEvictions() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEvictions;
+}
+
+double ImageCache::getHitRate() const
+{
+    QMutexLocker locker(&mMutex);
+    const qint64 total = mHits + mMisses;
+    return total > 0 ? double(mHits) / total : 0.0;
+}
+
+void ImageCache::logStats() const
+{
+    QMutexLocker locker(&mMutex);
+    const qint64 total = mHits + mMisses;
+    const double hitRate = total > 0 ? double(mHits) / total : 0.0;
+    qDebug() << "Image cache:" << mName << "images:" << mEntries.size() << "pinned:" << mPinCounts.size()
+             << "bytes:" << mBytes << "max:" << mMaxBytes << "hits:" << mHits << "misses:" << mMisses
+             << "hit rate:" << hitRate << "evictions:" << mEvictions;
+}
+
+}
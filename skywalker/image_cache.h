@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QHashFunctions>
+#include <QImage>
+#include <QMutex>
+#include <list>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Thread safe cache of decoded images with a byte budget. When the budget is
+// exceeded, the least recently used images get evicted. Pinned images are never
+// evicted, e.g. images that only exist in the cache.
+class ImageCache
+{
+public:
+    static constexpr qint64 DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+    explicit ImageCache(const QString& name, qint64 maxBytes = DEFAULT_MAX_BYTES);
+
+    void put(const QString& key, const QImage& image);
+
+    // Returns a null image if the key is not in the cache.
+    QImage get(const QString& key);
+
+    bool contains(const QString& key) const;
+
+    // Removes the image and its pins.
+    void remove(const QString& key);
+
+    void clear();
+
+    // Pins are counted. A key can be pinned before its image is put in the cache.
+    void pin(const QString& key);
+    void unpin(const QString& key);
+    bool isPinned(const QString& key) const;
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 getMaxBytes() const;
+    qint64 getBytes() const;
+    size_t size() const;
+    qint64 getHits() const;
+    qint64 getMisses() const;
+    qint64 getEvictions() const;
+    double getHitRate() const;
+    void logStats() const;
+
+private:
+    struct Entry
+    {
+        QString mKey;
+        QImage mImage;
+        qint64 mBytes = 0;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // Must be called with the mutex locked.
+    void evict();
+    bool isPinnedLocked(const QString& key) const;
+
+    const QString mName;
+    mutable QMutex mMutex;
+    EntryList mLru; // most recently used first
+    std::unordered_map<QString, EntryList::iterator> mEntries;
+    std::unordered_map<QString, int> mPinCounts;
+    qint64 mMaxBytes;
+    qint64 mBytes = 0;
+    qint64 mHits = 0;
+    qint64 mMisses = 0;
+    qint64 mEvictions = 0;
+};
+
+}
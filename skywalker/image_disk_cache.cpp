@@ -0,0 +1,333 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "image_disk_cache.h"
+#include "file_utils.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace Skywalker {
+
+static constexpr quint32 FILE_MAGIC = 0x534b5943; // SKYC
+static constexpr qint32 FILE_VERSION = 1;
+static constexpr char const* FILE_EXTENSION = ".img";
+
+ImageDiskCache* ImageDiskCache::create(QObject* parent)
+{
+    const QString path = FileUtils::getCachePath(SUB_DIR);
+
+    if (path.isEmpty())
+    {
+        qWarning() << "No image disk cache";
+        return nullptr;
+    }
+
+    return new ImageDiskCache(path, DEFAULT_MAX_BYTES, parent);
+}
+
+ImageDiskCache::ImageDiskCache(const QString& dirPath, qint64 maxBytes, QObject* parent) :
+    QAbstractNetworkCache(parent),
+    mDirPath(dirPath),
+    mMaxBytes(maxBytes)
+{
+    Q_ASSERT(mMaxBytes > 0);
+
+    if (!QDir().mkpath(mDirPath))
+        qWarning() << "Failed to create image cache path:" << mDirPath;
+}
+
+ImageDiskCache::~ImageDiskCache()
+{
+    for (auto& [device, _] : mInserting)
+        delete device;
+
+    logStats();
+}
+
+QString ImageDiskCache::getFileName(const QUrl& url) const
+{
+    const QString key = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha256).toHex();
+    return QString("%1/%2/%3%4").arg(mDirPath, key.left(2), key, FILE_EXTENSION);
+}
+
+QNetworkCacheMetaData ImageDiskCache::metaData(const QUrl& url)
+{
+    QNetworkCacheMetaData metaData;
+
+    if (!read(getFileName(url), metaData, nullptr))
+        return {};
+
+    return metaData;
+}
+
+void ImageDiskCache::updateMetaData(const QNetworkCacheMetaData& metaData)
+{
+    const QString fileName = getFileName(metaData.url());
+    QNetworkCacheMetaData oldMetaData;
+    QByteArray data;
+
+    if (!read(fileName, oldMetaData, &data))
+        return;
+
+    write(fileName, metaData, data);
+}
+
+QIODevice* ImageDiskCache::data(const QUrl& url)
+{
+    const QString fileName = getFileName(url);
+    QNetworkCacheMetaData metaData;
+    QByteArray data;
+
+    if (!read(fileName, metaData, &data))
+    {
+        ++mMisses;
+        return nullptr;
+    }
+
+    ++mHits;
+
+    // The modification time is the last use for pruning.
+    QFile file(fileName);
+
+    if (file.open(QIODevice::ReadOnly))
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+
+    auto* buffer = new QBuffer;
+    buffer->setData(data);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+bool ImageDiskCache::remove(const QUrl& url)
+{
+    for (auto it = mInserting.begin(); it != mInserting.end(); )
+    {
+        if (it->second.url() == url)
+        {
+            delete it->first;
+            it = mInserting.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    const QString fileName = getFileName(url);
+    const qint64 fileSize = QFileInfo(fileName).size();
+
+    if (!QFile::remove(fileName))
+        return false;
+
+    if (mSize >= 0)
+        mSize = std::max(qint64(0), mSize - fileSize);
+
+    return true;
+}
+
+qint64 ImageDiskCache::cacheSize() const
+{
+    if (mSize < 0)
+        mSize = scanSize();
+
+    return mSize;
+}
+
+QIODevice* ImageDiskCache::prepare(const QNetworkCacheMetaData& metaData)
+{
+    if (!metaData.isValid() || !metaData.url().isValid() || !metaData.saveToDisk())
+        return nullptr;
+
+    for (const auto& [header, value] : metaData.rawHeaders())
+    {
+        if (header.compare("content-length", Qt::CaseInsensitive) == 0 && value.toLongLong() > MAX_ITEM_BYTES)
+        {
+            qDebug() << "Image too large for cache:" << metaData.url() << "size:" << value;
+            return nullptr;
+        }
+    }
+
+    auto* buffer = new QBuffer;
+    buffer->open(QIODevice::WriteOnly);
+    mInserting[buffer] = metaData;
+    return buffer;
+}
+
+void ImageDiskCache::insert(QIODevice* device)
+{
+    auto it = mInserting.find(device);
+
+    if (it == mInserting.end())
+    {
+        qWarning() << "Unknown device";
+        return;
+    }
+
+    const QNetworkCacheMetaData metaData = it->second;
+    mInserting.erase(it);
+    const QByteArray data = static_cast<QBuffer*>(device)->data();
+    delete device;
+
+    if (data.size() > MAX_ITEM_BYTES)
+    {
+        qDebug() << "Image too large for cache:" << metaData.url() << "size:" << data.size();
+        return;
+    }
+
+    const QString fileName = getFileName(metaData.url());
+    const qint64 oldSize = QFileInfo(fileName).size();
+    const qint64 size = cacheSize();
+
+    if (!write(fileName, metaData, data))
+        return;
+
+    mSize = size - oldSize + QFileInfo(fileName).size();
+
+    if (mSize > mMaxBytes)
+        prune();
+}
+
+void ImageDiskCache::clear()
+{
+    qDebug() << "Clear image cache:" << mDirPath;
+
+    if (!QDir(mDirPath).removeRecursively())
+        qWarning() << "Failed to remove:" << mDirPath;
+
+    QDir().mkpath(mDirPath);
+    mSize = 0;
+}
+
+qint64 ImageDiskCache::prune()
+{
+    struct CacheFile
+    {
+        QDateTime mLastUsed;
+        QString mFileName;
+        qint64 mSize;
+    };
+
+    std::vector<CacheFile> files;
+    qint64 totalSize = 0;
+    QDirIterator it(mDirPath, { QString("*") + FILE_EXTENSION }, QDir::Files, QDirIterator::Subdirectories);
+
+    while (it.hasNext())
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        files.push_back({ info.lastModified(), info.filePath(), info.size() });
+        totalSize += info.size();
+    }
+
+    if (totalSize > mMaxBytes)
+    {
+        // Make some room, so we do not prune again on the next insert.
+        const qint64 targetSize = mMaxBytes * 9 / 10;
+        std::sort(files.begin(), files.end(),
+                  [](const CacheFile& lhs, const CacheFile& rhs){ return lhs.mLastUsed < rhs.mLastUsed; });
+
+        int removed = 0;
+
+        for (const auto& file : files)
+        {
+            if (totalSize <= targetSize)
+                break;
+
+            // Another instance may have removed the file already.
+            if (QFile::remove(file.mFileName) || !QFile::exists(file.mFileName))
+            {
+                totalSize -= file.mSize;
+                ++removed;
+            }
+        }
+
+        qDebug() << "Pruned image cache:" << mDirPath << "removed:" << removed << "size:" << totalSize;
+    }
+
+    mSize = totalSize;
+    return mSize;
+}
+
+qint64 ImageDiskCache::scanSize() const
+{
+    qint64 totalSize = 0;
+    QDirIterator it(mDirPath, { QString("*") + FILE_EXTENSION }, QDir::Files, QDirIterator::Subdirectories);
+
+    while (it.hasNext())
+    {
+        it.next();
+        totalSize += it.fileInfo().size();
+    }
+
+    return totalSize;
+}
+
+bool ImageDiskCache::read(const QString& fileName, QNetworkCacheMetaData& metaData, QByteArray* data) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    qint32 version = 0;
+    in >> magic >> version;
+
+    if (magic != FILE_MAGIC || version != FILE_VERSION)
+    {
+        qWarning() << "Invalid image cache file:" << fileName << "magic:" << magic << "version:" << version;
+        return false;
+    }
+
+    in >> metaData;
+
+    if (data)
+        in >> *data;
+
+    if (in.status() != QDataStream::Ok)
+    {
+        qWarning() << "Failed to read image cache file:" << fileName;
+        return false;
+    }
+
+    return true;
+}
+
+bool ImageDiskCache::write(const QString& fileName, const QNetworkCacheMetaData& metaData, const QByteArray& data)
+{
+    QDir().mkpath(QFileInfo(fileName).path());
+
+    // Readers never see a partially written file.
+    QSaveFile saveFile(fileName);
+
+    if (!saveFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot create image cache file:" << fileName << saveFile.errorString();
+        return false;
+    }
+
+    QDataStream out(&saveFile);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << FILE_MAGIC << FILE_VERSION << metaData << data;
+
+    if (!saveFile.commit())
+    {
+        qWarning() << "Failed to write image cache file:" << fileName << saveFile.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void ImageDiskCache::logStats() const
+{
+    qDebug() << "Image disk cache:" << mDirPath << "size:" << mSize << "max:" << mMaxBytes
+             << "hits:" << mHits << "misses:" << mMisses;
+}
+
+}
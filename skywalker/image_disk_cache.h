@@ -0,0 +1,69 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QAbstractNetworkCache>
+#include <QBuffer>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Persistent cache for downloaded images, shared by all ImageReaders, including
+// the one in the background message checker. Entries are stored by hash of the
+// URL together with their cache meta data. The network access manager uses the
+// meta data to revalidate stale entries (ETag, max-age).
+//
+// Files are written atomically, so multiple instances (and processes) can use the
+// same directory. When the total size exceeds the maximum, the least recently
+// used files are removed.
+class ImageDiskCache : public QAbstractNetworkCache
+{
+    Q_OBJECT
+
+public:
+    static constexpr char const* SUB_DIR = "images";
+    static constexpr qint64 DEFAULT_MAX_BYTES = 50 * 1024 * 1024;
+    static constexpr qint64 MAX_ITEM_BYTES = 5 * 1024 * 1024;
+
+    // Returns nullptr if the cache directory cannot be created.
+    static ImageDiskCache* create(QObject* parent = nullptr);
+
+    explicit ImageDiskCache(const QString& dirPath, qint64 maxBytes = DEFAULT_MAX_BYTES, QObject* parent = nullptr);
+    ~ImageDiskCache();
+
+    QNetworkCacheMetaData metaData(const QUrl& url) override;
+    void updateMetaData(const QNetworkCacheMetaData& metaData) override;
+    QIODevice* data(const QUrl& url) override;
+    bool remove(const QUrl& url) override;
+    qint64 cacheSize() const override;
+    QIODevice* prepare(const QNetworkCacheMetaData& metaData) override;
+    void insert(QIODevice* device) override;
+
+    const QString& getDirPath() const { return mDirPath; }
+    qint64 getMaxBytes() const { return mMaxBytes; }
+    QString getFileName(const QUrl& url) const;
+
+    // Remove least recently used files till the total size is below the maximum.
+    // Returns the new total size.
+    qint64 prune();
+
+    int getHits() const { return mHits; }
+    int getMisses() const { return mMisses; }
+    void logStats() const;
+
+public slots:
+    void clear() override;
+
+private:
+    bool read(const QString& fileName, QNetworkCacheMetaData& metaData, QByteArray* data) const;
+    bool write(const QString& fileName, const QNetworkCacheMetaData& metaData, const QByteArray& data);
+    qint64 scanSize() const;
+
+    QString mDirPath;
+    qint64 mMaxBytes;
+    mutable qint64 mSize = -1; // estimate, other instances may write too
+    std::unordered_map<QIODevice*, QNetworkCacheMetaData> mInserting;
+    int mHits = 0;
+    int mMisses = 0;
+};
+
+}
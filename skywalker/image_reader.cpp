@@ -1,8 +1,9 @@
 // Copyright (C) 2023 Michel de Boer
 // License: GPLv3
 #include "image_reader.h"
+#include "image_disk_cache.h"
 #include "photo_picker.h"
-#include <QImageReader>
+#include <QtConcurrent>
 
 namespace Skywalker {
 
@@ -11,13 +12,38 @@ ImageReader::ImageReader() :
 {
     mNetwork.setAutoDeleteReplies(true);
     mNetwork.setTransferTimeout(15000);
+
+    // The network access manager takes ownership of the cache.
+    auto* diskCache = ImageDiskCache::create();
+
+    if (diskCache)
+        mNetwork.setCache(diskCache);
 }
 
 bool ImageReader::getImage(const QString& urlString, const ImageCb& imageCb, const ErrorCb& errorCb)
 {
     qDebug() << "Get image:" << urlString;
 
-    if (urlString.startsWith("file://") || urlString.startsWith("image://"))
+    if (urlString.startsWith("file://"))
+    {
+        // Decode on the thread pool
+        auto* watcher = new QFutureWatcher<QImage>(this);
+
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [watcher, imageCb, errorCb]{
+            const QImage img = watcher->result();
+            watcher->deleteLater();
+
+            if (!img.isNull())
+                imageCb(img);
+            else
+                errorCb("Failed to load image");
+        });
+
+        watcher->setFuture(QtConcurrent::run([urlString]{ return PhotoPicker::loadImage(urlString); }));
+        return true;
+    }
+
+    if (urlString.startsWith("image://"))
     {
         auto img = PhotoPicker::loadImage(urlString);
 
@@ -44,6 +70,9 @@ bool ImageReader::getImageFromWeb(const QString& urlString, const ImageCb& image
     }
 
     QNetworkRequest request(url);
+
+    // Fresh images come from the disk cache, stale images get revalidated.
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
     QNetworkReply* reply = mNetwork.get(request);
 
     connect(reply, &QNetworkReply::finished, this, [this, reply, imageCb, errorCb]{
@@ -65,21 +94,24 @@ void ImageReader::replyFinished(QNetworkReply* reply, const ImageCb& imageCb, co
         return;
     }
 
-    QImageReader reader(reply);
-    reader.setAutoTransform(true);
-    QImage img = reader.read();
+    const QUrl url = reply->request().url();
 
-    if (img.isNull())
-    {
-        qWarning() << "Failed to read:" << reply->request().url();
-        if (errorCb)
-            errorCb(tr("Could not read image"));
+    // Decode on the thread pool. Web images are not scaled down, e.g. an image
+    // may be saved to the gallery.
+    PhotoPicker::readImageAsync(reply->readAll(), 0, this,
+        [url, imageCb, errorCb](QImage img, QString error){
+            if (img.isNull())
+            {
+                qWarning() << "Failed to read:" << url << error;
+                if (errorCb)
+                    errorCb(tr("Could not read image"));
 
-        return;
-    }
+                return;
+            }
 
-    if (imageCb)
-        imageCb(img);
+            if (imageCb)
+                imageCb(img);
+        });
 }
 
 }
@@ -0,0 +1,93 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "incremental_facet_parser.h"
+
+namespace Skywalker {
+
+void IncrementalFacetParser::setText(const QString& text)
+{
+    const int minSize = std::min(mText.size(), text.size());
+    int prefix = 0;
+
+    while (prefix < minSize && mText[prefix] == text[prefix])
+        ++prefix;
+
+    if (prefix == mText.size() && prefix == text.size())
+        return;
+
+    int suffix = 0;
+
+    while (suffix < minSize - prefix && mText[mText.size() - 1 - suffix] == text[text.size() - 1 - suffix])
+        ++suffix;
+
+    applyChange(text, prefix, mText.size() - prefix - suffix, text.size() - prefix - suffix);
+}
+
+void IncrementalFacetParser::applyChange(const QString& text, int position, int charsRemoved, int charsAdded)
+{
+    if (position < 0 || charsRemoved < 0 || charsAdded < 0 ||
+        position + charsRemoved > mText.size() || position + charsAdded > text.size() ||
+        mText.size() - charsRemoved + charsAdded != text.size())
+    {
+        qWarning() << "Inconsistent change, position:" << position << "removed:" << charsRemoved
+                   << "added:" << charsAdded << "old size:" << mText.size() << "new size:" << text.size();
+        mText = text;
+        mFacets.clear();
+        parse(0, text.size());
+        return;
+    }
+
+    // Start of the first and end of the last paragraph touched by the change.
+    const int start = position > 0 ? text.lastIndexOf('\n', position - 1) + 1 : 0;
+    int end = text.indexOf('\n', position + charsAdded);
+
+    if (end == -1)
+        end = text.size();
+
+    const int delta = charsAdded - charsRemoved;
+    const int oldEnd = end - delta;
+
+    auto first = std::lower_bound(mFacets.begin(), mFacets.end(), start,
+        [](const Facet& facet, int pos){ return facet.mStartIndex < pos; });
+    auto last = std::lower_bound(first, mFacets.end(), oldEnd,
+        [](const Facet& facet, int pos){ return facet.mStartIndex < pos; });
+
+    for (auto it = last; it != mFacets.end(); ++it)
+    {
+        it->mStartIndex += delta;
+        it->mEndIndex += delta;
+    }
+
+    mFacets.erase(first, last);
+    mText = text;
+    parse(start, end);
+}
+
+void IncrementalFacetParser::clear()
+{
+    mText.clear();
+    mFacets.clear();
+    mParsedChars = 0;
+}
+
+void IncrementalFacetParser::parse(int start, int end)
+{
+    auto parsed = ATProto::RichTextMaster::parseFacets(mText.sliced(start, end - start));
+    mParsedChars += end - start;
+
+    for (auto& facet : parsed)
+    {
+        facet.mStartIndex += start;
+        facet.mEndIndex += start;
+    }
+
+    // The parser returns facets grouped by type
+    std::stable_sort(parsed.begin(), parsed.end(),
+        [](const Facet& lhs, const Facet& rhs){ return lhs.mStartIndex < rhs.mStartIndex; });
+
+    const auto insertAt = std::lower_bound(mFacets.begin(), mFacets.end(), start,
+        [](const Facet& facet, int pos){ return facet.mStartIndex < pos; });
+    mFacets.insert(insertAt, parsed.begin(), parsed.end());
+}
+
+}
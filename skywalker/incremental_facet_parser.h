@@ -0,0 +1,43 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <atproto/lib/rich_text_master.h>
+
+namespace Skywalker {
+
+// Keeps the facets of a text while it is being edited. On a change only the
+// paragraphs touched by the change are parsed again. Facets never span a newline,
+// so the facets of the other paragraphs stay valid. Their positions get shifted
+// by the length difference of the change.
+class IncrementalFacetParser
+{
+public:
+    using Facet = ATProto::RichTextMaster::ParsedMatch;
+    using FacetList = std::vector<Facet>;
+
+    // Derives the change from the previous text by skipping the common prefix and suffix.
+    void setText(const QString& text);
+
+    // Applies a change as reported by QTextDocument::contentsChange. The text is
+    // the text after the change.
+    void applyChange(const QString& text, int position, int charsRemoved, int charsAdded);
+
+    void clear();
+
+    const QString& getText() const { return mText; }
+
+    // Facets ordered by position
+    const FacetList& getFacets() const { return mFacets; }
+
+    // Total number of characters parsed since construction or clear
+    qint64 getParsedChars() const { return mParsedChars; }
+
+private:
+    void parse(int start, int end);
+
+    QString mText;
+    FacetList mFacets;
+    qint64 mParsedChars = 0;
+};
+
+}
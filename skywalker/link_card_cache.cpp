@@ -0,0 +1,196 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "link_card_cache.h"
+#include "file_utils.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+
+namespace Skywalker {
+
+static constexpr const char* CACHE_SUB_PATH = "linkcards";
+static constexpr const char* CACHE_FILE_NAME = "link_cards.json";
+static constexpr int CACHE_VERSION = 1;
+
+std::unique_ptr<LinkCardCache> LinkCardCache::sInstance;
+
+LinkCardCache& LinkCardCache::instance()
+{
+    if (!sInstance)
+    {
+        const QString path = FileUtils::getCachePath(CACHE_SUB_PATH);
+
+        if (path.isEmpty())
+            qWarning() << "No cache path, link cards will not be persisted";
+
+        sInstance = std::make_unique<LinkCardCache>(path.isEmpty() ? QString() : path + "/" + CACHE_FILE_NAME);
+    }
+
+    return *sInstance;
+}
+
+LinkCardCache::LinkCardCache(const QString& fileName, std::chrono::seconds ttl, int maxEntries, QObject* parent) :
+    QObject(parent),
+    mFileName(fileName),
+    mTtl(ttl),
+    mMaxEntries(maxEntries)
+{
+    load();
+}
+
+std::optional<LinkCardCache::Entry> LinkCardCache::get(const QUrl& url)
+{
+    auto it = mEntries.find(url.toString());
+
+    if (it == mEntries.end())
+        return {};
+
+    if (isExpired(it->second, QDateTime::currentDateTimeUtc()))
+    {
+        qDebug() << "Link card expired:" << url;
+        mEntries.erase(it);
+        scheduleSave();
+        return {};
+    }
+
+    return it->second;
+}
+
+void LinkCardCache::put(const QUrl& url, const LinkCard& card)
+{
+    if (card.isEmpty())
+        return;
+
+    mEntries[url.toString()] = Entry{
+        card.getLink(), card.getTitle(), card.getDescription(), card.getThumb(),
+        QDateTime::currentDateTimeUtc() };
+
+    while ((int)mEntries.size() > mMaxEntries)
+        removeOldest();
+
+    scheduleSave();
+}
+
+bool LinkCardCache::isExpired(const Entry& entry, const QDateTime& now) const
+{
+    return entry.mTimestamp.secsTo(now) >= mTtl.count();
+}
+
+void LinkCardCache::removeOldest()
+{
+    auto oldest = std::min_element(mEntries.begin(), mEntries.end(),
+        [](const auto& lhs, const auto& rhs){ return lhs.second.mTimestamp < rhs.second.mTimestamp; });
+
+    if (oldest != mEntries.end())
+        mEntries.erase(oldest);
+}
+
+void LinkCardCache::scheduleSave()
+{
+    mDirty = true;
+
+    if (mSaveScheduled || mFileName.isEmpty())
+        return;
+
+    mSaveScheduled = true;
+    QTimer::singleShot(SAVE_DELAY_MS, this, [this]{
+        mSaveScheduled = false;
+
+        if (mDirty)
+            save();
+    });
+}
+
+void LinkCardCache::load()
+{
+    if (mFileName.isEmpty())
+        return;
+
+    QFile file(mFileName);
+
+    if (!file.exists())
+        return;
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Cannot open link card cache:" << mFileName << file.errorString();
+        return;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    const QJsonObject root = doc.object();
+
+    if (root["version"].toInt() != CACHE_VERSION)
+    {
+        qWarning() << "Unknown link card cache version:" << root["version"];
+        return;
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    for (const auto& value : root["cards"].toArray())
+    {
+        const QJsonObject json = value.toObject();
+        Entry entry{
+            json["link"].toString(),
+            json["title"].toString(),
+            json["description"].toString(),
+            json["thumb"].toString(),
+            QDateTime::fromMSecsSinceEpoch(json["timestamp"].toInteger()).toUTC() };
+
+        if (!isExpired(entry, now))
+            mEntries[json["url"].toString()] = entry;
+    }
+
+    qDebug() << "Link cards loaded:" << mEntries.size() << "file:" << mFileName;
+}
+
+void LinkCardCache::flush()
+{
+    if (mDirty)
+        save();
+}
+
+void LinkCardCache::save()
+{
+    mDirty = false;
+
+    if (mFileName.isEmpty())
+        return;
+
+    QJsonArray cards;
+
+    for (const auto& [url, entry] : mEntries)
+    {
+        QJsonObject json;
+        json.insert("url", url);
+        json.insert("link", entry.mLink);
+        json.insert("title", entry.mTitle);
+        json.insert("description", entry.mDescription);
+        json.insert("thumb", entry.mThumb);
+        json.insert("timestamp", entry.mTimestamp.toMSecsSinceEpoch());
+        cards.append(json);
+    }
+
+    QJsonObject root;
+    root.insert("version", CACHE_VERSION);
+    root.insert("cards", cards);
+
+    QSaveFile file(mFileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot create link card cache:" << mFileName << file.errorString();
+        return;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+
+    if (!file.commit())
+        qWarning() << "Failed to save link card cache:" << mFileName << file.errorString();
+}
+
+}
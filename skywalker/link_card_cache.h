@@ -0,0 +1,66 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "link_card.h"
+#include <QDateTime>
+#include <QUrl>
+#include <chrono>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Persistent cache of link cards, shared by all link card readers. Cards expire
+// after the TTL. Changes are saved to file shortly after they are made. Pending
+// changes are not saved on destruction, call flush before shutting down.
+class LinkCardCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::hours(24);
+    static constexpr int DEFAULT_MAX_ENTRIES = 500;
+    static constexpr int SAVE_DELAY_MS = 2000;
+
+    struct Entry
+    {
+        QString mLink;
+        QString mTitle;
+        QString mDescription;
+        QString mThumb;
+        QDateTime mTimestamp;
+    };
+
+    static LinkCardCache& instance();
+
+    // Without file name the cache is not persisted.
+    explicit LinkCardCache(const QString& fileName, std::chrono::seconds ttl = DEFAULT_TTL,
+                           int maxEntries = DEFAULT_MAX_ENTRIES, QObject* parent = nullptr);
+    // Returns nullopt if there is no card, or the card expired.
+    std::optional<Entry> get(const QUrl& url);
+
+    // Empty cards are not stored.
+    void put(const QUrl& url, const LinkCard& card);
+
+    void save();
+
+    // Save pending changes now, e.g. when the app pauses or the user signs out.
+    void flush();
+    int size() const { return (int)mEntries.size(); }
+
+private:
+    void load();
+    void scheduleSave();
+    bool isExpired(const Entry& entry, const QDateTime& now) const;
+    void removeOldest();
+
+    const QString mFileName;
+    const std::chrono::seconds mTtl;
+    const int mMaxEntries;
+    std::unordered_map<QString, Entry> mEntries; // url -> card
+    bool mDirty = false;
+    bool mSaveScheduled = false;
+
+    static std::unique_ptr<LinkCardCache> sInstance;
+};
+
+}
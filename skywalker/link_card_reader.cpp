@@ -48,6 +48,7 @@ public:
 LinkCardReader::LinkCardReader(QObject* parent):
     QObject(parent),
     mCardCache(100),
+    mDiskCache(&LinkCardCache::instance()),
     mGifUtils(this)
 {
     mNetwork.setAutoDeleteReplies(true);
@@ -61,6 +62,16 @@ LinkCardReader::LinkCardReader(QObject* parent):
     qDebug() << "Accept-Language:" << mAcceptLanguage;
 }
 
+LinkCardReader::~LinkCardReader()
+{
+    // Replies get deleted with the network manager after the fetches.
+    for (const auto& [_, fetch] : mFetches)
+    {
+        if (fetch.mReply)
+            disconnect(fetch.mReply, nullptr, this, nullptr);
+    }
+}
+
 LinkCard* LinkCardReader::makeLinkCard(const QString& link, const QString& title,
                        const QString& description, const QString& thumb)
 {
@@ -75,43 +86,53 @@ LinkCard* LinkCardReader::makeLinkCard(const QString& link, const QString& title
     return mCardCache[url];
 }
 
-void LinkCardReader::getLinkCard(const QString& link, bool retry)
+QUrl LinkCardReader::toUrl(const QString& link)
 {
-    qDebug() << "Get link card:" << link;
+    QString cleanedLink = link.startsWith("http") ? link : "https://" + link;
+    if (cleanedLink.endsWith("/"))
+        cleanedLink = cleanedLink.sliced(0, cleanedLink.size() - 1);
+
+    return QUrl(cleanedLink);
+}
 
-    if (mInProgress)
+LinkCard* LinkCardReader::getCachedCard(const QUrl& url)
+{
+    auto* card = mCardCache[url];
+    if (card)
     {
-        mInProgress->abort();
-        mInProgress = nullptr;
+        qDebug() << "Got card from cache:" << card->getLink();
+        return card;
     }
 
-    QString cleanedLink = link.startsWith("http") ? link : "https://" + link;
-    if (cleanedLink.endsWith("/"))
-        cleanedLink = cleanedLink.sliced(0, cleanedLink.size() - 1);
+    const auto entry = mDiskCache->get(url);
+    if (entry)
+    {
+        qDebug() << "Got card from disk cache:" << entry->mLink;
+        return makeLinkCard(entry->mLink, entry->mTitle, entry->mDescription, entry->mThumb);
+    }
 
-    QUrl url(cleanedLink);
+    return nullptr;
+}
+
+void LinkCardReader::getLinkCard(const QString& link, bool retry)
+{
+    qDebug() << "Get link card:" << link;
+
+    const QUrl url = toUrl(link);
     if (!url.isValid())
     {
         qWarning() << "Invalid link:" << link;
+        mRequestedUrl.clear();
         emit linkCardFailed();
         return;
     }
 
-    auto* card = mCardCache[url];
+    mRequestedUrl = url;
+
+    auto* card = getCachedCard(url);
     if (card)
     {
-        qDebug() << "Got card from cache:" << card->getLink();
-
-        if (!card->isEmpty())
-        {
-            emit linkCard(card);
-        }
-        else
-        {
-            qDebug() << "Card is empty";
-            emit linkCardFailed();
-        }
-
+        notifyCard(url, card);
         return;
     }
 
@@ -135,7 +156,80 @@ void LinkCardReader::getLinkCard(const QString& link, bool retry)
         }
     }
 
-    QNetworkRequest request(url);
+    fetch(url, retry);
+}
+
+void LinkCardReader::prefetchLinkCard(const QString& link)
+{
+    qDebug() << "Prefetch link card:" << link;
+
+    const QUrl url = toUrl(link);
+    if (!url.isValid())
+    {
+        qWarning() << "Invalid link:" << link;
+        return;
+    }
+
+    if (getCachedCard(url) || mGifUtils.isGiphyLink(url.toString()))
+        return;
+
+    fetch(url, false);
+}
+
+void LinkCardReader::notifyCard(const QUrl& url, LinkCard* card)
+{
+    if (url != mRequestedUrl)
+        return;
+
+    if (card && !card->isEmpty())
+    {
+        emit linkCard(card);
+    }
+    else
+    {
+        qDebug() << "Card is empty:" << url;
+        emit linkCardFailed();
+    }
+}
+
+void LinkCardReader::fetch(const QUrl& url, bool retry)
+{
+    const QString key = url.toString();
+
+    if (mFetches.contains(key))
+    {
+        qDebug() << "Fetch already in progress:" << key;
+        return;
+    }
+
+    mFetches[key] = Fetch{ url, url, retry, nullptr, {} };
+    mQueue.push_back(key);
+    startFetches();
+}
+
+void LinkCardReader::startFetches()
+{
+    for (auto it = mQueue.begin(); it != mQueue.end() && mActive < MAX_CONCURRENT; )
+    {
+        Fetch& fetch = mFetches[*it];
+        int& hostActive = mActivePerHost[fetch.mUrl.host()];
+
+        if (hostActive >= MAX_CONCURRENT_PER_HOST)
+        {
+            ++it;
+            continue;
+        }
+
+        ++hostActive;
+        ++mActive;
+        it = mQueue.erase(it);
+        startFetch(fetch);
+    }
+}
+
+void LinkCardReader::startFetch(Fetch& fetch)
+{
+    QNetworkRequest request(fetch.mUrl);
 
     // Without this YouTube Shorts does not load
     request.setAttribute(QNetworkRequest::CookieSaveControlAttribute, true);
@@ -148,14 +242,137 @@ void LinkCardReader::getLinkCard(const QString& link, bool retry)
     request.setRawHeader("User-Agent", Skywalker::getUserAgentString().toUtf8()); // For NYT, Reuters
 
     QNetworkReply* reply = mNetwork.get(request);
-    mInProgress = reply;
-    mPrevDestination = url;
-    mRetry = retry;
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply]{ extractLinkCard(reply); });
-    connect(reply, &QNetworkReply::errorOccurred, this, [this, reply](auto errCode){ requestFailed(reply, errCode); });
-    connect(reply, &QNetworkReply::sslErrors, this, [this, reply]{ requestSslFailed(reply); });
-    connect(reply, &QNetworkReply::redirected, this, [this, reply](const QUrl& url){ redirect(reply, url); });
+    fetch.mReply = reply;
+    const QString key = fetch.mUrl.toString();
+
+    // Errors, including SSL errors, also finish the reply.
+    connect(reply, &QNetworkReply::readyRead, this, [this, key]{ readHead(key); });
+    connect(reply, &QNetworkReply::finished, this, [this, key]{ fetchFinished(key); });
+    connect(reply, &QNetworkReply::redirected, this, [this, key](const QUrl& url){ redirect(key, url); });
+}
+
+bool LinkCardReader::isHeadComplete(const QByteArray& data, qsizetype from)
+{
+    const QLatin1StringView text(data);
+
+    // Start a bit earlier as a tag may have been cut off at the previous check.
+    const qsizetype start = std::max(qsizetype(0), from - 16);
+
+    if (text.indexOf(QLatin1StringView("</head"), start, Qt::CaseInsensitive) != -1 ||
+        text.indexOf(QLatin1StringView("<body"), start, Qt::CaseInsensitive) != -1)
+    {
+        return true;
+    }
+
+    // The Open Graph tags are typically at the start of the head. A tag may be
+    // cut off in the middle of its content.
+    const auto hasCompleteTag = [text](QLatin1StringView property){
+        const qsizetype index = text.indexOf(property);
+        return index != -1 && text.indexOf('>', index + property.size()) != -1;
+    };
+
+    return hasCompleteTag(QLatin1StringView("og:title")) &&
+           hasCompleteTag(QLatin1StringView("og:description")) &&
+           hasCompleteTag(QLatin1StringView("og:image"));
+}
+
+void LinkCardReader::readHead(const QString& key)
+{
+    auto it = mFetches.find(key);
+    if (it == mFetches.end())
+        return;
+
+    Fetch& fetch = it->second;
+
+    // Skip the body of a redirect response
+    const int status = fetch.mReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 300 && status < 400)
+        return;
+
+    const qsizetype prevSize = fetch.mData.size();
+    fetch.mData += fetch.mReply->readAll();
+
+    if (!isHeadComplete(fetch.mData, prevSize) && fetch.mData.size() < MAX_HEAD_SIZE)
+        return;
+
+    qDebug() << "Head read:" << key << "size:" << fetch.mData.size();
+    completeFetch(key, true);
+}
+
+void LinkCardReader::fetchFinished(const QString& key)
+{
+    auto it = mFetches.find(key);
+    if (it == mFetches.end())
+        return;
+
+    Fetch& fetch = it->second;
+    QNetworkReply* reply = fetch.mReply;
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        qDebug() << "Failed to get link:" << key;
+        qDebug() << "Error:" << reply->error() << reply->errorString();
+        completeFetch(key, false);
+        return;
+    }
+
+    fetch.mData += reply->readAll();
+    completeFetch(key, true);
+}
+
+void LinkCardReader::completeFetch(const QString& key, bool ok)
+{
+    auto it = mFetches.find(key);
+    Q_ASSERT(it != mFetches.end());
+    Fetch fetch = std::move(it->second);
+    mFetches.erase(it);
+
+    --mActive;
+    if (--mActivePerHost[fetch.mUrl.host()] == 0)
+        mActivePerHost.erase(fetch.mUrl.host());
+
+    // The rest of the page is not needed.
+    QNetworkReply* reply = fetch.mReply;
+    disconnect(reply, nullptr, this, nullptr);
+
+    if (reply->isRunning())
+        reply->abort();
+
+    if (!ok)
+    {
+        if (fetch.mUrl == mRequestedUrl)
+            emit linkCardFailed();
+
+        startFetches();
+        return;
+    }
+
+    auto card = extractLinkCard(fetch.mData, fetch.mUrl);
+
+    if (card->isEmpty())
+    {
+        auto* cookieJar = static_cast<CookieJar*>(mNetwork.cookieJar());
+        Q_ASSERT(cookieJar);
+
+        if (!fetch.mRetry && cookieJar->setCookiesFromReply(*reply))
+        {
+            qDebug() << "Cookies stored, retry";
+            this->fetch(fetch.mUrl, true);
+            return;
+        }
+
+        qDebug() << fetch.mUrl << "has no link card.";
+    }
+    else
+    {
+        card->setLink(fetch.mUrl.toString());
+        mDiskCache->put(fetch.mUrl, *card);
+    }
+
+    LinkCard* cachedCard = card.get();
+    mCardCache.insert(fetch.mUrl, card.release());
+    notifyCard(fetch.mUrl, cachedCard);
+    startFetches();
 }
 
 static QString matchRegexes(const std::vector<QRegularExpression>& regexes, const QByteArray& data, const QString& group)
@@ -171,7 +388,7 @@ static QString matchRegexes(const std::vector<QRegularExpression>& regexes, cons
     return {};
 }
 
-void LinkCardReader::extractLinkCard(QNetworkReply* reply)
+std::unique_ptr<LinkCard> LinkCardReader::extractLinkCard(const QByteArray& data, const QUrl& url)
 {
     static const QString ogTitleStr1(R"(<meta [^>]*(property|name) *=[\"']?(og:|twitter:)?title[\"']? [^>]*content=%1(?<title>[^%1]+?)%1[^>]*>)");
     static const QString ogTitleStr2(R"(<meta [^>]*content=%1(?<title>[^%1]+?)%1 [^>]*(property|name)=[\"']?(og:|twitter:)?title[\"']?[^>]*>)");
@@ -207,16 +424,7 @@ void LinkCardReader::extractLinkCard(QNetworkReply* reply)
         QRegularExpression(ogImageStr4)
     };
 
-    mInProgress = nullptr;
-
-    if (reply->error() != QNetworkReply::NoError)
-    {
-        requestFailed(reply, reply->error());
-        return;
-    }
-
     auto card = std::make_unique<LinkCard>(this);
-    const auto data = reply->readAll();
 
     const QString title = matchRegexes(ogTitleREs, data, "title");
     if (!title.isEmpty())
@@ -228,7 +436,6 @@ void LinkCardReader::extractLinkCard(QNetworkReply* reply)
 
     QString imgUrlString = matchRegexes(ogImageREs, data, "image");
     qDebug() << "img url:" << imgUrlString;
-    const auto& url = reply->request().url();
 
     if (!imgUrlString.isEmpty())
     {
@@ -264,29 +471,7 @@ void LinkCardReader::extractLinkCard(QNetworkReply* reply)
         }
     }
 
-    if (card->isEmpty())
-    {
-        auto* cookieJar = static_cast<CookieJar*>(mNetwork.cookieJar());
-        Q_ASSERT(cookieJar);
-
-        if (!mRetry && cookieJar->setCookiesFromReply(*reply))
-        {
-            qDebug() << "Cookies stored, retry";
-            getLinkCard(url.toString(), true);
-        }
-        else
-        {
-            mCardCache.insert(url, card.release());
-            qDebug() << url << "has no link card.";
-            emit linkCardFailed();
-        }
-
-        return;
-    }
-
-    card->setLink(url.toString());
-    mCardCache.insert(url, card.get());
-    emit linkCard(card.release());
+    return card;
 }
 
 QString LinkCardReader::toPlainText(const QString& text)
@@ -299,31 +484,21 @@ QString LinkCardReader::toPlainText(const QString& text)
     return UnicodeFonts::toPlainText(plain);
 }
 
-void LinkCardReader::requestFailed(QNetworkReply* reply, int errCode)
-{
-    mInProgress = nullptr;
-    qDebug() << "Failed to get link:" << reply->request().url();
-    qDebug() << "Error:" << errCode << reply->errorString();
-    qDebug() << reply->readAll();
-    emit linkCardFailed();
-}
-
-void LinkCardReader::requestSslFailed(QNetworkReply* reply)
+void LinkCardReader::redirect(const QString& key, const QUrl& redirectUrl)
 {
-    mInProgress = nullptr;
-    qDebug() << "SSL error, failed to get link:" << reply->request().url();
-    emit linkCardFailed();
-}
+    auto it = mFetches.find(key);
+    if (it == mFetches.end())
+        return;
 
-void LinkCardReader::redirect(QNetworkReply* reply, const QUrl& redirectUrl)
-{
-    qDebug() << "Prev url:" << mPrevDestination << "redirect url:" << redirectUrl;
+    Fetch& fetch = it->second;
+    QNetworkReply* reply = fetch.mReply;
+    qDebug() << "Prev url:" << fetch.mPrevDestination << "redirect url:" << redirectUrl;
 
     // Allow: https -> https, http -> http, http -> https
     // Allow https -> http only if the host stays the same
-    if (mPrevDestination.scheme() == redirectUrl.scheme() ||
-        mPrevDestination.scheme() == "http" ||
-        mPrevDestination.host() == redirectUrl.host())
+    if (fetch.mPrevDestination.scheme() == redirectUrl.scheme() ||
+        fetch.mPrevDestination.scheme() == "http" ||
+        fetch.mPrevDestination.host() == redirectUrl.host())
     {
         emit reply->redirectAllowed();
     }
@@ -332,7 +507,7 @@ void LinkCardReader::redirect(QNetworkReply* reply, const QUrl& redirectUrl)
     Q_ASSERT(cookieJar);
     cookieJar->setCookiesFromReply(*reply);
 
-    mPrevDestination = redirectUrl;
+    fetch.mPrevDestination = redirectUrl;
 }
 
 }
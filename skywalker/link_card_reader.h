@@ -2,42 +2,83 @@
 // License: GPLv3
 #pragma once
 #include "link_card.h"
+#include "link_card_cache.h"
 #include "gif_utils.h"
 #include <QCache>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QtQmlIntegration>
+#include <deque>
 
 namespace Skywalker {
 
+// Fetches link cards with multiple concurrent requests. Only the HTML head is
+// read. Results are cached in memory and in the persistent LinkCardCache.
+//
+// A card is signalled only for the last link requested with getLinkCard. A
+// request that is superseded continues in the background to fill the cache.
 class LinkCardReader : public QObject
 {
     Q_OBJECT
     QML_ELEMENT
 
 public:
+    static constexpr int MAX_CONCURRENT = 4;
+    static constexpr int MAX_CONCURRENT_PER_HOST = 2;
+    static constexpr qsizetype MAX_HEAD_SIZE = 1024 * 1024;
+
     explicit LinkCardReader(QObject* parent = nullptr);
+    ~LinkCardReader();
+
+    // For testing, default is LinkCardCache::instance()
+    void setDiskCache(LinkCardCache* diskCache) { mDiskCache = diskCache; }
 
     Q_INVOKABLE void getLinkCard(const QString& link, bool retry = false);
+    Q_INVOKABLE void prefetchLinkCard(const QString& link);
     Q_INVOKABLE LinkCard* makeLinkCard(const QString& link, const QString& title,
                                   const QString& description, const QString& thumb);
 
+    int getFetchCount() const { return (int)mFetches.size(); }
+
+    // Returns true if the data contains the complete HTML head, or all Open Graph
+    // tags for a card, each up to the end of its tag.
+    static bool isHeadComplete(const QByteArray& data, qsizetype from = 0);
+
 signals:
     void linkCard(LinkCard*);
     void linkCardFailed();
 
 private:
+    struct Fetch
+    {
+        QUrl mUrl;
+        QUrl mPrevDestination;
+        bool mRetry = false;
+        QNetworkReply* mReply = nullptr;
+        QByteArray mData;
+    };
+
+    static QUrl toUrl(const QString& link);
+    LinkCard* getCachedCard(const QUrl& url);
+    void fetch(const QUrl& url, bool retry);
+    void startFetches();
+    void startFetch(Fetch& fetch);
+    void readHead(const QString& key);
+    void fetchFinished(const QString& key);
+    void completeFetch(const QString& key, bool ok);
+    void notifyCard(const QUrl& url, LinkCard* card);
     QString toPlainText(const QString& text);
-    void extractLinkCard(QNetworkReply* reply);
-    void requestFailed(QNetworkReply* reply, int errCode);
-    void requestSslFailed(QNetworkReply* reply);
-    void redirect(QNetworkReply* reply, const QUrl& redirectUrl);
+    std::unique_ptr<LinkCard> extractLinkCard(const QByteArray& data, const QUrl& url);
+    void redirect(const QString& key, const QUrl& redirectUrl);
 
     QNetworkAccessManager mNetwork;
     QCache<QUrl, LinkCard> mCardCache;
-    QNetworkReply* mInProgress = nullptr;
-    QUrl mPrevDestination;
-    bool mRetry = false;
+    LinkCardCache* mDiskCache;
+    std::unordered_map<QString, Fetch> mFetches; // url -> fetch, started or queued
+    std::deque<QString> mQueue; // urls of fetches waiting to start
+    std::unordered_map<QString, int> mActivePerHost;
+    int mActive = 0;
+    QUrl mRequestedUrl;
     GifUtils mGifUtils;
     QString mAcceptLanguage;
 };
@@ -1,25 +1,108 @@
 // Copyright (C) 2023 Michel de Boer
 // License: GPLv3
 #include "local_post_model_changes.h"
+#include <algorithm>
 
 namespace Skywalker {
 
+LocalPostModelChanges::Store& LocalPostModelChanges::store()
+{
+    static thread_local Store sStore;
+    return sStore;
+}
+
+LocalPostModelChanges::LocalPostModelChanges() :
+    mBaseSeq(store().mSeq)
+{
+    store().mModels.push_back(this);
+}
+
+LocalPostModelChanges::~LocalPostModelChanges()
+{
+    std::erase(store().mModels, this);
+    removeObsoleteChanges();
+}
+
 const LocalPostModelChanges::Change* LocalPostModelChanges::getLocalChange(const QString& cid) const
 {
-    auto it = mChanges.find(cid);
-    return it != mChanges.end() ? &it->second : nullptr;
+    return getChange(store().mChanges, cid, mChangeCache);
 }
 
 const LocalPostModelChanges::Change* LocalPostModelChanges::getLocalUriChange(const QString& uri) const
 {
-    auto it = mUriChanges.find(uri);
-    return it != mUriChanges.end() ? &it->second : nullptr;
+    return getChange(store().mUriChanges, uri, mUriChangeCache);
+}
+
+const LocalPostModelChanges::Change* LocalPostModelChanges::getChange(const ChangeLog& log, const QString& key, ChangeCache& cache) const
+{
+    auto it = log.find(key);
+
+    if (it == log.end())
+        return nullptr;
+
+    const auto& updates = it->second;
+    Q_ASSERT(!updates.empty());
+    const qint64 lastSeq = updates.back().mSeq;
+
+    if (lastSeq <= mBaseSeq)
+        return nullptr;
+
+    auto& cached = cache[key];
+
+    if (cached.mSeq != lastSeq)
+    {
+        cached.mChange = {};
+
+        for (const auto& update : updates)
+        {
+            if (update.mSeq > mBaseSeq)
+                update.mApply(cached.mChange);
+        }
+
+        cached.mSeq = lastSeq;
+    }
+
+    return &cached.mChange;
 }
 
 void LocalPostModelChanges::clearLocalChanges()
 {
-    mChanges.clear();
-    mUriChanges.clear();
+    mBaseSeq = store().mSeq;
+    mChangeCache.clear();
+    mUriChangeCache.clear();
+    removeObsoleteChanges();
+}
+
+void LocalPostModelChanges::addChange(ChangeLog& log, const QString& key, std::function<void(Change&)> apply)
+{
+    log[key].push_back({ ++store().mSeq, std::move(apply) });
+}
+
+void LocalPostModelChanges::notifyModels(const std::function<void(LocalPostModelChanges*)>& notify)
+{
+    const auto& models = store().mModels;
+
+    // A model may get created or deleted as a result of a notification.
+    for (size_t i = 0; i < models.size(); ++i)
+        notify(models[i]);
+}
+
+void LocalPostModelChanges::removeObsoleteChanges()
+{
+    auto& s = store();
+    qint64 minBaseSeq = s.mSeq;
+
+    for (const auto* model : s.mModels)
+        minBaseSeq = std::min(minBaseSeq, model->mBaseSeq);
+
+    // Updates that are part of the posts in all models are not needed anymore.
+    for (auto* log : { &s.mChanges, &s.mUriChanges })
+    {
+        std::erase_if(*log, [minBaseSeq](auto& item){
+            std::erase_if(item.second, [minBaseSeq](const auto& update){ return update.mSeq <= minBaseSeq; });
+            return item.second.empty();
+        });
+    }
 }
 
 void LocalPostModelChanges::updatePostIndexedSecondsAgo()
@@ -28,117 +111,135 @@ void LocalPostModelChanges::updatePostIndexedSecondsAgo()
     postIndexedSecondsAgoChanged();
 }
 
+void LocalPostModelChanges::updateAllPostIndexedSecondsAgo()
+{
+    notifyModels([](auto* model){ model->updatePostIndexedSecondsAgo(); });
+}
+
 void LocalPostModelChanges::updateReplyCountDelta(const QString& cid, int delta)
 {
-    mChanges[cid].mReplyCountDelta += delta;
-    replyCountChanged();
+    addChange(store().mChanges, cid, [delta](Change& change){ change.mReplyCountDelta += delta; });
+    notifyModels([&cid](auto* model){ model->replyCountChanged(cid); });
 }
 
 void LocalPostModelChanges::updateRepostCountDelta(const QString& cid, int delta)
 {
-    mChanges[cid].mRepostCountDelta += delta;
-    repostCountChanged();
+    addChange(store().mChanges, cid, [delta](Change& change){ change.mRepostCountDelta += delta; });
+    notifyModels([&cid](auto* model){ model->repostCountChanged(cid); });
 }
 
 void LocalPostModelChanges::updateQuoteCountDelta(const QString& cid, int delta)
 {
-    mChanges[cid].mQuoteCountDelta += delta;
-    quoteCountChanged();
+    addChange(store().mChanges, cid, [delta](Change& change){ change.mQuoteCountDelta += delta; });
+    notifyModels([&cid](auto* model){ model->quoteCountChanged(cid); });
 }
 
 void LocalPostModelChanges::updateRepostUri(const QString& cid, const QString& repostUri)
 {
-    mChanges[cid].mRepostUri = repostUri;
-    repostUriChanged();
+    addChange(store().mChanges, cid, [repostUri](Change& change){ change.mRepostUri = repostUri; });
+    notifyModels([&cid](auto* model){ model->repostUriChanged(cid); });
 }
 
 void LocalPostModelChanges::updateLikeCountDelta(const QString& cid, int delta)
 {
-    mChanges[cid].mLikeCountDelta += delta;
-    likeCountChanged();
+    addChange(store().mChanges, cid, [delta](Change& change){ change.mLikeCountDelta += delta; });
+    notifyModels([&cid](auto* model){ model->likeCountChanged(cid); });
 }
 
 void LocalPostModelChanges::updateLikeUri(const QString& cid, const QString& likeUri)
 {
-    mChanges[cid].mLikeUri = likeUri;
-    likeUriChanged();
+    addChange(store().mChanges, cid, [likeUri](Change& change){ change.mLikeUri = likeUri; });
+    notifyModels([&cid](auto* model){ model->likeUriChanged(cid); });
 }
 
 void LocalPostModelChanges::updateLikeTransient(const QString& cid, bool transient)
 {
-    mChanges[cid].mLikeTransient = transient;
-    likeTransientChanged();
+    addChange(store().mChanges, cid, [transient](Change& change){ change.mLikeTransient = transient; });
+    notifyModels([&cid](auto* model){ model->likeTransientChanged(cid); });
 }
 
 void LocalPostModelChanges::updateThreadgateUri(const QString& cid, const QString& threadgateUri)
 {
-    mChanges[cid].mThreadgateUri = threadgateUri;
-    threadgateUriChanged();
+    addChange(store().mChanges, cid, [threadgateUri](Change& change){ change.mThreadgateUri = threadgateUri; });
+    notifyModels([&cid](auto* model){ model->threadgateUriChanged(cid); });
 }
 
 void LocalPostModelChanges::updateReplyRestriction(const QString& cid, const QEnums::ReplyRestriction replyRestricion)
 {
-    mChanges[cid].mReplyRestriction = replyRestricion;
-    replyRestrictionChanged();
+    addChange(store().mChanges, cid, [replyRestricion](Change& change){ change.mReplyRestriction = replyRestricion; });
+    notifyModels([&cid](auto* model){ model->replyRestrictionChanged(cid); });
 }
 
 void LocalPostModelChanges::updateReplyRestrictionLists(const QString& cid, const ListViewBasicList replyRestrictionLists)
 {
-    mChanges[cid].mReplyRestrictionLists = replyRestrictionLists;
-    replyRestrictionListsChanged();
+    addChange(store().mChanges, cid, [replyRestrictionLists](Change& change){ change.mReplyRestrictionLists = replyRestrictionLists; });
+    notifyModels([&cid](auto* model){ model->replyRestrictionListsChanged(cid); });
 }
 
 void LocalPostModelChanges::updateHiddenReplies(const QString& cid, const QStringList& hiddenReplies)
 {
-    mChanges[cid].mHiddenReplies = hiddenReplies;
-    hiddenRepliesChanged();
+    addChange(store().mChanges, cid, [hiddenReplies](Change& change){ change.mHiddenReplies = hiddenReplies; });
+    notifyModels([&cid](auto* model){ model->hiddenRepliesChanged(cid); });
 }
 
 void LocalPostModelChanges::updateThreadMuted(const QString& uri, bool muted)
 {
-    mUriChanges[uri].mThreadMuted = muted;
-    threadMutedChanged();
+    addChange(store().mUriChanges, uri, [muted](Change& change){ change.mThreadMuted = muted; });
+    notifyModels([&uri](auto* model){ model->threadMutedChanged(uri); });
 }
 
 bool LocalPostModelChanges::updateDetachedRecord(const QString& cid, const QString& postUri)
 {
     if (postUri.isEmpty())
     {
-        if (!mChanges[cid].mDetachedRecord)
+        bool detached = false;
+        auto it = store().mChanges.find(cid);
+
+        if (it != store().mChanges.end())
         {
-            // Was not locally detached, get record from network
-            return true;
+            Change change;
+
+            for (const auto& update : it->second)
+                update.mApply(change);
+
+            detached = change.mDetachedRecord != nullptr;
         }
-        else
+
+        if (!detached)
         {
-            mChanges[cid].mDetachedRecord = nullptr; // re-attach of a previously detached record
+            // Was not locally detached, get record from network
+            return true;
         }
+
+        // re-attach of a previously detached record
+        addChange(store().mChanges, cid, [](Change& change){ change.mDetachedRecord = nullptr; });
     }
     else
     {
-        mChanges[cid].mDetachedRecord = RecordView::makeDetachedRecord(postUri);
+        auto record = RecordView::makeDetachedRecord(postUri);
+        addChange(store().mChanges, cid, [record](Change& change){ change.mDetachedRecord = record; });
     }
 
-    detachedRecordChanged();
+    notifyModels([&cid](auto* model){ model->detachedRecordChanged(cid); });
     return false;
 }
 
 void LocalPostModelChanges::updateReAttachedRecord(const QString& cid, RecordView::SharedPtr record)
 {
-    mChanges[cid].mReAttachedRecord = record;
-    reAttachedRecordChanged();
+    addChange(store().mChanges, cid, [record](Change& change){ change.mReAttachedRecord = record; });
+    notifyModels([&cid](auto* model){ model->reAttachedRecordChanged(cid); });
 }
 
 void LocalPostModelChanges::updateViewerStatePinned(const QString& cid, bool pinned)
 {
-    mChanges[cid].mViewerStatePinned = pinned;
-    viewerStatePinnedChanged();
+    addChange(store().mChanges, cid, [pinned](Change& change){ change.mViewerStatePinned = pinned; });
+    notifyModels([&cid](auto* model){ model->viewerStatePinnedChanged(cid); });
 }
 
 void LocalPostModelChanges::updatePostDeleted(const QString& cid)
 {
-    mChanges[cid].mPostDeleted = true;
-    postDeletedChanged();
+    addChange(store().mChanges, cid, [](Change& change){ change.mPostDeleted = true; });
+    notifyModels([&cid](auto* model){ model->postDeletedChanged(cid); });
 }
 
 }
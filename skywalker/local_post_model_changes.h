@@ -6,11 +6,17 @@
 #include "record_view.h"
 #include <QHashFunctions>
 #include <QString>
+#include <functional>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace Skywalker {
 
+// Local changes to posts, e.g. likes and reposts, are written once to a change
+// log shared by all post models, indexed by post CID. Each model sees the changes
+// made since it got created or cleared. Changes made before that are already part
+// of the posts it received from the network, so they must not be applied twice.
 class  LocalPostModelChanges
 {
 public:
@@ -39,26 +45,33 @@ public:
         bool mPostDeleted = false;
     };
 
-    LocalPostModelChanges() = default;
-    virtual ~LocalPostModelChanges() = default;
+    LocalPostModelChanges();
+    LocalPostModelChanges(const LocalPostModelChanges&) = delete;
+    LocalPostModelChanges& operator=(const LocalPostModelChanges&) = delete;
+    virtual ~LocalPostModelChanges();
 
     const Change* getLocalChange(const QString& cid) const;
     const Change* getLocalUriChange(const QString& uri) const;
     void clearLocalChanges();
 
     void updatePostIndexedSecondsAgo();
-    void updateReplyCountDelta(const QString& cid, int delta);
-    void updateRepostCountDelta(const QString& cid, int delta);
-    void updateQuoteCountDelta(const QString& cid, int delta);
-    void updateRepostUri(const QString& cid, const QString& repostUri);
-    void updateLikeCountDelta(const QString& cid, int delta);
-    void updateLikeUri(const QString& cid, const QString& likeUri);
-    void updateLikeTransient(const QString& cid, bool transient);
-    void updateThreadgateUri(const QString& cid, const QString& threadgateUri);
-    void updateReplyRestriction(const QString& cid, const QEnums::ReplyRestriction replyRestricion);
-    void updateReplyRestrictionLists(const QString& cid, const ListViewBasicList replyRestrictionLists);
-    void updateHiddenReplies(const QString& cid, const QStringList& hiddenReplies);
-    void updateThreadMuted(const QString& uri, bool muted);
+
+    // Refresh the relative time in all models.
+    static void updateAllPostIndexedSecondsAgo();
+
+    // The updates below apply to all models.
+    static void updateReplyCountDelta(const QString& cid, int delta);
+    static void updateRepostCountDelta(const QString& cid, int delta);
+    static void updateQuoteCountDelta(const QString& cid, int delta);
+    static void updateRepostUri(const QString& cid, const QString& repostUri);
+    static void updateLikeCountDelta(const QString& cid, int delta);
+    static void updateLikeUri(const QString& cid, const QString& likeUri);
+    static void updateLikeTransient(const QString& cid, bool transient);
+    static void updateThreadgateUri(const QString& cid, const QString& threadgateUri);
+    static void updateReplyRestriction(const QString& cid, const QEnums::ReplyRestriction replyRestricion);
+    static void updateReplyRestrictionLists(const QString& cid, const ListViewBasicList replyRestrictionLists);
+    static void updateHiddenReplies(const QString& cid, const QStringList& hiddenReplies);
+    static void updateThreadMuted(const QString& uri, bool muted);
 
     /**
      * @brief updateDetachedRecord
@@ -66,37 +79,73 @@ public:
      * @param postUri the quote uri to be detached, empty uri means re-attach
      * @return true when a re-attached quote should be loaded
      */
-    bool updateDetachedRecord(const QString& cid, const QString& postUri);
+    static bool updateDetachedRecord(const QString& cid, const QString& postUri);
 
-    void updateReAttachedRecord(const QString& cid, RecordView::SharedPtr record);
-    void updateViewerStatePinned(const QString& cid, bool pinned);
-    void updatePostDeleted(const QString& cid);
+    static void updateReAttachedRecord(const QString& cid, RecordView::SharedPtr record);
+    static void updateViewerStatePinned(const QString& cid, bool pinned);
+    static void updatePostDeleted(const QString& cid);
 
 protected:
+    // The cid is the CID of the changed post. For a thread mute change, the uri
+    // is the URI of the thread root.
     virtual void postIndexedSecondsAgoChanged() = 0;
-    virtual void likeCountChanged() = 0;
-    virtual void likeUriChanged() = 0;
-    virtual void likeTransientChanged() = 0;
-    virtual void replyCountChanged() = 0;
-    virtual void repostCountChanged() = 0;
-    virtual void quoteCountChanged() = 0;
-    virtual void repostUriChanged() = 0;
-    virtual void threadgateUriChanged() = 0;
-    virtual void replyRestrictionChanged() = 0;
-    virtual void replyRestrictionListsChanged() = 0;
-    virtual void hiddenRepliesChanged() = 0;
-    virtual void threadMutedChanged() = 0;
-    virtual void detachedRecordChanged() = 0;
-    virtual void reAttachedRecordChanged() = 0;
-    virtual void viewerStatePinnedChanged() = 0;
-    virtual void postDeletedChanged() = 0;
+    virtual void likeCountChanged(const QString& cid) = 0;
+    virtual void likeUriChanged(const QString& cid) = 0;
+    virtual void likeTransientChanged(const QString& cid) = 0;
+    virtual void replyCountChanged(const QString& cid) = 0;
+    virtual void repostCountChanged(const QString& cid) = 0;
+    virtual void quoteCountChanged(const QString& cid) = 0;
+    virtual void repostUriChanged(const QString& cid) = 0;
+    virtual void threadgateUriChanged(const QString& cid) = 0;
+    virtual void replyRestrictionChanged(const QString& cid) = 0;
+    virtual void replyRestrictionListsChanged(const QString& cid) = 0;
+    virtual void hiddenRepliesChanged(const QString& cid) = 0;
+    virtual void threadMutedChanged(const QString& uri) = 0;
+    virtual void detachedRecordChanged(const QString& cid) = 0;
+    virtual void reAttachedRecordChanged(const QString& cid) = 0;
+    virtual void viewerStatePinnedChanged(const QString& cid) = 0;
+    virtual void postDeletedChanged(const QString& cid) = 0;
 
 private:
-    // Mapping from post CID to change
-    std::unordered_map<QString, Change> mChanges;
+    struct Update
+    {
+        qint64 mSeq;
+        std::function<void(Change&)> mApply;
+    };
+
+    // Updates per post in the order they were made
+    using ChangeLog = std::unordered_map<QString, std::vector<Update>>;
+
+    struct CachedChange
+    {
+        qint64 mSeq = 0; // last update applied
+        Change mChange;
+    };
+
+    using ChangeCache = std::unordered_map<QString, CachedChange>;
+
+    // Models live on the thread that created them, so each thread has its own log.
+    struct Store
+    {
+        qint64 mSeq = 0;
+        ChangeLog mChanges; // key is post CID
+        ChangeLog mUriChanges; // key is post URI
+        std::vector<LocalPostModelChanges*> mModels;
+    };
+
+    static Store& store();
+    static void addChange(ChangeLog& log, const QString& key, std::function<void(Change&)> apply);
+    static void notifyModels(const std::function<void(LocalPostModelChanges*)>& notify);
+    static void removeObsoleteChanges();
+
+    const Change* getChange(const ChangeLog& log, const QString& key, ChangeCache& cache) const;
+
+    // Changes up to this sequence number are part of the posts in the model.
+    qint64 mBaseSeq = 0;
 
-    // Mapping from post URI to change
-    std::unordered_map<QString, Change> mUriChanges;
+    // The changes since mBaseSeq, folded on first access.
+    mutable ChangeCache mChangeCache;
+    mutable ChangeCache mUriChangeCache;
 };
 
 }
@@ -10,10 +10,14 @@ namespace Skywalker {
 static constexpr int HD_BANDWIDTH_THRESHOLD_KBPS = 2000;
 
 M3U8Reader::M3U8Reader(QObject* parent) :
-    QObject(parent)
+    QObject(parent),
+    mSegmentLoader(mNetwork)
 {
     mNetwork.setAutoDeleteReplies(true);
     mNetwork.setTransferTimeout(15000);
+
+    connect(&mSegmentLoader, &HlsSegmentLoader::finished, this, [this]{ loadStreamFinished(); });
+    connect(&mSegmentLoader, &HlsSegmentLoader::failed, this, [this](const QString& error){ loadStreamFailed(error); });
 }
 
 void M3U8Reader::setLoading(bool loading)
@@ -43,6 +47,9 @@ void M3U8Reader::getVideoStream(const QString& link, bool firstCall)
     {
         setResolution();
         mLoopCount = 5;
+        mStreamUrls.clear();
+        mStreamSegments.clear();
+        mStreamDurationMs = 0;
     }
     else
     {
@@ -112,33 +119,108 @@ void M3U8Reader::extractStream(QNetworkReply* reply)
         }
 
         qDebug() << "Got video stream:" << parser.getStreamSegments();
+        const auto resolution = getStreamResolution(reply->request().url());
+        auto& segments = mStreamSegments[resolution];
+        segments.clear();
 
         for (const QString& segment : parser.getStreamSegments())
         {
             const QString streamUrl = buildStreamUrl(reply->request().url(), segment);
-            mStreamSegments.push_back(streamUrl);
+            segments.push_back(streamUrl);
+        }
+
+        mStreamDurationMs = parser.getStreamDurationSeconds() * 1000;
+
+        // Get the other resolution too, such that loading can switch between them.
+        for (const auto& [otherResolution, otherUrl] : mStreamUrls)
+        {
+            if (otherResolution != resolution && !mStreamSegments.contains(otherResolution))
+            {
+                getAlternateStream(otherUrl);
+                return;
+            }
         }
 
-        emit getVideoStreamOk(parser.getStreamDurationSeconds() * 1000);
+        emit getVideoStreamOk(mStreamDurationMs);
         return;
     }
 
     Q_ASSERT(streamType == M3U8StreamType::PLAYLIST);
-    QString stream = mResolution == STREAM_RESOLUTION_360 ? parser.getStream360() : parser.getStream720();
 
-    if (stream.isEmpty())
-        stream = mResolution == STREAM_RESOLUTION_360 ? parser.getStream720() : parser.getStream360();
+    if (!parser.getStream360().isEmpty())
+        mStreamUrls[STREAM_RESOLUTION_360] = buildStreamUrl(reply->request().url(), parser.getStream360());
+
+    if (!parser.getStream720().isEmpty())
+        mStreamUrls[STREAM_RESOLUTION_720] = buildStreamUrl(reply->request().url(), parser.getStream720());
 
-    if (stream.isEmpty())
+    if (mStreamUrls.empty())
     {
         qWarning() << "Cannot find stream:" << reply->request().url();
         emit getVideoStreamError();
         return;
     }
 
-    qDebug() << "Extracted stream:" << stream;
-    const QString streamUrl = buildStreamUrl(reply->request().url(), stream);
-    getVideoStream(streamUrl);
+    if (!mStreamUrls.contains(mResolution))
+        mResolution = mStreamUrls.begin()->first;
+
+    const QString& streamUrl = mStreamUrls[mResolution];
+    qDebug() << "Extracted stream:" << streamUrl;
+    getVideoStream(streamUrl, false);
+}
+
+M3U8Reader::StreamResolution M3U8Reader::getStreamResolution(const QUrl& streamUrl) const
+{
+    for (const auto& [resolution, url] : mStreamUrls)
+    {
+        if (QUrl(url) == streamUrl)
+            return resolution;
+    }
+
+    // The link was a stream without a playlist.
+    return mResolution;
+}
+
+void M3U8Reader::getAlternateStream(const QString& link)
+{
+    qDebug() << "Get alternate stream:" << link;
+    QNetworkRequest request{QUrl(link)};
+    QNetworkReply* reply = mNetwork.get(request);
+    mInProgress = reply;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply]{ extractAlternateStream(reply); });
+}
+
+void M3U8Reader::extractAlternateStream(QNetworkReply* reply)
+{
+    mInProgress = nullptr;
+
+    if (reply->error() == QNetworkReply::OperationCanceledError)
+        return;
+
+    // Failures are not fatal, the stream will be loaded without switching.
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        qWarning() << "Failed to get alternate stream:" << reply->request().url() << reply->errorString();
+        emit getVideoStreamOk(mStreamDurationMs);
+        return;
+    }
+
+    M3U8Parser parser;
+
+    if (parser.parse(reply->readAll()) == M3U8StreamType::VIDEO)
+    {
+        auto& segments = mStreamSegments[getStreamResolution(reply->request().url())];
+        segments.clear();
+
+        for (const QString& segment : parser.getStreamSegments())
+            segments.push_back(buildStreamUrl(reply->request().url(), segment));
+    }
+    else
+    {
+        qWarning() << "Invalid alternate stream:" << reply->request().url();
+    }
+
+    emit getVideoStreamOk(mStreamDurationMs);
 }
 
 QString M3U8Reader::buildStreamUrl(const QUrl& requestUrl, const QString& stream)
@@ -165,16 +247,67 @@ void M3U8Reader::requestSslFailed(QNetworkReply* reply)
     emit getVideoStreamError();
 }
 
+HlsSegmentLoader::VariantList M3U8Reader::getVariants(int& variantIndex) const
+{
+    static const std::vector<std::pair<StreamResolution, int>> VARIANTS{
+        { STREAM_RESOLUTION_360, 0 },
+        { STREAM_RESOLUTION_720, HD_BANDWIDTH_THRESHOLD_KBPS }
+    };
+
+    HlsSegmentLoader::VariantList variants;
+    variantIndex = 0;
+
+    for (const auto& [resolution, minBandwidthKbps] : VARIANTS)
+    {
+        auto it = mStreamSegments.find(resolution);
+
+        if (it == mStreamSegments.end() || it->second.isEmpty())
+            continue;
+
+        if (resolution == mResolution)
+            variantIndex = variants.size();
+
+        variants.push_back({ minBandwidthKbps, it->second });
+    }
+
+    // Switching is only possible if the segments of the streams are aligned.
+    if (variants.size() > 1 && variants.front().mSegmentUrls.size() != variants.back().mSegmentUrls.size())
+    {
+        qDebug() << "Streams not aligned:" << variants.front().mSegmentUrls.size() << variants.back().mSegmentUrls.size();
+        const auto variant = variants[variantIndex];
+        variants = { variant };
+        variantIndex = 0;
+    }
+
+    return variants;
+}
+
 void M3U8Reader::loadStream(const QString& fileName)
 {
-    if (!mStream)
+    if (mSegmentLoader.isActive())
     {
-        if (mStreamSegments.isEmpty())
-        {
-            qWarning() << "Stream is not yet set";
-            return;
-        }
+        qDebug() << "Stream is already loading";
+        return;
+    }
+
+    if (mStreamLoaded)
+    {
+        qDebug() << "Stream already loaded";
+        emit loadStreamOk(QUrl::fromLocalFile(mStream->fileName()).toString());
+        return;
+    }
+
+    int variantIndex = 0;
+    const auto variants = getVariants(variantIndex);
 
+    if (variants.empty())
+    {
+        qWarning() << "Stream is not yet set";
+        return;
+    }
+
+    if (!mStream)
+    {
         if (fileName.isEmpty())
         {
             mStream = FileUtils::makeTempFile("ts");
@@ -201,75 +334,32 @@ void M3U8Reader::loadStream(const QString& fileName)
         }
     }
 
-    setLoading(true);
-
-    if (mStreamSegments.isEmpty())
-    {
-        qDebug() << "No more segments to load";
-        mStream->close();
-        QUrl url = QUrl::fromLocalFile(mStream->fileName());
-        setLoading(false);
-        emit loadStreamOk(url.toString());
-        return;
-    }
+    // Start from scratch when retrying after a failure.
+    mStream->resize(0);
+    mStream->seek(0);
 
-    QUrl url(mStreamSegments.first());
-    if (!url.isValid())
-    {
-        qWarning() << "Invalid segment URL:" << mStreamSegments.first();
-        setLoading(false);
-        emit loadStreamError();
-        return;
-    }
-
-    mStreamSegments.pop_front();
-    QNetworkRequest request(url);
-    QNetworkReply* reply = mNetwork.get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply]{ loadStream(reply); });
-    connect(reply, &QNetworkReply::errorOccurred, this, [this, reply](auto errCode){ loadStreamFailed(reply, errCode); });
-    connect(reply, &QNetworkReply::sslErrors, this, [this, reply]{ loadStreamSslFailed(reply); });
-}
-
-void M3U8Reader::loadStream(QNetworkReply* reply)
-{
-    if (reply->error() != QNetworkReply::NoError)
-    {
-        loadStreamFailed(reply, reply->error());
-        return;
-    }
-
-    const auto data = reply->readAll();
+    setLoading(true);
 
-    if (mStream->write(data) < 0)
+    if (!mSegmentLoader.start(variants, variantIndex, mStream.get()))
     {
-        qWarning() << "Failed to save stream into tempfile:" << mStream->fileName();
         setLoading(false);
         emit loadStreamError();
-        return;
-    }
-    else
-    {
-        qDebug() << "Saved:" << reply->request().url() << "to:" << mStream->fileName();
-        mStream->flush();
-        loadStream();
     }
 }
 
-void M3U8Reader::loadStreamFailed(QNetworkReply* reply, int errCode)
+void M3U8Reader::loadStreamFinished()
 {
-    mInProgress = nullptr;
-    qDebug() << "Failed to load stream segment:" << reply->request().url();
-    qDebug() << "Error:" << errCode << reply->errorString();
-    qDebug() << reply->readAll();
+    qDebug() << "No more segments to load";
+    mStream->close();
+    mStreamLoaded = true;
+    QUrl url = QUrl::fromLocalFile(mStream->fileName());
     setLoading(false);
-    emit loadStreamError();
+    emit loadStreamOk(url.toString());
 }
 
-void M3U8Reader::loadStreamSslFailed(QNetworkReply* reply)
+void M3U8Reader::loadStreamFailed(const QString& error)
 {
-    mInProgress = nullptr;
-    qDebug() << "SSL error, failed to load stream segment:" << reply->request().url();
+    qDebug() << "Failed to load stream:" << error;
     setLoading(false);
     emit loadStreamError();
 }
@@ -1,6 +1,7 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "hls_segment_loader.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTemporaryFile>
@@ -11,6 +12,9 @@ namespace Skywalker {
 
 // Load Bluesky video stream into a temp file to work around a bug in the
 // Qt live streamer: https://bugreports.qt.io/browse/QTBUG-128908
+//
+// Segments are downloaded concurrently. When both the 360p and 720p streams are
+// available, the stream can switch on the bandwidth measured while loading.
 class M3U8Reader : public QObject
 {
     Q_OBJECT
@@ -47,17 +51,24 @@ private:
     void requestFailed(QNetworkReply* reply, int errCode);
     void requestSslFailed(QNetworkReply* reply);
     static QString buildStreamUrl(const QUrl& requestUrl, const QString& stream);
+    StreamResolution getStreamResolution(const QUrl& streamUrl) const;
+    void getAlternateStream(const QString& link);
+    void extractAlternateStream(QNetworkReply* reply);
+    HlsSegmentLoader::VariantList getVariants(int& variantIndex) const;
 
-    void loadStream(QNetworkReply* reply);
-    void loadStreamFailed(QNetworkReply* reply, int errCode);
-    void loadStreamSslFailed(QNetworkReply* reply);
+    void loadStreamFinished();
+    void loadStreamFailed(const QString& error);
 
     QNetworkAccessManager mNetwork;
     QNetworkReply* mInProgress = nullptr;
     int mLoopCount = 0; // protect against potential loop
     StreamResolution mResolution = STREAM_RESOLUTION_360;
-    QStringList mStreamSegments;
+    std::map<StreamResolution, QString> mStreamUrls;
+    std::map<StreamResolution, QStringList> mStreamSegments;
+    int mStreamDurationMs = 0;
+    HlsSegmentLoader mSegmentLoader;
     std::unique_ptr<QFile> mStream;
+    bool mStreamLoaded = false;
     bool mLoading = false;
 };
 
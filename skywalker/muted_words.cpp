@@ -6,7 +6,8 @@
 namespace Skywalker {
 
 MutedWords::MutedWords(QObject* parent) :
-    QObject(parent)
+    QObject(parent),
+    mMatcher(std::make_shared<Matcher>())
 {
 }
 
@@ -28,8 +29,7 @@ void MutedWords::clear()
         return;
 
     mEntries.clear();
-    mSingleWordIndex.clear();
-    mFirstWordIndex.clear();
+    buildMatcher();
 
     emit entriesChanged();
 }
@@ -73,7 +73,7 @@ bool MutedWords::preAdd(const Entry& entry)
         if (containsEntry(hashtag))
         {
             qDebug() << "Hashtag already muted for:" << entry.mRaw;
-            removeEntry(hashtag);
+            removeEntryInternal(hashtag);
         }
     }
 
@@ -81,34 +81,43 @@ bool MutedWords::preAdd(const Entry& entry)
 }
 
 void MutedWords::addEntry(const QString& word, const QJsonObject& bskyJson, const QStringList& unkwownTargets)
+{
+    if (!addEntryInternal(word, bskyJson, unkwownTargets))
+        return;
+
+    buildMatcher();
+    mDirty = true;
+    emit entriesChanged();
+}
+
+bool MutedWords::addEntryInternal(const QString& word, const QJsonObject& bskyJson, const QStringList& unkwownTargets)
 {
     Entry newEntry(cleanRawWord(word), SearchUtils::getNormalizedWords(word), bskyJson, unkwownTargets);
+    const size_t oldSize = mEntries.size();
 
     if (!preAdd(newEntry))
-        return;
+        return false;
 
-    const auto& [it, inserted] = mEntries.emplace(std::move(newEntry));
+    const auto& [_, inserted] = mEntries.emplace(std::move(newEntry));
 
     if (!inserted)
-    {
         qDebug() << "Already muted:" << word;
-        return;
-    }
 
-    const auto& entry = *it;
+    // preAdd may have removed an entry
+    return inserted || mEntries.size() != oldSize;
+}
 
-    if (entry.isHashtag())
-        addWordToIndex(&entry, mHashTagIndex);
-    else if (entry.mNormalizedWords.size() == 1)
-        addWordToIndex(&entry, mSingleWordIndex);
-    else if (entry.mNormalizedWords.size() > 1)
-        addWordToIndex(&entry, mFirstWordIndex);
+void MutedWords::removeEntry(const QString& word)
+{
+    if (!removeEntryInternal(word))
+        return;
 
+    buildMatcher();
     mDirty = true;
     emit entriesChanged();
 }
 
-void MutedWords::removeEntry(const QString& word)
+bool MutedWords::removeEntryInternal(const QString& word)
 {
     const Entry searchEntry{ word, {}, {}, {} };
     const auto it = mEntries.find(searchEntry);
@@ -116,21 +125,11 @@ void MutedWords::removeEntry(const QString& word)
     if (it == mEntries.end())
     {
         qDebug() << "Entry not found:" << word;
-        return;
+        return false;
     }
 
-    const Entry& entry = *it;
-
-    if (entry.isHashtag())
-        removeWordFromIndex(&entry, mHashTagIndex);
-    else if (entry.mNormalizedWords.size() == 1)
-        removeWordFromIndex(&entry, mSingleWordIndex);
-    else if (entry.mNormalizedWords.size() > 1)
-        removeWordFromIndex(&entry, mFirstWordIndex);
-
     mEntries.erase(it);
-    mDirty = true;
-    emit entriesChanged();
+    return true;
 }
 
 bool MutedWords::containsEntry(const QString& word)
@@ -139,90 +138,51 @@ bool MutedWords::containsEntry(const QString& word)
     return mEntries.count(searchEntry);
 }
 
-void MutedWords::addWordToIndex(const Entry* entry, WordIndexType& wordIndex)
+void MutedWords::buildMatcher()
 {
-    Q_ASSERT(entry);
-    Q_ASSERT(entry->mNormalizedWords.size() > 0);
-    const QString& word = entry->mNormalizedWords[0];
-    wordIndex[word].insert(entry);
+    auto matcher = std::make_shared<Matcher>();
+
+    for (const auto& entry : mEntries)
+    {
+        if (entry.isHashtag())
+            matcher->mHashtags.insert(WordTokenInterner::instance().intern(entry.mNormalizedWords[0]));
+        else
+            matcher->mWordAutomaton.addPattern(entry.mNormalizedWords, entry.mRaw);
+    }
+
+    matcher->mWordAutomaton.build();
+    mMatcher = std::move(matcher);
+    ++mVersion;
 }
 
-void MutedWords::removeWordFromIndex(const Entry* entry, WordIndexType& wordIndex)
+bool MutedWords::match(const NormalizedWordIndex& post) const
 {
-    Q_ASSERT(entry);
-    Q_ASSERT(entry->mNormalizedWords.size() > 0);
-    const QString& word = entry->mNormalizedWords[0];
-    auto& indexEntry = wordIndex[word];
-    indexEntry.erase(entry);
-
-    if (indexEntry.empty())
-        wordIndex.erase(word);
+    return mMatcher->match(post);
 }
 
-bool MutedWords::match(const NormalizedWordIndex& post) const
+bool MutedWords::Matcher::match(const NormalizedWordIndex& post) const
 {
-    if (mEntries.empty())
+    if (mHashtags.empty() && mWordAutomaton.empty())
         return false;
 
-    const auto& postHashtags = post.getUniqueHashtags();
-
-    for (const auto& [word, _] : mHashTagIndex)
-    {
-        if (postHashtags.count(word))
-        {
-            qDebug() << "Match on hashtag:" << word;
-            return true;
-        }
-    }
-
-    const auto& uniquePostWords = post.getUniqueNormalizedWords();
-
-    for (const auto& [word, _] : mSingleWordIndex)
+    if (!mHashtags.empty())
     {
-        if (uniquePostWords.count(word))
+        for (const WordToken hashtag : post.getUniqueHashtags())
         {
-            qDebug() << "Match on single word entry:" << word;
-            return true;
+            if (mHashtags.count(hashtag))
+            {
+                qDebug() << "Match on hashtag:" << WordTokenInterner::instance().getWord(hashtag);
+                return true;
+            }
         }
     }
 
-    const auto& postWords = post.getNormalizedWords();
+    const QString* matchedEntry = mWordAutomaton.match(post.getNormalizedWords());
 
-    for (const auto& [word, entries] : mFirstWordIndex)
+    if (matchedEntry)
     {
-        const auto uniqueWordIt = uniquePostWords.find(word);
-
-        if (uniqueWordIt == uniquePostWords.end())
-            continue;
-
-        qDebug() << "Matching first word:" << word;
-
-        for (const Entry* mutedEntry : entries)
-        {
-            Q_ASSERT(mutedEntry);
-            qDebug() << "Multi-word entry:" << mutedEntry->mRaw;
-
-            for (int postWordIndex : uniqueWordIt->second)
-            {
-                int matchedWords = 0;
-
-                for (int i = 0, j = postWordIndex;
-                     i < (int)mutedEntry->mNormalizedWords.size() && j < (int)postWords.size();
-                     ++i, ++j)
-                {
-                    if (mutedEntry->mNormalizedWords[i] != postWords[j])
-                        break;
-
-                    ++matchedWords;
-                }
-
-                if (matchedWords == (int)mutedEntry->mNormalizedWords.size())
-                {
-                    qDebug() << "Match on multi-word entry:" << mutedEntry->mRaw;
-                    return true;
-                }
-            }
-        }
+        qDebug() << "Match on entry:" << *matchedEntry;
+        return true;
     }
 
     return false;
@@ -250,10 +210,12 @@ bool MutedWords::legacyLoad(const UserSettings* userSettings)
     }
 
     for (const auto& word : mutedWords)
-        addEntry(word);
+        addEntryInternal(word, {}, {});
 
+    buildMatcher();
     qDebug() << "Muted words loaded from local app settings:" << mEntries.size();
     mDirty = true;
+    emit entriesChanged();
     return true;
 }
 
@@ -286,14 +248,18 @@ void MutedWords::load(const ATProto::UserPreferences& userPrefs)
         }
 
         if  (matchTag && !matchContent)
-            addEntry(QString("#%1").arg(mutedWord.mValue), mutedWord.mJson, unknownTargets);
+            addEntryInternal(QString("#%1").arg(mutedWord.mValue), mutedWord.mJson, unknownTargets);
         else
-            addEntry(mutedWord.mValue, mutedWord.mJson, unknownTargets);
+            addEntryInternal(mutedWord.mValue, mutedWord.mJson, unknownTargets);
 
     }
 
+    buildMatcher();
     qDebug() << "Muted words loaded:" << mEntries.size();
     mDirty = false;
+
+    if (!mEntries.empty())
+        emit entriesChanged();
 }
 
 static ATProto::AppBskyActor::MutedWord::Target makeTarget(
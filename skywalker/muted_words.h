@@ -4,10 +4,11 @@
 #include "user_settings.h"
 #include "normalized_word_index.h"
 #include "unicode_fonts.h"
+#include "word_automaton.h"
 #include <atproto/lib/user_preferences.h>
 #include <QObject>
 #include <QString>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <set>
 
@@ -20,7 +21,26 @@ class MutedWords : public QObject, public IMatchWords
     Q_PROPERTY(int maxSize MEMBER MAX_ENTRIES CONSTANT FINAL)
 
 public:
-    static constexpr size_t MAX_ENTRIES = 100;
+    static constexpr size_t MAX_ENTRIES = 1000;
+
+    // Matcher built from the entries. A new matcher is built when the entries
+    // change, so a matcher never changes and can be used from any thread.
+    class Matcher : public IMatchWords
+    {
+    public:
+        using SharedPtr = std::shared_ptr<const Matcher>;
+
+        bool match(const NormalizedWordIndex& post) const override;
+
+    private:
+        friend class MutedWords;
+
+        // Normalized hashtags (without #)
+        std::unordered_set<WordToken> mHashtags;
+
+        // Single word and multi-word entries
+        WordAutomaton mWordAutomaton;
+    };
 
     explicit MutedWords(QObject* parent = nullptr);
 
@@ -36,6 +56,8 @@ public:
     bool isDirty() const { return mDirty; }
 
     bool match(const NormalizedWordIndex& post) const override;
+    const Matcher::SharedPtr& getMatcher() const { return mMatcher; }
+    quint64 getVersion() const override { return mVersion; }
 
 signals:
     void entriesChanged();
@@ -64,21 +86,17 @@ private:
         bool isHashtag() const { return wordCount() == 1 && UnicodeFonts::isHashtag(mRaw); }
     };
 
-    using WordIndexType = std::unordered_map<QString, std::set<const Entry*>>;
-
-    void addWordToIndex(const Entry* entry, WordIndexType& wordIndex);
-    void removeWordFromIndex(const Entry* entry, WordIndexType& wordIndex);
     bool preAdd(const Entry& entry);
+    // These return true if the entries changed.
+    bool addEntryInternal(const QString& word, const QJsonObject& bskyJson, const QStringList& unkwownTargets);
+    bool removeEntryInternal(const QString& word);
 
-    std::set<Entry> mEntries;
-
-    // Normalized word (from single word entries) -> index
-    WordIndexType mSingleWordIndex;
-
-    // Normalized first word (from multi-word entries) -> index
-    WordIndexType mFirstWordIndex;
+    // Build the matcher from the entries. Must be called after changing the entries.
+    void buildMatcher();
 
-    WordIndexType mHashTagIndex;
+    std::set<Entry> mEntries;
+    Matcher::SharedPtr mMatcher;
+    quint64 mVersion = 0;
 
     bool mDirty = false;
 };
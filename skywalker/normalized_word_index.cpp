@@ -2,47 +2,102 @@
 // License: GPLv3
 #include "normalized_word_index.h"
 #include "search_utils.h"
+#include "word_index_cache.h"
+#include <algorithm>
 
 namespace Skywalker {
 
-const std::unordered_set<QString>& NormalizedWordIndex::getUniqueHashtags() const
+static std::vector<WordToken> makeSortedSet(std::vector<WordToken> tokens)
 {
-    if (mHashtags.empty())
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    tokens.shrink_to_fit();
+    return tokens;
+}
+
+NormalizedWordIndex::Indices::SharedPtr NormalizedWordIndex::createIndices() const
+{
+    auto& interner = WordTokenInterner::instance();
+    auto indices = std::make_shared<Indices>();
+
+    // Take the generation first. If the tokens get reset while interning, the
+    // indices are outdated right away and will be rebuilt.
+    indices->mTokenGeneration = interner.getGeneration();
+
+    indices->mNormalizedWords = interner.intern(SearchUtils::getNormalizedWords(getText()));
+    indices->mUniqueNormalizedWords = makeSortedSet(indices->mNormalizedWords);
+
+    const auto& hashtagList = getHashtags();
+    std::vector<QString> normalizedTags;
+    normalizedTags.reserve(hashtagList.size());
+
+    for (const auto& tag : hashtagList)
+        normalizedTags.push_back(SearchUtils::normalizeText(tag));
+
+    indices->mHashtagsInTextOrder = interner.intern(normalizedTags);
+    indices->mHashtags = makeSortedSet(indices->mHashtagsInTextOrder);
+    return indices;
+}
+
+const NormalizedWordIndex::Indices& NormalizedWordIndex::getIndices() const
+{
+    const quint32 generation = WordTokenInterner::instance().getGeneration();
+
+    if (!mIndices || mIndices->mTokenGeneration != generation)
     {
-        const auto& hashtagList = getHashtags();
+        const QString key = getIndexKey();
+        auto& cache = WordIndexCache::instance();
+        Indices::SharedPtr indices = key.isEmpty() ? nullptr : cache.get(key);
 
-        for (const auto& tag : hashtagList)
+        if (!indices || indices->mTokenGeneration != generation)
         {
-            const auto normalizedTag = SearchUtils::normalizeText(tag);
-            const_cast<NormalizedWordIndex*>(this)->mHashtags.insert(normalizedTag);
+            indices = createIndices();
+
+            if (!key.isEmpty())
+                cache.put(key, indices);
         }
+
+        const_cast<NormalizedWordIndex*>(this)->mIndices = std::move(indices);
     }
 
-    return mHashtags;
+    return *mIndices;
+}
+
+const std::vector<WordToken>& NormalizedWordIndex::getNormalizedWords() const
+{
+    return getIndices().mNormalizedWords;
 }
 
-const std::vector<QString>& NormalizedWordIndex::getNormalizedWords() const
+const std::vector<WordToken>& NormalizedWordIndex::getUniqueNormalizedWords() const
 {
-    if (mNormalizedWords.empty())
-        const_cast<NormalizedWordIndex*>(this)->mNormalizedWords = SearchUtils::getNormalizedWords(getText());
+    return getIndices().mUniqueNormalizedWords;
+}
 
-    return mNormalizedWords;
+const std::vector<WordToken>& NormalizedWordIndex::getUniqueHashtags() const
+{
+    return getIndices().mHashtags;
 }
 
-const std::unordered_map<QString, std::vector<int>>& NormalizedWordIndex::getUniqueNormalizedWords() const
+const std::vector<WordToken>& NormalizedWordIndex::getHashtagsInTextOrder() const
 {
-    if (mUniqueNormalizedWords.empty())
-    {
-        const auto& normalizedWords = getNormalizedWords();
+    return getIndices().mHashtagsInTextOrder;
+}
 
-        for (int i = 0; i < (int)normalizedWords.size(); ++i)
-        {
-            const QString& word = normalizedWords[i];
-            const_cast<NormalizedWordIndex*>(this)->mUniqueNormalizedWords[word].push_back(i);
-        }
-    }
+bool NormalizedWordIndex::containsNormalizedWord(WordToken word) const
+{
+    const auto& words = getUniqueNormalizedWords();
+    return std::binary_search(words.begin(), words.end(), word);
+}
 
-    return mUniqueNormalizedWords;
+bool NormalizedWordIndex::containsHashtag(WordToken hashtag) const
+{
+    const auto& hashtags = getUniqueHashtags();
+    return std::binary_search(hashtags.begin(), hashtags.end(), hashtag);
+}
+
+void NormalizedWordIndex::buildIndices() const
+{
+    getIndices();
 }
 
 }
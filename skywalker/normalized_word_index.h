@@ -1,8 +1,10 @@
 // Copyright (C) 2023 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "word_token.h"
 #include <QHashFunctions>
 #include <QString>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -12,20 +14,51 @@ namespace Skywalker {
 class NormalizedWordIndex
 {
 public:
+    struct Indices
+    {
+        using SharedPtr = std::shared_ptr<const Indices>;
+
+        std::vector<WordToken> mNormalizedWords;
+        std::vector<WordToken> mUniqueNormalizedWords;
+        std::vector<WordToken> mHashtags;
+        std::vector<WordToken> mHashtagsInTextOrder;
+        quint32 mTokenGeneration = 0;
+    };
+
     virtual ~NormalizedWordIndex() = default;
     virtual QString getText() const = 0;
     virtual std::vector<QString> getHashtags() const = 0;
 
-    const std::unordered_set<QString>& getUniqueHashtags() const;
-    const std::vector<QString>& getNormalizedWords() const;
-    const std::unordered_map<QString, std::vector<int>>& getUniqueNormalizedWords() const;
+    // Objects with the same key have the same text and hashtags, e.g. the CID of
+    // a post. Their indices are shared through the word index cache.
+    // Empty if the indices cannot be shared.
+    virtual QString getIndexKey() const { return {}; }
+
+    // Normalized words in order of the text
+    const std::vector<WordToken>& getNormalizedWords() const;
+
+    // Sorted sets of normalized words and hashtags
+    const std::vector<WordToken>& getUniqueNormalizedWords() const;
+    const std::vector<WordToken>& getUniqueHashtags() const;
+
+    // Normalized hashtags in order of the text
+    const std::vector<WordToken>& getHashtagsInTextOrder() const;
+
+    bool containsNormalizedWord(WordToken word) const;
+    bool containsHashtag(WordToken hashtag) const;
+
+    // Build the lazily created word and hashtag indices. After this the getters
+    // above do not modify the object anymore, until the word tokens get reset on
+    // sign out. Building the indices only depends on the text, so indices of
+    // different objects can be built in parallel.
+    void buildIndices() const;
 
 private:
-    std::unordered_set<QString> mHashtags; // normalized
-    std::vector<QString> mNormalizedWords;
+    const Indices& getIndices() const;
+    Indices::SharedPtr createIndices() const;
 
-    // normalized word -> indices into mNormalizedWords
-    std::unordered_map<QString, std::vector<int>> mUniqueNormalizedWords;
+    // The indices are immutable once built, so copies share them.
+    Indices::SharedPtr mIndices;
 };
 
 class IMatchWords
@@ -33,6 +66,10 @@ class IMatchWords
 public:
     virtual ~IMatchWords() = default;
     virtual bool match(const NormalizedWordIndex& post) const = 0;
+
+    // The version changes when the words to match change. A matcher that cannot
+    // change always has version 0.
+    virtual quint64 getVersion() const { return 0; }
 };
 
 }
@@ -951,82 +951,82 @@ void NotificationListModel::postIndexedSecondsAgoChanged()
     changeData({ int(Role::NotificationSecondsAgo) });
 }
 
-void NotificationListModel::likeCountChanged()
+void NotificationListModel::likeCountChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostLikeCount) });
 }
 
-void NotificationListModel::likeUriChanged()
+void NotificationListModel::likeUriChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostLikeUri) });
 }
 
-void NotificationListModel::likeTransientChanged()
+void NotificationListModel::likeTransientChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostLikeTransient) });
 }
 
-void NotificationListModel::replyCountChanged()
+void NotificationListModel::replyCountChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostReplyCount) });
 }
 
-void NotificationListModel::repostCountChanged()
+void NotificationListModel::repostCountChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostRepostCount) });
 }
 
-void NotificationListModel::quoteCountChanged()
+void NotificationListModel::quoteCountChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostQuoteCount) });
 }
 
-void NotificationListModel::repostUriChanged()
+void NotificationListModel::repostUriChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostRepostUri) });
 }
 
-void NotificationListModel::threadgateUriChanged()
+void NotificationListModel::threadgateUriChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostThreadgateUri) });
 }
 
-void NotificationListModel::replyRestrictionChanged()
+void NotificationListModel::replyRestrictionChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostReplyRestriction) });
 }
 
-void NotificationListModel::replyRestrictionListsChanged()
+void NotificationListModel::replyRestrictionListsChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostReplyRestrictionLists) });
 }
 
-void NotificationListModel::hiddenRepliesChanged()
+void NotificationListModel::hiddenRepliesChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostHiddenReplies), int(Role::NotificationPostIsHiddenReply) });
 }
 
-void NotificationListModel::threadMutedChanged()
+void NotificationListModel::threadMutedChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostThreadMuted) });
 }
 
-void NotificationListModel::detachedRecordChanged()
+void NotificationListModel::detachedRecordChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostRecord), int(Role::NotificationPostRecordWithMedia) });
 }
 
-void NotificationListModel::reAttachedRecordChanged()
+void NotificationListModel::reAttachedRecordChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostRecord), int(Role::NotificationPostRecordWithMedia) });
 }
 
-void NotificationListModel::viewerStatePinnedChanged()
+void NotificationListModel::viewerStatePinnedChanged(const QString&)
 {
     changeData({ int(Role::NotificationPostViewerStatePinned) });
 }
 
-void NotificationListModel::postDeletedChanged()
+void NotificationListModel::postDeletedChanged(const QString&)
 {
     changeData({ int(Role::NotificationReasonPostLocallyDeleted) });
 }
@@ -131,22 +131,22 @@ signals:
 
 protected:
     virtual void postIndexedSecondsAgoChanged() override;
-    virtual void likeCountChanged() override;
-    virtual void likeUriChanged() override;
-    virtual void likeTransientChanged() override;
-    virtual void replyCountChanged() override;
-    virtual void repostCountChanged() override;
-    virtual void quoteCountChanged() override;
-    virtual void repostUriChanged() override;
-    virtual void threadgateUriChanged() override;
-    virtual void replyRestrictionChanged() override;
-    virtual void replyRestrictionListsChanged() override;
-    virtual void hiddenRepliesChanged() override;
-    virtual void threadMutedChanged() override;
-    virtual void detachedRecordChanged() override;
-    virtual void reAttachedRecordChanged() override;
-    virtual void viewerStatePinnedChanged() override;
-    virtual void postDeletedChanged() override;
+    virtual void likeCountChanged(const QString&) override;
+    virtual void likeUriChanged(const QString&) override;
+    virtual void likeTransientChanged(const QString&) override;
+    virtual void replyCountChanged(const QString&) override;
+    virtual void repostCountChanged(const QString&) override;
+    virtual void quoteCountChanged(const QString&) override;
+    virtual void repostUriChanged(const QString&) override;
+    virtual void threadgateUriChanged(const QString&) override;
+    virtual void replyRestrictionChanged(const QString&) override;
+    virtual void replyRestrictionListsChanged(const QString&) override;
+    virtual void hiddenRepliesChanged(const QString&) override;
+    virtual void threadMutedChanged(const QString&) override;
+    virtual void detachedRecordChanged(const QString&) override;
+    virtual void reAttachedRecordChanged(const QString&) override;
+    virtual void viewerStatePinnedChanged(const QString&) override;
+    virtual void postDeletedChanged(const QString&) override;
 
     QHash<int, QByteArray> roleNames() const override;
 
@@ -15,6 +15,7 @@
 #include <QImage>
 #include <QImageReader>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 #ifdef Q_OS_ANDROID
 #include <QJniObject>
@@ -22,12 +23,58 @@
 #include <QtCore/private/qandroidextras_p.h>
 #endif
 
-namespace {
-constexpr int MAX_IMAGE_PIXEL_SIZE = 2000;
+namespace Skywalker::PhotoPicker {
+
+QSize scaledDownSize(QSize size, int maxPixelSize)
+{
+    if (maxPixelSize <= 0 || !size.isValid() || std::max(size.width(), size.height()) <= maxPixelSize)
+        return size;
+
+    return size.scaled(maxPixelSize, maxPixelSize, Qt::KeepAspectRatio);
+}
+
+QImage readImage(QImageReader& reader, int maxPixelSize)
+{
+    reader.setAutoTransform(true);
+
+    // The size is read from the header. Scaling is done before the EXIF
+    // transformation, the aspect ratio is not affected by a rotation.
+    const QSize size = reader.size();
+    const QSize scaledSize = scaledDownSize(size, maxPixelSize);
+
+    if (scaledSize != size)
+    {
+        qDebug() << "Scale down on decode:" << size << "->" << scaledSize;
+        reader.setScaledSize(scaledSize);
+    }
+
+    return reader.read();
+}
+
+void readImageAsync(const QByteArray& data, int maxPixelSize, QObject* context,
+                    const std::function<void(QImage img, QString error)>& cb)
+{
+    Q_ASSERT(context);
+    Q_ASSERT(cb);
+    using Result = std::tuple<QImage, QString>;
+    auto* watcher = new QFutureWatcher<Result>(context);
+
+    QObject::connect(watcher, &QFutureWatcher<Result>::finished, context, [watcher, cb]{
+        const auto [img, error] = watcher->result();
+        watcher->deleteLater();
+        cb(img, error);
+    });
+
+    watcher->setFuture(QtConcurrent::run([data, maxPixelSize]{
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        const QImage img = readImage(reader, maxPixelSize);
+        return Result{ img, img.isNull() ? reader.errorString() : QString() };
+    }));
 }
 
-namespace Skywalker::PhotoPicker {
-;
 std::tuple<QImage, QString, QString> readImageFd(int fd)
 {
     QString gifTempFileName;
@@ -49,8 +96,7 @@ std::tuple<QImage, QString, QString> readImageFd(int fd)
 
     QImageReader reader(&file);
     qDebug() << "Input image format:" << reader.format();
-    reader.setAutoTransform(true);
-    QImage img = reader.read();
+    QImage img = readImage(reader);
 
     if (img.isNull())
     {
@@ -91,7 +137,7 @@ bool pickPhoto(bool pickVideo)
     return true;
 }
 
-QImage loadImage(const QString& imgName)
+QImage loadImage(const QString& imgName, int maxPixelSize)
 {
     qDebug() << "Load image:" << imgName;
 
@@ -106,8 +152,7 @@ QImage loadImage(const QString& imgName)
         }
 
         QImageReader reader(fileName);
-        reader.setAutoTransform(true);
-        QImage img = reader.read();
+        QImage img = readImage(reader, maxPixelSize);
 
         if (img.isNull())
             qWarning() << "Failed to read:" << fileName;
@@ -124,6 +169,11 @@ QImage loadImage(const QString& imgName)
     {
         auto* imgProvider = ATProtoImageProvider::getProvider(ATProtoImageProvider::DRAFT_IMAGE);
         auto img = imgProvider->getImage(imgName);
+
+        // Draft images must be pinned while they are in use.
+        if (img.isNull())
+            qWarning() << "Draft image not in cache:" << imgName;
+
         return img;
     }
 
@@ -133,7 +183,7 @@ QImage loadImage(const QString& imgName)
 
 QImage cutRect(const QString& imgName, const QRect& rect)
 {
-    QImage img = loadImage(imgName);
+    QImage img = loadImage(imgName, 0);
 
     if (img.isNull())
         return {};
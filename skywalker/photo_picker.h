@@ -2,17 +2,38 @@
 // License: GPLv3
 #pragma once
 #include <QImage>
+#include <QImageReader>
+#include <QObject>
 #include <QString>
 #include <tuple>
 
 namespace Skywalker::PhotoPicker {
 
+constexpr int MAX_IMAGE_PIXEL_SIZE = 2000;
+
+// Size after scaling down such that width and height are at most maxPixelSize.
+QSize scaledDownSize(QSize size, int maxPixelSize);
+
+// Reads an image that is scaled down to maxPixelSize while decoding, such that the
+// full size image does not get allocated. For JPEG the decoder itself produces a
+// smaller image. maxPixelSize = 0 means no scaling.
+// The image will be rotated according to EXIF meta data.
+QImage readImage(QImageReader& reader, int maxPixelSize = MAX_IMAGE_PIXEL_SIZE);
+
+// Decodes image data on the global thread pool. The callback is called on the thread
+// of the context object, unless the context gets deleted before.
+void readImageAsync(const QByteArray& data, int maxPixelSize, QObject* context,
+                    const std::function<void(QImage img, QString error)>& cb);
+
+// Large images are scaled down to MAX_IMAGE_PIXEL_SIZE while decoding.
 std::tuple<QImage, QString /* gif temp file name */, QString /* error */> readImageFd(int fd);
 
 // Start photo pick selector on Android.
 bool pickPhoto(bool pickVideo = false);
 
-QImage loadImage(const QString& imgName);
+// Images from file:// are scaled down to maxPixelSize while decoding.
+// maxPixelSize <= 0 means no scaling.
+QImage loadImage(const QString& imgName, int maxPixelSize = MAX_IMAGE_PIXEL_SIZE);
 
 // Create a binary blob (image/*) for uploading an image.
 // { mimetype, image size } is returned
@@ -23,6 +44,7 @@ QImage loadImage(const QString& imgName);
 std::tuple<QString, QSize> createBlob(QByteArray& blob, const QString& imgName);
 std::tuple<QString, QSize> createBlob(QByteArray& blob, QImage img, const QString& fileName = "");
 
+// The rect is in the coordinates of the full size image.
 QImage cutRect(const QString& imgName, const QRect& rect);
 
 void savePhoto(const QString& sourceUrl, bool cache,
@@ -4,6 +4,7 @@
 #include "post_utils.h"
 #include "author_cache.h"
 #include "content_filter.h"
+#include "post_record_store.h"
 #include "unicode_fonts.h"
 #include "user_settings.h"
 #include "lexicon/lexicon.h"
@@ -108,6 +109,7 @@ Post::Post(const ATProto::AppBskyFeed::FeedViewPost::SharedPtr feedViewPost) :
 {
     if (feedViewPost)
     {
+        PostRecordStore::instance().intern(*feedViewPost->mPost);
         mPost = feedViewPost->mPost;
 
         // Cache authors to minimize network requests for authors later.
@@ -131,6 +133,7 @@ Post::Post(const ATProto::AppBskyFeed::PostView::SharedPtr postView) :
     mPost(postView)
 {
     Q_ASSERT(postView);
+    PostRecordStore::instance().intern(*postView);
     const BasicProfile profile = getAuthor();
 
     if (!profile.isNull())
@@ -34,6 +34,7 @@ public:
     explicit Post(const ATProto::AppBskyFeed::PostView::SharedPtr postView);
 
     const ATProto::AppBskyFeed::PostView* getPostView() const { return mPost.get(); }
+    const ATProto::AppBskyFeed::FeedViewPost::SharedPtr& getFeedViewPost() const { return mFeedViewPost; }
     bool isPlaceHolder() const { return !mPost; }
     bool isGap() const { return !mPost && mGapId > 0; }
     bool isEndOfFeed() const { return mEndOfFeed; }
@@ -51,6 +52,7 @@ public:
     void setReplyRefTimestamp(const QDateTime& timestamp) { mReplyRefTimestamp = timestamp; }
 
     QString getText() const override;
+    QString getIndexKey() const override { return getCid(); }
     QString getFormattedText(const std::set<QString>& emphasizeHashtags = {}) const;
     BasicProfile getAuthor() const;
     QDateTime getIndexedAt() const;
@@ -4,36 +4,95 @@
 
 namespace Skywalker {
 
-PostCache::Entry::Entry(const Post& post) :
-    mPost(post)
+// Rough estimate of the memory used by a post view with author, record,
+// embeds and labels, apart from its text.
+static constexpr qint64 POST_BASE_BYTES = 2048;
+static constexpr qint64 IMAGE_BYTES = 512;
+
+PostCache::PostCache(qint64 maxBytes) :
+    mMaxBytes(maxBytes)
 {
+    Q_ASSERT(mMaxBytes > 0);
 }
 
-PostCache::PostCache() :
-    mCache(500)
-{}
+qint64 PostCache::estimateBytes(const Post& post)
+{
+    return POST_BASE_BYTES +
+           (post.getUri().size() + post.getText().size()) * (qint64)sizeof(QChar) +
+           post.getImages().size() * IMAGE_BYTES;
+}
 
 void PostCache::clear()
 {
-    mCache.clear();
+    if (!mIndex.empty())
+        logStats();
+
+    mIndex.clear();
+    mLru.clear();
+    mBytes = 0;
+}
+
+void PostCache::touch(LruList::iterator it) const
+{
+    mLru.splice(mLru.begin(), mLru, it);
+}
+
+void PostCache::evict()
+{
+    Q_ASSERT(!mLru.empty());
+    const Entry& entry = mLru.back();
+    mBytes -= entry.mBytes;
+    mIndex.erase(entry.mUri);
+    mLru.pop_back();
+    ++mEvictions;
 }
 
 void PostCache::put(const Post& post)
 {
-    auto* entry = new Entry(post);
-    mCache.insert(post.getUri(), entry);
-    qDebug() << "Cached:" << post.getUri() << "size:" << mCache.size();
+    const QString& uri = post.getUri();
+    const qint64 bytes = estimateBytes(post);
+    auto indexIt = mIndex.find(uri);
+
+    if (indexIt != mIndex.end())
+    {
+        auto it = indexIt->second;
+        mBytes += bytes - it->mBytes;
+        it->mPost = post;
+        it->mBytes = bytes;
+        touch(it);
+    }
+    else
+    {
+        mLru.push_front(Entry{ uri, post, bytes });
+        mIndex[uri] = mLru.begin();
+        mBytes += bytes;
+    }
+
+    // Always keep the post just added
+    while (mBytes > mMaxBytes && mLru.size() > 1)
+        evict();
+
+    qDebug() << "Cached:" << uri << "size:" << mIndex.size() << "bytes:" << mBytes;
 }
 
 const Post* PostCache::get(const QString& uri) const
 {
-    auto* entry = mCache[uri];
-    return entry ? &entry->getPost() : nullptr;
+    const auto indexIt = mIndex.find(uri);
+
+    if (indexIt == mIndex.end())
+    {
+        ++mMisses;
+        return nullptr;
+    }
+
+    ++mHits;
+    touch(indexIt->second);
+    return &indexIt->second->mPost;
 }
 
 bool PostCache::contains(const QString& uri) const
 {
-    return mCache.contains(uri);
+    return mIndex.contains(uri);
 }
 
 std::vector<QString> PostCache::getNonCachedUris(const std::vector<QString>& uris) const
@@ -42,11 +101,27 @@ std::vector<QString> PostCache::getNonCachedUris(const std::vector<QString>& uri
 
     for (const auto& uri : uris)
     {
-        if (!contains(uri))
+        const auto indexIt = mIndex.find(uri);
+
+        if (indexIt == mIndex.end())
+        {
+            ++mMisses;
             nonCached.push_back(uri);
+        }
+        else
+        {
+            ++mHits;
+            touch(indexIt->second);
+        }
     }
 
     return nonCached;
 }
 
+void PostCache::logStats() const
+{
+    qDebug() << "Post cache, size:" << mIndex.size() << "bytes:" << mBytes << "hits:" << mHits
+             << "misses:" << mMisses << "evictions:" << mEvictions;
+}
+
 }
@@ -2,36 +2,57 @@
 // License: GPLv3
 #pragma once
 #include "post.h"
-#include <QCache>
-#include <QObject>
+#include <list>
+#include <unordered_map>
 
 namespace Skywalker {
 
+// LRU cache of posts keyed by at-uri. The cache size is bounded by an estimate of
+// the memory used by the cached posts.
 class PostCache
 {
 public:
-    class Entry : public QObject
-    {
-    public:
-        Entry() = default;
-        explicit Entry(const Post& post);
-
-        const Post& getPost() const { return mPost; }
+    static constexpr qint64 MAX_BYTES = 8 * 1024 * 1024;
 
-    private:
-        Post mPost;
-    };
-
-    PostCache();
+    explicit PostCache(qint64 maxBytes = MAX_BYTES);
 
     void clear();
     void put(const Post& post);
+
+    // The returned post stays valid till it gets evicted by a put.
     const Post* get(const QString& uri) const;
     bool contains(const QString& uri) const;
     std::vector<QString> getNonCachedUris(const std::vector<QString>& uris) const;
 
+    size_t size() const { return mIndex.size(); }
+    qint64 getBytes() const { return mBytes; }
+    qint64 getHits() const { return mHits; }
+    qint64 getMisses() const { return mMisses; }
+    qint64 getEvictions() const { return mEvictions; }
+    void logStats() const;
+
+    static qint64 estimateBytes(const Post& post);
+
 private:
-    QCache<QString, Entry> mCache; // key is at-uri
+    struct Entry
+    {
+        QString mUri;
+        Post mPost;
+        qint64 mBytes = 0;
+    };
+
+    using LruList = std::list<Entry>; // front is most recently used
+
+    void touch(LruList::iterator it) const;
+    void evict();
+
+    const qint64 mMaxBytes;
+    mutable LruList mLru;
+    std::unordered_map<QString, LruList::iterator> mIndex; // key is at-uri
+    qint64 mBytes = 0;
+    mutable qint64 mHits = 0;
+    mutable qint64 mMisses = 0;
+    qint64 mEvictions = 0;
 };
 
 }
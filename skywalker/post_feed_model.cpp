@@ -3,6 +3,9 @@
 #include "post_feed_model.h"
 #include "definitions.h"
 #include "user_settings.h"
+#include "utils.h"
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <algorithm>
 #include <ranges>
 
@@ -83,22 +86,132 @@ int PostFeedModel::prependFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& fee
         return 0;
     }
 
-    const int gapId = insertFeed(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed), 0);
-    return gapId;
+    auto page = createPage(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed));
+    return insertFeed(std::move(page), 0);
 }
 
 int PostFeedModel::gapFillFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int gapId)
+{
+    auto page = createPage(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed));
+    return gapFillPage(std::move(page), gapId);
+}
+
+void PostFeedModel::setFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedAddedCb& feedAddedCb)
+{
+    prepareFeedAsync(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed),
+        [this, feedAddedCb](PreparedFeed::SharedPtr preparedFeed){
+            if (preparedFeed)
+            {
+                // Clear before creating the page, otherwise the posts that are
+                // in the feed now would be filtered from the page.
+                clear();
+                addPage(createPage(*preparedFeed));
+            }
+
+            feedAddedCb();
+        });
+}
+
+void PostFeedModel::addFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedAddedCb& feedAddedCb)
+{
+    qDebug() << "Add raw posts async:" << feed->mFeed.size();
+    prepareFeedAsync(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed),
+        [this, feedAddedCb](PreparedFeed::SharedPtr preparedFeed){
+            if (preparedFeed)
+                addPage(createPage(*preparedFeed));
+
+            feedAddedCb();
+        });
+}
+
+void PostFeedModel::prependFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const GapCb& gapCb)
+{
+    if (feed->mFeed.empty())
+    {
+        gapCb(0);
+        return;
+    }
+
+    prepareFeedAsync(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed),
+        [this, gapCb](PreparedFeed::SharedPtr preparedFeed){
+            int gapId = 0;
+
+            if (preparedFeed)
+            {
+                if (mFeed.empty())
+                {
+                    clear();
+                    addPage(createPage(*preparedFeed));
+                }
+                else
+                {
+                    gapId = insertFeed(createPage(*preparedFeed), 0);
+                }
+            }
+
+            gapCb(gapId);
+        });
+}
+
+void PostFeedModel::gapFillFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int gapId, const GapCb& gapCb)
+{
+    prepareFeedAsync(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed),
+        [this, gapId, gapCb](PreparedFeed::SharedPtr preparedFeed){
+            int newGapId = 0;
+
+            if (preparedFeed)
+                newGapId = gapFillPage(createPage(*preparedFeed), gapId);
+
+            gapCb(newGapId);
+        });
+}
+
+void PostFeedModel::prepareFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedPreparedCb& feedPreparedCb)
+{
+    const auto snapshot = mFilterSnapshots ? mFilterSnapshots->getSnapshot() : nullptr;
+
+    if (!snapshot)
+    {
+        feedPreparedCb(prepareFeed(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed), makePageFilter()));
+        return;
+    }
+
+    auto* watcher = new QFutureWatcher<PreparedFeed::SharedPtr>(this);
+
+    connect(watcher, &QFutureWatcher<PreparedFeed::SharedPtr>::finished, this,
+        [this, watcher, generation=mFeedGeneration, feedPreparedCb]{
+            auto preparedFeed = watcher->result();
+            watcher->deleteLater();
+
+            if (generation != mFeedGeneration)
+            {
+                qDebug() << "Feed cleared, drop prepared page";
+                preparedFeed = nullptr;
+            }
+
+            feedPreparedCb(std::move(preparedFeed));
+        });
+
+    watcher->setFuture(QtConcurrent::run(
+        [feed=std::move(feed), filter=makePageFilter(snapshot)]{
+            return prepareFeed(feed, filter);
+        }));
+}
+
+int PostFeedModel::gapFillPage(Page::Ptr page, int gapId)
 {
     qDebug() << "Fill gap:" << gapId;
 
-    if (!mGapIdIndexMap.count(gapId))
+    const auto gapRow = findGapIndex(gapId);
+
+    if (!gapRow)
     {
         qWarning() << "Gap does not exist:" << gapId;
         return 0;
     }
 
-    const int gapIndex = mGapIdIndexMap[gapId];
-    mGapIdIndexMap.erase(gapId);
+    const int gapIndex = (int)*gapRow;
+    mIndexGapIdMap.erase(*gapRow);
 
     if (gapIndex > (int)mFeed.size() - 1)
     {
@@ -117,19 +230,22 @@ int PostFeedModel::gapFillFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& fee
     qDebug() << "Removed place holder post:" << gapIndex;
     logIndices();
 
-    return insertFeed(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed), gapIndex, gapId);
+    return insertFeed(std::move(page), gapIndex, gapId);
 }
 
 void PostFeedModel::insertPage(const TimelineFeed::iterator& feedInsertIt, const Page& page, int pageSize, int fillGapId)
 {
-    if (fillGapId > 0)
-        gapFillFilteredPostModels(page, pageSize, fillGapId);
-    else if (feedInsertIt == mFeed.begin())
-        prependPageToFilteredPostModels(page, pageSize);
-    else if (feedInsertIt == mFeed.end())
-        addPageToFilteredPostModels(page, pageSize);
-
+    const size_t insertIndex = feedInsertIt - mFeed.begin();
     mFeed.insert(feedInsertIt, page.mFeed.begin(), page.mFeed.begin() + pageSize);
+    addToIndices(pageSize, insertIndex);
+    updateOrderBreaks(insertIndex, insertIndex + pageSize);
+
+    if (fillGapId > 0)
+        gapFillFilteredPostModels(insertIndex, pageSize, fillGapId);
+    else if (insertIndex == 0)
+        prependPageToFilteredPostModels(pageSize);
+    else if (insertIndex + pageSize == mFeed.size())
+        addPageToFilteredPostModels(insertIndex, pageSize);
 
     for (const auto& post : page.mFeed)
     {
@@ -141,36 +257,34 @@ void PostFeedModel::insertPage(const TimelineFeed::iterator& feedInsertIt, const
     cleanupStoredCids();
 }
 
-void PostFeedModel::addPageToFilteredPostModels(const Page& page, int pageSize)
+void PostFeedModel::addPageToFilteredPostModels(size_t insertIndex, int pageSize)
 {
     for (auto& model : mFilteredPostFeedModels)
-        model->addPosts(page.mFeed, pageSize);
+        model->addPosts(insertIndex, pageSize);
 }
 
-void PostFeedModel::prependPageToFilteredPostModels(const Page& page, int pageSize)
+void PostFeedModel::prependPageToFilteredPostModels(int pageSize)
 {
     for (auto& model : mFilteredPostFeedModels)
-        model->prependPosts(page.mFeed, pageSize);
+        model->prependPosts(pageSize);
 }
 
-void PostFeedModel::gapFillFilteredPostModels(const Page& page, int pageSize, int gapId)
+void PostFeedModel::gapFillFilteredPostModels(size_t gapIndex, int pageSize, int gapId)
 {
     for (auto& model : mFilteredPostFeedModels)
-        model->gapFill(page.mFeed, pageSize, gapId);
+        model->gapFill(gapIndex, pageSize, gapId);
 }
 
 void PostFeedModel::removeHeadFromFilteredPostModels(size_t headSize)
 {
     for (auto& model : mFilteredPostFeedModels)
-        model->removeHeadPosts(mFeed, headSize);
+        model->removeHeadPosts(headSize);
 }
 
-void PostFeedModel::removeTailFromFilteredPostModels(size_t tailSize)
+void PostFeedModel::removeTailFromFilteredPostModels()
 {
     for (auto& model : mFilteredPostFeedModels)
-    {
-        model->removeTailPosts(mFeed, tailSize);
-    }
+        model->removeTailPosts();
 }
 
 void PostFeedModel::clearFilteredPostModels()
@@ -179,16 +293,14 @@ void PostFeedModel::clearFilteredPostModels()
         model->clear();
 }
 
-int PostFeedModel::insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int insertIndex, int fillGapId)
+int PostFeedModel::insertFeed(Page::Ptr page, int insertIndex, int fillGapId)
 {
-    auto page = createPage(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed));
-
     if (page->mFeed.empty())
     {
         qDebug() << "Page has no posts";
 
         if (fillGapId > 0)
-            gapFillFilteredPostModels(*page, 0, fillGapId);
+            gapFillFilteredPostModels(insertIndex, 0, fillGapId);
 
         return 0;
     }
@@ -209,18 +321,17 @@ int PostFeedModel::insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed
 
         beginInsertRows({}, insertIndex, lastInsertIndex);
         insertPage(mFeed.begin() + insertIndex, *page, page->mFeed.size(), fillGapId);
-        addToIndices(page->mFeed.size(), insertIndex);
 
         size_t indexOffset = 0;
 
         if (gapId != 0)
         {
-            mGapIdIndexMap[gapId] = lastInsertIndex;
+            mIndexGapIdMap.insert(lastInsertIndex, gapId);
             indexOffset = 1; // offset for the place holder post.
         }
 
         if (!page->mCursorNextPage.isEmpty())
-            mIndexCursorMap[lastInsertIndex - indexOffset] = page->mCursorNextPage;
+            mIndexCursorMap.insert(lastInsertIndex - indexOffset, page->mCursorNextPage);
 
         endInsertRows();
 
@@ -235,10 +346,7 @@ int PostFeedModel::insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed
         qDebug() << "Full overlap, no new posts";
 
         if (fillGapId > 0)
-        {
-            const Page emptyPage;
-            gapFillFilteredPostModels(emptyPage, 0, fillGapId);
-        }
+            gapFillFilteredPostModels(insertIndex, 0, fillGapId);
 
         return 0;
     }
@@ -247,10 +355,9 @@ int PostFeedModel::insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed
 
     beginInsertRows({}, insertIndex, insertIndex + *overlapStart - 1);
     insertPage(mFeed.begin() + insertIndex, *page, *overlapStart, fillGapId);
-    addToIndices(*overlapStart, insertIndex);
 
     if (!page->mCursorNextPage.isEmpty() && overlapEnd)
-        mIndexCursorMap[*overlapStart + *overlapEnd] = page->mCursorNextPage;
+        mIndexCursorMap.insert(*overlapStart + *overlapEnd, page->mCursorNextPage);
 
     endInsertRows();
 
@@ -262,6 +369,7 @@ int PostFeedModel::insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed
 
 void PostFeedModel::clear()
 {
+    ++mFeedGeneration;
     clearFilteredPostModels();
 
     if (!mFeed.empty())
@@ -269,7 +377,8 @@ void PostFeedModel::clear()
         beginRemoveRows({}, 0, mFeed.size() - 1);
         clearFeed();
         mIndexCursorMap.clear();
-        mGapIdIndexMap.clear();
+        mIndexGapIdMap.clear();
+        mOrderBreakIndexMap.clear();
         endRemoveRows();
     }
 
@@ -310,7 +419,7 @@ void PostFeedModel::addPage(Page::Ptr page)
 
     if (!page->mCursorNextPage.isEmpty())
     {
-        mIndexCursorMap[mFeed.size() - 1] = page->mCursorNextPage;
+        mIndexCursorMap.insert(mFeed.size() - 1, page->mCursorNextPage);
     }
     else
     {
@@ -333,16 +442,16 @@ void PostFeedModel::removeTailPosts(int size)
     if (size <= 0 || size >= (int)mFeed.size())
         return;
 
-    const auto removeIndexCursorIt = mIndexCursorMap.lower_bound(mFeed.size() - size - 1);
+    const auto removeCursorIndex = mIndexCursorMap.lowerBound(mFeed.size() - size - 1);
 
-    if (removeIndexCursorIt == mIndexCursorMap.end())
+    if (!removeCursorIndex)
     {
         qWarning() << "Cannot remove" << size << "posts";
         logIndices();
         return;
     }
 
-    const size_t removeIndex = removeIndexCursorIt->first + 1;
+    const size_t removeIndex = *removeCursorIndex + 1;
 
     if (removeIndex >= mFeed.size())
     {
@@ -352,23 +461,17 @@ void PostFeedModel::removeTailPosts(int size)
     }
 
     const size_t removeCount = mFeed.size() - removeIndex;
-    removeTailFromFilteredPostModels(removeCount);
 
     beginRemoveRows({}, removeIndex, mFeed.size() - 1);
     removePosts(removeIndex, removeCount);
-    mIndexCursorMap.erase(std::next(removeIndexCursorIt), mIndexCursorMap.end());
-
-    for (auto it = mGapIdIndexMap.begin(); it != mGapIdIndexMap.end(); )
-    {
-        if (it->second >= removeIndex)
-            it = mGapIdIndexMap.erase(it);
-        else
-            ++it;
-    }
+    mIndexCursorMap.eraseAfter(*removeCursorIndex);
+    mIndexGapIdMap.eraseFrom(removeIndex);
+    mOrderBreakIndexMap.eraseFrom(removeIndex);
 
     setEndOfFeed(false);
     endRemoveRows();
 
+    removeTailFromFilteredPostModels();
     qDebug() << "Removed tail rows:" << size << "new size:" << mFeed.size();
     logIndices();
 }
@@ -389,26 +492,20 @@ void PostFeedModel::removeHeadPosts(int size)
         return;
     }
 
-    const auto removeEndIndexCursorIt = mIndexCursorMap.upper_bound(removeEndIndex);
     const int removeSize = removeEndIndex + 1;
-    removeHeadFromFilteredPostModels(removeSize);
 
     beginRemoveRows({}, 0, removeEndIndex);
     removePosts(0, removeSize);
     Q_ASSERT(!mFeed.front().isGap());
-    mIndexCursorMap.erase(mIndexCursorMap.begin(), removeEndIndexCursorIt);
-
-    for (auto it = mGapIdIndexMap.begin(); it != mGapIdIndexMap.end(); )
-    {
-        if (it->second <= removeEndIndex)
-            it = mGapIdIndexMap.erase(it);
-        else
-            ++it;
-    }
+    mIndexCursorMap.eraseUpTo(removeEndIndex);
+    mIndexGapIdMap.eraseUpTo(removeEndIndex);
+    mOrderBreakIndexMap.eraseUpTo(removeEndIndex);
 
     addToIndices(-removeSize, removeSize);
+    updateOrderBreaks(0, 0);
     endRemoveRows();
 
+    removeHeadFromFilteredPostModels(removeSize);
     qDebug() << "Removed head rows, new size:" << mFeed.size();
     logIndices();
 }
@@ -428,20 +525,20 @@ QString PostFeedModel::getLastCursor() const
     if (isEndOfFeed() || mIndexCursorMap.empty())
         return {};
 
-    return mIndexCursorMap.rbegin()->second;
+    return mIndexCursorMap.last();
 }
 
 const Post* PostFeedModel::getGapPlaceHolder(int gapId) const
 {
-    const auto it = mGapIdIndexMap.find(gapId);
+    const auto gapRow = findGapIndex(gapId);
 
-    if (it == mGapIdIndexMap.end())
+    if (!gapRow)
     {
         qDebug() << "Gap does not exist:" << gapId;
         return nullptr;
     }
 
-    const int gapIndex = it->second;
+    const int gapIndex = (int)*gapRow;
 
     if (gapIndex > (int)mFeed.size())
     {
@@ -454,19 +551,118 @@ const Post* PostFeedModel::getGapPlaceHolder(int gapId) const
     return gap;
 }
 
+int PostFeedModel::findGapId(const QString& gapCursor) const
+{
+    const auto gapRow = mIndexGapIdMap.findRow([this, &gapCursor](size_t gapIndex, int){
+        return gapIndex < mFeed.size() && mFeed[gapIndex].getGapCursor() == gapCursor;
+    });
+
+    return gapRow ? *mIndexGapIdMap.find(*gapRow) : 0;
+}
+
+void PostFeedModel::addGapPlaceHolder(const QString& gapCursor)
+{
+    Page page;
+    page.mFeed.push_back(Post::createGapPlaceHolder(gapCursor));
+    const int gapId = page.mFeed.back().getGapId();
+    const size_t gapIndex = mFeed.size();
+
+    beginInsertRows({}, gapIndex, gapIndex);
+    insertPage(mFeed.end(), page, 1);
+    mIndexGapIdMap.insert(gapIndex, gapId);
+    endInsertRows();
+
+    qDebug() << "Added gap place holder:" << gapId << "index:" << gapIndex;
+}
+
+std::vector<TimelineStore::Segment> PostFeedModel::getStoreSegments(int maxPosts) const
+{
+    std::vector<TimelineStore::Segment> segments;
+    auto feed = std::make_shared<ATProto::AppBskyFeed::OutputFeed>();
+    int numPosts = 0;
+
+    const auto addAppendSegment = [&segments, &feed](const QString& cursor){
+        if (!feed->mFeed.empty())
+        {
+            feed->mCursor = Utils::makeOptionalString(cursor);
+            segments.push_back({ TimelineStore::SegmentType::APPEND, {}, feed });
+        }
+
+        feed = std::make_shared<ATProto::AppBskyFeed::OutputFeed>();
+    };
+
+    const auto addGapSegment = [&segments](const QString& gapCursor){
+        segments.push_back({ TimelineStore::SegmentType::GAP, gapCursor,
+                             std::make_shared<ATProto::AppBskyFeed::OutputFeed>() });
+    };
+
+    for (size_t i = 0; i < mFeed.size(); ++i)
+    {
+        const auto& post = mFeed[i];
+
+        if (post.isGap())
+        {
+            addAppendSegment(post.getGapCursor());
+            addGapSegment(post.getGapCursor());
+            continue;
+        }
+
+        // Parents and roots of a reply have no feed view post. They get recreated
+        // from the reply.
+        const auto& feedViewPost = post.getFeedViewPost();
+
+        if (feedViewPost)
+        {
+            feed->mFeed.push_back(feedViewPost);
+            ++numPosts;
+        }
+
+        const QString* cursor = mIndexCursorMap.find(i);
+
+        if (cursor && numPosts >= maxPosts && i < mFeed.size() - 1)
+        {
+            // The rest of the feed can be fetched by filling the gap.
+            addAppendSegment(*cursor);
+            addGapSegment(*cursor);
+            qDebug() << "Store segments cut at:" << i << "posts:" << numPosts;
+            return segments;
+        }
+    }
+
+    addAppendSegment(getLastCursor());
+    return segments;
+}
+
 QDateTime PostFeedModel::lastTimestamp() const
 {
-    return !mFeed.empty() ? mFeed.back().getTimelineTimestamp() : QDateTime();
+    for (auto it = mFeed.rbegin(); it != mFeed.rend(); ++it)
+    {
+        if (!it->isPlaceHolder())
+            return it->getTimelineTimestamp();
+    }
+
+    return {};
 }
 
 int PostFeedModel::findTimestamp(QDateTime timestamp) const
 {
-    for (int i = mFeed.size() - 1; i >= 0; --i)
+    const auto runStarts = getOrderedRunStarts();
+    size_t runEnd = mFeed.size();
+
+    for (auto it = runStarts.rbegin(); it != runStarts.rend(); ++it)
     {
-        const Post& post = mFeed[i];
+        const size_t runStart = *it;
+        const size_t laterEnd = findInOrderedRun(runStart, runEnd,
+            [&timestamp](const QDateTime& postTimestamp){ return postTimestamp < timestamp; });
 
-        if (!post.isPlaceHolder() && post.getTimelineTimestamp() >= timestamp)
-            return i;
+        // The last post before the partition point is the last post >= timestamp
+        for (size_t i = laterEnd; i > runStart; --i)
+        {
+            if (!mFeed[i - 1].isPlaceHolder())
+                return (int)(i - 1);
+        }
+
+        runEnd = runStart;
     }
 
     return 0;
@@ -495,10 +691,13 @@ FilteredPostFeedModel* PostFeedModel::addFilteredPostFeedModel(IPostFilter::Ptr
     Q_ASSERT(postFilter);
     qDebug() << "Add filtered post feed model:" << postFilter->getName();
     auto model = std::make_unique<FilteredPostFeedModel>(
-            std::move(postFilter), mUserDid, mFollowing, mMutedReposts, mContentFilter,
+            std::move(postFilter), mFeed, mUserDid, mFollowing, mMutedReposts, mContentFilter,
             mBookmarks, mMutedWords, mFocusHashtags, mHashtags, this);
 
-    model->setPosts(mFeed, mFeed.size());
+    connect(model.get(), &FilteredPostFeedModel::unfoldTimelinePosts, this,
+            [this](int timelineIndex){ unfoldPosts(timelineIndex); });
+
+    model->setPosts();
     auto* retval = model.get();
     mFilteredPostFeedModels.push_back(std::move(model));
     emit filteredPostFeedModelsChanged();
@@ -528,13 +727,15 @@ QList<FilteredPostFeedModel*> PostFeedModel::getFilteredPostFeedModels() const
     return QList<FilteredPostFeedModel*>(models.begin(), models.end());
 }
 
-void PostFeedModel::makeLocalFilteredModelChange(const std::function<void(LocalProfileChanges*)>& update)
+void PostFeedModel::unfoldPosts(int startIndex)
 {
+    AbstractPostFeedModel::unfoldPosts(startIndex);
+
     for (auto& model : mFilteredPostFeedModels)
-        update(model.get());
+        model->timelinePostsUnfolded();
 }
 
-void PostFeedModel::makeLocalFilteredModelChange(const std::function<void(LocalPostModelChanges*)>& update)
+void PostFeedModel::makeLocalFilteredModelChange(const std::function<void(LocalProfileChanges*)>& update)
 {
     for (auto& model : mFilteredPostFeedModels)
         update(model.get());
@@ -614,15 +815,50 @@ bool PostFeedModel::Page::tryAddToExistingThread(const Post& post, const PostRep
     return true;
 }
 
-bool PostFeedModel::mustHideContent(const Post& post) const
+PostFeedModel::PageFilter PostFeedModel::makePageFilter(const FilterSnapshot::SharedPtr& snapshot) const
 {
-    if (AbstractPostFeedModel::mustHideContent(post))
+    PageFilter filter;
+
+    if (snapshot)
+    {
+        filter.mSnapshot = snapshot;
+        filter.mFollowing = snapshot->mFollowing.get();
+        filter.mMutedReposts = snapshot->mMutedReposts.get();
+        filter.mContentFilter = snapshot->mContentFilter.get();
+        filter.mMutedWords = snapshot->mMutedWords.get();
+    }
+    else
+    {
+        filter.mFollowing = &mFollowing;
+        filter.mMutedReposts = &mMutedReposts;
+        filter.mContentFilter = &mContentFilter;
+        filter.mMutedWords = &mMutedWords;
+    }
+
+    filter.mUserDid = mUserDid;
+    filter.mFeedViewPref = mUserPreferences.getFeedViewPref(getPreferencesFeedKey());
+    filter.mLanguageFilterEnabled = mLanguageFilterEnabled;
+
+    if (mLanguageFilterEnabled)
+    {
+        filter.mShowUnknownContentLanguage = mUserSettings.getShowUnknownContentLanguage(mUserDid);
+        filter.mContentLanguages = mUserSettings.getContentLanguages(mUserDid);
+    }
+
+    filter.mHideRepliesInThreadFromUnfollowed = mUserSettings.getHideRepliesInThreadFromUnfollowed(mUserDid);
+    filter.mShowQuotesWithBlockedPost = mUserSettings.getShowQuotesWithBlockedPost(mUserDid);
+    return filter;
+}
+
+bool PostFeedModel::PageFilter::mustHideContent(const Post& post) const
+{
+    if (AbstractPostFeedModel::mustHideContent(post, *mContentFilter, *mMutedReposts, *mMutedWords))
         return true;
 
     return !passLanguageFilter(post);
 }
 
-bool PostFeedModel::passLanguageFilter(const Post& post) const
+bool PostFeedModel::PageFilter::passLanguageFilter(const Post& post) const
 {
     if (!mLanguageFilterEnabled)
         return true;
@@ -631,14 +867,14 @@ bool PostFeedModel::passLanguageFilter(const Post& post) const
 
     if (postLangs.empty())
     {
-        if (mUserSettings.getShowUnknownContentLanguage(mUserDid))
+        if (mShowUnknownContentLanguage)
             return true;
 
         qDebug() << "Unknown language:" << post.getText();
         return false;
     }
 
-    const QStringList sortedContentLangs = mUserSettings.getContentLanguages(mUserDid);
+    const QStringList& sortedContentLangs = mContentLanguages;
 
     if (sortedContentLangs.empty())
         return true;
@@ -653,18 +889,16 @@ bool PostFeedModel::passLanguageFilter(const Post& post) const
     return false;
 }
 
-bool PostFeedModel::mustShowReply(const Post& post, const std::optional<PostReplyRef>& replyRef) const
+bool PostFeedModel::PageFilter::mustShowReply(const Post& post, const std::optional<PostReplyRef>& replyRef) const
 {
-    const auto& feedViewPref = mUserPreferences.getFeedViewPref(getPreferencesFeedKey());
-
-    if (feedViewPref.mHideReplies)
+    if (mFeedViewPref.mHideReplies)
         return false;
 
     // Always show the replies of the user.
     if (post.getAuthor().getDid() == mUserDid)
         return true;
 
-    if (mUserSettings.getHideRepliesInThreadFromUnfollowed(mUserDid))
+    if (mHideRepliesInThreadFromUnfollowed)
     {
         // In case of blocked posts there is no reply ref.
         // Surely someone that blocks you is not a friend of yours.
@@ -681,11 +915,11 @@ bool PostFeedModel::mustShowReply(const Post& post, const std::optional<PostRepl
         const auto& rootDid = replyRef->mRoot.getAuthor().getDid();
 
         // Always show replies to the user
-        if (parentDid != mUserDid && !mFollowing.contains(rootDid))
+        if (parentDid != mUserDid && !mFollowing->contains(rootDid))
             return false;
     }
 
-    if (feedViewPref.mHideRepliesByUnfollowed)
+    if (mFeedViewPref.mHideRepliesByUnfollowed)
     {
         // In case of blocked posts there is no reply ref.
         // Surely someone that blocks you is not a friend of yours.
@@ -708,22 +942,21 @@ bool PostFeedModel::mustShowReply(const Post& post, const std::optional<PostRepl
         if (rootDid == mUserDid)
             return true;
 
-        if (!mFollowing.contains(parentDid))
+        if (!mFollowing->contains(parentDid))
             return false;
     }
 
     return true;
 }
 
-bool PostFeedModel::mustShowQuotePost(const Post& post) const
+bool PostFeedModel::PageFilter::mustShowQuotePost(const Post& post) const
 {
     Q_ASSERT(post.isQuotePost());
-    const auto& feedViewPref = mUserPreferences.getFeedViewPref(getPreferencesFeedKey());
 
-    if (feedViewPref.mHideQuotePosts)
+    if (mFeedViewPref.mHideQuotePosts)
         return false;
 
-    if (!mUserSettings.getShowQuotesWithBlockedPost(mUserDid))
+    if (!mShowQuotesWithBlockedPost)
     {
         const RecordView* record;
         const auto recordView = post.getRecordView();
@@ -823,9 +1056,68 @@ void PostFeedModel::Page::foldPosts(int startIndex, int endIndex)
     }
 }
 
+void PostFeedModel::FeedEntry::prepare(const ATProto::AppBskyFeed::FeedViewPost::SharedPtr& feedViewPost, const PageFilter& filter)
+{
+    mPost = Post(feedViewPost);
+    mReplyRef = mPost.getViewPostReplyRef();
+
+    // Tokenizing the post texts is the most expensive part of filtering (muted words,
+    // focus hashtags, hashtag index).
+    mPost.buildIndices();
+
+    if (mReplyRef)
+    {
+        mReplyRef->mRoot.buildIndices();
+        mReplyRef->mParent.buildIndices();
+    }
+
+    mHidden = (filter.mFeedViewPref.mHideReposts && mPost.isRepost()) ||
+              (mPost.isQuotePost() && !filter.mustShowQuotePost(mPost)) ||
+              filter.mustHideContent(mPost);
+
+    // Reposted replies are displayed without thread context
+    if (mHidden || mPost.isRepost())
+        return;
+
+    if (mReplyRef)
+    {
+        mShowReply = filter.mustShowReply(mPost, mReplyRef);
+        mRootHidden = filter.mustHideContent(mReplyRef->mRoot);
+        mParentHidden = filter.mustHideContent(mReplyRef->mParent);
+    }
+    else if (mPost.isReply())
+    {
+        mShowReply = filter.mustShowReply(mPost, {});
+    }
+}
+
+PostFeedModel::PreparedFeed::SharedPtr PostFeedModel::prepareFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr feed, const PageFilter& filter)
+{
+    auto preparedFeed = std::make_shared<PreparedFeed>();
+    preparedFeed->mEntries.resize(feed->mFeed.size());
+
+    for (size_t i = 0; i < feed->mFeed.size(); ++i)
+    {
+        const auto& feedEntry = feed->mFeed[i];
+
+        if (feedEntry->mPost->mRecordType == ATProto::RecordType::APP_BSKY_FEED_POST)
+            preparedFeed->mEntries[i].prepare(feedEntry, filter);
+    }
+
+    preparedFeed->mFeed = std::move(feed);
+    return preparedFeed;
+}
+
 PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed)
 {
-    const auto& feedViewPref = mUserPreferences.getFeedViewPref(getPreferencesFeedKey());
+    auto preparedFeed = prepareFeed(std::forward<ATProto::AppBskyFeed::OutputFeed::SharedPtr>(feed), makePageFilter());
+    return createPage(*preparedFeed);
+}
+
+PostFeedModel::Page::Ptr PostFeedModel::createPage(PreparedFeed& preparedFeed)
+{
+    const auto& feed = preparedFeed.mFeed;
+    auto& entries = preparedFeed.mEntries;
     auto page = std::make_unique<Page>();
 
     for (size_t i = 0; i < feed->mFeed.size(); ++i)
@@ -834,7 +1126,7 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
 
         if (feedEntry->mPost->mRecordType == ATProto::RecordType::APP_BSKY_FEED_POST)
         {
-            Post post(feedEntry);
+            Post& post = entries[i].mPost;
             page->collectThreadgate(post);
 
             // Due to reposting a post can show up multiple times in the feed.
@@ -847,16 +1139,10 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
                 continue;
             }
 
-            if (feedViewPref.mHideReposts && post.isRepost())
-                continue;
-
-            if (post.isQuotePost() && !mustShowQuotePost(post))
+            if (entries[i].mHidden)
                 continue;
 
-            if (mustHideContent(post))
-                continue;
-
-            const auto& replyRef = post.getViewPostReplyRef();
+            const auto& replyRef = entries[i].mReplyRef;
 
             // Reposted replies are displayed without thread context
             if (replyRef && !post.isRepost())
@@ -869,7 +1155,7 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
                 if (page->tryAddToExistingThread(post, *replyRef))
                     continue;
 
-                if (!mustShowReply(post, replyRef))
+                if (!entries[i].mShowReply)
                     continue;
 
                 bool rootAdded = false;
@@ -877,7 +1163,7 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
                 const auto& parentCid = replyRef->mParent.getCid();
 
                 if (!rootCid.isEmpty() && rootCid != parentCid && !cidIsStored(rootCid) && !page->cidAdded(rootCid) &&
-                    !mustHideContent(replyRef->mRoot))
+                    !entries[i].mRootHidden)
                 {
                     preprocess(replyRef->mRoot);
                     page->addPost(replyRef->mRoot);
@@ -888,7 +1174,7 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
                 // If the parent was seen already, but the root not, then show the parent
                 // again for consistency of the thread.
                 if (((!parentCid.isEmpty() && !cidIsStored(parentCid) && !page->cidAdded(parentCid)) || rootAdded) &&
-                    !mustHideContent(replyRef->mParent))
+                    !entries[i].mParentHidden)
                 {
                     preprocess(replyRef->mParent);
                     page->addPost(replyRef->mParent, true);
@@ -910,7 +1196,7 @@ PostFeedModel::Page::Ptr PostFeedModel::createPage(ATProto::AppBskyFeed::OutputF
             {
                 // A post can still be a reply even if there is no reply reference.
                 // The reference may be missing due to blocked posts.
-                if (!mustShowReply(post, {}))
+                if (!entries[i].mShowReply)
                     continue;
             }
             else
@@ -1036,24 +1322,31 @@ std::optional<size_t> PostFeedModel::findOverlapEnd(const Page& page, size_t fee
     const auto& cidLastPagePost = page.mFeed.back().getCid();
     const auto& timestampLastPagePost = page.mFeed.back().getTimelineTimestamp();
 
-    for (size_t i = feedIndex; i < mFeed.size(); ++ i)
-    {
-        const auto& post = mFeed[i];
+    // A post matching the last page post has the same timestamp, so the
+    // overlap end is the first post with a timestamp <= the last page post.
+    const auto runStarts = getOrderedRunStarts();
+    auto runIt = std::upper_bound(runStarts.begin(), runStarts.end(), feedIndex);
+    size_t runStart = feedIndex;
 
-        if (post.isPlaceHolder())
-            continue;
+    while (runStart < mFeed.size())
+    {
+        const size_t runEnd = runIt != runStarts.end() ? *runIt++ : mFeed.size();
+        const size_t i = findInOrderedRun(runStart, runEnd,
+            [&timestampLastPagePost](const QDateTime& postTimestamp){ return postTimestamp <= timestampLastPagePost; });
 
-        if (cidLastPagePost == post.getCid() && timestampLastPagePost == post.getTimelineTimestamp())
+        if (i < runEnd)
         {
-            qDebug() << "Last matching overlap index found:" << i;
-            return i;
-        }
+            const auto& post = mFeed[i];
+
+            if (cidLastPagePost == post.getCid() && timestampLastPagePost == post.getTimelineTimestamp())
+                qDebug() << "Last matching overlap index found:" << i;
+            else
+                qDebug() << "Overlap end on timestamp found:" << i << timestampLastPagePost << post.getTimelineTimestamp();
 
-        if (timestampLastPagePost >= post.getTimelineTimestamp())
-        {
-            qDebug() << "Overlap end on timestamp found:" << i << timestampLastPagePost << post.getTimelineTimestamp();
             return i;
         }
+
+        runStart = runEnd;
     }
 
     qWarning() << "No overlap found, page exceeds end of stored feed";
@@ -1062,33 +1355,103 @@ std::optional<size_t> PostFeedModel::findOverlapEnd(const Page& page, size_t fee
 
 void PostFeedModel::addToIndices(int offset, size_t startAtIndex)
 {
-    std::map<size_t, QString> newCursorMap;
-    for (const auto& [index, cursor] : mIndexCursorMap)
+    mIndexCursorMap.shift(startAtIndex, offset);
+    mIndexGapIdMap.shift(startAtIndex, offset);
+    mOrderBreakIndexMap.shift(startAtIndex, offset);
+}
+
+void PostFeedModel::updateOrderBreaks(size_t startIndex, size_t endIndex)
+{
+    std::optional<QDateTime> prevTimestamp;
+
+    for (size_t i = startIndex; i > 0; --i)
     {
-        if (index >= startAtIndex)
-            newCursorMap[index + offset] = cursor;
-        else
-            newCursorMap[index] = cursor;
+        if (!mFeed[i - 1].isPlaceHolder())
+        {
+            prevTimestamp = mFeed[i - 1].getTimelineTimestamp();
+            break;
+        }
     }
 
-    mIndexCursorMap = std::move(newCursorMap);
+    // Continue till the first post from endIndex, as its predecessor may have changed.
+    for (size_t i = startIndex; i < mFeed.size(); ++i)
+    {
+        mOrderBreakIndexMap.erase(i);
+        const auto& post = mFeed[i];
 
-    for (auto& [gapId, index] : mGapIdIndexMap)
+        if (post.isPlaceHolder())
+            continue;
+
+        const QDateTime timestamp = post.getTimelineTimestamp();
+
+        if (prevTimestamp && timestamp > *prevTimestamp)
+            mOrderBreakIndexMap.insert(i, timestamp);
+
+        prevTimestamp = timestamp;
+
+        if (i >= endIndex)
+            break;
+    }
+}
+
+std::vector<size_t> PostFeedModel::getOrderedRunStarts() const
+{
+    std::vector<size_t> runStarts{ 0 };
+    runStarts.reserve(mOrderBreakIndexMap.size() + 1);
+    mOrderBreakIndexMap.forEach([&runStarts](size_t index, const QDateTime&){ runStarts.push_back(index); });
+    return runStarts;
+}
+
+template<typename Pred>
+size_t PostFeedModel::findInOrderedRun(size_t runStart, size_t runEnd, Pred pred) const
+{
+    // A place holder gets the timestamp of the preceding post in the run. If
+    // there is no such post, then pred is false.
+    const auto predAt = [this, runStart, &pred](size_t index){
+        for (size_t i = index + 1; i > runStart; --i)
+        {
+            const auto& post = mFeed[i - 1];
+
+            if (!post.isPlaceHolder())
+                return pred(post.getTimelineTimestamp());
+        }
+
+        return false;
+    };
+
+    size_t low = runStart;
+    size_t high = runEnd;
+
+    while (low < high)
     {
-        if (index >= startAtIndex)
-            index += offset;
+        const size_t mid = low + (high - low) / 2;
+
+        if (predAt(mid))
+            high = mid;
+        else
+            low = mid + 1;
     }
+
+    return low;
+}
+
+std::optional<size_t> PostFeedModel::findGapIndex(int gapId) const
+{
+    // There are only a few gaps in a feed.
+    return mIndexGapIdMap.findRow([gapId](size_t, int id){ return id == gapId; });
 }
 
 void PostFeedModel::logIndices() const
 {
     qDebug() << "INDEX CURSOR MAP:";
-    for (const auto& [index, cursor] : mIndexCursorMap)
+    mIndexCursorMap.forEach([](size_t index, const QString& cursor){
         qDebug() << "Index:" << index << "Cursor:" << cursor;
+    });
 
     qDebug() << "GAP INDEX MAP:";
-    for (const auto& [gapId, index] : mGapIdIndexMap)
+    mIndexGapIdMap.forEach([](size_t index, int gapId){
         qDebug() << "Gap:" << gapId << "Index:" << index;
+    });
 }
 
 }
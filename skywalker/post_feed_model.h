@@ -2,9 +2,12 @@
 // License: GPLv3
 #pragma once
 #include "abstract_post_feed_model.h"
+#include "filter_snapshot.h"
 #include "filtered_post_feed_model.h"
 #include "generator_view.h"
 #include "post_filter.h"
+#include "row_index_map.h"
+#include "timeline_store.h"
 #include <atproto/lib/user_preferences.h>
 #include <map>
 #include <unordered_map>
@@ -70,16 +73,43 @@ public:
     // Returns 0 otherwise.
     int gapFillFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int gapId);
 
+    // With filter snapshots the posts of a page are created and filtered on a
+    // worker thread. Without them the async functions below create the page on
+    // the GUI thread and call the callback before returning.
+    void setFilterSnapshots(const FilterSnapshotPublisher* filterSnapshots) { mFilterSnapshots = filterSnapshots; }
+
+    // The callback is called on the GUI thread after the page has been added to
+    // the feed. If the feed got cleared meanwhile, then the page is dropped and
+    // the callback gets gap id 0.
+    using FeedAddedCb = std::function<void()>;
+    using GapCb = std::function<void(int gapId)>;
+    void setFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedAddedCb& feedAddedCb);
+    void addFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedAddedCb& feedAddedCb);
+    void prependFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const GapCb& gapCb);
+    void gapFillFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int gapId, const GapCb& gapCb);
+
     void removeTailPosts(int size);
     void removeHeadPosts(int size);
     void removePosts(int startIndex, int size);
 
     QString getLastCursor() const;
     const Post* getGapPlaceHolder(int gapId) const;
+
+    // Returns 0 if there is no gap with this cursor.
+    int findGapId(const QString& gapCursor) const;
+
+    // Add a gap place holder at the end of the feed.
+    void addGapPlaceHolder(const QString& gapCursor);
+
+    // Returns APPEND and GAP segments that rebuild the feed when replayed. Each gap
+    // in the feed becomes a GAP segment. If the feed has more than maxPosts posts,
+    // then it is cut at a page boundary and a GAP segment with the cursor of that
+    // page ends the segments.
+    std::vector<TimelineStore::Segment> getStoreSegments(int maxPosts) const;
     void clearLastInsertedRowIndex() { mLastInsertedRowIndex = -1; }
     int getLastInsertedRowIndex() const { return mLastInsertedRowIndex; }
 
-    // Get the timestamp of the last post in the feed
+    // Get the timestamp of the last post in the feed, place holders are skipped
     QDateTime lastTimestamp() const;
 
     // Returns the index of the last post >= timestamp, 0 if no such post exists
@@ -94,8 +124,10 @@ public:
     Q_INVOKABLE void deleteFilteredPostFeedModel(FilteredPostFeedModel* postFeedModel);
     QList<FilteredPostFeedModel*> getFilteredPostFeedModels() const;
 
+    // The filtered models share the posts, so they show the unfolding too.
+    void unfoldPosts(int startIndex) override;
+
     void makeLocalFilteredModelChange(const std::function<void(LocalProfileChanges*)>& update);
-    void makeLocalFilteredModelChange(const std::function<void(LocalPostModelChanges*)>& update);
 
 signals:
     void languageFilterConfiguredChanged();
@@ -122,27 +154,79 @@ private:
         void foldPosts(int startIndex, int endIndex);
     };
 
+    // Settings that decide which posts of a page are shown. The settings are
+    // copied, such that a page can be filtered on a worker thread.
+    struct PageFilter
+    {
+        FilterSnapshot::SharedPtr mSnapshot; // owns the filters below if set
+        const IProfileStore* mFollowing = nullptr;
+        const IProfileStore* mMutedReposts = nullptr;
+        const IContentFilter* mContentFilter = nullptr;
+        const IMatchWords* mMutedWords = nullptr;
+        QString mUserDid;
+        ATProto::UserPreferences::FeedViewPref mFeedViewPref;
+        bool mLanguageFilterEnabled = false;
+        bool mShowUnknownContentLanguage = true;
+        QStringList mContentLanguages; // sorted
+        bool mHideRepliesInThreadFromUnfollowed = false;
+        bool mShowQuotesWithBlockedPost = true;
+
+        bool mustHideContent(const Post& post) const;
+        bool passLanguageFilter(const Post& post) const;
+        bool mustShowReply(const Post& post, const std::optional<PostReplyRef>& replyRef) const;
+        bool mustShowQuotePost(const Post& post) const;
+    };
+
+    // A post from a received page with the filter decisions taken for it. The
+    // decisions that depend on the posts already in the feed are taken when the
+    // page gets added.
+    struct FeedEntry
+    {
+        Post mPost;
+        std::optional<PostReplyRef> mReplyRef;
+        bool mHidden = false;
+        bool mShowReply = true;
+        bool mRootHidden = false;
+        bool mParentHidden = false;
+
+        void prepare(const ATProto::AppBskyFeed::FeedViewPost::SharedPtr& feedViewPost, const PageFilter& filter);
+    };
+
+    struct PreparedFeed
+    {
+        using SharedPtr = std::shared_ptr<PreparedFeed>;
+        ATProto::AppBskyFeed::OutputFeed::SharedPtr mFeed;
+        std::vector<FeedEntry> mEntries;
+    };
+
+    using FeedPreparedCb = std::function<void(PreparedFeed::SharedPtr)>;
+
     void insertPage(const TimelineFeed::iterator& feedInsertIt, const Page& page, int pageSize, int fillGapId = 0);
     void addPage(Page::Ptr page);
+    int gapFillPage(Page::Ptr page, int gapId);
 
-    void addPageToFilteredPostModels(const Page& page, int pageSize);
-    void prependPageToFilteredPostModels(const Page& page, int pageSize);
-    void gapFillFilteredPostModels(const Page& page, int pageSize, int gapId);
+    void addPageToFilteredPostModels(size_t insertIndex, int pageSize);
+    void prependPageToFilteredPostModels(int pageSize);
+    void gapFillFilteredPostModels(size_t gapIndex, int pageSize, int gapId);
     void removeHeadFromFilteredPostModels(size_t headSize);
-    void removeTailFromFilteredPostModels(size_t tailSize);
+    void removeTailFromFilteredPostModels();
     void clearFilteredPostModels();
 
     FilteredPostFeedModel* addFilteredPostFeedModel(IPostFilter::Ptr postFilter);
 
-    virtual bool mustHideContent(const Post& post) const override;
-    bool passLanguageFilter(const Post& post) const;
-    bool mustShowReply(const Post& post, const std::optional<PostReplyRef>& replyRef) const;
-    bool mustShowQuotePost(const Post& post) const;
+    PageFilter makePageFilter(const FilterSnapshot::SharedPtr& snapshot = nullptr) const;
+    static PreparedFeed::SharedPtr prepareFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr feed, const PageFilter& filter);
+
+    // Prepares the feed on a worker thread if there is a filter snapshot. The
+    // callback gets nullptr if the feed got cleared while preparing.
+    void prepareFeedAsync(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, const FeedPreparedCb& feedPreparedCb);
+
     Page::Ptr createPage(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed);
+    Page::Ptr createPage(PreparedFeed& preparedFeed);
     Page::Ptr createPage(ATProto::AppBskyFeed::GetQuotesOutput::SharedPtr&& feed);
 
     // Returns gap id if insertion created a gap in the feed.
-    int insertFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr&& feed, int insertIndex, int fillGapId = 0);
+    int insertFeed(Page::Ptr page, int insertIndex, int fillGapId = 0);
 
     // Returns an index in the page feed
     std::optional<size_t> findOverlapStart(const Page& page, size_t feedIndex) const;
@@ -151,8 +235,21 @@ private:
     std::optional<size_t> findOverlapEnd(const Page& page, size_t feedIndex) const;
 
     void addToIndices(int offset, size_t startAtIndex);
+    std::optional<size_t> findGapIndex(int gapId) const;
     void logIndices() const;
 
+    // Recompute the order breaks for the posts from startIndex till endIndex.
+    void updateOrderBreaks(size_t startIndex, size_t endIndex);
+
+    // Start index of each run of posts ordered on descending timestamp.
+    std::vector<size_t> getOrderedRunStarts() const;
+
+    // Returns the first index in [runStart, runEnd) for which pred(timestamp)
+    // is true, or runEnd if there is none. pred must be false for the first
+    // posts of the run and true for the others.
+    template<typename Pred>
+    size_t findInOrderedRun(size_t runStart, size_t runEnd, Pred pred) const;
+
     bool mIsHomeFeed = false;
     const ATProto::UserPreferences& mUserPreferences;
     const UserSettings& mUserSettings;
@@ -160,10 +257,15 @@ private:
 
     // The index is the last (non-filtered) post from a received page. The cursor is to get
     // the next page.
-    std::map<size_t, QString> mIndexCursorMap; // cursor to post at next index
+    RowIndexMap<QString> mIndexCursorMap; // cursor to post at next index
+
+    // Index of each gap -> gap id
+    RowIndexMap<int> mIndexGapIdMap;
 
-    // Index of each gap
-    std::unordered_map<int, size_t> mGapIdIndexMap;
+    // Index of each post with a later timestamp than its preceding post -> timestamp
+    // A timeline is ordered on descending timestamp, but a feed may be ordered
+    // otherwise. Between these indices the feed can be binary searched on timestamp.
+    RowIndexMap<QDateTime> mOrderBreakIndexMap;
 
     int mLastInsertedRowIndex = -1;
     QString mFeedName;
@@ -172,6 +274,12 @@ private:
     QString mQuoteUri; // posts quoting this post
 
     std::vector<FilteredPostFeedModel::Ptr> mFilteredPostFeedModels;
+
+    const FilterSnapshotPublisher* mFilterSnapshots = nullptr;
+
+    // Incremented when the feed is cleared. Pages prepared for an older
+    // generation are dropped.
+    quint64 mFeedGeneration = 0;
 };
 
 }
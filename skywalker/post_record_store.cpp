@@ -0,0 +1,84 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "post_record_store.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace Skywalker {
+
+// Minimum number of records in the store before expired records get removed.
+static constexpr size_t MIN_SWEEP_SIZE = 1000;
+
+PostRecordStore& PostRecordStore::instance()
+{
+    static PostRecordStore sInstance;
+    return sInstance;
+}
+
+void PostRecordStore::intern(ATProto::AppBskyFeed::PostView& postView)
+{
+    if (postView.mRecordType != ATProto::RecordType::APP_BSKY_FEED_POST || postView.mCid.isEmpty())
+        return;
+
+    auto& record = std::get<ATProto::AppBskyFeed::Record::Post::SharedPtr>(postView.mRecord);
+
+    if (!record)
+        return;
+
+    QMutexLocker locker(&mMutex);
+    auto [it, inserted] = mRecords.try_emplace(postView.mCid, record);
+
+    if (!inserted)
+    {
+        auto storedRecord = it->second.lock();
+
+        if (storedRecord)
+        {
+            record = std::move(storedRecord);
+            ++mHits;
+            return;
+        }
+
+        it->second = record;
+    }
+
+    ++mMisses;
+
+    if (mRecords.size() >= std::max(mNextSweepSize, MIN_SWEEP_SIZE))
+        removeExpired();
+}
+
+void PostRecordStore::removeExpired()
+{
+    std::erase_if(mRecords, [](const auto& item){ return item.second.expired(); });
+
+    // Sweeping again when the store doubled keeps the amortized cost per record constant.
+    mNextSweepSize = mRecords.size() * 2;
+    qDebug() << "Removed expired post records, size:" << mRecords.size();
+}
+
+size_t PostRecordStore::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mRecords.size();
+}
+
+qint64 PostRecordStore::getHits() const
+{
+    QMutexLocker locker(&mMutex);
+    return mHits;
+}
+
+qint64 PostRecordStore::getMisses() const
+{
+    QMutexLocker locker(&mMutex);
+    return mMisses;
+}
+
+void PostRecordStore::logStats() const
+{
+    QMutexLocker locker(&mMutex);
+    qDebug() << "Post record store, size:" << mRecords.size() << "hits:" << mHits << "misses:" << mMisses;
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <atproto/lib/lexicon/app_bsky_feed.h>
+#include <QHashFunctions>
+#include <QMutex>
+#include <QString>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Store of post records shared by all post views with the same CID. The CID is
+// the hash of the record, so post views with the same CID have identical records.
+// A post that shows up in the timeline, threads, feeds, search results and
+// notifications holds its record (text, facets, embed references) only once.
+//
+// The views around a record (author, counts, viewer state) differ per request
+// and are not shared. Local changes like likes and reposts are kept once for all
+// models by LocalPostModelChanges. A record is released when the last post view
+// holding it is deleted. A shared record must not be modified.
+//
+// Posts are created on worker threads when feed pages are prepared, so the store
+// is thread safe.
+class PostRecordStore
+{
+public:
+    static PostRecordStore& instance();
+
+    // Replace the record of the post view by the stored record with the same CID.
+    // Store the record if there is none.
+    void intern(ATProto::AppBskyFeed::PostView& postView);
+
+    size_t size() const;
+    qint64 getHits() const;
+    qint64 getMisses() const;
+    void logStats() const;
+
+private:
+    using RecordWeakPtr = ATProto::AppBskyFeed::Record::Post::SharedPtr::weak_type;
+
+    PostRecordStore() = default;
+    void removeExpired();
+
+    mutable QMutex mMutex;
+    std::unordered_map<QString, RecordWeakPtr> mRecords; // key is CID
+    size_t mNextSweepSize = 0;
+    qint64 mHits = 0;
+    qint64 mMisses = 0;
+};
+
+}
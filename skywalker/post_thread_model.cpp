@@ -417,15 +417,15 @@ QVariant PostThreadModel::getData(int row, AbstractPostFeedModel::Role role)
     return data(index, (int)role);
 }
 
-void PostThreadModel::replyRestrictionChanged()
+void PostThreadModel::replyRestrictionChanged(const QString& cid)
 {
-    AbstractPostFeedModel::replyRestrictionChanged();
+    AbstractPostFeedModel::replyRestrictionChanged(cid);
     emit threadReplyRestrictionChanged();
 }
 
-void PostThreadModel::replyRestrictionListsChanged()
+void PostThreadModel::replyRestrictionListsChanged(const QString& cid)
 {
-    AbstractPostFeedModel::replyRestrictionListsChanged();
+    AbstractPostFeedModel::replyRestrictionListsChanged(cid);
     emit threadReplyRestrictionListsChanged();
 }
 
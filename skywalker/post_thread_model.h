@@ -43,8 +43,8 @@ signals:
     void threadReplyRestrictionListsChanged();
 
 protected:
-    virtual void replyRestrictionChanged() override;
-    virtual void replyRestrictionListsChanged() override;
+    virtual void replyRestrictionChanged(const QString& cid) override;
+    virtual void replyRestrictionListsChanged(const QString& cid) override;
 
 private:
     struct Page
@@ -249,13 +249,10 @@ void PostUtils::addThreadgate(const QString& uri, const QString& cid, bool allow
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid, threadgateUri, allowMention, allowFollowing, allowList, allowNobody, hiddenReplies](LocalPostModelChanges* model){
-                    model->updateThreadgateUri(cid, threadgateUri);
-                    model->updateReplyRestriction(cid, Post::makeReplyRestriction(allowMention, allowFollowing, !allowList.empty(), allowNobody));
-                    model->updateReplyRestrictionLists(cid, allowList);
-                    model->updateHiddenReplies(cid, hiddenReplies);
-                });
+            LocalPostModelChanges::updateThreadgateUri(cid, threadgateUri);
+            LocalPostModelChanges::updateReplyRestriction(cid, Post::makeReplyRestriction(allowMention, allowFollowing, !allowList.empty(), allowNobody));
+            LocalPostModelChanges::updateReplyRestrictionLists(cid, allowList);
+            LocalPostModelChanges::updateHiddenReplies(cid, hiddenReplies);
 
             emit threadgateOk();
         },
@@ -301,13 +298,10 @@ void PostUtils::undoThreadgate(const QString& threadgateUri, const QString& cid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateThreadgateUri(cid, "");
-                    model->updateReplyRestriction(cid, QEnums::REPLY_RESTRICTION_NONE);
-                    model->updateReplyRestrictionLists(cid, {});
-                    model->updateHiddenReplies(cid, {});
-                });
+            LocalPostModelChanges::updateThreadgateUri(cid, "");
+            LocalPostModelChanges::updateReplyRestriction(cid, QEnums::REPLY_RESTRICTION_NONE);
+            LocalPostModelChanges::updateReplyRestrictionLists(cid, {});
+            LocalPostModelChanges::updateHiddenReplies(cid, {});
 
             emit undoThreadgateOk();
         },
@@ -360,20 +354,7 @@ void PostUtils::detachQuote(const QString& postUri, const QString& embeddingUri,
 
             // The returned (uri, cid) is the embedding post
             qDebug() << "Detach quote succeeded:" << uri << cid << detached;
-            bool mustLoadReAttachedRecord = false;
-
-            mSkywalker->makeLocalModelChange(
-                [postUri, cid, detached, &mustLoadReAttachedRecord](LocalPostModelChanges* model){
-                    if (detached)
-                    {
-                        model->updateDetachedRecord(cid, postUri);
-                    }
-                    else
-                    {
-                        if (model->updateDetachedRecord(cid, {}))
-                            mustLoadReAttachedRecord = true;
-                    }
-                });
+            const bool mustLoadReAttachedRecord = LocalPostModelChanges::updateDetachedRecord(cid, detached ? postUri : QString{});
 
             if (mustLoadReAttachedRecord)
             {
@@ -461,10 +442,7 @@ void PostUtils::continueReAttachQuote(const QString& embeddingUri, int retries)
                 }
             }
 
-            mSkywalker->makeLocalModelChange(
-                [cid=postViewList[0]->mCid, recordView](LocalPostModelChanges* model){
-                    model->updateReAttachedRecord(cid, recordView);
-                });
+            LocalPostModelChanges::updateReAttachedRecord(postViewList[0]->mCid, recordView);
 
             emit detachQuoteOk(false);
         },
@@ -739,10 +717,7 @@ void PostUtils::continuePost(ATProto::AppBskyFeed::Record::Post::SharedPtr post)
 
             if (post->mReply && post->mReply->mParent)
             {
-                mSkywalker->makeLocalModelChange(
-                    [post](LocalPostModelChanges* model){
-                        model->updateReplyCountDelta(post->mReply->mParent->mCid, 1);
-                    });
+                LocalPostModelChanges::updateReplyCountDelta(post->mReply->mParent->mCid, 1);
             }
 
             if (post->mEmbed)
@@ -755,10 +730,7 @@ void PostUtils::continuePost(ATProto::AppBskyFeed::Record::Post::SharedPtr post)
 
                     if (record && record->mRecord)
                     {
-                        mSkywalker->makeLocalModelChange(
-                            [record](LocalPostModelChanges* model){
-                                model->updateQuoteCountDelta(record->mRecord->mCid, 1);
-                            });
+                        LocalPostModelChanges::updateQuoteCountDelta(record->mRecord->mCid, 1);
                     }
                 }
                 else if (post->mEmbed->mType == ATProto::AppBskyEmbed::EmbedType::RECORD_WITH_MEDIA)
@@ -770,10 +742,7 @@ void PostUtils::continuePost(ATProto::AppBskyFeed::Record::Post::SharedPtr post)
 
                     if (recordWithMedia && recordWithMedia->mRecord && recordWithMedia->mRecord->mRecord)
                     {
-                        mSkywalker->makeLocalModelChange(
-                            [recordWithMedia](LocalPostModelChanges* model){
-                                model->updateQuoteCountDelta(recordWithMedia->mRecord->mRecord->mCid, 1);
-                            });
+                        LocalPostModelChanges::updateQuoteCountDelta(recordWithMedia->mRecord->mRecord->mCid, 1);
                     }
                 }
             }
@@ -820,11 +789,8 @@ void PostUtils::continueRepost(const QString& uri, const QString& cid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid, repostUri](LocalPostModelChanges* model){
-                    model->updateRepostCountDelta(cid, 1);
-                    model->updateRepostUri(cid, repostUri);
-                });
+            LocalPostModelChanges::updateRepostCountDelta(cid, 1);
+            LocalPostModelChanges::updateRepostUri(cid, repostUri);
 
             emit repostOk();
         },
@@ -847,11 +813,8 @@ void PostUtils::undoRepost(const QString& repostUri, const QString& origPostCid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [origPostCid](LocalPostModelChanges* model){
-                    model->updateRepostCountDelta(origPostCid, -1);
-                    model->updateRepostUri(origPostCid, "");
-                });
+            LocalPostModelChanges::updateRepostCountDelta(origPostCid, -1);
+            LocalPostModelChanges::updateRepostUri(origPostCid, "");
 
             emit undoRepostOk();
         },
@@ -869,10 +832,7 @@ void PostUtils::like(const QString& uri, const QString& cid)
     if (!postMaster())
         return;
 
-    mSkywalker->makeLocalModelChange(
-        [cid](LocalPostModelChanges* model){
-            model->updateLikeTransient(cid, true);
-        });
+    LocalPostModelChanges::updateLikeTransient(cid, true);
 
 
     postMaster()->like(uri, cid,
@@ -880,12 +840,9 @@ void PostUtils::like(const QString& uri, const QString& cid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid, likeUri](LocalPostModelChanges* model){
-                    model->updateLikeCountDelta(cid, 1);
-                    model->updateLikeUri(cid, likeUri);
-                    model->updateLikeTransient(cid, false);
-                });
+            LocalPostModelChanges::updateLikeCountDelta(cid, 1);
+            LocalPostModelChanges::updateLikeUri(cid, likeUri);
+            LocalPostModelChanges::updateLikeTransient(cid, false);
 
             emit likeOk();
         },
@@ -895,10 +852,7 @@ void PostUtils::like(const QString& uri, const QString& cid)
 
             qDebug() << "Like failed:" << error << " - " << msg;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateLikeTransient(cid, false);
-                });
+            LocalPostModelChanges::updateLikeTransient(cid, false);
 
             emit likeFailed(msg);
         });
@@ -909,22 +863,16 @@ void PostUtils::undoLike(const QString& likeUri, const QString& cid)
     if (!postMaster())
         return;
 
-    mSkywalker->makeLocalModelChange(
-        [cid](LocalPostModelChanges* model){
-            model->updateLikeTransient(cid, true);
-        });
+    LocalPostModelChanges::updateLikeTransient(cid, true);
 
     postMaster()->undo(likeUri,
         [this, presence=getPresence(), cid]{
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateLikeCountDelta(cid, -1);
-                    model->updateLikeUri(cid, "");
-                    model->updateLikeTransient(cid, false);
-                });
+            LocalPostModelChanges::updateLikeCountDelta(cid, -1);
+            LocalPostModelChanges::updateLikeUri(cid, "");
+            LocalPostModelChanges::updateLikeTransient(cid, false);
 
             emit undoLikeOk();
         },
@@ -934,10 +882,7 @@ void PostUtils::undoLike(const QString& likeUri, const QString& cid)
 
             qDebug() << "Undo like failed:" << error << " - " << msg;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateLikeTransient(cid, false);
-                });
+            LocalPostModelChanges::updateLikeTransient(cid, false);
 
             emit undoLikeFailed(msg);
         });
@@ -953,10 +898,7 @@ void PostUtils::muteThread(const QString& uri)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [uri](LocalPostModelChanges* model){
-                    model->updateThreadMuted(uri, true);
-                });
+            LocalPostModelChanges::updateThreadMuted(uri, true);
 
             emit muteThreadOk();
         },
@@ -979,10 +921,7 @@ void PostUtils::unmuteThread(const QString& uri)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [uri](LocalPostModelChanges* model){
-                    model->updateThreadMuted(uri, false);
-                });
+            LocalPostModelChanges::updateThreadMuted(uri, false);
 
             emit unmuteThreadOk();
         },
@@ -1005,10 +944,7 @@ void PostUtils::deletePost(const QString& postUri, const QString& cid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updatePostDeleted(cid);
-                });
+            LocalPostModelChanges::updatePostDeleted(cid);
 
             emit postDeletedOk();
         },
@@ -1302,8 +1238,11 @@ void PostUtils::extractMentionsAndLinks(const QString& text, const QString& pree
     if (cursor < 0)
         cursor = text.size();
 
+    // The preedit text is not part of the text document, so the change is derived
+    // from the previous text instead of taken from the document.
     const QString fullText = text.sliced(0, cursor) + preeditText + text.sliced(cursor);
-    const auto facets = ATProto::RichTextMaster::parseFacets(fullText);
+    mFacetParser.setText(fullText);
+    const auto& facets = mFacetParser.getFacets();
 
     int preeditCursor = cursor + preeditText.length();
     bool editMentionFound = false;
@@ -5,6 +5,7 @@
 #include "facet_highlighter.h"
 #include "generator_view.h"
 #include "image_reader.h"
+#include "incremental_facet_parser.h"
 #include "link_card.h"
 #include "list_view.h"
 #include "postgate.h"
@@ -212,6 +213,7 @@ private:
     int mLinkShorteningReduction = 0;
     std::unique_ptr<ImageReader> mImageReader;
     FacetHighlighter mFacetHighlighter;
+    IncrementalFacetParser mFacetParser;
     bool mPickingPhoto = false;
 };
 
@@ -0,0 +1,179 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "profile_batcher.h"
+#include <atproto/lib/client.h>
+#include <QDebug>
+
+namespace Skywalker {
+
+ProfileBatcher::ProfileBatcher(const GetProfilesFun& getProfiles, std::chrono::milliseconds window,
+                               std::chrono::milliseconds retryDelay, QObject* parent) :
+    QObject(parent),
+    mGetProfiles(getProfiles),
+    mRetryDelay(retryDelay)
+{
+    Q_ASSERT(mGetProfiles);
+    mWindowTimer.setSingleShot(true);
+    mWindowTimer.setInterval(window);
+    connect(&mWindowTimer, &QTimer::timeout, this, [this]{ flush(); });
+}
+
+bool ProfileBatcher::request(const QString& did)
+{
+    if (did.isEmpty() || mPendingDids.contains(did))
+        return false;
+
+    mPendingDids.insert(did);
+    mQueue.push_back(did);
+
+    if ((int)mQueue.size() >= MAX_BATCH_SIZE)
+        flush();
+    else if (!mWindowTimer.isActive())
+        mWindowTimer.start();
+
+    return true;
+}
+
+bool ProfileBatcher::isPending(const QString& did) const
+{
+    return mPendingDids.contains(did);
+}
+
+void ProfileBatcher::clear()
+{
+    mWindowTimer.stop();
+    mQueue.clear();
+    mPendingDids.clear();
+    ++mGeneration;
+}
+
+void ProfileBatcher::flush()
+{
+    mWindowTimer.stop();
+
+    // Responses may come in synchronously and add new requests to the queue.
+    std::vector<QString> queue;
+    queue.swap(mQueue);
+
+    mRequestedDidCount += queue.size();
+
+    for (size_t start = 0; start < queue.size(); start += MAX_BATCH_SIZE)
+    {
+        const size_t end = std::min(start + MAX_BATCH_SIZE, queue.size());
+        sendBatch(std::vector<QString>(queue.begin() + start, queue.begin() + end));
+    }
+}
+
+void ProfileBatcher::sendBatch(std::vector<QString> dids, int retry)
+{
+    if (retry == 0)
+    {
+        ++mRequestCount;
+        ++mBatchSizes[(int)dids.size()];
+    }
+    else
+    {
+        ++mRetryCount;
+    }
+
+    qDebug() << "Get profiles, batch size:" << dids.size() << "retry:" << retry;
+
+    mGetProfiles(dids,
+        [this, presence=getPresence(), generation=mGeneration, dids](ProfileList profiles){
+            if (!presence || generation != mGeneration)
+                return;
+
+            std::unordered_set<QString> missingDids(dids.begin(), dids.end());
+
+            for (const auto& profile : profiles)
+            {
+                missingDids.erase(profile->mDid);
+                mPendingDids.erase(profile->mDid);
+                emit profileReceived(profile);
+            }
+
+            // Profiles of deleted or deactivated accounts are left out of the response.
+            for (const auto& did : missingDids)
+            {
+                mPendingDids.erase(did);
+                emit profileFailed(did, "NotFound", "Profile not found");
+            }
+        },
+        [this, presence=getPresence(), generation=mGeneration, dids, retry](const QString& error, const QString& msg){
+            if (!presence || generation != mGeneration)
+                return;
+
+            qDebug() << "Get profiles failed:" << error << " - " << msg << "batch size:" << dids.size() << "retry:" << retry;
+
+            // An invalid DID makes the whole batch fail.
+            if (error == ATProto::ATProtoErrorMsg::INVALID_REQUEST)
+            {
+                splitBatch(dids, error, msg);
+                return;
+            }
+
+            // A network or server error says nothing about the DIDs themselves.
+            if (isTransientError(error) && retry < MAX_RETRIES)
+            {
+                const auto delay = mRetryDelay * (1 << retry);
+
+                QTimer::singleShot(delay, this, [this, generation, dids, retry]{
+                    if (generation == mGeneration)
+                        sendBatch(dids, retry + 1);
+                });
+
+                return;
+            }
+
+            for (const auto& did : dids)
+            {
+                mPendingDids.erase(did);
+                emit requestFailed(did, error, msg);
+            }
+        });
+}
+
+void ProfileBatcher::splitBatch(const std::vector<QString>& dids, const QString& error, const QString& msg)
+{
+    if (dids.size() == 1)
+    {
+        const QString& did = dids.front();
+        mPendingDids.erase(did);
+        emit profileFailed(did, error, msg);
+        return;
+    }
+
+    const auto half = dids.begin() + dids.size() / 2;
+    sendBatch(std::vector<QString>(dids.begin(), half));
+    sendBatch(std::vector<QString>(half, dids.end()));
+}
+
+bool ProfileBatcher::isTransientError(const QString& error)
+{
+    return error != ATProto::ATProtoErrorMsg::INVALID_REQUEST &&
+           error != ATProto::ATProtoErrorMsg::EXPIRED_TOKEN &&
+           error != ATProto::ATProtoErrorMsg::INVALID_TOKEN &&
+           error != "NoClient";
+}
+
+double ProfileBatcher::getAverageBatchSize() const
+{
+    int batchCount = 0;
+    qint64 didCount = 0;
+
+    for (const auto& [size, count] : mBatchSizes)
+    {
+        batchCount += count;
+        didCount += qint64(size) * count;
+    }
+
+    return batchCount > 0 ? double(didCount) / batchCount : 0.0;
+}
+
+void ProfileBatcher::logStats() const
+{
+    qDebug() << "Profile batcher requests:" << mRequestCount << "retries:" << mRetryCount << "DIDs:" << mRequestedDidCount
+             << "average batch size:" << getAverageBatchSize() << "batch sizes:" << mBatchSizes;
+}
+
+}
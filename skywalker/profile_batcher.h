@@ -0,0 +1,84 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "presence.h"
+#include <atproto/lib/lexicon/app_bsky_actor.h>
+#include <QObject>
+#include <QTimer>
+#include <chrono>
+#include <map>
+#include <unordered_set>
+
+namespace Skywalker {
+
+// Collects profile requests for a short time and gets them with as few
+// getProfiles calls as possible. A DID that is already queued or in flight
+// is not requested again. A request failing on a network or server error is
+// retried with backoff. A batch rejected as invalid is split to single out the
+// DID causing it.
+class ProfileBatcher : public QObject, public Presence
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_BATCH_SIZE = 25; // max actors for app.bsky.actor.getProfiles
+    static constexpr std::chrono::milliseconds DEFAULT_WINDOW{50};
+    static constexpr std::chrono::milliseconds DEFAULT_RETRY_DELAY{1000}; // doubles with every retry
+    static constexpr int MAX_RETRIES = 3;
+
+    using ProfileList = ATProto::AppBskyActor::ProfileViewDetailedList;
+    using SuccessCb = std::function<void(ProfileList)>;
+    using ErrorCb = std::function<void(const QString& error, const QString& msg)>;
+    using GetProfilesFun = std::function<void(const std::vector<QString>& dids, const SuccessCb&, const ErrorCb&)>;
+
+    explicit ProfileBatcher(const GetProfilesFun& getProfiles, std::chrono::milliseconds window = DEFAULT_WINDOW,
+                            std::chrono::milliseconds retryDelay = DEFAULT_RETRY_DELAY, QObject* parent = nullptr);
+
+    // Returns false if the DID is already queued or in flight.
+    bool request(const QString& did);
+
+    bool isPending(const QString& did) const;
+
+    // Drop the queued requests. Responses for requests in flight are ignored.
+    void clear();
+
+    // Send the queued requests now.
+    void flush();
+
+    int getRequestCount() const { return mRequestCount; } // retries not included
+    int getRetryCount() const { return mRetryCount; }
+    qint64 getRequestedDidCount() const { return mRequestedDidCount; }
+    double getAverageBatchSize() const;
+    const std::map<int, int>& getBatchSizes() const { return mBatchSizes; } // size -> count
+    void logStats() const;
+
+signals:
+    void profileReceived(ATProto::AppBskyActor::ProfileViewDetailed::SharedPtr profile);
+
+    // The DID was not returned by a successful request, or a request for
+    // only this DID was rejected as invalid.
+    void profileFailed(const QString& did, const QString& error, const QString& msg);
+
+    // The request for the DID failed for a reason unrelated to the DID, also
+    // after retrying. The DID can be requested again.
+    void requestFailed(const QString& did, const QString& error, const QString& msg);
+
+private:
+    void sendBatch(std::vector<QString> dids, int retry = 0);
+    void splitBatch(const std::vector<QString>& dids, const QString& error, const QString& msg);
+    static bool isTransientError(const QString& error);
+
+    GetProfilesFun mGetProfiles;
+    std::chrono::milliseconds mRetryDelay;
+    std::vector<QString> mQueue;
+    std::unordered_set<QString> mPendingDids; // queued or in flight
+    QTimer mWindowTimer;
+    int mGeneration = 0; // responses from an older generation are ignored
+
+    int mRequestCount = 0;
+    int mRetryCount = 0;
+    qint64 mRequestedDidCount = 0;
+    std::map<int, int> mBatchSizes;
+};
+
+}
@@ -25,17 +25,49 @@ void ProfileStore::add(const BasicProfile& profile)
         return;
 
     mDidProfileMap[did] = profile;
+    changed();
 }
 
 void ProfileStore::remove(const QString& did)
 {
     qDebug() << "Remove profile:" << did;
     mDidProfileMap.erase(did);
+    changed();
 }
 
 void ProfileStore::clear()
 {
     mDidProfileMap.clear();
+    changed();
+}
+
+void ProfileStore::changed()
+{
+    ++mVersion;
+
+    if (mChangedCb)
+        mChangedCb();
+}
+
+ProfileStoreSnapshot::SharedPtr ProfileStore::createSnapshot() const
+{
+    return std::make_shared<ProfileStoreSnapshot>(mDidProfileMap);
+}
+
+ProfileStoreSnapshot::ProfileStoreSnapshot(const std::unordered_map<QString, BasicProfile>& didProfileMap) :
+    mDidProfileMap(didProfileMap)
+{
+}
+
+bool ProfileStoreSnapshot::contains(const QString& did) const
+{
+    return mDidProfileMap.count(did);
+}
+
+const BasicProfile* ProfileStoreSnapshot::get(const QString& did) const
+{
+    auto it = mDidProfileMap.find(did);
+    return it != mDidProfileMap.end() ? &it->second : nullptr;
 }
 
 size_t ProfileStore::size()
@@ -3,6 +3,7 @@
 #pragma once
 #include "profile.h"
 #include "profile_matcher.h"
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
@@ -17,6 +18,22 @@ public:
     virtual const BasicProfile* get(const QString& did) const = 0;
 };
 
+// Immutable copy of a profile store that can be read from any thread.
+class ProfileStoreSnapshot : public IProfileStore
+{
+public:
+    using SharedPtr = std::shared_ptr<const ProfileStoreSnapshot>;
+
+    explicit ProfileStoreSnapshot(const std::unordered_map<QString, BasicProfile>& didProfileMap);
+
+    bool contains(const QString& did) const override;
+    const BasicProfile* get(const QString& did) const override;
+    size_t size() const { return mDidProfileMap.size(); }
+
+private:
+    const std::unordered_map<QString, BasicProfile> mDidProfileMap;
+};
+
 class ProfileStore : public IProfileStore
 {
 public:
@@ -27,8 +44,20 @@ public:
     virtual void clear();
     size_t size();
 
+    // The version changes with every modification.
+    quint64 getVersion() const { return mVersion; }
+    ProfileStoreSnapshot::SharedPtr createSnapshot() const;
+
+    // Called after every modification.
+    using ChangedCb = std::function<void()>;
+    void setChangedCb(const ChangedCb& changedCb) { mChangedCb = changedCb; }
+
 private:
+    void changed();
+
     std::unordered_map<QString, BasicProfile> mDidProfileMap;
+    quint64 mVersion = 0;
+    ChangedCb mChangedCb;
 };
 
 class ProfileListItemStore : public ProfileStore
@@ -313,10 +313,7 @@ void ProfileUtils::setPinnedPost(const QString& did, const QString& uri, const Q
 
             if (profile->mPinnedPost)
             {
-                mSkywalker->makeLocalModelChange(
-                    [profile](LocalPostModelChanges* model){
-                        model->updateViewerStatePinned(profile->mPinnedPost->mCid, false);
-                    });
+                LocalPostModelChanges::updateViewerStatePinned(profile->mPinnedPost->mCid, false);
             }
 
             continueSetPinnedPost(profile->mDid, uri, cid);
@@ -340,10 +337,7 @@ void ProfileUtils::continueSetPinnedPost(const QString& did, const QString& uri,
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateViewerStatePinned(cid, true);
-                });
+            LocalPostModelChanges::updateViewerStatePinned(cid, true);
 
             emit setPinnedPostOk(uri, cid);
         },
@@ -366,10 +360,7 @@ void ProfileUtils::clearPinnedPost(const QString& did, const QString& cid)
             if (!presence)
                 return;
 
-            mSkywalker->makeLocalModelChange(
-                [cid](LocalPostModelChanges* model){
-                    model->updateViewerStatePinned(cid, false);
-                });
+            LocalPostModelChanges::updateViewerStatePinned(cid, false);
 
             emit clearPinnedPostOk();
         },
@@ -65,6 +65,7 @@ public:
     QString getUri() const;
     QString getCid() const;
     QString getText() const override;
+    QString getIndexKey() const override { return getCid(); }
     QString getFormattedText() const;
     BasicProfile getAuthor() const;
     QDateTime getIndexedAt() const;
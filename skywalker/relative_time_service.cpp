@@ -0,0 +1,128 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "relative_time_service.h"
+#include <QDebug>
+#include <optional>
+
+using namespace std::chrono_literals;
+
+namespace Skywalker {
+
+std::unique_ptr<RelativeTimeService> RelativeTimeService::sInstance;
+
+RelativeTimeService& RelativeTimeService::instance()
+{
+    if (!sInstance)
+        sInstance = std::unique_ptr<RelativeTimeService>(new RelativeTimeService);
+
+    return *sInstance;
+}
+
+RelativeTimeService::RelativeTimeService(QObject* parent) :
+    QObject(parent)
+{
+    mTimer.setSingleShot(true);
+    mTimer.setTimerType(Qt::CoarseTimer);
+    connect(&mTimer, &QTimer::timeout, this, [this]{ refresh(); });
+}
+
+void RelativeTimeService::addClient(Client* client)
+{
+    Q_ASSERT(client);
+    mClients.insert(client);
+    reschedule();
+}
+
+void RelativeTimeService::removeClient(Client* client)
+{
+    mClients.erase(client);
+
+    if (mClients.empty())
+        mTimer.stop();
+}
+
+void RelativeTimeService::reschedule()
+{
+    if (mRescheduleScheduled || mPaused)
+        return;
+
+    mRescheduleScheduled = true;
+
+    QTimer::singleShot(0, this, [this]{
+        mRescheduleScheduled = false;
+        scheduleNextRefresh();
+    });
+}
+
+void RelativeTimeService::pause()
+{
+    qDebug() << "Pause relative time refresh";
+    mPaused = true;
+    mTimer.stop();
+}
+
+void RelativeTimeService::resume()
+{
+    if (!mPaused)
+        return;
+
+    qDebug() << "Resume relative time refresh";
+    mPaused = false;
+
+    // Times have moved on while paused.
+    refresh();
+}
+
+void RelativeTimeService::refresh()
+{
+    if (mPaused)
+        return;
+
+    for (auto* client : mClients)
+        client->refreshRelativeTime();
+
+    scheduleNextRefresh();
+}
+
+void RelativeTimeService::scheduleNextRefresh()
+{
+    if (mPaused)
+        return;
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    std::optional<std::chrono::milliseconds> delay;
+
+    for (const auto* client : mClients)
+    {
+        const QDateTime timestamp = client->getYoungestVisibleTimestamp();
+
+        if (!timestamp.isValid())
+            continue;
+
+        const auto clientDelay = getRefreshDelay(now - timestamp);
+
+        if (!delay || clientDelay < *delay)
+            delay = clientDelay;
+    }
+
+    if (!delay)
+    {
+        mTimer.stop();
+        return;
+    }
+
+    mTimer.start(*delay);
+}
+
+std::chrono::milliseconds RelativeTimeService::getRefreshDelay(std::chrono::milliseconds age)
+{
+    if (age < 0ms)
+        age = 0ms;
+
+    const std::chrono::milliseconds unit = age < 1min ? 1s : (age < 1h ? 1min : 1h);
+
+    // Labels are rounded to the nearest unit, so they change half way a unit.
+    return unit - (age + unit / 2) % unit;
+}
+
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QDateTime>
+#include <QObject>
+#include <QTimer>
+#include <chrono>
+#include <unordered_set>
+
+namespace Skywalker {
+
+// Refreshes relative times ("5s", "3m", "2h") shown for the visible items of
+// models. A single timer serves all models. The timer fires when the label of
+// the youngest visible item changes: every second for items younger than a
+// minute, every minute for items younger than an hour, hourly otherwise.
+class RelativeTimeService : public QObject
+{
+    Q_OBJECT
+
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Signal that the relative times of the visible items have changed.
+        virtual void refreshRelativeTime() = 0;
+
+        // Returns the timestamp of the youngest visible item. Invalid if there
+        // are no visible items.
+        virtual QDateTime getYoungestVisibleTimestamp() const = 0;
+    };
+
+    static RelativeTimeService& instance();
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    // Compute the next refresh time at the next event loop iteration, e.g. after
+    // the visible items of a client have changed.
+    void reschedule();
+
+    void pause();
+    void resume();
+    bool isPaused() const { return mPaused; }
+    bool isActive() const { return mTimer.isActive(); }
+
+    // Time till the relative time label of an item with this age changes.
+    static std::chrono::milliseconds getRefreshDelay(std::chrono::milliseconds age);
+
+private:
+    explicit RelativeTimeService(QObject* parent = nullptr);
+
+    void refresh();
+    void scheduleNextRefresh();
+
+    std::unordered_set<Client*> mClients;
+    QTimer mTimer;
+    bool mRescheduleScheduled = false;
+    bool mPaused = false;
+
+    static std::unique_ptr<RelativeTimeService> sInstance;
+};
+
+}
@@ -0,0 +1,164 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QtGlobal>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace Skywalker {
+
+// Ordered map from row index to a value, for values attached to some rows of a
+// list model. When rows get inserted or removed, the rows of the entries after
+// that point must be shifted.
+//
+// Entries are stored relative to a base offset. A shift from the first row only
+// changes the offset. A shift from another row moves the entries at the side of
+// the shift point with the fewest rows, and changes the offset if that is the
+// side before the shift point.
+template<typename T>
+class RowIndexMap
+{
+public:
+    bool empty() const { return mEntries.empty(); }
+    size_t size() const { return mEntries.size(); }
+
+    void clear()
+    {
+        mEntries.clear();
+        mOffset = 0;
+    }
+
+    void insert(size_t row, T value)
+    {
+        mEntries.insert_or_assign(toKey(row), std::move(value));
+    }
+
+    void erase(size_t row)
+    {
+        mEntries.erase(toKey(row));
+    }
+
+    // Erase the entries at rows > row
+    void eraseAfter(size_t row)
+    {
+        mEntries.erase(mEntries.upper_bound(toKey(row)), mEntries.end());
+    }
+
+    // Erase the entries at rows >= row
+    void eraseFrom(size_t row)
+    {
+        mEntries.erase(mEntries.lower_bound(toKey(row)), mEntries.end());
+    }
+
+    // Erase the entries at rows <= row
+    void eraseUpTo(size_t row)
+    {
+        mEntries.erase(mEntries.begin(), mEntries.upper_bound(toKey(row)));
+    }
+
+    const T* find(size_t row) const
+    {
+        const auto it = mEntries.find(toKey(row));
+        return it != mEntries.end() ? &it->second : nullptr;
+    }
+
+    // The map must not be empty.
+    size_t lastRow() const { return toRow(mEntries.rbegin()->first); }
+    const T& last() const { return mEntries.rbegin()->second; }
+
+    // Returns the row of the first entry at a row >= row
+    std::optional<size_t> lowerBound(size_t row) const
+    {
+        const auto it = mEntries.lower_bound(toKey(row));
+
+        if (it == mEntries.end())
+            return {};
+
+        return toRow(it->first);
+    }
+
+    // Returns the row of the first entry for which pred(row, value) is true
+    template<typename Pred>
+    std::optional<size_t> findRow(Pred pred) const
+    {
+        for (const auto& [key, value] : mEntries)
+        {
+            if (pred(toRow(key), value))
+                return toRow(key);
+        }
+
+        return {};
+    }
+
+    template<typename Fun>
+    void forEach(Fun fun) const
+    {
+        for (const auto& [key, value] : mEntries)
+            fun(toRow(key), value);
+    }
+
+    // Add offset to the rows >= startRow. If an entry is moved onto the row of
+    // another entry, then the moved entry is kept.
+    void shift(size_t startRow, int offset)
+    {
+        if (offset == 0 || mEntries.empty())
+            return;
+
+        const qint64 startKey = toKey(startRow);
+
+        if (mEntries.rbegin()->first < startKey)
+            return;
+
+        if (mEntries.begin()->first >= startKey)
+        {
+            mOffset += offset;
+            return;
+        }
+
+        if (startRow <= lastRow() - startRow)
+        {
+            // Moving the rows before startRow in the opposite direction and
+            // changing the offset is the same as moving the rows after.
+            std::vector<typename Map::node_type> nodes;
+
+            for (auto it = mEntries.begin(); it != mEntries.end() && it->first < startKey; )
+                nodes.push_back(mEntries.extract(it++));
+
+            mOffset += offset;
+
+            for (auto& node : nodes)
+            {
+                node.key() -= offset;
+                mEntries.insert(std::move(node));
+            }
+        }
+        else
+        {
+            std::vector<typename Map::node_type> nodes;
+
+            for (auto it = mEntries.lower_bound(startKey); it != mEntries.end(); )
+                nodes.push_back(mEntries.extract(it++));
+
+            for (auto& node : nodes)
+            {
+                node.key() += offset;
+                auto result = mEntries.insert(std::move(node));
+
+                if (!result.inserted)
+                    result.position->second = std::move(result.node.mapped());
+            }
+        }
+    }
+
+private:
+    using Map = std::map<qint64, T>; // row - offset -> value
+
+    qint64 toKey(size_t row) const { return qint64(row) - mOffset; }
+    size_t toRow(qint64 key) const { return size_t(key + mOffset); }
+
+    Map mEntries;
+    qint64 mOffset = 0;
+};
+
+}
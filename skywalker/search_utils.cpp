@@ -2,6 +2,7 @@
 // License: GPLv3
 #include "search_utils.h"
 #include "skywalker.h"
+#include "unicode_fonts.h"
 #include "utils.h"
 #include <QTextBoundaryFinder>
 
@@ -37,8 +38,93 @@ static std::vector<QString> combineSingleCharsToWords(const std::vector<QString>
     return combinedWords;
 }
 
+static bool isAsciiWordChar(char16_t c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool isAsciiLetter(char16_t c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isAsciiDigit(char16_t c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Returns the end of the word segment starting at start according to the
+// Unicode word boundary rules (UAX #29) restricted to ASCII:
+// - letters, digits and underscores join (WB5, WB8-10, WB13a-b)
+// - letters join over a single : . or ' (WB6-7)
+// - digits join over a single , ; . or ' (WB11-12)
+static qsizetype asciiWordEnd(QStringView text, qsizetype start)
+{
+    qsizetype end = start + 1;
+
+    while (end < text.size())
+    {
+        const char16_t prev = text[end - 1].unicode();
+        const char16_t c = text[end].unicode();
+
+        if (isAsciiWordChar(c))
+        {
+            ++end;
+            continue;
+        }
+
+        if (end + 1 >= text.size())
+            break;
+
+        const char16_t next = text[end + 1].unicode();
+        const bool midNumLet = (c == '.' || c == '\'');
+
+        if (isAsciiLetter(prev) && isAsciiLetter(next) && (midNumLet || c == ':'))
+            end += 2;
+        else if (isAsciiDigit(prev) && isAsciiDigit(next) && (midNumLet || c == ',' || c == ';'))
+            end += 2;
+        else
+            break;
+    }
+
+    return end;
+}
+
+// Same result as the QTextBoundaryFinder word items for ASCII text. A word
+// starts with a letter or digit.
+static std::vector<QString> getAsciiWords(const QString& text)
+{
+    std::vector<QString> words;
+    qsizetype pos = 0;
+
+    while (pos < text.size())
+    {
+        const char16_t c = text[pos].unicode();
+
+        if (!isAsciiWordChar(c))
+        {
+            ++pos;
+            continue;
+        }
+
+        const qsizetype end = asciiWordEnd(text, pos);
+
+        // A segment starting with an underscore is not a word.
+        if (c != '_')
+            words.push_back(text.sliced(pos, end - pos));
+
+        pos = end;
+    }
+
+    return words;
+}
+
 QString SearchUtils::normalizeText(const QString& text)
 {
+    // For ASCII the decomposition and removal of diacritics change nothing.
+    if (UnicodeFonts::isAscii(text))
+        return text.toLower();
+
     return ATProto::RichTextMaster::normalizeText(text);
 }
 
@@ -60,6 +146,9 @@ std::vector<QString> SearchUtils::getWords(const QString& text)
     if (text.isEmpty())
         return {};
 
+    if (UnicodeFonts::isAscii(text))
+        return getAsciiWords(text);
+
     std::vector<QString> words;
     QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Word, text);
     int startWordPos = 0;
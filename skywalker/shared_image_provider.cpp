@@ -19,13 +19,14 @@ SharedImageProvider* SharedImageProvider::getProvider(const QString& name)
 
 SharedImageProvider::SharedImageProvider(const QString& name) :
     QQuickImageProvider(QQuickImageProvider::Image),
+    mImages(name),
     mName(name)
 {
 }
 
 SharedImageProvider::~SharedImageProvider()
 {
-    Q_ASSERT(mImages.empty());
+    Q_ASSERT(mImages.size() == 0);
 }
 
 QString SharedImageProvider::getIdFromSource(const QString& source) const
@@ -49,9 +50,10 @@ QString SharedImageProvider::addImage(const QImage& image)
 {
     QMutexLocker locker(&mMutex);
     QString id = QString("SharedImg_%1").arg(mNextId++);
-    mImages[id] = image;
+    mImages.pin(id);
+    mImages.put(id, image);
     QString source = QString("image://%1/%2").arg(mName, id);
-    qDebug() << "Added img source:" << source << "total:" << mImages.size();
+    qDebug() << "Added img source:" << source << "total:" << mImages.size() << "bytes:" << mImages.getBytes();
     return source;
 }
 
@@ -62,9 +64,8 @@ void SharedImageProvider::removeImage(const QString& source)
     if (id.isEmpty())
         return;
 
-    QMutexLocker locker(&mMutex);
-    mImages.erase(id);
-    qDebug() << "Removed source:" << source << "id:" << id << "total:" << mImages.size();
+    mImages.remove(id);
+    qDebug() << "Removed source:" << source << "id:" << id << "total:" << mImages.size() << "bytes:" << mImages.getBytes();
 }
 
 QImage SharedImageProvider::getImage(const QString& source)
@@ -74,16 +75,12 @@ QImage SharedImageProvider::getImage(const QString& source)
     if (id.isEmpty())
         return {};
 
-    QMutexLocker locker(&mMutex);
-    const auto it = mImages.find(id);
+    const QImage img = mImages.get(id);
 
-    if (it == mImages.end())
-    {
+    if (img.isNull())
         qWarning() << "Image not found:" << source;
-        return {};
-    }
 
-    return it->second;
+    return img;
 }
 
 void SharedImageProvider::replaceImage(const QString& source, const QImage& image)
@@ -93,29 +90,23 @@ void SharedImageProvider::replaceImage(const QString& source, const QImage& imag
     if (id.isEmpty())
         return;
 
-    QMutexLocker locker(&mMutex);
-    const auto it = mImages.find(id);
-
-    if (it == mImages.end())
+    if (!mImages.contains(id))
     {
         qWarning() << "Image not found:" << source;
         return;
     }
 
-    mImages[id] = image;
+    mImages.put(id, image);
     qDebug() << "Replaced image for source:" << source << "id:" << id;
 }
 
 QImage SharedImageProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
 {
-    QMutexLocker locker(&mMutex);
-    const auto it = mImages.find(id);
+    QImage img = mImages.get(id);
 
-    if (it == mImages.end())
+    if (img.isNull())
         return {};
 
-    QImage img = it->second;
-
     if (size)
         *size = img.size();
 
@@ -1,6 +1,7 @@
 // Copyright (C) 2023 Michel de Boer
 // License: GPLv3
 #pragma once
+#include "image_cache.h"
 #include <QHashFunctions>
 #include <QMutex>
 #include <QQuickImageProvider>
@@ -24,12 +25,18 @@ public:
     void replaceImage(const QString& source, const QImage& image);
 
     QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+    void logStats() const { mImages.logStats(); }
 
 private:
     QString getIdFromSource(const QString& source) const;
 
-    QMutex mMutex;
-    std::unordered_map<QString, QImage> mImages; // id -> image
+    QMutex mMutex; // for mNextId
+
+    // The images are pinned from addImage till removeImage, as there is no other
+    // copy of them. The budget does not bound them, the owners of the sources
+    // must remove them. The cache keeps track of the bytes held and warns when
+    // they exceed the budget.
+    ImageCache mImages; // id -> image
     int mNextId = 1;
     QString mName;
 
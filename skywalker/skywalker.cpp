@@ -1,16 +1,22 @@
 // Copyright (C) 2023 Michel de Boer
 // License: GPLv3
 #include "skywalker.h"
+#include "atproto_image_provider.h"
 #include "author_cache.h"
 #include "chat.h"
 #include "file_utils.h"
 #include "focus_hashtags.h"
 #include "jni_callback.h"
+#include "link_card_cache.h"
 #include "offline_message_checker.h"
+#include "post_record_store.h"
 #include "photo_picker.h"
+#include "relative_time_service.h"
 #include "shared_image_provider.h"
 #include "temp_file_holder.h"
 #include "utils.h"
+#include "word_index_cache.h"
+#include "word_token.h"
 #include <atproto/lib/at_uri.h>
 #include <QClipboard>
 #include <QGuiApplication>
@@ -51,6 +57,7 @@ Skywalker::Skywalker(QObject* parent) :
     mBookmarks(this),
     mMutedWords(this),
     mFocusHashtags(new FocusHashtags(this)),
+    mFilterSnapshots(mContentFilter, mMutedWords, *mFocusHashtags, mUserFollows, mMutedReposts, this),
     mNotificationListModel(mContentFilter, mBookmarks, mMutedWords, this),
     mChat(std::make_unique<Chat>(mBsky, mUserDid, this)),
     mUserHashtags(USER_HASHTAG_INDEX_SIZE),
@@ -63,6 +70,9 @@ Skywalker::Skywalker(QObject* parent) :
 {
     mBookmarks.setSkywalker(this);
     mTimelineModel.setIsHomeFeed(true);
+    mTimelineModel.setFilterSnapshots(&mFilterSnapshots);
+    mUserFollows.setChangedCb([this]{ mFilterSnapshots.invalidate(); });
+    mMutedReposts.setChangedCb([this]{ mFilterSnapshots.invalidate(); });
     connect(&mBookmarks, &Bookmarks::sizeChanged, this, [this]{ mBookmarks.save(); });
     connect(mChat.get(), &Chat::settingsFailed, this, [this](QString error){ showStatusMessage(error, QEnums::STATUS_LEVEL_ERROR); });
     connect(&mRefreshTimer, &QTimer::timeout, this, [this]{ refreshSession(); });
@@ -106,6 +116,7 @@ Skywalker::Skywalker(QObject* parent) :
 Skywalker::~Skywalker()
 {
     saveHashtags();
+    LinkCardCache::instance().flush();
     Q_ASSERT(mPostThreadModels.empty());
     Q_ASSERT(mAuthorFeedModels.empty());
     Q_ASSERT(mSearchPostFeedModels.empty());
@@ -291,6 +302,13 @@ void Skywalker::switchUser(const QString& did)
     mUserSettings.setActiveUserDid(did);
 }
 
+void Skywalker::removeUser(const QString& did)
+{
+    qDebug() << "Remove user:" << did;
+    mUserSettings.removeUser(did);
+    mTimelineStore.remove(did);
+}
+
 void Skywalker::startTimelineAutoUpdate()
 {
     qDebug() << "Start timeline auto update";
@@ -472,6 +490,7 @@ void Skywalker::getUserPreferences()
     mBsky->getPreferences(
         [this](auto prefs){
             mUserPreferences = prefs;
+            mFilterSnapshots.invalidate();
             updateFavoriteFeeds();
             initLabelers();
             loadLabelSettings();
@@ -570,6 +589,7 @@ void Skywalker::saveUserPreferences(const ATProto::UserPreferences& prefs, std::
         [this, prefs, okCb]{
             qDebug() << "saveUserPreferences ok";
             mUserPreferences = prefs;
+            mFilterSnapshots.invalidate();
 
             if (okCb)
                 okCb();
@@ -721,6 +741,7 @@ void Skywalker::dataMigration()
 void Skywalker::syncTimeline(int maxPages)
 {
     const auto timestamp = getSyncTimestamp();
+    mTimelineStore.open(mUserDid);
 
     if (!timestamp.isValid() || !mUserSettings.getRewindToLastSeenPost(mUserDid))
     {
@@ -730,10 +751,99 @@ void Skywalker::syncTimeline(int maxPages)
         return;
     }
 
+    if (restoreTimeline(timestamp))
+        return;
+
     disableDebugLogging(); // sync can cause a lot of logging
     syncTimeline(timestamp, maxPages);
 }
 
+bool Skywalker::restoreTimeline(QDateTime tillTimestamp)
+{
+    Q_ASSERT(tillTimestamp.isValid());
+    auto segments = mTimelineStore.load();
+
+    if (segments.empty())
+    {
+        qDebug() << "No stored timeline";
+        return false;
+    }
+
+    qInfo() << "Restore timeline:" << tillTimestamp << "segments:" << segments.size();
+    disableDebugLogging(); // restore can cause a lot of logging
+    mTimelineModel.clear();
+
+    // Replaying the segments in the order they were received rebuilds the timeline
+    // including its gaps.
+    for (auto& segment : segments)
+    {
+        switch (segment.mType)
+        {
+        case TimelineStore::SegmentType::APPEND:
+            mTimelineModel.addFeed(std::move(segment.mFeed));
+            break;
+        case TimelineStore::SegmentType::PREPEND:
+            mTimelineModel.prependFeed(std::move(segment.mFeed));
+            break;
+        case TimelineStore::SegmentType::GAP_FILL:
+        {
+            const int gapId = mTimelineModel.findGapId(segment.mGapCursor);
+
+            if (gapId > 0)
+                mTimelineModel.gapFillFeed(std::move(segment.mFeed), gapId);
+            else
+                qDebug() << "Gap not found:" << segment.mGapCursor;
+
+            break;
+        }
+        case TimelineStore::SegmentType::GAP:
+            mTimelineModel.addGapPlaceHolder(segment.mGapCursor);
+            break;
+        }
+    }
+
+    restoreDebugLogging();
+    const auto lastTimestamp = mTimelineModel.lastTimestamp();
+
+    if (lastTimestamp.isNull() || lastTimestamp >= tillTimestamp)
+    {
+        qInfo() << "Stored timeline does not reach:" << tillTimestamp << "last:" << lastTimestamp;
+        mTimelineModel.clear();
+        mTimelineStore.clear();
+        return false;
+    }
+
+    const auto index = mTimelineModel.findTimestamp(tillTimestamp);
+    qInfo() << "Timeline restored, last timestamp:" << lastTimestamp << "index:" << index
+            << "feed size:" << mTimelineModel.rowCount();
+
+    if (mTimelineStore.needsCompaction())
+        compactTimelineStore();
+
+    finishTimelineSync(index);
+
+    // Only the posts since the timeline was stored need to be fetched.
+    getTimelinePrepend(2);
+    return true;
+}
+
+void Skywalker::storeTimelinePage(TimelineStore::SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor)
+{
+    if (feed.mFeed.empty())
+        return;
+
+    mTimelineStore.append(type, feed, gapCursor);
+}
+
+void Skywalker::compactTimelineStore()
+{
+    if (!mTimelineStore.isOpen())
+        return;
+
+    const auto segments = mTimelineModel.getStoreSegments(TimelineStore::MAX_COMPACTED_POSTS);
+    mTimelineStore.compact(segments);
+}
+
 void Skywalker::syncTimeline(QDateTime tillTimestamp, int maxPages, const QString& cursor)
 {
     Q_ASSERT(mBsky);
@@ -749,6 +859,10 @@ void Skywalker::syncTimeline(QDateTime tillTimestamp, int maxPages, const QStrin
     setGetTimelineInProgress(true);
     mBsky->getTimeline(TIMELINE_SYNC_PAGE_SIZE, Utils::makeOptionalString(cursor),
         [this, tillTimestamp, maxPages, cursor](auto feed){
+            if (cursor.isEmpty())
+                mTimelineStore.clear();
+
+            storeTimelinePage(TimelineStore::SegmentType::APPEND, *feed);
             mTimelineModel.addFeed(std::move(feed));
             setGetTimelineInProgress(false);
             const auto lastTimestamp = mTimelineModel.lastTimestamp();
@@ -861,25 +975,28 @@ void Skywalker::getTimeline(int limit, int maxPages, int minEntries, const QStri
     setGetTimelineInProgress(true);
     mBsky->getTimeline(limit, Utils::makeOptionalString(cursor),
        [this, maxPages, minEntries, cursor](auto feed){
-            setGetTimelineInProgress(false);
-            int addedPosts = 0;
+            // The page is added when it has been prepared on a worker thread.
+            const int oldRowCount = cursor.isEmpty() ? 0 : mTimelineModel.rowCount();
+            const auto feedAdded = [this, maxPages, minEntries, oldRowCount]{
+                setGetTimelineInProgress(false);
+                const int addedPosts = mTimelineModel.rowCount() - oldRowCount;
+                const int postsToAdd = minEntries - addedPosts;
+
+                if (postsToAdd > 0)
+                    getTimelineNextPage(maxPages - 1, postsToAdd);
+            };
 
             if (cursor.isEmpty())
             {
-                mTimelineModel.setFeed(std::move(feed));
-                addedPosts = mTimelineModel.rowCount();
+                mTimelineStore.clear();
+                storeTimelinePage(TimelineStore::SegmentType::APPEND, *feed);
+                mTimelineModel.setFeedAsync(std::move(feed), feedAdded);
             }
             else
             {
-                const int oldRowCount = mTimelineModel.rowCount();
-                mTimelineModel.addFeed(std::move(feed));
-                addedPosts = mTimelineModel.rowCount() - oldRowCount;
+                storeTimelinePage(TimelineStore::SegmentType::APPEND, *feed);
+                mTimelineModel.addFeedAsync(std::move(feed), feedAdded);
             }
-
-            const int postsToAdd = minEntries - addedPosts;
-
-            if (postsToAdd > 0)
-                getTimelineNextPage(maxPages - 1, postsToAdd);
        },
        [this](const QString& error, const QString& msg){
             qInfo() << "getTimeline FAILED:" << error << " - " << msg;
@@ -911,17 +1028,22 @@ void Skywalker::getTimelinePrepend(int autoGapFill, int pageSize)
 
     mBsky->getTimeline(pageSize, {},
         [this, autoGapFill](auto feed){
-            const int gapId = mTimelineModel.prependFeed(std::move(feed));
-            setGetTimelineInProgress(false);
-            setAutoUpdateTimelineInProgress(false);
+            storeTimelinePage(TimelineStore::SegmentType::PREPEND, *feed);
+            mTimelineModel.prependFeedAsync(std::move(feed), [this, autoGapFill](int gapId){
+                setGetTimelineInProgress(false);
+                setAutoUpdateTimelineInProgress(false);
 
-            if (gapId > 0)
-            {
-                if (autoGapFill > 0)
-                    getTimelineForGap(gapId, autoGapFill - 1);
-                else
-                    qDebug() << "Gap created, no auto gap fill";
-            }
+                if (mTimelineStore.needsCompaction())
+                    compactTimelineStore();
+
+                if (gapId > 0)
+                {
+                    if (autoGapFill > 0)
+                        getTimelineForGap(gapId, autoGapFill - 1);
+                    else
+                        qDebug() << "Gap created, no auto gap fill";
+                }
+            });
         },
         [this](const QString& error, const QString& msg){
             qWarning() << "getTimelinePrepend FAILED:" << error << " - " << msg;
@@ -963,26 +1085,28 @@ void Skywalker::getTimelineForGap(int gapId, int autoGapFill, bool userInitiated
     setGetTimelineInProgress(true);
     const int pageSize = userInitiated ? TIMELINE_GAP_FILL_SIZE : TIMELINE_ADD_PAGE_SIZE;
     mBsky->getTimeline(pageSize, cur,
-        [this, gapId, autoGapFill, userInitiated](auto feed){
+        [this, gapId, autoGapFill, userInitiated, gapCursor=*cur](auto feed){
+            storeTimelinePage(TimelineStore::SegmentType::GAP_FILL, *feed, gapCursor);
             mTimelineModel.clearLastInsertedRowIndex();
-            const int newGapId = mTimelineModel.gapFillFeed(std::move(feed), gapId);
-            setGetTimelineInProgress(false);
+            mTimelineModel.gapFillFeedAsync(std::move(feed), gapId, [this, autoGapFill, userInitiated](int newGapId){
+                setGetTimelineInProgress(false);
 
-            if (userInitiated)
-            {
-                const int gapEndIndex = mTimelineModel.getLastInsertedRowIndex();
+                if (userInitiated)
+                {
+                    const int gapEndIndex = mTimelineModel.getLastInsertedRowIndex();
 
-                if (gapEndIndex >= 0)
-                    emit gapFilled(gapEndIndex);
-            }
+                    if (gapEndIndex >= 0)
+                        emit gapFilled(gapEndIndex);
+                }
 
-            if (newGapId > 0)
-            {
-                if (autoGapFill > 0)
-                    getTimelineForGap(newGapId, autoGapFill - 1, userInitiated);
-                else
-                    qDebug() << "Gap created, no auto gap fill";
-            }
+                if (newGapId > 0)
+                {
+                    if (autoGapFill > 0)
+                        getTimelineForGap(newGapId, autoGapFill - 1, userInitiated);
+                    else
+                        qDebug() << "Gap created, no auto gap fill";
+                }
+            });
         },
         [this](const QString& error, const QString& msg){
             qWarning() << "getTimelineForGap FAILED:" << error << " - " << msg;
@@ -1011,6 +1135,7 @@ void Skywalker::getTimelineNextPage(int maxPages, int minEntries)
     {
         qInfo() << "Time line size:" << mTimelineModel.rowCount() << "remove head posts:" << TIMELINE_ADD_PAGE_SIZE;
         mTimelineModel.removeHeadPosts(TIMELINE_ADD_PAGE_SIZE);
+        compactTimelineStore();
     }
 
     getTimeline(TIMELINE_ADD_PAGE_SIZE, maxPages, minEntries, cursor);
@@ -1368,6 +1493,8 @@ void Skywalker::timelineMovementEnded(int firstVisibleIndex, int lastVisibleInde
     if (mSignOutInProgress)
         return;
 
+    mTimelineModel.setVisibleRange(firstVisibleIndex, lastVisibleIndex);
+
     if (lastVisibleIndex > -1)
     {
         if (firstVisibleIndex > -1)
@@ -1379,7 +1506,10 @@ void Skywalker::timelineMovementEnded(int firstVisibleIndex, int lastVisibleInde
     const int maxTailSize = mTimelineModel.hasFilters() ? PostFeedModel::MAX_TIMELINE_SIZE * 0.6 : TIMELINE_DELETE_SIZE * 2;
 
     if (lastVisibleIndex > -1 && mTimelineModel.rowCount() - lastVisibleIndex > maxTailSize)
+    {
         mTimelineModel.removeTailPosts(mTimelineModel.rowCount() - lastVisibleIndex - (maxTailSize - TIMELINE_DELETE_SIZE));
+        compactTimelineStore();
+    }
 
     if (lastVisibleIndex > mTimelineModel.rowCount() - 5 && !mGetTimelineInProgress)
         getTimelineNextPage();
@@ -1451,7 +1581,9 @@ void Skywalker::removePostThreadModel(int id)
 
 void Skywalker::updatePostIndexedSecondsAgo()
 {
-    makeLocalModelChange([](LocalPostModelChanges* model){ model->updatePostIndexedSecondsAgo(); });
+    // Post feed models with a known visible range also get refreshed by the
+    // RelativeTimeService. This refreshes the others.
+    LocalPostModelChanges::updateAllPostIndexedSecondsAgo();
 }
 
 void Skywalker::makeLocalModelChange(const std::function<void(LocalProfileChanges*)>& update)
@@ -1487,34 +1619,6 @@ void Skywalker::makeLocalModelChange(const std::function<void(LocalProfileChange
         update(model.get());
 }
 
-void Skywalker::makeLocalModelChange(const std::function<void(LocalPostModelChanges*)>& update)
-{
-    // Apply change to all active models. When a model gets refreshed (after clear)
-    // or deleted, then the local changes will disapper.
-
-    update(&mTimelineModel);
-    mTimelineModel.makeLocalFilteredModelChange(update);
-    update(&mNotificationListModel);
-
-    for (auto& [_, model] : mPostThreadModels.items())
-        update(model.get());
-
-    for (auto& [_, model] : mAuthorFeedModels.items())
-        update(model.get());
-
-    for (auto& [_, model] : mSearchPostFeedModels.items())
-        update(model.get());
-
-    for (auto& [_, model] : mPostFeedModels.items())
-    {
-        update(model.get());
-        model->makeLocalFilteredModelChange(update);
-    }
-
-    if (mBookmarksModel)
-        update(mBookmarksModel.get());
-}
-
 void Skywalker::makeLocalModelChange(const std::function<void(LocalAuthorModelChanges*)>& update)
 {
     for (auto& [_, model] : mAuthorListModels.items())
@@ -3186,6 +3290,13 @@ void Skywalker::pauseApp()
     }
 
     saveHashtags();
+    WordIndexCache::instance().logStats();
+    PostRecordStore::instance().logStats();
+    AuthorCache::instance().logStats();
+    SharedImageProvider::getProvider(SharedImageProvider::SHARED_IMAGE)->logStats();
+    ATProtoImageProvider::getProvider(ATProtoImageProvider::DRAFT_IMAGE)->logStats();
+    RelativeTimeService::instance().pause();
+    LinkCardCache::instance().flush();
     mUserSettings.setOfflineUnread(mUserDid, mUnreadNotificationCount);
     mUserSettings.setOfflineMessageCheckTimestamp(QDateTime{});
     mUserSettings.setOffLineChatCheckRev(mUserDid, mChat->getLastRev());
@@ -3208,6 +3319,7 @@ void Skywalker::pauseApp()
 void Skywalker::resumeApp()
 {
     qDebug() << "Resume app";
+    RelativeTimeService::instance().resume();
 
     if (mBsky && mBsky->getSession())
     {
@@ -3301,6 +3413,7 @@ void Skywalker::signOut()
     qDebug() << "Logout:" << mUserDid;
     mSignOutInProgress = true;
     saveHashtags();
+    LinkCardCache::instance().flush();
 
     stopTimelineAutoUpdate();
     stopRefreshTimers();
@@ -3321,6 +3434,9 @@ void Skywalker::signOut()
     mEditUserPreferences = nullptr;
     mGlobalContentGroupListModel = nullptr;
     mTimelineModel.clear();
+    mTimelineStore.remove(mUserDid);
+    WordIndexCache::instance().logStats();
+    WordIndexCache::instance().clear();
     mUserDid.clear();
     mUserProfile = {};
     mAnniversary.setFirstAppearance({});
@@ -3332,10 +3448,14 @@ void Skywalker::signOut()
     mBookmarks.clear();
     mMutedWords.clear();
     mFocusHashtags->clear();
+
+    // All token users have been cleared.
+    WordTokenInterner::instance().reset();
     mUserHashtags.clear();
     mSeenHashtags.clear();
     mFavoriteFeeds.clear();
     mContentFilter.clear();
+    mFilterSnapshots.invalidate();
     mUserSettings.setActiveUserDid({});
     mTimelineSynced = false;
     setAutoUpdateTimelineInProgress(false);
@@ -12,6 +12,7 @@
 #include "edit_user_preferences.h"
 #include "favorite_feeds.h"
 #include "feed_list_model.h"
+#include "filter_snapshot.h"
 #include "hashtag_index.h"
 #include "item_store.h"
 #include "labeler.h"
@@ -23,6 +24,7 @@
 #include "profile_store.h"
 #include "search_post_feed_model.h"
 #include "starter_pack_list_model.h"
+#include "timeline_store.h"
 #include "user_settings.h"
 #include <atproto/lib/client.h>
 #include <atproto/lib/plc_directory_client.h>
@@ -78,6 +80,7 @@ public:
     Q_INVOKABLE bool resumeSession(bool retry = false);
     Q_INVOKABLE void deleteSession();
     Q_INVOKABLE void switchUser(const QString& did);
+    Q_INVOKABLE void removeUser(const QString& did);
     Q_INVOKABLE void getUserProfileAndFollows();
     Q_INVOKABLE void getUserPreferences();
     Q_INVOKABLE void dataMigration();
@@ -191,7 +194,6 @@ public:
     Q_INVOKABLE void signOut();
 
     void makeLocalModelChange(const std::function<void(LocalProfileChanges*)>& update);
-    void makeLocalModelChange(const std::function<void(LocalPostModelChanges*)>& update);
     void makeLocalModelChange(const std::function<void(LocalAuthorModelChanges*)>& update);
     void makeLocalModelChange(const std::function<void(LocalFeedModelChanges*)>& update);
     void makeLocalModelChange(const std::function<void(LocalListModelChanges*)>& update);
@@ -224,8 +226,12 @@ public:
     int getUnreadNotificationCount() const { return mUnreadNotificationCount; }
     void setUnreadNotificationCount(int unread);
     void addToUnreadNotificationCount(int addUnread);
+
     IndexedProfileStore& getUserFollows() { return mUserFollows; }
     ProfileListItemStore& getMutedReposts() { return mMutedReposts; }
+
+    // Thread safe
+    FilterSnapshot::SharedPtr getFilterSnapshot() const { return mFilterSnapshots.getSnapshot(); }
     ATProto::Client* getBskyClient() const { return mBsky.get(); }
     ATProto::PlcDirectoryClient& getPlcDirectory() { return mPlcDirectory; }
     HashtagIndex& getUserHashtags() { return mUserHashtags; }
@@ -295,6 +301,9 @@ private:
     void getListListMutes(int limit, int maxPages, int minEntries, const QString& cursor, int modelId);
     void signalGetUserProfileOk(ATProto::AppBskyActor::ProfileView::SharedPtr user);
     void syncTimeline(QDateTime tillTimestamp, int maxPages = 40, const QString& cursor = {});
+    bool restoreTimeline(QDateTime tillTimestamp);
+    void storeTimelinePage(TimelineStore::SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor = {});
+    void compactTimelineStore();
     void finishTimelineSync(int index);
     void finishTimelineSyncFailed();
     void updatePostIndexedSecondsAgo();
@@ -347,6 +356,7 @@ private:
     MutedWords mMutedWords;
     MutedWordsNoMutes mMutedWordsNoMutes;
     std::unique_ptr<FocusHashtags> mFocusHashtags;
+    FilterSnapshotPublisher mFilterSnapshots;
 
     bool mAutoUpdateTimelineInProgress = false;
     bool mGetTimelineInProgress = false;
@@ -385,6 +395,7 @@ private:
     Anniversary mAnniversary;
     std::unique_ptr<DraftPostsMigration> mDraftPostsMigration;
     PostFeedModel mTimelineModel;
+    TimelineStore mTimelineStore;
     bool mTimelineSynced = false;
     bool mDebugLogging = false;
 };
@@ -0,0 +1,241 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "software_video_encoder.h"
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <limits>
+
+namespace Skywalker {
+
+static constexpr quint32 MOVIE_TIME_SCALE = 1000;
+static constexpr quint32 FIXED_ONE = 0x00010000; // 16.16 fixed point
+
+static QByteArray createAtom(const char* type, const QByteArray& payload)
+{
+    QByteArray atom;
+    QDataStream out(&atom, QIODevice::WriteOnly);
+    out << quint32(8 + payload.size());
+    out.writeRawData(type, 4);
+    out.writeRawData(payload.constData(), payload.size());
+    return atom;
+}
+
+static void writeMatrix(QDataStream& out)
+{
+    out << FIXED_ONE << quint32(0) << quint32(0)
+        << quint32(0) << FIXED_ONE << quint32(0)
+        << quint32(0) << quint32(0) << quint32(0x40000000);
+}
+
+static void writeZeros(QDataStream& out, int count)
+{
+    for (int i = 0; i < count; ++i)
+        out << quint8(0);
+}
+
+SoftwareVideoEncoder::~SoftwareVideoEncoder()
+{
+    if (mFile.isOpen())
+        close();
+}
+
+bool SoftwareVideoEncoder::open(const QString& fileName, int width, int height, int fps, int quality)
+{
+    qDebug() << "file:" << fileName << "width:" << width << "height:" << height << "fps:" << fps << "quality:" << quality;
+    Q_ASSERT(!mFile.isOpen());
+    Q_ASSERT(width > 0 && height > 0 && fps > 0);
+    mWidth = width;
+    mHeight = height;
+    mFps = fps;
+    mQuality = quality;
+    mFrameSizes.clear();
+    mFrameOffsets.clear();
+    mFile.setFileName(fileName);
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qWarning() << "Cannot open video file:" << fileName << mFile.errorString();
+        return false;
+    }
+
+    QByteArray ftyp;
+    QDataStream ftypOut(&ftyp, QIODevice::WriteOnly);
+    ftypOut.writeRawData("qt  ", 4);
+    ftypOut << quint32(0x20050300);
+    ftypOut.writeRawData("qt  ", 4);
+    mFile.write(createAtom("ftyp", ftyp));
+
+    // The size of the media data gets filled in on close.
+    mMdatOffset = mFile.pos();
+    mFile.write(createAtom("mdat", {}));
+    return true;
+}
+
+QByteArray SoftwareVideoEncoder::compressFrame(const QImage& frame, int quality)
+{
+    QByteArray jpg;
+    QBuffer buffer(&jpg);
+    buffer.open(QIODevice::WriteOnly);
+
+    if (!frame.convertedTo(QImage::Format_RGB888).save(&buffer, "jpg", quality))
+    {
+        qWarning() << "Failed to compress frame";
+        return {};
+    }
+
+    return jpg;
+}
+
+bool SoftwareVideoEncoder::push(const QByteArray& compressedFrame)
+{
+    Q_ASSERT(mFile.isOpen());
+
+    if (compressedFrame.isEmpty())
+    {
+        qWarning() << "Empty frame:" << mFrameSizes.size();
+        return false;
+    }
+
+    const qint64 offset = mFile.pos();
+
+    if (offset + compressedFrame.size() > std::numeric_limits<quint32>::max())
+    {
+        qWarning() << "Video file too large:" << offset;
+        return false;
+    }
+
+    if (mFile.write(compressedFrame) != compressedFrame.size())
+    {
+        qWarning() << "Failed to write frame:" << mFrameSizes.size() << mFile.errorString();
+        return false;
+    }
+
+    mFrameOffsets.push_back(quint32(offset));
+    mFrameSizes.push_back(quint32(compressedFrame.size()));
+    return true;
+}
+
+bool SoftwareVideoEncoder::close()
+{
+    if (!mFile.isOpen())
+        return false;
+
+    const qint64 mdatEnd = mFile.pos();
+    mFile.seek(mMdatOffset);
+    QDataStream sizeOut(&mFile);
+    sizeOut << quint32(mdatEnd - mMdatOffset);
+    mFile.seek(mdatEnd);
+
+    const bool ok = mFile.write(createMovieAtom()) > 0;
+    mFile.close();
+    qDebug() << "Video closed:" << mFile.fileName() << "frames:" << mFrameSizes.size() << "ok:" << ok;
+    return ok;
+}
+
+QByteArray SoftwareVideoEncoder::createMovieAtom() const
+{
+    const quint32 frameCount = mFrameSizes.size();
+    const quint32 movieDuration = quint32(qint64(frameCount) * MOVIE_TIME_SCALE / mFps);
+
+    QByteArray mvhd;
+    QDataStream mvhdOut(&mvhd, QIODevice::WriteOnly);
+    mvhdOut << quint32(0) // version, flags
+            << quint32(0) << quint32(0) // creation, modification time
+            << MOVIE_TIME_SCALE << movieDuration
+            << FIXED_ONE << quint16(0x0100); // rate, volume
+    writeZeros(mvhdOut, 10);
+    writeMatrix(mvhdOut);
+    writeZeros(mvhdOut, 24); // preview, poster, selection, current time
+    mvhdOut << quint32(2); // next track ID
+
+    QByteArray tkhd;
+    QDataStream tkhdOut(&tkhd, QIODevice::WriteOnly);
+    tkhdOut << quint32(0x00000003) // version, flags: enabled, in movie
+            << quint32(0) << quint32(0) // creation, modification time
+            << quint32(1) << quint32(0) // track ID, reserved
+            << movieDuration;
+    writeZeros(tkhdOut, 8);
+    tkhdOut << quint16(0) << quint16(0) << quint16(0) << quint16(0); // layer, alternate group, volume, reserved
+    writeMatrix(tkhdOut);
+    tkhdOut << quint32(mWidth) * FIXED_ONE << quint32(mHeight) * FIXED_ONE;
+
+    QByteArray mdhd;
+    QDataStream mdhdOut(&mdhd, QIODevice::WriteOnly);
+    mdhdOut << quint32(0) << quint32(0) << quint32(0) // version, flags, creation, modification
+            << quint32(mFps) << frameCount // time scale, duration: each frame takes 1 unit
+            << quint16(0) << quint16(0); // language, quality
+
+    QByteArray mediaHdlr;
+    QDataStream mediaHdlrOut(&mediaHdlr, QIODevice::WriteOnly);
+    mediaHdlrOut << quint32(0);
+    mediaHdlrOut.writeRawData("mhlrvide", 8);
+    writeZeros(mediaHdlrOut, 13); // manufacturer, flags, flags mask, empty name
+
+    QByteArray vmhd;
+    QDataStream vmhdOut(&vmhd, QIODevice::WriteOnly);
+    vmhdOut << quint32(0x00000001) << quint16(0x0040); // version, flags, graphics mode: copy
+    writeZeros(vmhdOut, 6); // opcolor
+
+    QByteArray dataHdlr;
+    QDataStream dataHdlrOut(&dataHdlr, QIODevice::WriteOnly);
+    dataHdlrOut << quint32(0);
+    dataHdlrOut.writeRawData("dhlralis", 8);
+    writeZeros(dataHdlrOut, 13);
+
+    QByteArray dref;
+    QDataStream drefOut(&dref, QIODevice::WriteOnly);
+    drefOut << quint32(0) << quint32(1) // version, flags, entry count
+            << quint32(12);
+    drefOut.writeRawData("alis", 4);
+    drefOut << quint32(0x00000001); // data is in this file
+
+    QByteArray stsd;
+    QDataStream stsdOut(&stsd, QIODevice::WriteOnly);
+    stsdOut << quint32(0) << quint32(1) << quint32(86); // version, flags, entry count, entry size
+    stsdOut.writeRawData("jpeg", 4);
+    writeZeros(stsdOut, 6);
+    stsdOut << quint16(1) // data reference index
+            << quint16(0) << quint16(0) << quint32(0) // version, revision, vendor
+            << quint32(0) << quint32(512) // temporal, spatial quality
+            << quint16(mWidth) << quint16(mHeight)
+            << quint32(72 * FIXED_ONE) << quint32(72 * FIXED_ONE) // resolution: 72 dpi
+            << quint32(0) << quint16(1); // data size, frames per sample
+    const QByteArray compressorName = "Photo - JPEG";
+    stsdOut << quint8(compressorName.size());
+    stsdOut.writeRawData(compressorName.constData(), compressorName.size());
+    writeZeros(stsdOut, 31 - compressorName.size());
+    stsdOut << quint16(24) << qint16(-1); // depth, color table ID: none
+
+    QByteArray stts;
+    QDataStream sttsOut(&stts, QIODevice::WriteOnly);
+    sttsOut << quint32(0) << quint32(1) << frameCount << quint32(1);
+
+    QByteArray stsc;
+    QDataStream stscOut(&stsc, QIODevice::WriteOnly);
+    stscOut << quint32(0) << quint32(1) << quint32(1) << quint32(1) << quint32(1); // each frame is a chunk
+
+    QByteArray stsz;
+    QDataStream stszOut(&stsz, QIODevice::WriteOnly);
+    stszOut << quint32(0) << quint32(0) << frameCount;
+
+    for (const quint32 size : mFrameSizes)
+        stszOut << size;
+
+    QByteArray stco;
+    QDataStream stcoOut(&stco, QIODevice::WriteOnly);
+    stcoOut << quint32(0) << frameCount;
+
+    for (const quint32 offset : mFrameOffsets)
+        stcoOut << offset;
+
+    const QByteArray stbl = createAtom("stsd", stsd) + createAtom("stts", stts) + createAtom("stsc", stsc) +
+                            createAtom("stsz", stsz) + createAtom("stco", stco);
+    const QByteArray minf = createAtom("vmhd", vmhd) + createAtom("hdlr", dataHdlr) +
+                            createAtom("dinf", createAtom("dref", dref)) + createAtom("stbl", stbl);
+    const QByteArray mdia = createAtom("mdhd", mdhd) + createAtom("hdlr", mediaHdlr) + createAtom("minf", minf);
+    const QByteArray trak = createAtom("tkhd", tkhd) + createAtom("mdia", mdia);
+    return createAtom("moov", createAtom("mvhd", mvhd) + createAtom("trak", trak));
+}
+
+}
@@ -0,0 +1,45 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QFile>
+#include <QImage>
+
+namespace Skywalker {
+
+// Portable video encoder for platforms without a hardware encoder. Frames are
+// compressed as JPEG (Motion-JPEG) and stored in a QuickTime (.mov) container.
+class SoftwareVideoEncoder
+{
+public:
+    static constexpr int DEFAULT_QUALITY = 85;
+    static constexpr char const* FILE_EXTENSION = "mov";
+
+    ~SoftwareVideoEncoder();
+
+    bool open(const QString& fileName, int width, int height, int fps, int quality = DEFAULT_QUALITY);
+    bool close();
+    bool isOpen() const { return mFile.isOpen(); }
+
+    // Compresses a frame. Thread safe, frames can be compressed in parallel.
+    static QByteArray compressFrame(const QImage& frame, int quality = DEFAULT_QUALITY);
+
+    // Frames must be pushed in order.
+    bool push(const QByteArray& compressedFrame);
+
+    int getFrameCount() const { return (int)mFrameSizes.size(); }
+    int getQuality() const { return mQuality; }
+
+private:
+    QByteArray createMovieAtom() const;
+
+    QFile mFile;
+    int mWidth = 0;
+    int mHeight = 0;
+    int mFps = 0;
+    int mQuality = DEFAULT_QUALITY;
+    qint64 mMdatOffset = 0;
+    std::vector<quint32> mFrameSizes;
+    std::vector<quint32> mFrameOffsets;
+};
+
+}
@@ -0,0 +1,377 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "timeline_store.h"
+#include "file_utils.h"
+#include <atproto/lib/xjson.h>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace Skywalker {
+
+static constexpr const char* TIMELINE_SUB_PATH = "timeline";
+static constexpr const char* TIMELINE_FILE_EXTENSION = "tl";
+static constexpr char MAGIC[4] = { 'S', 'K', 'T', 'L' };
+static constexpr qint64 HEADER_SIZE = 8;
+static constexpr qint64 SEGMENT_HEADER_SIZE = 10;
+
+TimelineStore::TimelineStore(const QString& dirPath) :
+    mDirPath(dirPath)
+{
+}
+
+TimelineStore::~TimelineStore()
+{
+    close();
+}
+
+QString TimelineStore::getFileName(const QString& did) const
+{
+    QString dirPath = mDirPath.isEmpty() ? FileUtils::getAppDataPath(TIMELINE_SUB_PATH) : mDirPath;
+
+    if (dirPath.isEmpty())
+        return {};
+
+    // A DID contains colons that are not allowed in file names on all platforms.
+    QString baseName = did;
+    baseName.replace(':', '_');
+    return QString("%1/%2.%3").arg(dirPath, baseName, TIMELINE_FILE_EXTENSION);
+}
+
+bool TimelineStore::open(const QString& did)
+{
+    if (isOpen() && did == mDid)
+        return true;
+
+    close();
+
+    if (did.isEmpty())
+    {
+        qWarning() << "No DID";
+        return false;
+    }
+
+    const QString fileName = getFileName(did);
+
+    if (fileName.isEmpty())
+    {
+        qWarning() << "Cannot determine timeline store file name:" << did;
+        return false;
+    }
+
+    mFile.setFileName(fileName);
+
+    if (!mFile.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "Cannot open timeline store:" << fileName << mFile.errorString();
+        return false;
+    }
+
+    mDid = did;
+    const qint64 fileSize = mFile.size();
+    bool validHeader = false;
+
+    if (fileSize >= HEADER_SIZE)
+    {
+        const QByteArray header = mFile.read(HEADER_SIZE);
+        validHeader = header == createHeader();
+
+        if (!validHeader)
+            qInfo() << "Timeline store has different version, discard:" << fileName;
+    }
+
+    if (!validHeader)
+    {
+        if (!writeHeader())
+        {
+            close();
+            return false;
+        }
+
+        qDebug() << "Created timeline store:" << fileName;
+        return true;
+    }
+
+    uchar* data = mFile.map(0, fileSize);
+
+    if (!data)
+    {
+        qWarning() << "Cannot map timeline store:" << fileName << mFile.errorString();
+        close();
+        return false;
+    }
+
+    const qint64 validSize = parseSegments(data, fileSize, nullptr);
+    mFile.unmap(data);
+
+    if (validSize < fileSize)
+    {
+        qWarning() << "Timeline store truncated:" << fileName << "valid size:" << validSize << "file size:" << fileSize;
+        mFile.resize(validSize);
+    }
+
+    mFile.seek(validSize);
+    qDebug() << "Opened timeline store:" << fileName << "segments:" << mSegmentCount << "size:" << validSize;
+    return true;
+}
+
+void TimelineStore::close()
+{
+    if (mFile.isOpen())
+    {
+        qDebug() << "Close timeline store:" << mFile.fileName();
+        mFile.close();
+    }
+
+    mDid.clear();
+    mSegmentCount = 0;
+}
+
+QByteArray TimelineStore::createHeader() const
+{
+    QByteArray header(MAGIC, sizeof(MAGIC));
+    const quint32 version = qToLittleEndian(VERSION);
+    header.append((const char*)&version, sizeof(version));
+    return header;
+}
+
+bool TimelineStore::writeHeader()
+{
+    mSegmentCount = 0;
+
+    if (!mFile.resize(0) || !mFile.seek(0))
+    {
+        qWarning() << "Cannot reset timeline store:" << mFile.fileName() << mFile.errorString();
+        return false;
+    }
+
+    if (mFile.write(createHeader()) != HEADER_SIZE)
+    {
+        qWarning() << "Cannot write timeline store header:" << mFile.fileName() << mFile.errorString();
+        return false;
+    }
+
+    mFile.flush();
+    return true;
+}
+
+QByteArray TimelineStore::createSegment(SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor) const
+{
+    QJsonArray jsonFeed;
+
+    for (const auto& feedViewPost : feed.mFeed)
+        jsonFeed.append(feedViewPost->toJson());
+
+    QJsonObject json;
+    json.insert("feed", jsonFeed);
+
+    if (feed.mCursor && !feed.mCursor->isEmpty())
+        json.insert("cursor", *feed.mCursor);
+
+    if (!gapCursor.isEmpty())
+        json.insert("gapCursor", gapCursor);
+
+    const QByteArray payload = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    const quint32 segmentType = qToLittleEndian(quint32(type));
+    const quint32 payloadSize = qToLittleEndian(quint32(payload.size()));
+    const quint16 checksum = qToLittleEndian(qChecksum(payload));
+
+    QByteArray segment;
+    segment.reserve(SEGMENT_HEADER_SIZE + payload.size());
+    segment.append((const char*)&segmentType, sizeof(segmentType));
+    segment.append((const char*)&payloadSize, sizeof(payloadSize));
+    segment.append((const char*)&checksum, sizeof(checksum));
+    segment.append(payload);
+    return segment;
+}
+
+qint64 TimelineStore::parseSegments(const uchar* data, qint64 size, std::vector<Segment>* segments)
+{
+    mSegmentCount = 0;
+    qint64 offset = HEADER_SIZE;
+
+    while (offset + SEGMENT_HEADER_SIZE <= size)
+    {
+        const quint32 segmentType = qFromLittleEndian<quint32>(data + offset);
+        const quint32 payloadSize = qFromLittleEndian<quint32>(data + offset + 4);
+        const quint16 checksum = qFromLittleEndian<quint16>(data + offset + 8);
+        const qint64 payloadOffset = offset + SEGMENT_HEADER_SIZE;
+
+        if (segmentType < quint32(SegmentType::APPEND) || segmentType > quint32(SegmentType::GAP))
+        {
+            qWarning() << "Invalid segment type:" << segmentType << "offset:" << offset;
+            break;
+        }
+
+        if (payloadOffset + payloadSize > size)
+        {
+            qWarning() << "Truncated segment, offset:" << offset << "size:" << payloadSize;
+            break;
+        }
+
+        const QByteArray payload = QByteArray::fromRawData((const char*)data + payloadOffset, payloadSize);
+
+        if (qChecksum(payload) != checksum)
+        {
+            qWarning() << "Checksum error, offset:" << offset;
+            break;
+        }
+
+        if (segments)
+        {
+            QJsonParseError error;
+            const QJsonDocument json = QJsonDocument::fromJson(payload, &error);
+
+            if (error.error != QJsonParseError::NoError)
+            {
+                qWarning() << "Invalid JSON in segment:" << error.errorString() << "offset:" << offset;
+                break;
+            }
+
+            try {
+                Segment segment;
+                segment.mType = SegmentType(segmentType);
+                segment.mGapCursor = json.object().value("gapCursor").toString();
+                segment.mFeed = ATProto::AppBskyFeed::OutputFeed::fromJson(json);
+                segments->push_back(std::move(segment));
+            } catch (ATProto::InvalidJsonException& e) {
+                qWarning() << "Segment format error:" << e.msg() << "offset:" << offset;
+                break;
+            }
+        }
+
+        ++mSegmentCount;
+        offset = payloadOffset + payloadSize;
+    }
+
+    return offset;
+}
+
+std::vector<TimelineStore::Segment> TimelineStore::load()
+{
+    std::vector<Segment> segments;
+
+    if (!isOpen())
+    {
+        qWarning() << "Timeline store not open";
+        return segments;
+    }
+
+    const qint64 fileSize = mFile.size();
+
+    if (fileSize <= HEADER_SIZE)
+        return segments;
+
+    uchar* data = mFile.map(0, fileSize);
+
+    if (!data)
+    {
+        qWarning() << "Cannot map timeline store:" << mFile.fileName() << mFile.errorString();
+        return segments;
+    }
+
+    const qint64 validSize = parseSegments(data, fileSize, &segments);
+    mFile.unmap(data);
+
+    if (validSize < fileSize)
+    {
+        qWarning() << "Discard invalid tail of timeline store, valid size:" << validSize << "file size:" << fileSize;
+        mFile.resize(validSize);
+        mFile.seek(validSize);
+    }
+
+    qDebug() << "Loaded timeline segments:" << segments.size();
+    return segments;
+}
+
+bool TimelineStore::append(SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor)
+{
+    if (!isOpen())
+        return false;
+
+    const QByteArray segment = createSegment(type, feed, gapCursor);
+
+    if (!mFile.seek(mFile.size()) || mFile.write(segment) != segment.size())
+    {
+        qWarning() << "Failed to append timeline segment:" << mFile.fileName() << mFile.errorString();
+        return false;
+    }
+
+    mFile.flush();
+    ++mSegmentCount;
+    qDebug() << "Appended timeline segment, type:" << quint32(type) << "posts:" << feed.mFeed.size() << "segments:" << mSegmentCount;
+    return true;
+}
+
+void TimelineStore::clear()
+{
+    if (!isOpen())
+        return;
+
+    qDebug() << "Clear timeline store:" << mFile.fileName();
+    writeHeader();
+}
+
+void TimelineStore::remove(const QString& did)
+{
+    if (did == mDid)
+        close();
+
+    const QString fileName = getFileName(did);
+
+    if (fileName.isEmpty() || !QFile::exists(fileName))
+        return;
+
+    if (QFile::remove(fileName))
+        qDebug() << "Removed timeline store:" << fileName;
+    else
+        qWarning() << "Cannot remove timeline store:" << fileName;
+}
+
+bool TimelineStore::compact(const std::vector<Segment>& segments)
+{
+    if (!isOpen())
+        return false;
+
+    const QString fileName = mFile.fileName();
+    const QString did = mDid;
+    QSaveFile saveFile(fileName);
+
+    if (!saveFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot create timeline store:" << fileName << saveFile.errorString();
+        return false;
+    }
+
+    saveFile.write(createHeader());
+
+    for (const auto& segment : segments)
+        saveFile.write(createSegment(segment.mType, *segment.mFeed, segment.mGapCursor));
+
+    // The file gets replaced atomically, so the old content stays intact when
+    // anything fails.
+    mFile.close();
+
+    if (!saveFile.commit())
+        qWarning() << "Failed to compact timeline store:" << fileName << saveFile.errorString();
+
+    if (!open(did))
+        return false;
+
+    qDebug() << "Compacted timeline store, segments:" << mSegmentCount << "size:" << getSize();
+    return true;
+}
+
+bool TimelineStore::needsCompaction() const
+{
+    return isOpen() && (mSegmentCount > MAX_SEGMENTS || getSize() > MAX_FILE_SIZE);
+}
+
+qint64 TimelineStore::getSize() const
+{
+    return isOpen() ? mFile.size() : 0;
+}
+
+}
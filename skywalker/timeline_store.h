@@ -0,0 +1,85 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <atproto/lib/lexicon/app_bsky_feed.h>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+namespace Skywalker {
+
+// Persistent store of the raw timeline pages received for a user. The store is an
+// append-only log of segments. Replaying the segments in order through the timeline
+// model rebuilds the timeline as it was before the app got closed.
+//
+// File layout:
+//   header:  magic (4 bytes), version (4 bytes)
+//   segment: type (4 bytes), payload size (4 bytes), checksum (2 bytes), payload
+//
+// The payload is a compact JSON page in the getTimeline output format. A segment
+// that got truncated or corrupted (e.g. the app got killed while writing) ends the
+// log. Integers are stored in little endian.
+class TimelineStore
+{
+public:
+    static constexpr quint32 VERSION = 1;
+    static constexpr qint64 MAX_FILE_SIZE = 8 * 1024 * 1024;
+    static constexpr int MAX_SEGMENTS = 100;
+    static constexpr int MAX_COMPACTED_POSTS = 2000;
+
+    enum class SegmentType : quint32
+    {
+        APPEND = 1,    // page added at the end of the timeline
+        PREPEND = 2,   // page added at the start of the timeline
+        GAP_FILL = 3,  // page filling the gap identified by the gap cursor
+        GAP = 4        // gap place holder with the gap cursor added at the end of the timeline
+    };
+
+    struct Segment
+    {
+        SegmentType mType;
+        QString mGapCursor;
+        ATProto::AppBskyFeed::OutputFeed::SharedPtr mFeed;
+    };
+
+    // The default directory is the app data directory.
+    explicit TimelineStore(const QString& dirPath = {});
+    ~TimelineStore();
+
+    bool open(const QString& did);
+    void close();
+    bool isOpen() const { return mFile.isOpen(); }
+    const QString& getDid() const { return mDid; }
+
+    std::vector<Segment> load();
+    bool append(SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor = {});
+
+    // Remove all segments.
+    void clear();
+
+    // Delete the store of a user.
+    void remove(const QString& did);
+
+    // Replace all segments by the APPEND and GAP segments describing the timeline.
+    bool compact(const std::vector<Segment>& segments);
+    bool needsCompaction() const;
+
+    int getSegmentCount() const { return mSegmentCount; }
+    qint64 getSize() const;
+
+private:
+    QString getFileName(const QString& did) const;
+    QByteArray createHeader() const;
+    QByteArray createSegment(SegmentType type, const ATProto::AppBskyFeed::OutputFeed& feed, const QString& gapCursor) const;
+    bool writeHeader();
+
+    // Returns the offset after the last valid segment.
+    qint64 parseSegments(const uchar* data, qint64 size, std::vector<Segment>* segments);
+
+    QString mDirPath;
+    QString mDid;
+    QFile mFile;
+    int mSegmentCount = 0;
+};
+
+}
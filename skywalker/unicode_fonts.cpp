@@ -30,6 +30,29 @@ bool UnicodeFonts::isDigit(QChar c)
     return (c >= '0' && c <= '9');
 }
 
+// The loop has no early exit, so the compiler can vectorize it.
+static char16_t orAllChars(QStringView text)
+{
+    const char16_t* data = text.utf16();
+    const qsizetype size = text.size();
+    char16_t bits = 0;
+
+    for (qsizetype i = 0; i < size; ++i)
+        bits |= data[i];
+
+    return bits;
+}
+
+bool UnicodeFonts::isAscii(QStringView text)
+{
+    return orAllChars(text) < 0x80;
+}
+
+bool UnicodeFonts::isLatin1(QStringView text)
+{
+    return orAllChars(text) < 0x100;
+}
+
 uint UnicodeFonts::convertToSmallCaps(QChar c)
 {
     static const QString SMALL_CAPS = "ᴀʙᴄᴅᴇꜰɢʜɪᴊᴋʟᴍɴᴏᴘǫʀsᴛᴜᴠᴡxʏᴢ";
@@ -178,6 +201,11 @@ QString UnicodeFonts::normalizeToNFKD(const QString& text)
 
 int UnicodeFonts::graphemeLength(const QString& text)
 {
+    // Latin-1 has no combining characters, each character is a grapheme,
+    // except CR-LF.
+    if (isLatin1(text))
+        return int(text.size() - text.count(u"\r\n"));
+
     QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, text);
     int length = 0;
 
@@ -189,6 +217,22 @@ int UnicodeFonts::graphemeLength(const QString& text)
 
 GraphemeInfo UnicodeFonts::getGraphemeInfo(const QString& text)
 {
+    if (isLatin1(text))
+    {
+        std::vector<int> charPositions = {0, };
+        charPositions.reserve(text.size() + 1);
+
+        for (int i = 1; i <= text.size(); ++i)
+        {
+            if (i < text.size() && text[i - 1] == '\r' && text[i] == '\n')
+                continue;
+
+            charPositions.push_back(i);
+        }
+
+        return GraphemeInfo(int(charPositions.size()) - 1, charPositions);
+    }
+
     QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, text);
     int length = 0;
     std::vector<int> charPositions = {0, };
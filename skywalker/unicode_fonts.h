@@ -21,6 +21,10 @@ public:
     static bool isAlpha(QChar c);
     static bool isDigit(QChar c);
 
+    // Fast checks to select a simpler code path for plain text.
+    static bool isAscii(QStringView text);
+    static bool isLatin1(QStringView text);
+
     // Returns 0 if there is no conversion
     static uint convertToFont(QChar c, FontType font);
 
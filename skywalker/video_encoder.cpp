@@ -5,6 +5,26 @@
 
 namespace Skywalker {
 
+const char* VideoEncoder::getFileExtension()
+{
+#if defined(Q_OS_ANDROID)
+    return "mp4";
+#else
+    return SoftwareVideoEncoder::FILE_EXTENSION;
+#endif
+}
+
+QByteArray VideoEncoder::prepareFrame(const QImage& frame)
+{
+#if defined(Q_OS_ANDROID)
+    // Must match format in QVideoEncoder.java
+    const QImage rgba = frame.convertedTo(QImage::Format_RGBA8888);
+    return QByteArray((const char*)rgba.constBits(), rgba.sizeInBytes());
+#else
+    return SoftwareVideoEncoder::compressFrame(frame);
+#endif
+}
+
 bool VideoEncoder::open(const QString& fileName, int width, int height, int fps, int bitRate)
 {
     qDebug() << "file:" << fileName << "width:" << width << "height:" << height << "fps:" << fps << "bitRate:" << bitRate;
@@ -23,13 +43,11 @@ bool VideoEncoder::open(const QString& fileName, int width, int height, int fps,
                                                            (jint)bitRate);
     return (bool)result;
 #else
-    Q_UNUSED(fileName);
-    Q_UNUSED(width);
-    Q_UNUSED(height);
-    Q_UNUSED(fps);
+    // The software encoder uses a fixed JPEG quality
     Q_UNUSED(bitRate);
-    qWarning() << "Video encoding not supported!";
-    return false;
+    mWidth = width;
+    mHeight = height;
+    return mEncoder.open(fileName, width, height, fps);
 #endif
 }
 
@@ -44,28 +62,23 @@ bool VideoEncoder::close()
 
     return true;
 #else
-    qWarning() << "Video encoding not supported!";
-    return false;
+    return mEncoder.close();
 #endif
 }
 
-bool VideoEncoder::push(const QImage& frame)
+bool VideoEncoder::push(const QByteArray& preparedFrame)
 {
 #if defined(Q_OS_ANDROID)
-    Q_ASSERT(mWidth == frame.width());
-    Q_ASSERT(mHeight == frame.height());
+    const int size = mWidth * mHeight * 4;
+    Q_ASSERT(preparedFrame.size() == size);
     QJniEnvironment env;
-    const int size = frame.width() * frame.height() * 4;
     auto jsFrame = env->NewByteArray(size);
-    const uint8_t* frameBits = frame.constBits();
-    env->SetByteArrayRegion(jsFrame, 0, size, (jbyte*)frameBits);
+    env->SetByteArrayRegion(jsFrame, 0, size, (const jbyte*)preparedFrame.constData());
     auto added = mEncoder->callMethod<jboolean>("addFrame", "([B)Z", jsFrame);
     env->DeleteLocalRef(jsFrame);
     return (bool)added;
 #else
-    Q_UNUSED(frame);
-    qWarning() << "Video encoding not supported!";
-    return false;
+    return mEncoder.push(preparedFrame);
 #endif
 }
 
@@ -6,20 +6,35 @@
 
 #if defined(Q_OS_ANDROID)
 #include <QJniObject>
+#else
+#include "software_video_encoder.h"
 #endif
 
 namespace Skywalker {
 
+// On Android the platform's H.264 encoder is used. On other platforms the
+// portable software encoder.
 class VideoEncoder
 {
 public:
+    // Extension of the video file to create.
+    static const char* getFileExtension();
+
+    // Converts a frame to the input for the encoder. Thread safe, multiple frames
+    // can be prepared in parallel.
+    static QByteArray prepareFrame(const QImage& frame);
+
     bool open(const QString& fileName, int width, int height, int fps, int bitRate);
     bool close();
-    bool push(const QImage& frame);
+
+    // Frames must be pushed in order.
+    bool push(const QByteArray& preparedFrame);
 
 private:
 #if defined(Q_OS_ANDROID)
     std::unique_ptr<QJniObject> mEncoder;
+#else
+    SoftwareVideoEncoder mEncoder;
 #endif
     int mWidth = 0;
     int mHeight = 0;
@@ -0,0 +1,124 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "word_automaton.h"
+#include <QDebug>
+#include <queue>
+
+namespace Skywalker {
+
+WordAutomaton::WordAutomaton()
+{
+    clear();
+}
+
+void WordAutomaton::clear()
+{
+    mNodes.clear();
+    mNodes.emplace_back(); // root
+    mPatterns.clear();
+    mBuilt = true;
+}
+
+void WordAutomaton::addPattern(const std::vector<QString>& words, const QString& label)
+{
+    if (words.empty())
+        return;
+
+    const auto tokens = WordTokenInterner::instance().intern(words);
+    int state = 0;
+
+    for (const WordToken word : tokens)
+    {
+        const auto it = mNodes[state].mNext.find(word);
+
+        if (it != mNodes[state].mNext.end())
+        {
+            state = it->second;
+        }
+        else
+        {
+            const int next = (int)mNodes.size();
+            mNodes[state].mNext[word] = next;
+            mNodes.emplace_back();
+            state = next;
+        }
+    }
+
+    if (mNodes[state].mPatternIndex < 0)
+    {
+        mNodes[state].mPatternIndex = (int)mPatterns.size();
+        mPatterns.push_back(label);
+    }
+
+    mBuilt = false;
+}
+
+void WordAutomaton::build()
+{
+    // Breadth first, such that the fail node of a node is complete before the
+    // node itself is processed.
+    std::queue<int> nodeQueue;
+
+    for (const auto& [_, child] : mNodes[0].mNext)
+    {
+        mNodes[child].mFail = 0;
+        nodeQueue.push(child);
+    }
+
+    while (!nodeQueue.empty())
+    {
+        const int state = nodeQueue.front();
+        nodeQueue.pop();
+
+        for (const auto [word, child] : mNodes[state].mNext)
+        {
+            int fail = mNodes[state].mFail;
+
+            while (fail != 0 && !mNodes[fail].mNext.contains(word))
+                fail = mNodes[fail].mFail;
+
+            const auto it = mNodes[fail].mNext.find(word);
+            mNodes[child].mFail = (it != mNodes[fail].mNext.end()) ? it->second : 0;
+
+            // A pattern that is a suffix of the path to this node matches as well.
+            if (mNodes[child].mPatternIndex < 0)
+                mNodes[child].mPatternIndex = mNodes[mNodes[child].mFail].mPatternIndex;
+
+            nodeQueue.push(child);
+        }
+    }
+
+    mBuilt = true;
+    qDebug() << "Word automaton built, patterns:" << mPatterns.size() << "nodes:" << mNodes.size();
+}
+
+const QString* WordAutomaton::match(const std::vector<WordToken>& words) const
+{
+    Q_ASSERT(mBuilt);
+
+    if (mPatterns.empty())
+        return nullptr;
+
+    int state = 0;
+
+    for (const WordToken word : words)
+    {
+        auto it = mNodes[state].mNext.find(word);
+
+        while (state != 0 && it == mNodes[state].mNext.end())
+        {
+            state = mNodes[state].mFail;
+            it = mNodes[state].mNext.find(word);
+        }
+
+        state = (it != mNodes[state].mNext.end()) ? it->second : 0;
+        const int patternIndex = mNodes[state].mPatternIndex;
+
+        if (patternIndex >= 0)
+            return &mPatterns[patternIndex];
+    }
+
+    return nullptr;
+}
+
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "word_token.h"
+#include <QString>
+#include <unordered_map>
+#include <vector>
+
+namespace Skywalker {
+
+// Aho-Corasick automaton over sequences of normalized words. A pattern is a
+// sequence of one or more words, e.g. a muted word or phrase. Matching a text
+// against all patterns is a single pass over the words of the text, independent
+// of the number of patterns.
+class WordAutomaton
+{
+public:
+    WordAutomaton();
+
+    void clear();
+    bool empty() const { return mPatterns.empty(); }
+    size_t patternCount() const { return mPatterns.size(); }
+
+    // Adding patterns invalidates the automaton till build() is called.
+    void addPattern(const std::vector<QString>& words, const QString& label);
+    void build();
+
+    // Returns the label of a pattern that occurs in the words.
+    // Returns nullptr if there is no match.
+    const QString* match(const std::vector<WordToken>& words) const;
+
+private:
+    struct Node
+    {
+        std::unordered_map<WordToken, int> mNext;
+        int mFail = 0;
+
+        // Index of a pattern ending in this node, or in a node on its fail chain.
+        // -1 if there is no such pattern.
+        int mPatternIndex = -1;
+    };
+
+    std::vector<Node> mNodes;
+    std::vector<QString> mPatterns; // labels
+    bool mBuilt = true;
+};
+
+}
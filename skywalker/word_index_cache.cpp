@@ -0,0 +1,108 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "word_index_cache.h"
+#include <QDebug>
+
+namespace Skywalker {
+
+WordIndexCache& WordIndexCache::instance()
+{
+    static WordIndexCache sInstance;
+    return sInstance;
+}
+
+WordIndexCache::WordIndexCache(size_t maxSize) :
+    mMaxSize(maxSize)
+{
+    Q_ASSERT(mMaxSize > 0);
+}
+
+NormalizedWordIndex::Indices::SharedPtr WordIndexCache::get(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    auto it = mEntries.find(key);
+
+    if (it == mEntries.end())
+    {
+        ++mMisses;
+        return nullptr;
+    }
+
+    ++mHits;
+    mLru.splice(mLru.begin(), mLru, it->second.mLruIt);
+    return it->second.mIndices;
+}
+
+void WordIndexCache::put(const QString& key, NormalizedWordIndex::Indices::SharedPtr indices)
+{
+    Q_ASSERT(!key.isEmpty());
+    QMutexLocker locker(&mMutex);
+    auto it = mEntries.find(key);
+
+    if (it != mEntries.end())
+    {
+        // Another thread indexed the same key at the same time.
+        it->second.mIndices = std::move(indices);
+        mLru.splice(mLru.begin(), mLru, it->second.mLruIt);
+        return;
+    }
+
+    if (mEntries.size() >= mMaxSize)
+    {
+        mEntries.erase(mLru.back());
+        mLru.pop_back();
+        ++mEvictions;
+    }
+
+    mLru.push_front(key);
+    mEntries[key] = Entry{ std::move(indices), mLru.begin() };
+}
+
+void WordIndexCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mEntries.clear();
+    mLru.clear();
+    mHits = 0;
+    mMisses = 0;
+    mEvictions = 0;
+}
+
+size_t WordIndexCache::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEntries.size();
+}
+
+qint64 WordIndexCache::getHits() const
+{
+    QMutexLocker locker(&mMutex);
+    return mHits;
+}
+
+qint64 WordIndexCache::getMisses() const
+{
+    QMutexLocker locker(&mMutex);
+    return mMisses;
+}
+
+qint64 WordIndexCache::getEvictions() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEvictions;
+}
+
+double WordIndexCache::getHitRate() const
+{
+    QMutexLocker locker(&mMutex);
+    const qint64 lookups = mHits + mMisses;
+    return lookups > 0 ? (double)mHits / lookups : 0.0;
+}
+
+void WordIndexCache::logStats() const
+{
+    qDebug() << "Word index cache, size:" << size() << "hits:" << getHits() << "misses:" << getMisses()
+             << "evictions:" << getEvictions() << "hit rate:" << getHitRate();
+}
+
+}
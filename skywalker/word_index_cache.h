@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "normalized_word_index.h"
+#include <QMutex>
+#include <list>
+#include <unordered_map>
+
+namespace Skywalker {
+
+// Cache of normalized word indices shared by all objects with the same index key,
+// e.g. all copies of a post in the timeline, threads, author feeds and search
+// results. The least recently used indices get evicted.
+//
+// The cache is thread safe, indices may be built on worker threads.
+class WordIndexCache
+{
+public:
+    static constexpr size_t MAX_SIZE = 10000;
+
+    static WordIndexCache& instance();
+
+    explicit WordIndexCache(size_t maxSize = MAX_SIZE);
+
+    // Returns nullptr if the key is not cached.
+    NormalizedWordIndex::Indices::SharedPtr get(const QString& key);
+    void put(const QString& key, NormalizedWordIndex::Indices::SharedPtr indices);
+    void clear();
+
+    size_t size() const;
+    qint64 getHits() const;
+    qint64 getMisses() const;
+    qint64 getEvictions() const;
+    double getHitRate() const;
+    void logStats() const;
+
+private:
+    using LruList = std::list<QString>; // front is most recently used
+
+    struct Entry
+    {
+        NormalizedWordIndex::Indices::SharedPtr mIndices;
+        LruList::iterator mLruIt;
+    };
+
+    const size_t mMaxSize;
+    mutable QMutex mMutex;
+    std::unordered_map<QString, Entry> mEntries;
+    LruList mLru;
+    qint64 mHits = 0;
+    qint64 mMisses = 0;
+    qint64 mEvictions = 0;
+};
+
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#include "word_token.h"
+#include <QDebug>
+
+namespace Skywalker {
+
+WordTokenInterner& WordTokenInterner::instance()
+{
+    static WordTokenInterner sInstance;
+    return sInstance;
+}
+
+WordToken WordTokenInterner::internLocked(const QString& word)
+{
+    const auto [it, inserted] = mTokens.try_emplace(word, (WordToken)mWords.size());
+
+    if (inserted)
+        mWords.push_back(word);
+
+    return it->second;
+}
+
+WordToken WordTokenInterner::intern(const QString& word)
+{
+    QMutexLocker locker(&mMutex);
+    return internLocked(word);
+}
+
+std::vector<WordToken> WordTokenInterner::intern(const std::vector<QString>& words)
+{
+    std::vector<WordToken> tokens;
+    tokens.reserve(words.size());
+    QMutexLocker locker(&mMutex);
+
+    for (const auto& word : words)
+        tokens.push_back(internLocked(word));
+
+    return tokens;
+}
+
+QString WordTokenInterner::getWord(WordToken token) const
+{
+    QMutexLocker locker(&mMutex);
+    return token < mWords.size() ? mWords[token] : QString{};
+}
+
+size_t WordTokenInterner::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mWords.size();
+}
+
+void WordTokenInterner::reset()
+{
+    QMutexLocker locker(&mMutex);
+    qDebug() << "Reset word tokens, size:" << mWords.size();
+    mTokens.clear();
+    mWords.clear();
+    mGeneration.fetch_add(1, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QHashFunctions>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace Skywalker {
+
+// Id of an interned normalized word.
+using WordToken = quint32;
+
+// Process wide table of normalized words. Each distinct word gets a token, such that
+// indices can store and compare 32-bit tokens instead of strings. Tokens are not
+// released while a user is signed in, the table grows with the vocabulary seen. On
+// sign out the table is reset. A reset starts a new generation, tokens from an
+// older generation must not be used anymore.
+//
+// The interner is thread safe, indices may be built on worker threads.
+class WordTokenInterner
+{
+public:
+    static WordTokenInterner& instance();
+
+    WordToken intern(const QString& word);
+    std::vector<WordToken> intern(const std::vector<QString>& words);
+
+    // Returns the word for a token, empty string for an unknown token.
+    QString getWord(WordToken token) const;
+
+    size_t size() const;
+
+    // Drop all tokens and start a new generation.
+    void reset();
+    quint32 getGeneration() const { return mGeneration.load(std::memory_order_acquire); }
+
+private:
+    WordTokenInterner() = default;
+    WordToken internLocked(const QString& word);
+
+    mutable QMutex mMutex;
+    std::unordered_map<QString, WordToken> mTokens;
+    std::deque<QString> mWords; // token -> word
+    std::atomic<quint32> mGeneration = 0;
+};
+
+}
@@ -1,13 +1,31 @@
 // Copyright (C) 2024 Michel de Boer
 // License: GPLv3
 #include "test_anniversary.h"
+#include "test_bounded_queue.h"
+#include "test_filter_snapshot.h"
 #include "test_filtered_post_feed_model.h"
 #include "test_focus_hashtags.h"
+#include "test_formatted_text_cache.h"
+#include "test_grapheme_block_data.h"
 #include "test_hashtag_index.h"
+#include "test_hls_segment_loader.h"
+#include "test_image_cache.h"
+#include "test_image_disk_cache.h"
+#include "test_incremental_facet_parser.h"
+#include "test_link_card_reader.h"
 #include "test_muted_words.h"
+#include "test_photo_picker.h"
+#include "test_post_cache.h"
 #include "test_post_feed_model.h"
+#include "test_post_record_store.h"
+#include "test_profile_batcher.h"
+#include "test_relative_time_service.h"
+#include "test_row_index_map.h"
 #include "test_search_utils.h"
+#include "test_software_video_encoder.h"
+#include "test_timeline_store.h"
 #include "test_unicode_fonts.h"
+#include "test_word_index_cache.h"
 #include <QtTest/QTest>
 
 int main(int argc, char *argv[])
@@ -24,6 +42,12 @@ int main(int argc, char *argv[])
     TestMutedWords testMutedWords;
     QTest::qExec(&testMutedWords, argc, argv);
 
+    TestPostCache testPostCache;
+    QTest::qExec(&testPostCache, argc, argv);
+
+    TestPostRecordStore testPostRecordStore;
+    QTest::qExec(&testPostRecordStore, argc, argv);
+
     TestPostFeedModel testPostFeedModel;
     QTest::qExec(&testPostFeedModel, argc, argv);
 
@@ -36,5 +60,53 @@ int main(int argc, char *argv[])
     TestUnicodeFonts testUnicodeFonts;
     QTest::qExec(&testUnicodeFonts, argc, argv);
 
+    TestTimelineStore testTimelineStore;
+    QTest::qExec(&testTimelineStore, argc, argv);
+
+    TestWordIndexCache testWordIndexCache;
+    QTest::qExec(&testWordIndexCache, argc, argv);
+
+    TestRelativeTimeService testRelativeTimeService;
+    QTest::qExec(&testRelativeTimeService, argc, argv);
+
+    TestFilterSnapshot testFilterSnapshot;
+    QTest::qExec(&testFilterSnapshot, argc, argv);
+
+    TestProfileBatcher testProfileBatcher;
+    QTest::qExec(&testProfileBatcher, argc, argv);
+
+    TestImageCache testImageCache;
+    QTest::qExec(&testImageCache, argc, argv);
+
+    TestImageDiskCache testImageDiskCache;
+    QTest::qExec(&testImageDiskCache, argc, argv);
+
+    TestPhotoPicker testPhotoPicker;
+    QTest::qExec(&testPhotoPicker, argc, argv);
+
+    TestHlsSegmentLoader testHlsSegmentLoader;
+    QTest::qExec(&testHlsSegmentLoader, argc, argv);
+
+    TestBoundedQueue testBoundedQueue;
+    QTest::qExec(&testBoundedQueue, argc, argv);
+
+    TestSoftwareVideoEncoder testSoftwareVideoEncoder;
+    QTest::qExec(&testSoftwareVideoEncoder, argc, argv);
+
+    TestIncrementalFacetParser testIncrementalFacetParser;
+    QTest::qExec(&testIncrementalFacetParser, argc, argv);
+
+    TestGraphemeBlockData testGraphemeBlockData;
+    QTest::qExec(&testGraphemeBlockData, argc, argv);
+
+    TestLinkCardReader testLinkCardReader;
+    QTest::qExec(&testLinkCardReader, argc, argv);
+
+    TestFormattedTextCache testFormattedTextCache;
+    QTest::qExec(&testFormattedTextCache, argc, argv);
+
+    TestRowIndexMap testRowIndexMap;
+    QTest::qExec(&testRowIndexMap, argc, argv);
+
     return 0;
 }
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <bounded_queue.h>
+#include <QThread>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestBoundedQueue : public QObject
+{
+    Q_OBJECT
+private slots:
+    void fifo()
+    {
+        BoundedQueue<int> queue(3);
+        QVERIFY(queue.push(1));
+        QVERIFY(queue.push(2));
+        QVERIFY(queue.push(3));
+        QCOMPARE((int)queue.size(), 3);
+        QCOMPARE(queue.pop().value(), 1);
+        QCOMPARE(queue.pop().value(), 2);
+        QCOMPARE(queue.pop().value(), 3);
+        QCOMPARE((int)queue.size(), 0);
+        QCOMPARE((int)queue.getPeakSize(), 3);
+    }
+
+    void close()
+    {
+        BoundedQueue<int> queue(3);
+        QVERIFY(queue.push(1));
+        queue.close();
+        QVERIFY(!queue.push(2));
+        QCOMPARE(queue.pop().value(), 1);
+        QVERIFY(!queue.pop());
+    }
+
+    void cancel()
+    {
+        BoundedQueue<int> queue(3);
+        QVERIFY(queue.push(1));
+        queue.cancel();
+        QVERIFY(!queue.push(2));
+        QVERIFY(!queue.pop());
+    }
+
+    void producerConsumer()
+    {
+        constexpr int ITEM_COUNT = 1000;
+        BoundedQueue<int> queue(4);
+
+        std::unique_ptr<QThread> producer(QThread::create([&queue]{
+            for (int i = 0; i < ITEM_COUNT; ++i)
+                queue.push(i);
+
+            queue.close();
+        }));
+
+        producer->start();
+        int expected = 0;
+
+        while (auto item = queue.pop())
+        {
+            QCOMPARE(*item, expected);
+            ++expected;
+        }
+
+        QVERIFY(producer->wait());
+        QCOMPARE(expected, ITEM_COUNT);
+        QVERIFY(queue.getPeakSize() <= queue.getMaxSize());
+    }
+
+    void cancelUnblocksProducer()
+    {
+        BoundedQueue<int> queue(1);
+        QVERIFY(queue.push(1));
+        bool pushed = true;
+
+        std::unique_ptr<QThread> producer(QThread::create([&queue, &pushed]{
+            pushed = queue.push(2);
+        }));
+
+        producer->start();
+        QTest::qWait(20);
+        QVERIFY(!producer->isFinished());
+        queue.cancel();
+        QVERIFY(producer->wait());
+        QVERIFY(!pushed);
+    }
+};
@@ -0,0 +1,141 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <filter_snapshot.h>
+#include <post.h>
+#include <atproto/lib/post_master.h>
+#include <QSignalSpy>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestFilterSnapshot : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mContentFilter = std::make_unique<ContentFilter>(mUserPreferences, &mUserSettings);
+        mMutedWords = std::make_unique<MutedWords>();
+        mFocusHashtags = std::make_unique<FocusHashtags>();
+        mFollowing.clear();
+        mMutedReposts.clear();
+        mPublisher = std::make_unique<FilterSnapshotPublisher>(
+            *mContentFilter, *mMutedWords, *mFocusHashtags, mFollowing, mMutedReposts);
+    }
+
+    void cleanup()
+    {
+        mPublisher = nullptr;
+        mFocusHashtags = nullptr;
+        mMutedWords = nullptr;
+        mContentFilter = nullptr;
+    }
+
+    void initialSnapshot()
+    {
+        const auto snapshot = mPublisher->getSnapshot();
+        QVERIFY(snapshot);
+        QCOMPARE(snapshot->mVersion, quint64(1));
+        QVERIFY(!snapshot->mMutedWords->match(setPost("hello world")));
+        QVERIFY(!snapshot->mFocusHashtags->match(setPost("#skywalker")));
+        QVERIFY(!snapshot->mFollowing->contains("did:plc:foo"));
+    }
+
+    void mutedWordsChange()
+    {
+        const auto oldSnapshot = mPublisher->getSnapshot();
+        QSignalSpy spy(mPublisher.get(), &FilterSnapshotPublisher::snapshotPublished);
+
+        mMutedWords->addEntry("hello");
+        mMutedWords->addEntry("#sky");
+
+        // Changes are published at once at the next event loop iteration
+        QTRY_COMPARE(spy.count(), 1);
+        const auto snapshot = mPublisher->getSnapshot();
+        QCOMPARE(snapshot->mVersion, oldSnapshot->mVersion + 1);
+        QVERIFY(snapshot->mMutedWords->match(setPost("hello world")));
+        QVERIFY(snapshot->mMutedWords->match(setPost("blue #sky")));
+
+        // The old snapshot does not change
+        QVERIFY(!oldSnapshot->mMutedWords->match(setPost("hello world")));
+    }
+
+    void focusHashtagsChange()
+    {
+        QSignalSpy spy(mPublisher.get(), &FilterSnapshotPublisher::snapshotPublished);
+        mFocusHashtags->addEntry("#skywalker", Qt::red);
+        QTRY_COMPARE(spy.count(), 1);
+
+        auto snapshot = mPublisher->getSnapshot();
+        QVERIFY(snapshot->mFocusHashtags->match(setPost("#skywalker")));
+        QCOMPARE(snapshot->mFocusHashtags->highlightColor(setPost("#skywalker")), QColor(Qt::red));
+
+        mFocusHashtags->getEntries().front()->setHighlightColor(Qt::blue);
+        QTRY_COMPARE(spy.count(), 2);
+
+        snapshot = mPublisher->getSnapshot();
+        QCOMPARE(snapshot->mFocusHashtags->highlightColor(setPost("#skywalker")), QColor(Qt::blue));
+    }
+
+    void followsChange()
+    {
+        const auto oldSnapshot = mPublisher->getSnapshot();
+        mFollowing.add(BasicProfile("did:plc:foo", "foo.bsky.social", "Foo", ""));
+        mPublisher->publish();
+
+        auto snapshot = mPublisher->getSnapshot();
+        QVERIFY(snapshot->mFollowing->contains("did:plc:foo"));
+        QVERIFY(snapshot->mFollowing->get("did:plc:foo"));
+        QVERIFY(!oldSnapshot->mFollowing->contains("did:plc:foo"));
+
+        // Unchanged stores are shared between snapshots
+        QVERIFY(snapshot->mFollowing != oldSnapshot->mFollowing);
+        QVERIFY(snapshot->mMutedReposts == oldSnapshot->mMutedReposts);
+
+        const auto followingSnapshot = snapshot->mFollowing;
+        mPublisher->publish();
+        QVERIFY(mPublisher->getSnapshot()->mFollowing == followingSnapshot);
+    }
+
+    void contentFilter()
+    {
+        const auto snapshot = mPublisher->getSnapshot();
+        const QStringList labelIds{ "porn", "nudity", "gore", "!hide", "!warn", "unknown-label" };
+
+        for (const auto& labelId : labelIds)
+        {
+            const ContentLabelList labels{ ContentLabel("did:plc:labeler", "", "", labelId, {}) };
+            const auto [visibility, warning] = snapshot->mContentFilter->getVisibilityAndWarning(labels);
+            const auto [expectedVisibility, expectedWarning] = mContentFilter->getVisibilityAndWarning(labels);
+            QCOMPARE(visibility, expectedVisibility);
+            QCOMPARE(warning, expectedWarning);
+        }
+    }
+
+private:
+    Post setPost(const QString& text)
+    {
+        ATProto::Client client(nullptr);
+        ATProto::PostMaster pm(client);
+        auto postView = std::make_shared<ATProto::AppBskyFeed::PostView>();
+
+        pm.createPost(text, "", nullptr, [postView](auto&& postRecord){
+            const auto json = postRecord->toJson();
+            postView->mRecordType = ATProto::RecordType::APP_BSKY_FEED_POST;
+            postView->mRecord = ATProto::AppBskyFeed::Record::Post::fromJson(json);
+            postView->mAuthor = std::make_unique<ATProto::AppBskyActor::ProfileViewBasic>();
+        });
+
+        return Post(postView);
+    }
+
+    ATProto::UserPreferences mUserPreferences;
+    UserSettings mUserSettings;
+    std::unique_ptr<ContentFilter> mContentFilter;
+    std::unique_ptr<MutedWords> mMutedWords;
+    std::unique_ptr<FocusHashtags> mFocusHashtags;
+    ProfileStore mFollowing;
+    ProfileStore mMutedReposts;
+    std::unique_ptr<FilterSnapshotPublisher> mPublisher;
+};
@@ -6,6 +6,8 @@
 #include <muted_words.h>
 #include <filtered_post_feed_model.h>
 #include <user_settings.h>
+#include <QRandomGenerator>
+#include <QSignalSpy>
 #include <QtTest/QTest>
 
 using namespace Skywalker;
@@ -21,31 +23,28 @@ private slots:
         auto filter = std::make_unique<AuthorPostFilter>(profile);
 
         mPostFeedModel = std::make_unique<FilteredPostFeedModel>(
-            std::move(filter), mUserDid, mFollowing, mMutedReposts, mContentFilter,
+            std::move(filter), mTimeline, mUserDid, mFollowing, mMutedReposts, mContentFilter,
             mBookmarks, mMutedWords, mFocusHashtags, mHashtags);
     }
 
     void cleanup()
     {
         mPostFeedModel = nullptr;
+        mTimeline.clear();
         mNextPostId = 1;
     }
 
     void setFeed()
     {
-        mPostFeedModel->setPosts(getTimeline(1, TEST_DATE), 1);
+        setTimeline(getTimeline(1, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 1);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
 
-        mPostFeedModel->setPosts(getTimeline(2, TEST_DATE), 2);
+        setTimeline(getTimeline(2, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 2);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
 
-        mPostFeedModel->setPosts(getTimeline(2, TEST_DATE), 1);
-        QCOMPARE(mPostFeedModel->rowCount(), 1);
-        QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
-
-        mPostFeedModel->setPosts(getTimeline(4, TEST_DATE), 4);
+        setTimeline(getTimeline(4, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 3);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 1);
 
@@ -58,7 +57,7 @@ private slots:
 
     void clearFeed()
     {
-        mPostFeedModel->setPosts(getTimeline(1, TEST_DATE), 1);
+        setTimeline(getTimeline(1, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 1);
         mPostFeedModel->clear();
         QCOMPARE(mPostFeedModel->rowCount(), 0);
@@ -66,24 +65,24 @@ private slots:
 
     void addToEmptyFeed()
     {
-        mPostFeedModel->addPosts(getTimeline(1, TEST_DATE), 1);
+        appendToTimeline(getTimeline(1, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 1);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
 
-        mPostFeedModel->clear();
-        mPostFeedModel->addPosts(getTimeline(4, TEST_DATE), 4);
+        clearTimeline();
+        appendToTimeline(getTimeline(4, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 3);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 1);
     }
 
     void prependToEmptyFeed()
     {
-        mPostFeedModel->prependPosts(getTimeline(1, TEST_DATE), 1);
+        prependToTimeline(getTimeline(1, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 1);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
 
-        mPostFeedModel->clear();
-        mPostFeedModel->prependPosts(getTimeline(4, TEST_DATE), 4);
+        clearTimeline();
+        prependToTimeline(getTimeline(4, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 3);
         QCOMPARE(mPostFeedModel->getNumPostsChecked(), 0);
     }
@@ -91,7 +90,7 @@ private slots:
     void gapFill()
     {
         mNextPostId = 3;
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 4);
 
         mNextPostId = 1;
@@ -99,7 +98,7 @@ private slots:
         auto gap = Post::createGapPlaceHolder("GAP");
         const int gapId = gap.getGapId();
         posts.push_back(gap);
-        mPostFeedModel->prependPosts(posts, posts.size());
+        prependToTimeline(posts);
         QCOMPARE(mPostFeedModel->rowCount(), 6); // 5 posts + gap place holder
 
         const Post& post = mPostFeedModel->getPost(1);
@@ -108,7 +107,7 @@ private slots:
         QCOMPARE(post.getGapId(), gapId);
 
         mNextPostId = 2;
-        mPostFeedModel->gapFill(getTimeline(3, TEST_DATE + 1s), 2, gapId);
+        fillGap(1, getTimeline(2, TEST_DATE + 1s), gapId);
         QCOMPARE(mPostFeedModel->rowCount(), 7); // 7 posts
 
         for (int i = 0; i < mPostFeedModel->rowCount(); ++i)
@@ -122,7 +121,7 @@ private slots:
     void emptyGapFill()
     {
         mNextPostId = 3;
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 4);
 
         mNextPostId = 1;
@@ -130,11 +129,11 @@ private slots:
         auto gap = Post::createGapPlaceHolder("GAP");
         const int gapId = gap.getGapId();
         posts.push_back(gap);
-        mPostFeedModel->prependPosts(posts, posts.size());
+        prependToTimeline(posts);
         QCOMPARE(mPostFeedModel->rowCount(), 7); // 6 posts + gap place holder
 
         mNextPostId = 3;
-        mPostFeedModel->gapFill(getTimeline(2, TEST_DATE, "bar"), 2, gapId);
+        fillGap(2, getTimeline(2, TEST_DATE, "bar"), gapId);
         QCOMPARE(mPostFeedModel->rowCount(), 6); // 6 posts (all gap posts filtered away)
 
         for (int i = 0; i < mPostFeedModel->rowCount(); ++i)
@@ -148,7 +147,7 @@ private slots:
     void gapFillAfterGapMoveDown()
     {
         mNextPostId = 3;
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 4);
 
         mNextPostId = 1;
@@ -156,14 +155,14 @@ private slots:
         auto gap = Post::createGapPlaceHolder("GAP");
         const int gapId = gap.getGapId();
         posts.push_back(gap);
-        mPostFeedModel->prependPosts(posts, posts.size());
+        prependToTimeline(posts);
         QCOMPARE(mPostFeedModel->rowCount(), 6); // 5 posts + gap place holder
 
         const Post& post = mPostFeedModel->getPost(1);
         QVERIFY(post.isGap());
         QCOMPARE(post.getGapId(), gapId);
 
-        mPostFeedModel->prependPosts(getTimeline(1, TEST_DATE), 1);
+        prependToTimeline(getTimeline(1, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 7); // 6 posts + gap place holder
 
         const Post& post2 = mPostFeedModel->getPost(1);
@@ -174,7 +173,7 @@ private slots:
         QCOMPARE(post3.getGapId(), gapId);
 
         mNextPostId = 2;
-        mPostFeedModel->gapFill(getTimeline(3, TEST_DATE + 1s), 1, gapId);
+        fillGap(2, getTimeline(1, TEST_DATE + 1s), gapId);
         QCOMPARE(mPostFeedModel->rowCount(), 7); // 7 posts
 
         for (int i = 0; i < mPostFeedModel->rowCount(); ++i)
@@ -192,7 +191,7 @@ private slots:
     void gapFillAfterGapMoveUp()
     {
         mNextPostId = 3;
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
         QCOMPARE(mPostFeedModel->rowCount(), 4);
 
         mNextPostId = 1;
@@ -200,14 +199,14 @@ private slots:
         auto gap = Post::createGapPlaceHolder("GAP");
         const int gapId = gap.getGapId();
         posts.push_back(gap);
-        mPostFeedModel->prependPosts(posts, posts.size());
+        prependToTimeline(posts);
         QCOMPARE(mPostFeedModel->rowCount(), 6); // 5 posts + gap place holder
 
         const Post& post = mPostFeedModel->getPost(1);
         QVERIFY(post.isGap());
         QCOMPARE(post.getGapId(), gapId);
 
-        mPostFeedModel->removeHeadPosts(getTimeline(1, TEST_DATE + 2s), 1);
+        removeTimelineHead(1);
         QCOMPARE(mPostFeedModel->rowCount(), 5); // 4 posts + gap place holder
 
         const Post& post2 = mPostFeedModel->getPost(1);
@@ -218,7 +217,7 @@ private slots:
         QCOMPARE(post3.getGapId(), gapId);
 
         mNextPostId = 2;
-        mPostFeedModel->gapFill(getTimeline(3, TEST_DATE + 1s), 1, gapId);
+        fillGap(0, getTimeline(1, TEST_DATE + 1s), gapId);
         QCOMPARE(mPostFeedModel->rowCount(), 5); // 5 posts
 
         for (int i = 0; i < mPostFeedModel->rowCount(); ++i)
@@ -235,24 +234,104 @@ private slots:
 
     void removeTailPosts()
     {
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE - 1h), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
+        appendToTimeline(getTimeline(5, TEST_DATE - 1h));
         QCOMPARE(mPostFeedModel->rowCount(), 8);
 
-        mPostFeedModel->removeTailPosts(getTimeline(5, TEST_DATE - 1h), 5);
+        removeTimelineTail(5);
         QCOMPARE(mPostFeedModel->rowCount(), 4);
     }
 
     void removeHeadPosts()
     {
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE), 5);
-        mPostFeedModel->addPosts(getTimeline(5, TEST_DATE - 1h), 5);
+        appendToTimeline(getTimeline(5, TEST_DATE));
+        appendToTimeline(getTimeline(5, TEST_DATE - 1h));
         QCOMPARE(mPostFeedModel->rowCount(), 8);
 
-        mPostFeedModel->removeHeadPosts(getTimeline(6, TEST_DATE), 6);
+        removeTimelineHead(6);
         QCOMPARE(mPostFeedModel->rowCount(), 3);
     }
 
+    void unfoldPosts()
+    {
+        setTimeline(getTimeline(4, TEST_DATE));
+        QSignalSpy spy(mPostFeedModel.get(), &FilteredPostFeedModel::unfoldTimelinePosts);
+
+        prependToTimeline(getTimeline(4, TEST_DATE + 1h));
+        mPostFeedModel->unfoldPosts(3);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.takeFirst().at(0).toInt(), 4);
+    }
+
+    void compareToFilteringTimeline()
+    {
+        // The model must show the posts stored in the timeline, not copies.
+        // A fixed seed makes a failure reproducible.
+        static constexpr quint32 SEED = 20231120;
+        QRandomGenerator generator(SEED);
+        auto* random = &generator;
+        QDateTime headTime = TEST_DATE;
+        QDateTime tailTime = TEST_DATE;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            const int size = random->bounded(1, 20);
+
+            switch (random->bounded(5))
+            {
+            case 0:
+            {
+                headTime = headTime.addSecs(size + 1);
+                auto posts = getTimeline(size, headTime);
+
+                if (random->bounded(2))
+                    posts.push_back(Post::createGapPlaceHolder("GAP"));
+
+                prependToTimeline(posts);
+                break;
+            }
+            case 1:
+                tailTime = tailTime.addSecs(-size);
+                appendToTimeline(getTimeline(size, tailTime));
+                break;
+            case 2:
+            {
+                const auto gapIt = std::find_if(mTimeline.begin(), mTimeline.end(), [](const Post& post){ return post.isGap(); });
+
+                if (gapIt != mTimeline.end())
+                    fillGap(gapIt - mTimeline.begin(), getTimeline(random->bounded(3), TEST_DATE), gapIt->getGapId());
+
+                break;
+            }
+            case 3:
+                if (size < (int)mTimeline.size())
+                    removeTimelineHead(size);
+
+                break;
+            case 4:
+                if (size < (int)mTimeline.size())
+                    removeTimelineTail(size);
+
+                break;
+            }
+
+            std::vector<const Post*> expected;
+
+            for (const auto& post : mTimeline)
+            {
+                if (post.isGap() || post.getAuthor().getDid() == "did:plc:foo")
+                    expected.push_back(&post);
+            }
+
+            const QString step = QString("seed: %1 step: %2").arg(SEED).arg(i);
+            QVERIFY2(mPostFeedModel->rowCount() == (int)expected.size(),
+                     qPrintable(QString("%1 rows: %2 expected: %3").arg(step).arg(mPostFeedModel->rowCount()).arg(expected.size())));
+
+            for (int row = 0; row < (int)expected.size(); ++row)
+                QVERIFY2(&mPostFeedModel->getPost(row) == expected[row], qPrintable(QString("%1 row: %2").arg(step).arg(row)));
+        }
+    }
+
 private:
     static constexpr char const* POST_TEMPLATE = R"##({
         "post": {
@@ -273,6 +352,52 @@ private:
 
     const QDateTime TEST_DATE = QDateTime::fromString("2023-11-20T18:46:00.000Z", Qt::ISODateWithMs);
 
+    // The functions below change the timeline like PostFeedModel does.
+    void setTimeline(const std::deque<Post>& posts)
+    {
+        mTimeline = posts;
+        mPostFeedModel->setPosts();
+    }
+
+    void clearTimeline()
+    {
+        mPostFeedModel->clear();
+        mTimeline.clear();
+    }
+
+    void appendToTimeline(const std::deque<Post>& posts)
+    {
+        const size_t startIndex = mTimeline.size();
+        mTimeline.insert(mTimeline.end(), posts.begin(), posts.end());
+        mPostFeedModel->addPosts(startIndex, posts.size());
+    }
+
+    void prependToTimeline(const std::deque<Post>& posts)
+    {
+        mTimeline.insert(mTimeline.begin(), posts.begin(), posts.end());
+        mPostFeedModel->prependPosts(posts.size());
+    }
+
+    void fillGap(size_t gapIndex, const std::deque<Post>& posts, int gapId)
+    {
+        QCOMPARE(mTimeline[gapIndex].getGapId(), gapId);
+        mTimeline.erase(mTimeline.begin() + gapIndex);
+        mTimeline.insert(mTimeline.begin() + gapIndex, posts.begin(), posts.end());
+        mPostFeedModel->gapFill(gapIndex, posts.size(), gapId);
+    }
+
+    void removeTimelineHead(size_t numPosts)
+    {
+        mTimeline.erase(mTimeline.begin(), mTimeline.begin() + numPosts);
+        mPostFeedModel->removeHeadPosts(numPosts);
+    }
+
+    void removeTimelineTail(size_t numPosts)
+    {
+        mTimeline.erase(mTimeline.end() - numPosts, mTimeline.end());
+        mPostFeedModel->removeTailPosts();
+    }
+
     std::deque<Post> getTimeline(int numPosts, QDateTime startTime, QString authorId = "")
     {
         std::deque<Post> timeline;
@@ -331,6 +456,7 @@ private:
     MutedWords mMutedWords;
     FocusHashtags mFocusHashtags;
     HashtagIndex mHashtags{10};
+    std::deque<Post> mTimeline;
     FilteredPostFeedModel::Ptr mPostFeedModel;
     int mNextPostId = 1;
 };
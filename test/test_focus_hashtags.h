@@ -62,6 +62,13 @@ private slots:
             << QColor{"yellow"}
             << std::set<QString>{ "hello", "world" };
 
+        QTest::newRow("first in text")
+            << std::vector<TestFocus>{ {{"hello"}, "blue"}, {{"world"}, "yellow"} }
+            << "#world #hello"
+            << true
+            << QColor{"yellow"}
+            << std::set<QString>{ "hello", "world" };
+
         QTest::newRow("multi hashtag entry 1")
             << std::vector<TestFocus>{ {{"hello", "moon"}, "blue"} }
             << "#hello #world"
@@ -107,12 +114,20 @@ private slots:
         }
 
         const auto post = setPost(text);
+        const auto matcher = focusHashtags.createMatcher();
         QCOMPARE(focusHashtags.match(post), match);
+        QCOMPARE(matcher->match(post), match);
 
         if (color.isValid())
+        {
             QCOMPARE(focusHashtags.highlightColor(post), color);
+            QCOMPARE(matcher->highlightColor(post), color);
+        }
         else
+        {
             QVERIFY(!focusHashtags.highlightColor(post).isValid());
+            QVERIFY(!matcher->highlightColor(post).isValid());
+        }
 
         QCOMPARE(focusHashtags.getNormalizedMatchHashtags(post), matchedTags);
     }
@@ -145,6 +160,18 @@ private slots:
         QVERIFY(!focusHashtags.match(post));
     }
 
+    void changeHighlightColor()
+    {
+        const auto post = setPost("#World #order");
+
+        FocusHashtags focusHashtags;
+        focusHashtags.addEntry("world", Qt::red);
+        QCOMPARE(focusHashtags.highlightColor(post), QColor(Qt::red));
+
+        focusHashtags.getEntries().front()->setHighlightColor(Qt::blue);
+        QCOMPARE(focusHashtags.highlightColor(post), QColor(Qt::blue));
+    }
+
     void addToEntry()
     {
         const auto post = setPost("#World #order");
@@ -182,6 +209,20 @@ private slots:
         QCOMPARE(focusHashtags.getEntries().size(), 0);
     }
 
+    void resetWordTokens()
+    {
+        const auto post = setPost("#World #order");
+        post.buildIndices();
+
+        WordTokenInterner::instance().reset();
+        QCOMPARE(WordTokenInterner::instance().size(), 0);
+
+        // The indices of the post are rebuilt with new tokens.
+        FocusHashtags focusHashtags;
+        focusHashtags.addEntry("world");
+        QVERIFY(focusHashtags.match(post));
+    }
+
     void noDuplicates()
     {
         FocusHashtagEntry entry;
@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <focus_hashtags.h>
+#include <formatted_text_cache.h>
+#include <user_settings.h>
+#include <atproto/lib/post_master.h>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestFormattedTextCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mFocusHashtags = std::make_unique<FocusHashtags>();
+        mCache = std::make_unique<FormattedTextCache>(10);
+        mLinkColor = UserSettings::getCurrentLinkColor();
+    }
+
+    void cleanup()
+    {
+        UserSettings::setCurrentLinkColor(mLinkColor);
+        mCache = nullptr;
+        mFocusHashtags = nullptr;
+    }
+
+    void cacheHit()
+    {
+        const auto post = createPost("cid1", "Hello #skywalker https://example.com");
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 1);
+        QCOMPARE(mCache->size(), 1);
+    }
+
+    void focusHashtagsChanged()
+    {
+        const auto post = createPost("cid1", "Hello #skywalker");
+        mCache->getFormattedText(post, *mFocusHashtags);
+        QCOMPARE(mCache->getFormatCount(), 1);
+
+        mFocusHashtags->addEntry("#skywalker", Qt::red);
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 2);
+
+        auto* entry = mFocusHashtags->getEntries().front();
+        mFocusHashtags->addHashtagToEntry(entry, "#bluesky");
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 3);
+
+        entry->setHighlightColor(Qt::blue);
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 4);
+
+        mFocusHashtags->removeEntry(entry->getId());
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 5);
+
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 5);
+    }
+
+    void linkColorChanged()
+    {
+        const auto post = createPost("cid1", "Hello https://example.com");
+        mCache->getFormattedText(post, *mFocusHashtags);
+        QCOMPARE(mCache->getFormatCount(), 1);
+
+        UserSettings::setCurrentLinkColor("#123456");
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 2);
+    }
+
+    void postWithoutCid()
+    {
+        const auto post = createPost("", "Draft");
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormattedText(post, *mFocusHashtags), expectedText(post));
+        QCOMPARE(mCache->getFormatCount(), 2);
+        QCOMPARE(mCache->size(), 0);
+    }
+
+    void maxSize()
+    {
+        for (int i = 0; i < 20; ++i)
+            mCache->getFormattedText(createPost(QString("cid%1").arg(i), "Hello"), *mFocusHashtags);
+
+        QCOMPARE(mCache->size(), 10);
+        mCache->clear();
+        QCOMPARE(mCache->size(), 0);
+    }
+
+    void focusHashtagsVersion()
+    {
+        quint64 version = mFocusHashtags->getVersion();
+
+        mFocusHashtags->addEntry("#skywalker");
+        QVERIFY(mFocusHashtags->getVersion() != version);
+        version = mFocusHashtags->getVersion();
+
+        auto* entry = mFocusHashtags->getEntries().front();
+        entry->setHighlightColor(Qt::green);
+        QVERIFY(mFocusHashtags->getVersion() != version);
+        version = mFocusHashtags->getVersion();
+
+        entry->setHighlightColor(Qt::green);
+        QCOMPARE(mFocusHashtags->getVersion(), version);
+
+        mFocusHashtags->clear();
+        QVERIFY(mFocusHashtags->getVersion() != version);
+    }
+
+private:
+    QString expectedText(const Post& post) const
+    {
+        return post.getFormattedText(mFocusHashtags->getNormalizedMatchHashtags(post));
+    }
+
+    Post createPost(const QString& cid, const QString& text)
+    {
+        ATProto::Client client(nullptr);
+        ATProto::PostMaster pm(client);
+        auto postView = std::make_shared<ATProto::AppBskyFeed::PostView>();
+        postView->mCid = cid;
+
+        pm.createPost(text, "", nullptr, [postView](auto&& postRecord){
+            const auto json = postRecord->toJson();
+            postView->mRecordType = ATProto::RecordType::APP_BSKY_FEED_POST;
+            postView->mRecord = ATProto::AppBskyFeed::Record::Post::fromJson(json);
+            postView->mAuthor = std::make_shared<ATProto::AppBskyActor::ProfileViewBasic>();
+        });
+
+        return Post(postView);
+    }
+
+    std::unique_ptr<FocusHashtags> mFocusHashtags;
+    std::unique_ptr<FormattedTextCache> mCache;
+    QString mLinkColor;
+};
@@ -0,0 +1,122 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <grapheme_block_data.h>
+#include <QRandomGenerator>
+#include <QTextBoundaryFinder>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestGraphemeBlockData : public QObject
+{
+    Q_OBJECT
+private slots:
+    void emojiLength_data()
+    {
+        QTest::addColumn<QString>("grapheme");
+        QTest::addColumn<int>("emojiLength");
+
+        QTest::newRow("letter") << QString("a") << 0;
+        QTest::newRow("single emoji") << QString("\U0001F600") << 0;
+        QTest::newRow("rainbow flag") << QString("\U0001F3F3\uFE0F\u200D\U0001F308") << 6;
+        QTest::newRow("keycap") << QString("1\uFE0F\u20E3") << 3;
+    }
+
+    void emojiLength()
+    {
+        QFETCH(QString, grapheme);
+        QFETCH(int, emojiLength);
+        QCOMPARE(GraphemeBlockData::getEmojiLength(grapheme), emojiLength);
+    }
+
+    void edits_data()
+    {
+        QTest::addColumn<QString>("oldText");
+        QTest::addColumn<QString>("newText");
+
+        QTest::newRow("empty") << QString("") << QString("hello \U0001F600");
+        QTest::newRow("append") << QString("hello") << QString("hello world");
+        QTest::newRow("clear") << QString("hello \U0001F600") << QString("");
+        QTest::newRow("join ZWJ") << QString("a \U0001F3F3\uFE0F b") << QString("a \U0001F3F3\uFE0F\u200D\U0001F308 b");
+        QTest::newRow("split ZWJ") << QString("a \U0001F3F3\uFE0F\u200D\U0001F308 b") << QString("a \U0001F3F3\uFE0F b");
+        QTest::newRow("add keycap") << QString("press 1 now") << QString("press 1\uFE0F\u20E3 now");
+        QTest::newRow("flag parity") << QString("\U0001F1F3\U0001F1F1\U0001F1E9\U0001F1EA")
+                                     << QString("\U0001F1FA\U0001F1F3\U0001F1F1\U0001F1E9\U0001F1EA");
+        QTest::newRow("combining mark") << QString("cafe latte") << QString("cafe\u0301 latte");
+    }
+
+    void edits()
+    {
+        QFETCH(QString, oldText);
+        QFETCH(QString, newText);
+
+        GraphemeBlockData data;
+        data.update(oldText);
+        checkGraphemes(data);
+        data.update(newText);
+        checkGraphemes(data);
+    }
+
+    void randomEdits()
+    {
+        const QStringList pieces = { "a", "b", " ", "\U0001F600", "\uFE0F", "\u200D", "\u20E3",
+                                     "\U0001F3F3", "\U0001F308", "\U0001F1F3", "\U0001F1F1", "\u0301", "1" };
+        QRandomGenerator generator(42);
+        QString text;
+        GraphemeBlockData data;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const int position = text.isEmpty() ? 0 : generator.bounded(text.size() + 1);
+
+            if (generator.bounded(3) == 0 && position < text.size())
+                text.remove(position, generator.bounded(1, 4));
+            else
+                text.insert(position, pieces[generator.bounded(pieces.size())]);
+
+            data.update(text);
+            checkGraphemes(data);
+        }
+    }
+
+    void segmentOnlyAroundChange()
+    {
+        QString text;
+
+        for (int i = 0; i < 500; ++i)
+            text += QString("word \U0001F3F3\uFE0F\u200D\U0001F308 ");
+
+        GraphemeBlockData data;
+        QCOMPARE(data.update(text), (int)text.size());
+
+        text.insert(text.size() / 2, "\U0001F600");
+        QVERIFY(data.update(text) < 40);
+        checkGraphemes(data);
+
+        QCOMPARE(data.update(text), 0);
+    }
+
+private:
+    static void checkGraphemes(const GraphemeBlockData& data)
+    {
+        const QString& text = data.getText();
+        QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, text);
+        std::vector<int> expected;
+        int next;
+
+        while ((next = boundaryFinder.toNextBoundary()) != -1)
+            expected.push_back(next);
+
+        const auto& graphemes = data.getGraphemes();
+        QCOMPARE(data.getLength(), (int)expected.size());
+        int prev = 0;
+
+        for (int i = 0; i < (int)expected.size(); ++i)
+        {
+            QCOMPARE(graphemes[i].mEnd, expected[i]);
+            QCOMPARE(graphemes[i].mEmojiLength, GraphemeBlockData::getEmojiLength(QStringView(text).sliced(prev, expected[i] - prev)));
+            prev = expected[i];
+        }
+    }
+};
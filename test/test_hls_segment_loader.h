@@ -0,0 +1,217 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "test_http_server.h"
+#include <hls_segment_loader.h>
+#include <m3u8_reader.h>
+#include <QBuffer>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+#include <limits>
+
+using namespace Skywalker;
+
+class TestHlsSegmentLoader : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mServer = std::make_unique<TestHttpServer>();
+        QVERIFY(mServer->start());
+        mLoader = std::make_unique<HlsSegmentLoader>(mNetwork);
+        mOutput.setData({});
+        mOutput.open(QIODevice::WriteOnly);
+    }
+
+    void cleanup()
+    {
+        mLoader = nullptr;
+        mServer = nullptr;
+        mOutput.close();
+    }
+
+    void writeInOrder()
+    {
+        // Later segments are faster, so they complete out of order.
+        const auto variants = createVariants(1, SEGMENT_COUNT, [](int segment){ return 10 * (SEGMENT_COUNT - segment); });
+        QSignalSpy finishedSpy(mLoader.get(), &HlsSegmentLoader::finished);
+
+        QVERIFY(mLoader->start(variants, 0, &mOutput));
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QVERIFY(!mLoader->isActive());
+        QCOMPARE(mOutput.data(), expectedOutput({ 0, 0, 0, 0, 0, 0, 0, 0 }));
+        QCOMPARE(mServer->getRequestCount(), SEGMENT_COUNT);
+        QVERIFY(mServer->getPeakActiveRequests() > 1);
+        QVERIFY(mServer->getPeakActiveRequests() <= HlsSegmentLoader::DEFAULT_MAX_CONCURRENT);
+    }
+
+    void maxConcurrent()
+    {
+        const auto variants = createVariants(1, SEGMENT_COUNT, [](int){ return 10; });
+        QSignalSpy finishedSpy(mLoader.get(), &HlsSegmentLoader::finished);
+        mLoader->setMaxConcurrent(1);
+
+        QVERIFY(mLoader->start(variants, 0, &mOutput));
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QCOMPARE(mOutput.data(), expectedOutput({ 0, 0, 0, 0, 0, 0, 0, 0 }));
+        QCOMPARE(mServer->getPeakActiveRequests(), 1);
+    }
+
+    void maxBufferedBytes()
+    {
+        // The first segment is slow, the others get buffered.
+        const auto variants = createVariants(1, SEGMENT_COUNT, [](int segment){ return segment == 0 ? 200 : 0; });
+        QSignalSpy finishedSpy(mLoader.get(), &HlsSegmentLoader::finished);
+        mLoader->setMaxConcurrent(4);
+        mLoader->setMaxBufferedBytes(SEGMENT_SIZE);
+
+        QVERIFY(mLoader->start(variants, 0, &mOutput));
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QCOMPARE(mOutput.data(), expectedOutput({ 0, 0, 0, 0, 0, 0, 0, 0 }));
+
+        // Only the downloads in flight when the maximum was reached exceed it.
+        QVERIFY(mLoader->getPeakBufferedBytes() >= SEGMENT_SIZE);
+        QVERIFY(mLoader->getPeakBufferedBytes() <= 3 * SEGMENT_SIZE);
+    }
+
+    void switchUp()
+    {
+        auto variants = createVariants(2, SEGMENT_COUNT, [](int){ return 10; });
+        variants[1].mMinBandwidthKbps = 1;
+        QSignalSpy finishedSpy(mLoader.get(), &HlsSegmentLoader::finished);
+        QSignalSpy switchSpy(mLoader.get(), &HlsSegmentLoader::variantSwitched);
+        mLoader->setMaxConcurrent(1);
+
+        QVERIFY(mLoader->start(variants, 0, &mOutput));
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QCOMPARE(switchSpy.count(), 1);
+        QCOMPARE(mLoader->getVariantIndex(), 1);
+        QVERIFY(mLoader->getMeasuredKbps() > 0);
+
+        // The switch happens after the minimum number of samples
+        QCOMPARE(mOutput.data(), expectedOutput({ 0, 0, 1, 1, 1, 1, 1, 1 }));
+    }
+
+    void switchDown()
+    {
+        auto variants = createVariants(2, SEGMENT_COUNT, [](int){ return 0; });
+        variants[1].mMinBandwidthKbps = std::numeric_limits<int>::max();
+        QSignalSpy finishedSpy(mLoader.get(), &HlsSegmentLoader::finished);
+        mLoader->setMaxConcurrent(1);
+
+        QVERIFY(mLoader->start(variants, 1, &mOutput));
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QCOMPARE(mLoader->getVariantIndex(), 0);
+        QCOMPARE(mOutput.data(), expectedOutput({ 1, 1, 0, 0, 0, 0, 0, 0 }));
+    }
+
+    void segmentNotFound()
+    {
+        auto variants = createVariants(1, SEGMENT_COUNT, [](int){ return 0; });
+        variants[0].mSegmentUrls[3] = mServer->getUrl("missing.ts");
+        QSignalSpy failedSpy(mLoader.get(), &HlsSegmentLoader::failed);
+
+        QVERIFY(mLoader->start(variants, 0, &mOutput));
+        QTRY_COMPARE(failedSpy.count(), 1);
+        QVERIFY(!mLoader->isActive());
+    }
+
+    void unalignedVariants()
+    {
+        auto variants = createVariants(2, SEGMENT_COUNT, [](int){ return 0; });
+        variants[1].mSegmentUrls.pop_back();
+        QVERIFY(!mLoader->start(variants, 0, &mOutput));
+    }
+
+    void m3u8Reader()
+    {
+        mServer->setContent("video.m3u8", "#EXTM3U\n360p/video.m3u8\n720p/video.m3u8\n");
+
+        const QStringList resolutions{ "360p", "720p" };
+
+        for (const QString& resolution : resolutions)
+        {
+            QByteArray playlist = "#EXTM3U\n";
+
+            for (int i = 0; i < 4; ++i)
+            {
+                playlist += "#EXTINF:2.0,\n" + QString("video%1.ts\n").arg(i).toUtf8();
+                mServer->setContent(QString("%1/video%2.ts").arg(resolution).arg(i), QString("%1-%2;").arg(resolution).arg(i).toUtf8());
+            }
+
+            mServer->setContent(resolution + "/video.m3u8", playlist);
+        }
+
+        M3U8Reader reader;
+        QSignalSpy streamOkSpy(&reader, &M3U8Reader::getVideoStreamOk);
+        QSignalSpy loadOkSpy(&reader, &M3U8Reader::loadStreamOk);
+
+        reader.getVideoStream(mServer->getUrl("video.m3u8"));
+        QTRY_COMPARE(streamOkSpy.count(), 1);
+        QCOMPARE(streamOkSpy.takeFirst().at(0).toInt(), 8000);
+
+        QTemporaryDir dir;
+        const QString fileName = dir.filePath("video.ts");
+        reader.loadStream(fileName);
+        QTRY_COMPARE(loadOkSpy.count(), 1);
+        QVERIFY(!reader.isLoading());
+
+        // The default bandwidth on desktop selects 720p to start with. The tiny
+        // segments may measure a low bandwidth and switch to 360p later.
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QString content = QString::fromUtf8(file.readAll());
+        static const QRegularExpression expected("^720p-0;720p-1;(360p|720p)-2;(360p|720p)-3;$");
+        QVERIFY2(expected.match(content).hasMatch(), qPrintable(content));
+    }
+
+private:
+    HlsSegmentLoader::VariantList createVariants(int variantCount, int segmentCount, const std::function<int(int)>& delayMs)
+    {
+        HlsSegmentLoader::VariantList variants;
+
+        for (int v = 0; v < variantCount; ++v)
+        {
+            HlsSegmentLoader::Variant variant;
+            variant.mMinBandwidthKbps = v * 1000;
+
+            for (int s = 0; s < segmentCount; ++s)
+            {
+                const QString path = QString("v%1/seg%2.ts").arg(v).arg(s);
+                mServer->setContent(path, getSegmentData(v, s), delayMs(s));
+                variant.mSegmentUrls.push_back(mServer->getUrl(path));
+            }
+
+            variants.push_back(variant);
+        }
+
+        return variants;
+    }
+
+    static QByteArray getSegmentData(int variant, int segment)
+    {
+        QByteArray data = QString("v%1s%2:").arg(variant).arg(segment).toUtf8();
+        data.resize(SEGMENT_SIZE, '.');
+        return data;
+    }
+
+    static QByteArray expectedOutput(const std::vector<int>& variantPerSegment)
+    {
+        QByteArray data;
+
+        for (int s = 0; s < (int)variantPerSegment.size(); ++s)
+            data += getSegmentData(variantPerSegment[s], s);
+
+        return data;
+    }
+
+    static constexpr int SEGMENT_COUNT = 8;
+    static constexpr int SEGMENT_SIZE = 1000;
+    QNetworkAccessManager mNetwork;
+    std::unique_ptr<TestHttpServer> mServer;
+    std::unique_ptr<HlsSegmentLoader> mLoader;
+    QBuffer mOutput;
+};
@@ -0,0 +1,81 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <QHashFunctions>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <unordered_map>
+
+// Local HTTP stand-in serving fixed content per path.
+class TestHttpServer : public QTcpServer
+{
+public:
+    TestHttpServer()
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]{
+            while (auto* socket = nextPendingConnection())
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]{ handleRequest(socket); });
+        });
+    }
+
+    bool start() { return listen(QHostAddress::LocalHost); }
+    QString getUrl(const QString& path) const { return QString("http://127.0.0.1:%1/%2").arg(serverPort()).arg(path); }
+
+    void setContent(const QString& path, const QByteArray& content, int delayMs = 0)
+    {
+        mContent[path] = { content, delayMs };
+    }
+
+    int getRequestCount() const { return mRequestCount; }
+    int getPeakActiveRequests() const { return mPeakActiveRequests; }
+
+private:
+    struct Content
+    {
+        QByteArray mData;
+        int mDelayMs = 0;
+    };
+
+    void handleRequest(QTcpSocket* socket)
+    {
+        auto& request = mRequests[socket];
+        request += socket->readAll();
+
+        if (!request.contains("\r\n\r\n"))
+            return;
+
+        const QString path = QString::fromUtf8(request.split(' ').value(1)).sliced(1);
+        mRequests.erase(socket);
+        ++mRequestCount;
+        ++mActiveRequests;
+        mPeakActiveRequests = std::max(mPeakActiveRequests, mActiveRequests);
+
+        auto it = mContent.find(path);
+        const int delayMs = it != mContent.end() ? it->second.mDelayMs : 0;
+
+        QTimer::singleShot(delayMs, socket, [this, socket, path]{
+            --mActiveRequests;
+            auto contentIt = mContent.find(path);
+
+            if (contentIt == mContent.end())
+            {
+                socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            }
+            else
+            {
+                const QByteArray& data = contentIt->second.mData;
+                socket->write(QString("HTTP/1.1 200 OK\r\nContent-Length: %1\r\nConnection: close\r\n\r\n").arg(data.size()).toUtf8());
+                socket->write(data);
+            }
+
+            socket->disconnectFromHost();
+        });
+    }
+
+    std::unordered_map<QString, Content> mContent;
+    std::unordered_map<QTcpSocket*, QByteArray> mRequests;
+    int mRequestCount = 0;
+    int mActiveRequests = 0;
+    int mPeakActiveRequests = 0;
+};
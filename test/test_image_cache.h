@@ -0,0 +1,119 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <image_cache.h>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestImageCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        // Room for 3 test images
+        mCache = std::make_unique<ImageCache>("test", 3 * getImageBytes());
+    }
+
+    void cleanup()
+    {
+        mCache = nullptr;
+    }
+
+    void putAndGet()
+    {
+        QVERIFY(mCache->get("img1").isNull());
+        mCache->put("img1", createImage(Qt::red));
+        QCOMPARE(mCache->get("img1").pixelColor(0, 0), QColor(Qt::red));
+        QCOMPARE((int)mCache->size(), 1);
+        QCOMPARE(mCache->getBytes(), getImageBytes());
+        QCOMPARE(mCache->getHits(), qint64(1));
+        QCOMPARE(mCache->getMisses(), qint64(1));
+        QCOMPARE(mCache->getHitRate(), 0.5);
+
+        mCache->put("img1", createImage(Qt::blue));
+        QCOMPARE(mCache->get("img1").pixelColor(0, 0), QColor(Qt::blue));
+        QCOMPARE(mCache->getBytes(), getImageBytes());
+
+        mCache->remove("img1");
+        QVERIFY(!mCache->contains("img1"));
+        QCOMPARE(mCache->getBytes(), qint64(0));
+    }
+
+    void evictLeastRecentlyUsed()
+    {
+        mCache->put("img1", createImage(Qt::red));
+        mCache->put("img2", createImage(Qt::red));
+        mCache->put("img3", createImage(Qt::red));
+        mCache->get("img1");
+        mCache->put("img4", createImage(Qt::red));
+
+        QVERIFY(mCache->contains("img1"));
+        QVERIFY(!mCache->contains("img2"));
+        QVERIFY(mCache->contains("img3"));
+        QVERIFY(mCache->contains("img4"));
+        QCOMPARE(mCache->getEvictions(), qint64(1));
+        QCOMPARE(mCache->getBytes(), 3 * getImageBytes());
+    }
+
+    void pinned()
+    {
+        mCache->pin("img1");
+        mCache->put("img1", createImage(Qt::red));
+        mCache->put("img2", createImage(Qt::red));
+        mCache->put("img3", createImage(Qt::red));
+        mCache->put("img4", createImage(Qt::red));
+
+        QVERIFY(mCache->contains("img1"));
+        QVERIFY(!mCache->contains("img2"));
+
+        // Pinned images may exceed the budget
+        mCache->pin("img3");
+        mCache->pin("img4");
+        mCache->pin("img5");
+        mCache->put("img5", createImage(Qt::red));
+        QCOMPARE((int)mCache->size(), 4);
+        QCOMPARE(mCache->getBytes(), 4 * getImageBytes());
+
+        // Unpinning brings the cache back within budget
+        mCache->unpin("img3");
+        QVERIFY(!mCache->contains("img3"));
+        QCOMPARE(mCache->getBytes(), 3 * getImageBytes());
+    }
+
+    void pinCount()
+    {
+        mCache->pin("img1");
+        mCache->pin("img1");
+        mCache->unpin("img1");
+        QVERIFY(mCache->isPinned("img1"));
+        mCache->unpin("img1");
+        QVERIFY(!mCache->isPinned("img1"));
+    }
+
+    void shrinkBudget()
+    {
+        mCache->put("img1", createImage(Qt::red));
+        mCache->put("img2", createImage(Qt::red));
+        mCache->setMaxBytes(getImageBytes());
+        QVERIFY(!mCache->contains("img1"));
+        QVERIFY(mCache->contains("img2"));
+    }
+
+private:
+    static QImage createImage(QColor color)
+    {
+        QImage img(IMAGE_SIZE, QImage::Format_ARGB32);
+        img.fill(color);
+        return img;
+    }
+
+    static qint64 getImageBytes()
+    {
+        return createImage(Qt::black).sizeInBytes();
+    }
+
+    static constexpr QSize IMAGE_SIZE{ 10, 10 };
+    std::unique_ptr<ImageCache> mCache;
+};
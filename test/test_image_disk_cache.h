@@ -0,0 +1,166 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <image_disk_cache.h>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestImageDiskCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mDir = std::make_unique<QTemporaryDir>();
+        QVERIFY(mDir->isValid());
+        mCache = std::make_unique<ImageDiskCache>(mDir->path(), 4 * ITEM_SIZE);
+    }
+
+    void cleanup()
+    {
+        mCache = nullptr;
+        mDir = nullptr;
+    }
+
+    void insertAndRead()
+    {
+        const QUrl url("https://cdn.bsky.app/img/avatar_thumbnail/plain/did:plc:foo/bar@jpeg");
+        QVERIFY(!mCache->metaData(url).isValid());
+        QVERIFY(!mCache->data(url));
+
+        insert(*mCache, url, "etag-1", 'A');
+        const auto metaData = mCache->metaData(url);
+        QVERIFY(metaData.isValid());
+        QCOMPARE(metaData.url(), url);
+        QCOMPARE(getETag(metaData), QByteArray("etag-1"));
+
+        std::unique_ptr<QIODevice> device(mCache->data(url));
+        QVERIFY(device);
+        QCOMPARE(device->readAll(), QByteArray(ITEM_SIZE, 'A'));
+        QCOMPARE(mCache->getHits(), 1);
+        QCOMPARE(mCache->getMisses(), 1);
+        QVERIFY(mCache->cacheSize() > ITEM_SIZE);
+
+        QVERIFY(mCache->remove(url));
+        QVERIFY(!mCache->metaData(url).isValid());
+        QCOMPARE(mCache->cacheSize(), qint64(0));
+    }
+
+    void updateMetaData()
+    {
+        const QUrl url("https://cdn.bsky.app/img/1");
+        insert(*mCache, url, "etag-1", 'A');
+
+        auto metaData = mCache->metaData(url);
+        metaData.setRawHeaders({{ "ETag", "etag-2" }});
+        mCache->updateMetaData(metaData);
+
+        QCOMPARE(getETag(mCache->metaData(url)), QByteArray("etag-2"));
+        std::unique_ptr<QIODevice> device(mCache->data(url));
+        QCOMPARE(device->readAll(), QByteArray(ITEM_SIZE, 'A'));
+    }
+
+    void abortInsert()
+    {
+        const QUrl url("https://cdn.bsky.app/img/1");
+        QIODevice* device = mCache->prepare(createMetaData(url, "etag-1"));
+        QVERIFY(device);
+        device->write("partial");
+        QVERIFY(!mCache->remove(url));
+        QVERIFY(!mCache->metaData(url).isValid());
+    }
+
+    void noStore()
+    {
+        const QUrl url("https://cdn.bsky.app/img/1");
+        auto metaData = createMetaData(url, "etag-1");
+        metaData.setSaveToDisk(false);
+        QVERIFY(!mCache->prepare(metaData));
+    }
+
+    void pruneLeastRecentlyUsed()
+    {
+        const QUrl url1("https://cdn.bsky.app/img/1");
+        const QUrl url2("https://cdn.bsky.app/img/2");
+        const QUrl url3("https://cdn.bsky.app/img/3");
+        const QUrl url4("https://cdn.bsky.app/img/4");
+
+        insert(*mCache, url1, "1", 'A');
+        insert(*mCache, url2, "2", 'B');
+        insert(*mCache, url3, "3", 'C');
+        setLastUsed(url1, 3);
+        setLastUsed(url2, 1);
+        setLastUsed(url3, 2);
+
+        insert(*mCache, url4, "4", 'D');
+        QVERIFY(mCache->metaData(url1).isValid());
+        QVERIFY(!mCache->metaData(url2).isValid());
+        QVERIFY(mCache->metaData(url3).isValid());
+        QVERIFY(mCache->metaData(url4).isValid());
+        QVERIFY(mCache->cacheSize() <= mCache->getMaxBytes());
+    }
+
+    void sharedDirectory()
+    {
+        const QUrl url("https://cdn.bsky.app/img/1");
+        insert(*mCache, url, "etag-1", 'A');
+
+        ImageDiskCache otherCache(mDir->path());
+        std::unique_ptr<QIODevice> device(otherCache.data(url));
+        QVERIFY(device);
+        QCOMPARE(device->readAll(), QByteArray(ITEM_SIZE, 'A'));
+        QCOMPARE(otherCache.cacheSize(), mCache->cacheSize());
+    }
+
+    void clear()
+    {
+        insert(*mCache, QUrl("https://cdn.bsky.app/img/1"), "1", 'A');
+        mCache->clear();
+        QCOMPARE(mCache->cacheSize(), qint64(0));
+        QVERIFY(!mCache->metaData(QUrl("https://cdn.bsky.app/img/1")).isValid());
+    }
+
+private:
+    static QNetworkCacheMetaData createMetaData(const QUrl& url, const QByteArray& etag)
+    {
+        QNetworkCacheMetaData metaData;
+        metaData.setUrl(url);
+        metaData.setRawHeaders({{ "ETag", etag }, { "Cache-Control", "max-age=3600" }});
+        metaData.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(3600));
+        return metaData;
+    }
+
+    static QByteArray getETag(const QNetworkCacheMetaData& metaData)
+    {
+        for (const auto& [header, value] : metaData.rawHeaders())
+        {
+            if (header == "ETag")
+                return value;
+        }
+
+        return {};
+    }
+
+    static void insert(ImageDiskCache& cache, const QUrl& url, const QByteArray& etag, char fill)
+    {
+        QIODevice* device = cache.prepare(createMetaData(url, etag));
+        QVERIFY(device);
+        device->write(QByteArray(ITEM_SIZE, fill));
+        cache.insert(device);
+    }
+
+    void setLastUsed(const QUrl& url, int minutes)
+    {
+        QFile file(mCache->getFileName(url));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QDateTime lastUsed = QDateTime::currentDateTimeUtc().addSecs(-3600 + minutes * 60);
+        QVERIFY(file.setFileTime(lastUsed, QFileDevice::FileModificationTime));
+    }
+
+    static constexpr int ITEM_SIZE = 1000;
+    std::unique_ptr<QTemporaryDir> mDir;
+    std::unique_ptr<ImageDiskCache> mCache;
+};
@@ -0,0 +1,148 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <incremental_facet_parser.h>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestIncrementalFacetParser : public QObject
+{
+    Q_OBJECT
+private slots:
+    void typing()
+    {
+        const QString text = createText(3);
+        IncrementalFacetParser parser;
+
+        for (int i = 1; i <= text.size(); ++i)
+        {
+            parser.setText(text.first(i));
+            checkFacets(parser);
+        }
+
+        QVERIFY(parser.getFacets().size() >= 9);
+    }
+
+    void edits_data()
+    {
+        QTest::addColumn<int>("position");
+        QTest::addColumn<int>("charsRemoved");
+        QTest::addColumn<QString>("added");
+
+        QTest::newRow("insert start") << 0 << 0 << QString("@bob.bsky.social ");
+        QTest::newRow("insert in mention") << 5 << 0 << QString("x");
+        QTest::newRow("split paragraph") << 30 << 0 << QString("\n");
+        QTest::newRow("join paragraphs") << 0 << 80 << QString("");
+        QTest::newRow("replace across paragraphs") << 20 << 60 << QString("#new\nhttps://example.org ");
+        QTest::newRow("remove all") << 0 << -1 << QString("");
+    }
+
+    void edits()
+    {
+        QFETCH(int, position);
+        QFETCH(int, charsRemoved);
+        QFETCH(QString, added);
+
+        const QString text = createText(4);
+
+        if (charsRemoved == -1)
+            charsRemoved = text.size();
+
+        IncrementalFacetParser parser;
+        parser.setText(text);
+        checkFacets(parser);
+
+        QString newText = text;
+        newText.replace(position, charsRemoved, added);
+        parser.applyChange(newText, position, charsRemoved, added.size());
+        checkFacets(parser);
+
+        parser.setText(text);
+        checkFacets(parser);
+    }
+
+    void inconsistentChange()
+    {
+        IncrementalFacetParser parser;
+        parser.setText("hello #world");
+        parser.applyChange("#sky @alice.bsky.social", 0, 1, 1);
+        checkFacets(parser);
+    }
+
+    void onlyChangedParagraphParsed()
+    {
+        const QString text = createText(50);
+        IncrementalFacetParser parser;
+        parser.setText(text);
+        QCOMPARE((int)parser.getParsedChars(), (int)text.size());
+
+        // Type at the end of the first paragraph
+        const int position = text.indexOf('\n');
+        QString newText = text;
+        newText.insert(position, " #more");
+        parser.setText(newText);
+        checkFacets(parser);
+        QCOMPARE((int)parser.getParsedChars(), (int)text.size() + position + 6);
+    }
+
+    void benchmarkIncremental()
+    {
+        const QString text = createText(30);
+        IncrementalFacetParser parser;
+        parser.setText(text);
+        int i = 0;
+
+        QBENCHMARK {
+            parser.setText(text + QString(i++ % 2 ? "x" : ""));
+        }
+
+        QVERIFY(!parser.getFacets().empty());
+    }
+
+    void benchmarkFullParse()
+    {
+        const QString text = createText(30);
+        int i = 0;
+        size_t count = 0;
+
+        QBENCHMARK {
+            count += ATProto::RichTextMaster::parseFacets(text + QString(i++ % 2 ? "x" : "")).size();
+        }
+
+        QVERIFY(count > 0);
+    }
+
+private:
+    // About 100 characters per paragraph
+    static QString createText(int paragraphs)
+    {
+        QStringList lines;
+
+        for (int i = 0; i < paragraphs; ++i)
+        {
+            lines.push_back(QString("Hi @user%1.bsky.social have a look at https://example.com/page/%1 "
+                                    "it is great #tag%1 and more text").arg(i));
+        }
+
+        return lines.join('\n');
+    }
+
+    static void checkFacets(const IncrementalFacetParser& parser)
+    {
+        auto expected = ATProto::RichTextMaster::parseFacets(parser.getText());
+        std::stable_sort(expected.begin(), expected.end(),
+            [](const auto& lhs, const auto& rhs){ return lhs.mStartIndex < rhs.mStartIndex; });
+
+        const auto& facets = parser.getFacets();
+        QCOMPARE((int)facets.size(), (int)expected.size());
+
+        for (int i = 0; i < (int)facets.size(); ++i)
+        {
+            QCOMPARE((int)facets[i].mType, (int)expected[i].mType);
+            QCOMPARE(facets[i].mStartIndex, expected[i].mStartIndex);
+            QCOMPARE(facets[i].mEndIndex, expected[i].mEndIndex);
+            QCOMPARE(facets[i].mMatch, expected[i].mMatch);
+        }
+    }
+};
@@ -0,0 +1,227 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include "test_http_server.h"
+#include <link_card_reader.h>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestLinkCardReader : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mServer = std::make_unique<TestHttpServer>();
+        QVERIFY(mServer->start());
+        mDiskCache = std::make_unique<LinkCardCache>(QString());
+        mReader = std::make_unique<LinkCardReader>();
+        mReader->setDiskCache(mDiskCache.get());
+    }
+
+    void cleanup()
+    {
+        mReader = nullptr;
+        mDiskCache = nullptr;
+        mServer = nullptr;
+    }
+
+    void isHeadComplete_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+        QTest::addColumn<bool>("complete");
+
+        QTest::newRow("empty") << QByteArray() << false;
+        QTest::newRow("open head") << QByteArray("<html><head><title>x</title>") << false;
+        QTest::newRow("head end") << QByteArray("<html><head></head>") << true;
+        QTest::newRow("head end upper case") << QByteArray("<HTML><HEAD></HEAD>") << true;
+        QTest::newRow("body") << QByteArray("<html><body>") << true;
+        QTest::newRow("og tags") << createHead("Title", "Description", "/img.jpg") << true;
+        QTest::newRow("og tags missing") << QByteArray(R"(<head><meta property="og:title" content="x">)") << false;
+        QTest::newRow("og tag cut off") << createHead("Title", "Description", "/img.jpg").chopped(10) << false;
+    }
+
+    void isHeadComplete()
+    {
+        QFETCH(QByteArray, data);
+        QFETCH(bool, complete);
+        QCOMPARE(LinkCardReader::isHeadComplete(data), complete);
+    }
+
+    void readCard()
+    {
+        // The body is large and never needed.
+        mServer->setContent("page", createPage("Title", "Description", "/img.jpg", 2 * LinkCardReader::MAX_HEAD_SIZE));
+        QSignalSpy cardSpy(mReader.get(), &LinkCardReader::linkCard);
+
+        mReader->getLinkCard(mServer->getUrl("page"));
+        QTRY_COMPARE(cardSpy.count(), 1);
+
+        const auto* card = cardSpy.takeFirst().at(0).value<LinkCard*>();
+        QVERIFY(card);
+        QCOMPARE(card->getTitle(), QString("Title"));
+        QCOMPARE(card->getDescription(), QString("Description"));
+        QCOMPARE(card->getThumb(), mServer->getUrl("img.jpg"));
+        QCOMPARE(mReader->getFetchCount(), 0);
+        QCOMPARE(mDiskCache->size(), 1);
+    }
+
+    void noCard()
+    {
+        mServer->setContent("page", "<html><head></head><body>Hello</body></html>");
+        QSignalSpy failedSpy(mReader.get(), &LinkCardReader::linkCardFailed);
+
+        mReader->getLinkCard(mServer->getUrl("page"));
+        QTRY_COMPARE(failedSpy.count(), 1);
+        QCOMPARE(mDiskCache->size(), 0);
+    }
+
+    void notFound()
+    {
+        QSignalSpy failedSpy(mReader.get(), &LinkCardReader::linkCardFailed);
+        mReader->getLinkCard(mServer->getUrl("missing"));
+        QTRY_COMPARE(failedSpy.count(), 1);
+    }
+
+    void dedupe()
+    {
+        mServer->setContent("page", createPage("Title", "Description", "/img.jpg"), 50);
+        QSignalSpy cardSpy(mReader.get(), &LinkCardReader::linkCard);
+
+        mReader->prefetchLinkCard(mServer->getUrl("page"));
+        mReader->prefetchLinkCard(mServer->getUrl("page"));
+        mReader->getLinkCard(mServer->getUrl("page"));
+        QCOMPARE(mReader->getFetchCount(), 1);
+        QTRY_COMPARE(cardSpy.count(), 1);
+        QCOMPARE(mServer->getRequestCount(), 1);
+
+        // From the memory cache
+        mReader->getLinkCard(mServer->getUrl("page"));
+        QCOMPARE(cardSpy.count(), 2);
+        QCOMPARE(mServer->getRequestCount(), 1);
+    }
+
+    void maxConcurrentPerHost()
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            const QString path = QString("page%1").arg(i);
+            mServer->setContent(path, createPage("Title", "Description", "/img.jpg"), 50);
+            mReader->prefetchLinkCard(mServer->getUrl(path));
+        }
+
+        QCOMPARE(mReader->getFetchCount(), 5);
+        QTRY_COMPARE(mReader->getFetchCount(), 0);
+        QCOMPARE(mServer->getRequestCount(), 5);
+        QCOMPARE(mServer->getPeakActiveRequests(), LinkCardReader::MAX_CONCURRENT_PER_HOST);
+        QCOMPARE(mDiskCache->size(), 5);
+    }
+
+    void lastRequestWins()
+    {
+        mServer->setContent("slow", createPage("Slow", "Description", "/img.jpg"), 200);
+        mServer->setContent("fast", createPage("Fast", "Description", "/img.jpg"));
+        QSignalSpy cardSpy(mReader.get(), &LinkCardReader::linkCard);
+
+        mReader->getLinkCard(mServer->getUrl("slow"));
+        mReader->getLinkCard(mServer->getUrl("fast"));
+        QTRY_COMPARE(mReader->getFetchCount(), 0);
+        QCOMPARE(cardSpy.count(), 1);
+        QCOMPARE(cardSpy.takeFirst().at(0).value<LinkCard*>()->getTitle(), QString("Fast"));
+
+        // The superseded request filled the cache
+        mReader->getLinkCard(mServer->getUrl("slow"));
+        QCOMPARE(cardSpy.count(), 1);
+        QCOMPARE(cardSpy.takeFirst().at(0).value<LinkCard*>()->getTitle(), QString("Slow"));
+        QCOMPARE(mServer->getRequestCount(), 2);
+    }
+
+    void diskCache()
+    {
+        QTemporaryDir dir;
+        const QString fileName = dir.filePath("cards.json");
+        LinkCard card;
+        card.setLink("https://example.com");
+        card.setTitle("Title");
+        card.setDescription("Description");
+        card.setThumb("https://example.com/img.jpg");
+
+        {
+            LinkCardCache cache(fileName);
+            cache.put(QUrl("https://example.com"), card);
+            cache.put(QUrl("https://empty.example.com"), LinkCard());
+            QCOMPARE(cache.size(), 1);
+            cache.flush();
+        }
+
+        {
+            LinkCardCache cache(fileName);
+            QCOMPARE(cache.size(), 1);
+            const auto entry = cache.get(QUrl("https://example.com"));
+            QVERIFY(entry);
+            QCOMPARE(entry->mLink, card.getLink());
+            QCOMPARE(entry->mTitle, card.getTitle());
+            QCOMPARE(entry->mDescription, card.getDescription());
+            QCOMPARE(entry->mThumb, card.getThumb());
+        }
+
+        {
+            LinkCardCache cache(fileName, std::chrono::seconds(0));
+            QCOMPARE(cache.size(), 0);
+        }
+    }
+
+    void diskCacheMaxEntries()
+    {
+        LinkCardCache cache(QString(), LinkCardCache::DEFAULT_TTL, 2);
+        LinkCard card;
+        card.setTitle("Title");
+
+        cache.put(QUrl("https://1.example.com"), card);
+        QTest::qWait(2);
+        cache.put(QUrl("https://2.example.com"), card);
+        QTest::qWait(2);
+        cache.put(QUrl("https://3.example.com"), card);
+
+        QCOMPARE(cache.size(), 2);
+        QVERIFY(!cache.get(QUrl("https://1.example.com")));
+        QVERIFY(cache.get(QUrl("https://3.example.com")));
+    }
+
+    void diskCacheHit()
+    {
+        LinkCard card;
+        card.setLink(mServer->getUrl("page"));
+        card.setTitle("Cached");
+        mDiskCache->put(QUrl(mServer->getUrl("page")), card);
+        QSignalSpy cardSpy(mReader.get(), &LinkCardReader::linkCard);
+
+        mReader->getLinkCard(mServer->getUrl("page"));
+        QCOMPARE(cardSpy.count(), 1);
+        QCOMPARE(cardSpy.takeFirst().at(0).value<LinkCard*>()->getTitle(), QString("Cached"));
+        QCOMPARE(mServer->getRequestCount(), 0);
+    }
+
+private:
+    static QByteArray createHead(const QString& title, const QString& description, const QString& image)
+    {
+        return QString(R"(<html><head><meta property="og:title" content="%1" />)"
+                       R"(<meta property="og:description" content="%2" />)"
+                       R"(<meta property="og:image" content="%3" />)").arg(title, description, image).toUtf8();
+    }
+
+    static QByteArray createPage(const QString& title, const QString& description, const QString& image, qsizetype bodySize = 100)
+    {
+        QByteArray page = createHead(title, description, image) + "</head><body>";
+        page += QByteArray(bodySize, 'x');
+        page += "</body></html>";
+        return page;
+    }
+
+    std::unique_ptr<TestHttpServer> mServer;
+    std::unique_ptr<LinkCardCache> mDiskCache;
+    std::unique_ptr<LinkCardReader> mReader;
+};
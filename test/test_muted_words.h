@@ -3,7 +3,10 @@
 #pragma once
 #include <muted_words.h>
 #include <post.h>
+#include <search_utils.h>
 #include <atproto/lib/post_master.h>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
 #include <QtTest/QTest>
 
 using namespace Skywalker;
@@ -194,7 +197,196 @@ private slots:
         QCOMPARE(mutedWords.getEntries().size(), 0);
     }
 
+    void phraseOverlap()
+    {
+        MutedWords mutedWords;
+        mutedWords.addEntry("quick brown");
+        mutedWords.addEntry("the quick brown fox");
+
+        QVERIFY(!mutedWords.match(setPost("the quick red fox")));
+        QVERIFY(mutedWords.match(setPost("the quick quick brown cat")));
+        QVERIFY(mutedWords.match(setPost("the the quick brown fox")));
+    }
+
+    void largeCorpus()
+    {
+        setupCorpus();
+        QLoggingCategory::setFilterRules("*.debug=false");
+
+        for (const auto& post : mCorpusPosts)
+            QCOMPARE(mCorpusMutedWords->match(post), mCorpusReference.match(post));
+
+        QLoggingCategory::setFilterRules("");
+    }
+
+    void benchmarkWordAutomaton()
+    {
+        setupCorpus();
+        QLoggingCategory::setFilterRules("*.debug=false");
+        int matches = 0;
+
+        QBENCHMARK {
+            for (const auto& post : mCorpusPosts)
+                matches += mCorpusMutedWords->match(post);
+        }
+
+        QLoggingCategory::setFilterRules("");
+        QVERIFY(matches > 0);
+    }
+
+    void benchmarkLinearScan()
+    {
+        setupCorpus();
+        int matches = 0;
+
+        QBENCHMARK {
+            for (const auto& post : mCorpusPosts)
+                matches += mCorpusReference.match(post);
+        }
+
+        QVERIFY(matches > 0);
+    }
+
 private:
+    // The matching algorithm before the word automaton: each muted entry is
+    // looked up in the post. Cost grows with the number of entries.
+    class LinearScanMatcher
+    {
+    public:
+        void addEntry(const QString& word)
+        {
+            const auto words = WordTokenInterner::instance().intern(SearchUtils::getNormalizedWords(word));
+
+            if (words.size() == 1 && UnicodeFonts::isHashtag(word))
+                mHashtags.insert(words[0]);
+            else if (words.size() == 1)
+                mSingleWords.insert(words[0]);
+            else if (words.size() > 1)
+                mFirstWordIndex[words[0]].push_back(words);
+        }
+
+        bool match(const NormalizedWordIndex& post) const
+        {
+            for (const WordToken hashtag : mHashtags)
+            {
+                if (post.containsHashtag(hashtag))
+                    return true;
+            }
+
+            for (const WordToken word : mSingleWords)
+            {
+                if (post.containsNormalizedWord(word))
+                    return true;
+            }
+
+            const auto& postWords = post.getNormalizedWords();
+
+            for (const auto& [word, phrases] : mFirstWordIndex)
+            {
+                if (!post.containsNormalizedWord(word))
+                    continue;
+
+                for (const auto& phrase : phrases)
+                {
+                    for (int postWordIndex = 0; postWordIndex < (int)postWords.size(); ++postWordIndex)
+                    {
+                        int i = 0;
+
+                        for (int j = postWordIndex; i < (int)phrase.size() && j < (int)postWords.size(); ++i, ++j)
+                        {
+                            if (phrase[i] != postWords[j])
+                                break;
+                        }
+
+                        if (i == (int)phrase.size())
+                            return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        std::unordered_set<WordToken> mHashtags;
+        std::unordered_set<WordToken> mSingleWords;
+        std::unordered_map<WordToken, std::vector<std::vector<WordToken>>> mFirstWordIndex;
+    };
+
+    static constexpr int CORPUS_VOCABULARY_SIZE = 20000;
+    static constexpr int CORPUS_POSTS = 500;
+    static constexpr int CORPUS_POST_WORDS = 30;
+
+    static QString corpusWord(int index)
+    {
+        QString word;
+
+        do {
+            word += QChar('a' + index % 26);
+            index /= 26;
+        } while (index > 0);
+
+        return word + "x";
+    }
+
+    // Muted words and posts with random words from a fixed vocabulary. The number
+    // of muted entries is the maximum.
+    void setupCorpus()
+    {
+        if (mCorpusMutedWords)
+            return;
+
+        QRandomGenerator random(42);
+        QLoggingCategory::setFilterRules("*.debug=false");
+        mCorpusMutedWords = std::make_unique<MutedWords>();
+
+        // A word is used in one entry only, as muting a word replaces a muted hashtag
+        // for the same word.
+        std::unordered_set<int> usedWords;
+
+        while (usedWords.size() < MutedWords::MAX_ENTRIES)
+        {
+            const int wordIndex = random.bounded(CORPUS_VOCABULARY_SIZE);
+
+            if (!usedWords.insert(wordIndex).second)
+                continue;
+
+            const int kind = random.bounded(10);
+            QString entry = corpusWord(wordIndex);
+
+            if (kind == 0)
+                entry = "#" + entry;
+            else if (kind < 3)
+                entry += " " + corpusWord(random.bounded(CORPUS_VOCABULARY_SIZE));
+
+            mCorpusMutedWords->addEntry(entry);
+            mCorpusReference.addEntry(entry);
+        }
+
+        for (int i = 0; i < CORPUS_POSTS; ++i)
+        {
+            QStringList words;
+
+            for (int j = 0; j < CORPUS_POST_WORDS; ++j)
+            {
+                QString word = corpusWord(random.bounded(CORPUS_VOCABULARY_SIZE));
+
+                if (random.bounded(20) == 0)
+                    word = "#" + word;
+
+                words.push_back(word);
+            }
+
+            mCorpusPosts.push_back(setPost(words.join(' ')));
+        }
+
+        QLoggingCategory::setFilterRules("");
+    }
+
+    std::unique_ptr<MutedWords> mCorpusMutedWords;
+    LinearScanMatcher mCorpusReference;
+    std::vector<Post> mCorpusPosts;
+
     Post setPost(const QString& text)
     {
         ATProto::Client client(nullptr);
@@ -0,0 +1,133 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <atproto_image_provider.h>
+#include <photo_picker.h>
+#include <QBuffer>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestPhotoPicker : public QObject
+{
+    Q_OBJECT
+private slots:
+    void scaledDownSize_data()
+    {
+        QTest::addColumn<QSize>("size");
+        QTest::addColumn<int>("maxPixelSize");
+        QTest::addColumn<QSize>("output");
+
+        QTest::newRow("small") << QSize(800, 600) << 2000 << QSize(800, 600);
+        QTest::newRow("max") << QSize(2000, 1000) << 2000 << QSize(2000, 1000);
+        QTest::newRow("landscape") << QSize(8000, 6000) << 2000 << QSize(2000, 1500);
+        QTest::newRow("portrait") << QSize(6000, 8000) << 2000 << QSize(1500, 2000);
+        QTest::newRow("no max") << QSize(8000, 6000) << 0 << QSize(8000, 6000);
+        QTest::newRow("invalid") << QSize() << 2000 << QSize();
+    }
+
+    void scaledDownSize()
+    {
+        QFETCH(QSize, size);
+        QFETCH(int, maxPixelSize);
+        QFETCH(QSize, output);
+        QCOMPARE(PhotoPicker::scaledDownSize(size, maxPixelSize), output);
+    }
+
+    void readImage()
+    {
+        const QByteArray data = createPng(QSize(4000, 1000));
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+
+        const QImage img = PhotoPicker::readImage(reader, 2000);
+        QCOMPARE(img.size(), QSize(2000, 500));
+    }
+
+    void readImageAsync()
+    {
+        const QByteArray data = createPng(QSize(1000, 4000));
+        QImage result;
+
+        PhotoPicker::readImageAsync(data, 2000, this, [&result](QImage img, QString error){
+            QVERIFY(error.isEmpty());
+            result = img;
+        });
+
+        QTRY_COMPARE(result.size(), QSize(500, 2000));
+    }
+
+    void cutRectFullSize()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath("big.png");
+        QImage img(QSize(4000, 1000), QImage::Format_RGB32);
+        img.fill(Qt::blue);
+        QPainter(&img).fillRect(QRect(3000, 0, 1000, 1000), Qt::red);
+        QVERIFY(img.save(fileName));
+
+        // Loading scales down, cutting uses the full size coordinates
+        QCOMPARE(PhotoPicker::loadImage("file://" + fileName).size(), QSize(2000, 500));
+        const QImage cut = PhotoPicker::cutRect("file://" + fileName, QRect(3000, 0, 1000, 1000));
+        QCOMPARE(cut.size(), QSize(1000, 1000));
+        QCOMPARE(cut.pixelColor(999, 999), QColor(Qt::red));
+    }
+
+    void postDraftImagesExceedingBudget()
+    {
+        auto* provider = ATProtoImageProvider::getProvider(ATProtoImageProvider::DRAFT_IMAGE);
+        const QImage img(QSize(2048, 1024), QImage::Format_ARGB32);
+        const int imgCount = int(2 * ATProtoImageProvider::MAX_CACHE_BYTES / img.sizeInBytes());
+        QStringList sources;
+
+        // The draft gets opened before its images are loaded
+        for (int i = 0; i < imgCount; ++i)
+        {
+            const QString id = QString("host/did:plc:user/cid%1").arg(i);
+            sources.push_back(provider->idToSource(id));
+            provider->pinImage(sources.back());
+        }
+
+        for (int i = 0; i < imgCount; ++i)
+            provider->addImage(provider->sourceToId(sources[i]), img);
+
+        // Posting the draft loads all images
+        for (const auto& source : sources)
+            QVERIFY(!PhotoPicker::loadImage(source).isNull());
+
+        for (const auto& source : sources)
+            provider->unpinImage(source);
+
+        QVERIFY(provider->getImage(sources.front()).isNull());
+        provider->clear();
+    }
+
+    void readImageAsyncError()
+    {
+        QString result;
+
+        PhotoPicker::readImageAsync("garbage", 2000, this, [&result](QImage img, QString error){
+            QVERIFY(img.isNull());
+            result = error;
+        });
+
+        QTRY_VERIFY(!result.isEmpty());
+    }
+
+private:
+    static QByteArray createPng(QSize size)
+    {
+        QImage img(size, QImage::Format_RGB32);
+        img.fill(Qt::blue);
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        img.save(&buffer, "png");
+        return data;
+    }
+};
@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <post_cache.h>
+#include <QJsonDocument>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestPostCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void putAndGet()
+    {
+        PostCache cache;
+        cache.put(getPost(1));
+        QVERIFY(cache.contains(getUri(1)));
+        QCOMPARE(cache.get(getUri(1))->getCid(), "cid1");
+        QVERIFY(!cache.get(getUri(2)));
+        QCOMPARE((int)cache.getHits(), 1);
+        QCOMPARE((int)cache.getMisses(), 1);
+    }
+
+    void replace()
+    {
+        PostCache cache;
+        cache.put(getPost(1));
+        const qint64 bytes = cache.getBytes();
+        cache.put(getPost(1));
+        QCOMPARE((int)cache.size(), 1);
+        QCOMPARE(cache.getBytes(), bytes);
+    }
+
+    void evictOnBytes()
+    {
+        const qint64 postBytes = PostCache::estimateBytes(getPost(1));
+        PostCache cache(postBytes * 2);
+        cache.put(getPost(1));
+        cache.put(getPost(2));
+        QVERIFY(cache.get(getUri(1)));
+
+        cache.put(getPost(3));
+        QCOMPARE((int)cache.size(), 2);
+        QCOMPARE((int)cache.getEvictions(), 1);
+        QVERIFY(cache.contains(getUri(1)));
+        QVERIFY(!cache.contains(getUri(2)));
+        QVERIFY(cache.contains(getUri(3)));
+    }
+
+    void nonCachedUris()
+    {
+        PostCache cache;
+        cache.put(getPost(1));
+        cache.put(getPost(3));
+
+        const std::vector<QString> uris{ getUri(1), getUri(2), getUri(3), getUri(4) };
+        const std::vector<QString> expected{ getUri(2), getUri(4) };
+        QCOMPARE(cache.getNonCachedUris(uris), expected);
+    }
+
+    void clear()
+    {
+        PostCache cache;
+        cache.put(getPost(1));
+        cache.clear();
+        QCOMPARE((int)cache.size(), 0);
+        QCOMPARE(cache.getBytes(), qint64(0));
+        QVERIFY(!cache.contains(getUri(1)));
+    }
+
+private:
+    static constexpr char const* POST_TEMPLATE = R"##({
+        "feed": [{
+            "post": {
+                "uri": "%1",
+                "cid": "cid%2",
+                "author": {
+                    "did": "did:plc:foo",
+                    "handle": "foo.bsky.social"
+                },
+                "record": {
+                    "$type": "app.bsky.feed.post",
+                    "text": "Hello world!",
+                    "createdAt": "2023-11-20T18:46:00.000Z"
+                },
+                "indexedAt": "2023-11-20T18:46:00.000Z"
+            }
+        }]
+    })##";
+
+    static QString getUri(int id)
+    {
+        return QString("at://did:plc:foo/app.bsky.feed.post/r%1").arg(id);
+    }
+
+    Post getPost(int id)
+    {
+        const QString data = QString(POST_TEMPLATE).arg(getUri(id), QString::number(id));
+        auto json = QJsonDocument::fromJson(data.toUtf8());
+        auto feed = ATProto::AppBskyFeed::OutputFeed::fromJson(json);
+        return Post(feed->mFeed[0]);
+    }
+};
@@ -6,6 +6,7 @@
 #include <muted_words.h>
 #include <post_feed_model.h>
 #include <user_settings.h>
+#include <QSignalSpy>
 #include <QtTest/QTest>
 
 using namespace Skywalker;
@@ -17,14 +18,13 @@ class TestPostFeedModel : public QObject
 private slots:
     void init()
     {
-        mPostFeedModel = std::make_unique<PostFeedModel>(
-            HOME_FEED, mUserDid, mFollowing, mMutedReposts, mContentFilter,
-            mBookmarks, mMutedWords, mFocusHashtags, mHashtags, mUserPreferences, mUserSettings);
+        mPostFeedModel = makeModel();
     }
 
     void cleanup()
     {
         mPostFeedModel = nullptr;
+        mFilterSnapshots = nullptr;
         mNextPostId = 1;
     }
 
@@ -358,6 +358,65 @@ private slots:
         QVERIFY(!mPostFeedModel->getGapPlaceHolder(gapId));
     }
 
+    void storeSegmentsWithGap()
+    {
+        mNextPostId = 3;
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
+
+        mNextPostId = 1;
+        const int gapId = mPostFeedModel->prependFeed(getFeed(1, TEST_DATE + 2s, "CUR2"));
+        QCOMPARE_GT(gapId, 0);
+        QCOMPARE(mPostFeedModel->rowCount(), 7); // 6 posts + gap place holder
+
+        const auto segments = mPostFeedModel->getStoreSegments(100);
+        QCOMPARE((int)segments.size(), 3);
+        QCOMPARE(segments[0].mType, TimelineStore::SegmentType::APPEND);
+        QCOMPARE(*segments[0].mFeed->mCursor, "CUR2");
+        QCOMPARE(segments[1].mType, TimelineStore::SegmentType::GAP);
+        QCOMPARE(segments[1].mGapCursor, "CUR2");
+        QCOMPARE(segments[2].mType, TimelineStore::SegmentType::APPEND);
+        QCOMPARE((int)segments[2].mFeed->mFeed.size(), 5);
+        QCOMPARE(*segments[2].mFeed->mCursor, "CUR1");
+
+        // Replaying the segments rebuilds the feed with its gap.
+        PostFeedModel model(HOME_FEED, mUserDid, mFollowing, mMutedReposts, mContentFilter,
+                            mBookmarks, mMutedWords, mFocusHashtags, mHashtags, mUserPreferences, mUserSettings);
+        replay(model, segments);
+        QCOMPARE(model.rowCount(), 7);
+        QVERIFY(model.getPost(1).isGap());
+        QCOMPARE(model.getPost(1).getGapCursor(), "CUR2");
+        QCOMPARE(model.getLastCursor(), "CUR1");
+
+        const int replayedGapId = model.findGapId("CUR2");
+        QCOMPARE_GT(replayedGapId, 0);
+        mNextPostId = 2;
+        QCOMPARE(model.gapFillFeed(getFeed(3, TEST_DATE + 1s, "CUR3"), replayedGapId), 0);
+        QCOMPARE(model.rowCount(), 7); // 7 posts
+    }
+
+    void storeSegmentsCut()
+    {
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE - 1h, "CUR2"));
+
+        const auto segments = mPostFeedModel->getStoreSegments(5);
+        QCOMPARE((int)segments.size(), 2);
+        QCOMPARE((int)segments[0].mFeed->mFeed.size(), 5);
+        QCOMPARE(segments[1].mType, TimelineStore::SegmentType::GAP);
+        QCOMPARE(segments[1].mGapCursor, "CUR1");
+
+        PostFeedModel model(HOME_FEED, mUserDid, mFollowing, mMutedReposts, mContentFilter,
+                            mBookmarks, mMutedWords, mFocusHashtags, mHashtags, mUserPreferences, mUserSettings);
+        replay(model, segments);
+        QCOMPARE(model.rowCount(), 6); // 5 posts + gap place holder
+        QCOMPARE(model.lastTimestamp(), TEST_DATE - 4s);
+
+        // A page stored after compaction gets appended after the gap.
+        model.addFeed(getFeed(5, TEST_DATE - 2h, "CUR3"));
+        QCOMPARE(model.rowCount(), 11);
+        QVERIFY(model.getPost(5).isGap());
+    }
+
     void findTimestamp()
     {
         mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
@@ -381,7 +440,295 @@ private slots:
         QCOMPARE(index, 0);
     }
 
+    void findTimestampOutOfOrder()
+    {
+        // The third post is later than its predecessor
+        mPostFeedModel->setFeed(getFeed({ TEST_DATE, TEST_DATE - 2s, TEST_DATE + 5s, TEST_DATE - 3s, TEST_DATE - 4s }));
+        QCOMPARE(mPostFeedModel->rowCount(), 5);
+        QCOMPARE(mPostFeedModel->findTimestamp(TEST_DATE + 1s), 2);
+        QCOMPARE(mPostFeedModel->findTimestamp(TEST_DATE - 1s), 2);
+        QCOMPARE(mPostFeedModel->findTimestamp(TEST_DATE - 4s), 4);
+        QCOMPARE(mPostFeedModel->findTimestamp(TEST_DATE + 6s), 0);
+    }
+
+    void findTimestampCompareToScan()
+    {
+        // Every 7th post is later than its predecessor
+        std::vector<QDateTime> timestamps;
+
+        for (int i = 0; i < 200; ++i)
+            timestamps.push_back(TEST_DATE - std::chrono::seconds(i * 10 - (i % 7 == 0 ? 35 : 0)));
+
+        mPostFeedModel->setFeed(getFeed({ timestamps.begin(), timestamps.begin() + 100 }, "CUR1"));
+        mPostFeedModel->addFeed(getFeed({ timestamps.begin() + 100, timestamps.end() }, "CUR2"));
+        QCOMPARE(mPostFeedModel->rowCount(), 200);
+        compareFindTimestampToScan();
+
+        // Prepend with a gap
+        mPostFeedModel->prependFeed(getFeed(5, TEST_DATE + 100s));
+        QCOMPARE(mPostFeedModel->rowCount(), 206);
+        compareFindTimestampToScan();
+
+        mPostFeedModel->removeTailPosts(100);
+        QCOMPARE(mPostFeedModel->rowCount(), 106);
+        compareFindTimestampToScan();
+
+        mPostFeedModel->removeHeadPosts(5);
+        QCOMPARE(mPostFeedModel->rowCount(), 100);
+        compareFindTimestampToScan();
+    }
+
+    void benchmarkPrepend()
+    {
+        mPostFeedModel->setFeed(getFeed(AbstractPostFeedModel::MAX_TIMELINE_SIZE, TEST_DATE, "CUR1"));
+        QDateTime headTimestamp = TEST_DATE;
+
+        // Includes the creation of the page to prepend.
+        QBENCHMARK {
+            headTimestamp = headTimestamp.addSecs(100);
+            mPostFeedModel->prependFeed(getFeed(50, headTimestamp));
+            mPostFeedModel->removeHeadPosts(50);
+        }
+
+        QCOMPARE(mPostFeedModel->rowCount(), AbstractPostFeedModel::MAX_TIMELINE_SIZE);
+    }
+
+    void benchmarkRewind()
+    {
+        mPostFeedModel->setFeed(getFeed(AbstractPostFeedModel::MAX_TIMELINE_SIZE, TEST_DATE, "CUR1"));
+        int index = -1;
+
+        QBENCHMARK {
+            index = mPostFeedModel->findTimestamp(TEST_DATE - 10s);
+        }
+
+        QCOMPARE(index, 10);
+    }
+
+    void rowTargetedChange()
+    {
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
+        QSignalSpy spy(mPostFeedModel.get(), &QAbstractItemModel::dataChanged);
+
+        LocalPostModelChanges::updateLikeCountDelta("cid2", 1);
+        LocalPostModelChanges::updateLikeUri("cid2", "at://did:plc:foo/app.bsky.feed.like/l1");
+        LocalPostModelChanges::updateLikeCountDelta("cid4", 1);
+
+        // Changes are coalesced till the event loop runs
+        QCOMPARE(spy.count(), 0);
+        QTRY_COMPARE(spy.count(), 2);
+
+        const auto rowLikeAndUri = spy.at(0);
+        QCOMPARE(rowLikeAndUri.at(0).value<QModelIndex>().row(), 1);
+        QCOMPARE(rowLikeAndUri.at(1).value<QModelIndex>().row(), 1);
+        QCOMPARE(rowLikeAndUri.at(2).value<QList<int>>().size(), 2);
+
+        const auto rowLike = spy.at(1);
+        QCOMPARE(rowLike.at(0).value<QModelIndex>().row(), 3);
+        QCOMPARE(rowLike.at(1).value<QModelIndex>().row(), 3);
+        QCOMPARE(rowLike.at(2).value<QList<int>>(), QList<int>{ int(AbstractPostFeedModel::Role::PostLikeCount) });
+    }
+
+    void rowTargetedChangeAfterInsert()
+    {
+        mNextPostId = 2;
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
+        LocalPostModelChanges::updateLikeCountDelta("cid3", 1);
+
+        mNextPostId = 1;
+        const int gapId = mPostFeedModel->prependFeed(getFeed(5, TEST_DATE + 1s, "CUR2"));
+        QCOMPARE(gapId, 0);
+        QCOMPARE(mPostFeedModel->rowCount(), 6);
+
+        QSignalSpy spy(mPostFeedModel.get(), &QAbstractItemModel::dataChanged);
+        QTRY_COMPARE(spy.count(), 1);
+
+        // cid3 moved from row 1 to row 2 by the prepend
+        QCOMPARE(spy.at(0).at(0).value<QModelIndex>().row(), 2);
+    }
+
+    void sharedLocalChange()
+    {
+        mPostFeedModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        auto otherModel = makeModel();
+        mNextPostId = 1;
+        otherModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        QSignalSpy spy(otherModel.get(), &QAbstractItemModel::dataChanged);
+
+        // A change is made once and shows in all models
+        LocalPostModelChanges::updateLikeCountDelta("cid1", 1);
+        QCOMPARE(getLikeCount(*mPostFeedModel, 0), 1);
+        QCOMPARE(getLikeCount(*otherModel, 0), 1);
+        QTRY_COMPARE(spy.count(), 1);
+
+        // Posts received after the change have it already
+        auto newModel = makeModel();
+        mNextPostId = 1;
+        newModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        QCOMPARE(getLikeCount(*newModel, 0), 0);
+
+        otherModel->clear();
+        mNextPostId = 1;
+        otherModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        QCOMPARE(getLikeCount(*otherModel, 0), 0);
+
+        LocalPostModelChanges::updateLikeCountDelta("cid1", -1);
+        QCOMPARE(getLikeCount(*mPostFeedModel, 0), 0);
+        QCOMPARE(getLikeCount(*otherModel, 0), -1);
+        QCOMPARE(getLikeCount(*newModel, 0), -1);
+    }
+
+    void visibleRangeRefresh()
+    {
+        mPostFeedModel->addFeed(getFeed(5, TEST_DATE, "CUR1"));
+
+        // Without a visible range nothing is scheduled for refresh
+        QVERIFY(!mPostFeedModel->getYoungestVisibleTimestamp().isValid());
+
+        QSignalSpy spy(mPostFeedModel.get(), &QAbstractItemModel::dataChanged);
+        mPostFeedModel->setVisibleRange(2, 3);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(mPostFeedModel->getYoungestVisibleTimestamp(), TEST_DATE - 2s);
+
+        mPostFeedModel->refreshRelativeTime();
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.at(1).at(0).value<QModelIndex>().row(), 2);
+        QCOMPARE(spy.at(1).at(1).value<QModelIndex>().row(), 3);
+        QCOMPARE(spy.at(1).at(2).value<QList<int>>(), QList<int>{ int(AbstractPostFeedModel::Role::PostIndexedSecondsAgo) });
+
+        // Without a visible range, the service neither refreshes nor schedules
+        mPostFeedModel->setVisibleRange(-1, 10);
+        QCOMPARE(spy.count(), 2);
+        mPostFeedModel->refreshRelativeTime();
+        QCOMPARE(spy.count(), 2);
+        QVERIFY(!mPostFeedModel->getYoungestVisibleTimestamp().isValid());
+
+        // The timeline update timer refreshes all rows
+        mPostFeedModel->updatePostIndexedSecondsAgo();
+        QCOMPARE(spy.count(), 3);
+        QCOMPARE(spy.at(2).at(0).value<QModelIndex>().row(), 0);
+        QCOMPARE(spy.at(2).at(1).value<QModelIndex>().row(), 4);
+
+        // The range gets clipped to the feed
+        mPostFeedModel->setVisibleRange(3, 10);
+        QCOMPARE(mPostFeedModel->getYoungestVisibleTimestamp(), TEST_DATE - 3s);
+    }
+
+    void viewRecordRefresh()
+    {
+        mPostFeedModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        const auto index = mPostFeedModel->index(0);
+        const int mutedReasonRole = int(AbstractPostFeedModel::Role::PostMutedReason);
+        QCOMPARE(mPostFeedModel->data(index, mutedReasonRole).value<QEnums::MutedPostReason>(), QEnums::MUTED_POST_NONE);
+
+        // The view record is rebuilt when the muted words change.
+        mMutedWords.addEntry("world");
+        QCOMPARE(mPostFeedModel->data(index, mutedReasonRole).value<QEnums::MutedPostReason>(), QEnums::MUTED_POST_WORDS);
+
+        mMutedWords.removeEntry("world");
+        QCOMPARE(mPostFeedModel->data(index, mutedReasonRole).value<QEnums::MutedPostReason>(), QEnums::MUTED_POST_NONE);
+
+        const quint64 version = mContentFilter.getVersion();
+        emit mContentFilter.contentGroupsChanged();
+        QVERIFY(mContentFilter.getVersion() != version);
+
+        const int visibilityRole = int(AbstractPostFeedModel::Role::PostContentVisibility);
+        QCOMPARE(mPostFeedModel->data(index, visibilityRole).value<QEnums::ContentVisibility>(), QEnums::CONTENT_VISIBILITY_SHOW);
+    }
+
+    void viewRecordReinsertedPost()
+    {
+        mPostFeedModel->addFeed(getFeed(2, TEST_DATE, "CUR1"));
+        const int labelsRole = int(AbstractPostFeedModel::Role::PostLabels);
+        QVERIFY(mPostFeedModel->data(mPostFeedModel->index(0), labelsRole).value<ContentLabelList>().empty());
+
+        mPostFeedModel->removeHeadPosts(1);
+        QCOMPARE(mPostFeedModel->rowCount(), 1);
+
+        // The same post fetched again, now with a label
+        const QString labeledPost = QString(POST_TEMPLATE).arg("1", (TEST_DATE + 1s).toString(Qt::ISODateWithMs))
+            .replace(R"("indexedAt")", R"("labels": [{ "src": "did:plc:labeler", "uri": "at://did:plc:foo/app.bsky.feed.post/r1", "val": "funny", "cts": "2023-11-20T18:46:00.000Z" }], "indexedAt")");
+        mPostFeedModel->prependFeed(getFeed(QString(R"({ "feed": [%1]})").arg(labeledPost).toUtf8(), "CUR2"));
+        QCOMPARE(mPostFeedModel->rowCount(), 2);
+        QCOMPARE(mPostFeedModel->getPost(0).getCid(), "cid1");
+
+        const auto labels = mPostFeedModel->data(mPostFeedModel->index(0), labelsRole).value<ContentLabelList>();
+        QCOMPARE(labels.size(), 1);
+        QCOMPARE(labels.front().getLabelId(), "funny");
+    }
+
+    void addFeedAsync()
+    {
+        setFilterSnapshots();
+
+        bool added = false;
+        mPostFeedModel->setFeedAsync(getFeed(5, TEST_DATE, "CUR1"), [&added]{ added = true; });
+        QTRY_VERIFY(added);
+        QCOMPARE(mPostFeedModel->rowCount(), 5);
+
+        added = false;
+        mPostFeedModel->addFeedAsync(getFeed(5, TEST_DATE - 1h, "CUR2"), [&added]{ added = true; });
+        QTRY_VERIFY(added);
+        QCOMPARE(mPostFeedModel->rowCount(), 10);
+        QCOMPARE(mPostFeedModel->getLastCursor(), "CUR2");
+
+        int gapId = -1;
+        mPostFeedModel->prependFeedAsync(getFeed(2, TEST_DATE + 1h, "CUR3"), [&gapId](int id){ gapId = id; });
+        QTRY_VERIFY(gapId >= 0);
+        QVERIFY(gapId > 0);
+        QCOMPARE(mPostFeedModel->rowCount(), 13); // 2 posts + gap place holder
+        QVERIFY(mPostFeedModel->getGapPlaceHolder(gapId));
+    }
+
+    void addFeedAsyncFiltersWithSnapshot()
+    {
+        mMutedWords.addEntry("world");
+        setFilterSnapshots();
+
+        // The page is filtered with the snapshot taken when the page was added.
+        bool added = false;
+        mPostFeedModel->addFeedAsync(getFeed(2, TEST_DATE), [&added]{ added = true; });
+        mMutedWords.removeEntry("world");
+        QTRY_VERIFY(added);
+        QCOMPARE(mPostFeedModel->rowCount(), 0);
+
+        mFilterSnapshots->publish();
+        added = false;
+        mPostFeedModel->addFeedAsync(getFeed(2, TEST_DATE), [&added]{ added = true; });
+        QTRY_VERIFY(added);
+        QCOMPARE(mPostFeedModel->rowCount(), 2);
+    }
+
+    void clearWhileAddingFeedAsync()
+    {
+        setFilterSnapshots();
+
+        bool added = false;
+        mPostFeedModel->addFeedAsync(getFeed(5, TEST_DATE), [&added]{ added = true; });
+        mPostFeedModel->clear();
+        QTRY_VERIFY(added);
+        QCOMPARE(mPostFeedModel->rowCount(), 0);
+    }
+
 private:
+    void setFilterSnapshots()
+    {
+        mFilterSnapshots = std::make_unique<FilterSnapshotPublisher>(
+            mContentFilter, mMutedWords, mFocusHashtags, mFollowing, mMutedReposts);
+        mPostFeedModel->setFilterSnapshots(mFilterSnapshots.get());
+    }
+
+    static void replay(PostFeedModel& model, const std::vector<TimelineStore::Segment>& segments)
+    {
+        for (const auto& segment : segments)
+        {
+            if (segment.mType == TimelineStore::SegmentType::GAP)
+                model.addGapPlaceHolder(segment.mGapCursor);
+            else
+                model.addFeed(ATProto::AppBskyFeed::OutputFeed::SharedPtr(segment.mFeed));
+        }
+    }
+
     static constexpr char const* POST_TEMPLATE = R"##({
         "post": {
             "uri": "at://did:plc:foo/app.bsky.feed.post/r%1",
@@ -401,6 +748,59 @@ private:
 
     const QDateTime TEST_DATE = QDateTime::fromString("2023-11-20T18:46:00.000Z", Qt::ISODateWithMs);
 
+    void compareFindTimestampToScan()
+    {
+        const QDateTime first = TEST_DATE + 200s;
+        const QDateTime last = TEST_DATE - 2100s;
+
+        for (QDateTime timestamp = first; timestamp >= last; timestamp = timestamp.addSecs(-3))
+            QCOMPARE(mPostFeedModel->findTimestamp(timestamp), findTimestampScan(timestamp));
+    }
+
+    int findTimestampScan(QDateTime timestamp) const
+    {
+        for (int i = mPostFeedModel->rowCount() - 1; i >= 0; --i)
+        {
+            const Post& post = mPostFeedModel->getPost(i);
+
+            if (!post.isPlaceHolder() && post.getTimelineTimestamp() >= timestamp)
+                return i;
+        }
+
+        return 0;
+    }
+
+    ATProto::AppBskyFeed::OutputFeed::SharedPtr getFeed(const std::vector<QDateTime>& postTimes, const std::optional<QString>& cursor = {})
+    {
+        QString feedData = R"###({ "feed": [)###";
+
+        for (int i = 0; i < (int)postTimes.size(); ++i)
+        {
+            QString postData = QString(POST_TEMPLATE).arg(QString::number(mNextPostId++),
+                                                          postTimes[i].toString(Qt::ISODateWithMs));
+            feedData += postData;
+
+            if (i < (int)postTimes.size() - 1)
+                feedData += ',';
+        }
+
+        feedData += "]}";
+
+        return getFeed(feedData.toUtf8(), cursor);
+    }
+
+    PostFeedModel::Ptr makeModel()
+    {
+        return std::make_unique<PostFeedModel>(
+            HOME_FEED, mUserDid, mFollowing, mMutedReposts, mContentFilter,
+            mBookmarks, mMutedWords, mFocusHashtags, mHashtags, mUserPreferences, mUserSettings);
+    }
+
+    static int getLikeCount(const PostFeedModel& model, int row)
+    {
+        return model.data(model.index(row, 0), int(AbstractPostFeedModel::Role::PostLikeCount)).toInt();
+    }
+
     ATProto::AppBskyFeed::OutputFeed::SharedPtr getFeed(int numPosts, QDateTime startTime, const std::optional<QString>& cursor = {})
     {
         QString feedData = R"###({ "feed": [)###";
@@ -444,6 +844,7 @@ private:
     MutedWords mMutedWords;
     FocusHashtags mFocusHashtags;
     HashtagIndex mHashtags{10};
+    std::unique_ptr<FilterSnapshotPublisher> mFilterSnapshots;
     PostFeedModel::Ptr mPostFeedModel;
     int mNextPostId = 1;
 };
@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <author_cache.h>
+#include <post.h>
+#include <post_record_store.h>
+#include <QJsonDocument>
+#include <QtTest/QTest>
+#include <thread>
+
+using namespace Skywalker;
+
+class TestPostRecordStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shareRecord()
+    {
+        const Post post1 = getPost("cid1", 10);
+        const Post post2 = getPost("cid1", 20);
+
+        QVERIFY(getRecord(post1) == getRecord(post2));
+        QCOMPARE(post1.getLikeCount(), 10);
+        QCOMPARE(post2.getLikeCount(), 20);
+    }
+
+    void differentCid()
+    {
+        const Post post1 = getPost("cid2", 0);
+        const Post post2 = getPost("cid3", 0);
+        QVERIFY(getRecord(post1) != getRecord(post2));
+    }
+
+    void releaseRecord()
+    {
+        auto post = std::make_unique<Post>(getPost("cid4", 0));
+        const auto* record = getRecord(*post).get();
+        ATProto::AppBskyFeed::Record::Post::SharedPtr::weak_type weakRecord = getRecord(*post);
+        QVERIFY(record);
+
+        post = nullptr;
+        QVERIFY(weakRecord.expired());
+    }
+
+    void concurrentIntern()
+    {
+        constexpr int NUM_THREADS = 4;
+        constexpr int NUM_POSTS = 100;
+        std::vector<std::vector<Post>> posts(NUM_THREADS);
+        std::vector<std::thread> threads;
+
+        // Posts put their authors in the author cache, which must be created on
+        // the GUI thread.
+        AuthorCache::instance();
+
+        for (int i = 0; i < NUM_THREADS; ++i)
+        {
+            threads.emplace_back([&postList=posts[i]]{
+                for (int j = 0; j < NUM_POSTS; ++j)
+                    postList.push_back(getPost(QString("cid-concurrent-%1").arg(j), 0));
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (int i = 1; i < NUM_THREADS; ++i)
+        {
+            for (int j = 0; j < NUM_POSTS; ++j)
+                QVERIFY(getRecord(posts[i][j]) == getRecord(posts[0][j]));
+        }
+    }
+
+private:
+    static constexpr char const* POST_TEMPLATE = R"##({
+        "feed": [{
+            "post": {
+                "uri": "at://did:plc:foo/app.bsky.feed.post/%1",
+                "cid": "%1",
+                "author": {
+                    "did": "did:plc:foo",
+                    "handle": "foo.bsky.social"
+                },
+                "record": {
+                    "$type": "app.bsky.feed.post",
+                    "text": "Hello world!",
+                    "createdAt": "2023-11-20T18:46:00.000Z"
+                },
+                "likeCount": %2,
+                "indexedAt": "2023-11-20T18:46:00.000Z"
+            }
+        }]
+    })##";
+
+    static Post getPost(const QString& cid, int likeCount)
+    {
+        const QString data = QString(POST_TEMPLATE).arg(cid, QString::number(likeCount));
+        auto json = QJsonDocument::fromJson(data.toUtf8());
+        auto feed = ATProto::AppBskyFeed::OutputFeed::fromJson(json);
+        return Post(feed->mFeed[0]);
+    }
+
+    static const ATProto::AppBskyFeed::Record::Post::SharedPtr& getRecord(const Post& post)
+    {
+        return std::get<ATProto::AppBskyFeed::Record::Post::SharedPtr>(post.getPostView()->mRecord);
+    }
+};
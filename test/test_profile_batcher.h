@@ -0,0 +1,250 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <profile_batcher.h>
+#include <atproto/lib/client.h>
+#include <QSignalSpy>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+using namespace std::chrono_literals;
+
+class TestProfileBatcher : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mRequests.clear();
+        mUnknownDids.clear();
+        mInvalidDids.clear();
+        mFailError = "InternalServerError";
+        mFail = false;
+        mFailCount = 0;
+        mBatcher = std::make_unique<ProfileBatcher>(
+            [this](const auto& dids, const auto& successCb, const auto& errorCb){
+                getProfiles(dids, successCb, errorCb); },
+            10ms, 10ms);
+    }
+
+    void cleanup()
+    {
+        mBatcher = nullptr;
+    }
+
+    void batchRequests_data()
+    {
+        QTest::addColumn<int>("numDids");
+        QTest::addColumn<int>("numRequests");
+
+        QTest::newRow("1") << 1 << 1;
+        QTest::newRow("24") << 24 << 1;
+        QTest::newRow("25") << 25 << 1;
+        QTest::newRow("26") << 26 << 2;
+        QTest::newRow("100") << 100 << 4;
+        QTest::newRow("101") << 101 << 5;
+    }
+
+    void batchRequests()
+    {
+        QFETCH(int, numDids);
+        QFETCH(int, numRequests);
+        QSignalSpy spy(mBatcher.get(), &ProfileBatcher::profileReceived);
+
+        for (int i = 0; i < numDids; ++i)
+            QVERIFY(mBatcher->request(getDid(i)));
+
+        QTRY_COMPARE(spy.count(), numDids);
+        QCOMPARE((int)mRequests.size(), numRequests);
+        QCOMPARE(mBatcher->getRequestCount(), numRequests);
+        QCOMPARE((int)mBatcher->getRequestedDidCount(), numDids);
+
+        for (const auto& request : mRequests)
+            QVERIFY((int)request.size() <= ProfileBatcher::MAX_BATCH_SIZE);
+
+        QVERIFY(!mBatcher->isPending(getDid(0)));
+    }
+
+    void deduplicate()
+    {
+        QVERIFY(mBatcher->request(getDid(1)));
+        QVERIFY(!mBatcher->request(getDid(1)));
+        QVERIFY(mBatcher->request(getDid(2)));
+        QVERIFY(mBatcher->isPending(getDid(1)));
+
+        QSignalSpy spy(mBatcher.get(), &ProfileBatcher::profileReceived);
+        QTRY_COMPARE(spy.count(), 2);
+        QCOMPARE((int)mRequests.size(), 1);
+        QCOMPARE((int)mRequests[0].size(), 2);
+
+        // Once received a DID can be requested again
+        QVERIFY(mBatcher->request(getDid(1)));
+    }
+
+    void missingProfile()
+    {
+        mUnknownDids.insert(getDid(2));
+        QSignalSpy receivedSpy(mBatcher.get(), &ProfileBatcher::profileReceived);
+        QSignalSpy failedSpy(mBatcher.get(), &ProfileBatcher::profileFailed);
+
+        for (int i = 0; i < 3; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(receivedSpy.count() + failedSpy.count(), 3);
+        QCOMPARE(failedSpy.count(), 1);
+        QCOMPARE(failedSpy.at(0).at(0).toString(), getDid(2));
+        QVERIFY(!mBatcher->isPending(getDid(2)));
+    }
+
+    void requestFailed()
+    {
+        mFail = true;
+        QSignalSpy failedSpy(mBatcher.get(), &ProfileBatcher::requestFailed);
+        QSignalSpy profileFailedSpy(mBatcher.get(), &ProfileBatcher::profileFailed);
+
+        for (int i = 0; i < 30; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(failedSpy.count(), 30);
+        QCOMPARE((int)mRequests.size(), 2 * (1 + ProfileBatcher::MAX_RETRIES));
+        QCOMPARE(mBatcher->getRequestCount(), 2);
+        QCOMPARE(mBatcher->getRetryCount(), 2 * ProfileBatcher::MAX_RETRIES);
+        QCOMPARE(profileFailedSpy.count(), 0);
+        QVERIFY(!mBatcher->isPending(getDid(0)));
+    }
+
+    void expiredToken()
+    {
+        mFail = true;
+        mFailError = ATProto::ATProtoErrorMsg::EXPIRED_TOKEN;
+        QSignalSpy failedSpy(mBatcher.get(), &ProfileBatcher::requestFailed);
+
+        for (int i = 0; i < 3; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(failedSpy.count(), 3);
+        QCOMPARE((int)mRequests.size(), 1);
+        QCOMPARE(mBatcher->getRetryCount(), 0);
+    }
+
+    void invalidDid()
+    {
+        mInvalidDids.insert(getDid(7));
+        QSignalSpy receivedSpy(mBatcher.get(), &ProfileBatcher::profileReceived);
+        QSignalSpy profileFailedSpy(mBatcher.get(), &ProfileBatcher::profileFailed);
+        QSignalSpy requestFailedSpy(mBatcher.get(), &ProfileBatcher::requestFailed);
+
+        for (int i = 0; i < 30; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(receivedSpy.count() + profileFailedSpy.count(), 30);
+        QCOMPARE(profileFailedSpy.count(), 1);
+        QCOMPARE(profileFailedSpy.at(0).at(0).toString(), getDid(7));
+        QCOMPARE(profileFailedSpy.at(0).at(1).toString(), ATProto::ATProtoErrorMsg::INVALID_REQUEST);
+        QCOMPARE(requestFailedSpy.count(), 0);
+        QCOMPARE(mBatcher->getRetryCount(), 0);
+        QCOMPARE((int)mBatcher->getRequestedDidCount(), 30);
+        QVERIFY(!mBatcher->isPending(getDid(7)));
+
+        // The batch without the invalid DID is not split.
+        QCOMPARE(mBatcher->getBatchSizes().at(5), 1);
+    }
+
+    void retryRequest()
+    {
+        mFailCount = 2;
+        QSignalSpy receivedSpy(mBatcher.get(), &ProfileBatcher::profileReceived);
+        QSignalSpy failedSpy(mBatcher.get(), &ProfileBatcher::requestFailed);
+
+        for (int i = 0; i < 3; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(receivedSpy.count(), 3);
+        QCOMPARE((int)mRequests.size(), 3);
+        QCOMPARE(failedSpy.count(), 0);
+        QCOMPARE((int)mBatcher->getRequestedDidCount(), 3);
+        QCOMPARE(mBatcher->getRequestCount(), 1);
+        QCOMPARE(mBatcher->getRetryCount(), 2);
+        QCOMPARE(mBatcher->getAverageBatchSize(), 3.0);
+    }
+
+    void clearPending()
+    {
+        QSignalSpy spy(mBatcher.get(), &ProfileBatcher::profileReceived);
+        mBatcher->request(getDid(1));
+        mBatcher->clear();
+        QVERIFY(!mBatcher->isPending(getDid(1)));
+        QTest::qWait(50);
+        QCOMPARE(spy.count(), 0);
+        QVERIFY(mRequests.empty());
+    }
+
+    void batchSizeStats()
+    {
+        QSignalSpy spy(mBatcher.get(), &ProfileBatcher::profileReceived);
+
+        for (int i = 0; i < 30; ++i)
+            mBatcher->request(getDid(i));
+
+        QTRY_COMPARE(spy.count(), 30);
+        const auto& batchSizes = mBatcher->getBatchSizes();
+        QCOMPARE((int)batchSizes.size(), 2);
+        QCOMPARE(batchSizes.at(25), 1);
+        QCOMPARE(batchSizes.at(5), 1);
+        QCOMPARE(mBatcher->getAverageBatchSize(), 15.0);
+    }
+
+private:
+    static QString getDid(int i)
+    {
+        return QString("did:plc:user%1").arg(i);
+    }
+
+    // Stand-in for the getProfiles call of the bsky client. The response comes
+    // in asynchronously like a network reply.
+    void getProfiles(const std::vector<QString>& dids, const ProfileBatcher::SuccessCb& successCb,
+                     const ProfileBatcher::ErrorCb& errorCb)
+    {
+        mRequests.push_back(dids);
+
+        QTimer::singleShot(0, this, [this, dids, successCb, errorCb]{
+            if (mFail || mFailCount > 0)
+            {
+                --mFailCount;
+                errorCb(mFailError, "Test failure");
+                return;
+            }
+
+            for (const auto& did : dids)
+            {
+                if (mInvalidDids.contains(did))
+                {
+                    errorCb(ATProto::ATProtoErrorMsg::INVALID_REQUEST, "Invalid actor");
+                    return;
+                }
+            }
+
+            ProfileBatcher::ProfileList profiles;
+
+            for (const auto& did : dids)
+            {
+                if (mUnknownDids.contains(did))
+                    continue;
+
+                auto profile = std::make_shared<ATProto::AppBskyActor::ProfileViewDetailed>();
+                profile->mDid = did;
+                profiles.push_back(profile);
+            }
+
+            successCb(std::move(profiles));
+        });
+    }
+
+    std::unique_ptr<ProfileBatcher> mBatcher;
+    std::vector<std::vector<QString>> mRequests;
+    std::unordered_set<QString> mUnknownDids;
+    std::unordered_set<QString> mInvalidDids; // make the whole request fail
+    QString mFailError;
+    bool mFail = false;
+    int mFailCount = 0; // number of requests to fail
+};
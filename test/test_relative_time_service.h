@@ -0,0 +1,96 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <relative_time_service.h>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+using namespace std::chrono_literals;
+
+class TestRelativeTimeService : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mClient = std::make_unique<TestClient>();
+    }
+
+    void cleanup()
+    {
+        RelativeTimeService::instance().removeClient(mClient.get());
+        mClient = nullptr;
+    }
+
+    void refreshDelay_data()
+    {
+        QTest::addColumn<qint64>("ageMs");
+        QTest::addColumn<qint64>("delayMs");
+
+        QTest::newRow("new") << qint64(0) << qint64(500);
+        QTest::newRow("future") << qint64(-5000) << qint64(500);
+        QTest::newRow("seconds") << qint64(10'200) << qint64(300);
+        QTest::newRow("seconds half way") << qint64(10'500) << qint64(1000);
+        QTest::newRow("last second") << qint64(59'800) << qint64(700);
+        QTest::newRow("first minute") << qint64(60'000) << qint64(30'000);
+        QTest::newRow("minutes") << qint64(5 * 60'000 + 40'000) << qint64(50'000);
+        QTest::newRow("first hour") << qint64(3'600'000) << qint64(1'800'000);
+        QTest::newRow("hours") << qint64(3 * 3'600'000 + 1'000'000) << qint64(800'000);
+        QTest::newRow("days") << qint64(50 * 3'600'000) << qint64(1'800'000);
+    }
+
+    void refreshDelay()
+    {
+        QFETCH(qint64, ageMs);
+        QFETCH(qint64, delayMs);
+        const auto delay = RelativeTimeService::getRefreshDelay(std::chrono::milliseconds(ageMs));
+        QCOMPARE(qint64(delay.count()), delayMs);
+    }
+
+    void client()
+    {
+        auto& service = RelativeTimeService::instance();
+        auto& client = *mClient;
+        client.mTimestamp = QDateTime::currentDateTimeUtc();
+        service.addClient(&client);
+
+        // Young item refreshes every second
+        QTRY_VERIFY(service.isActive());
+        QTRY_VERIFY_WITH_TIMEOUT(client.mRefreshCount >= 1, 2000);
+
+        service.pause();
+        QVERIFY(!service.isActive());
+        const int count = client.mRefreshCount;
+        service.reschedule();
+        QTest::qWait(10);
+        QVERIFY(!service.isActive());
+
+        service.resume();
+        QCOMPARE(client.mRefreshCount, count + 1);
+        QVERIFY(service.isActive());
+
+        service.removeClient(&client);
+        QVERIFY(!service.isActive());
+    }
+
+    void noVisibleItems()
+    {
+        auto& service = RelativeTimeService::instance();
+        service.addClient(mClient.get());
+        QTest::qWait(10);
+        QVERIFY(!service.isActive());
+    }
+
+private:
+    class TestClient : public RelativeTimeService::Client
+    {
+    public:
+        void refreshRelativeTime() override { ++mRefreshCount; }
+        QDateTime getYoungestVisibleTimestamp() const override { return mTimestamp; }
+
+        QDateTime mTimestamp;
+        int mRefreshCount = 0;
+    };
+
+    std::unique_ptr<TestClient> mClient;
+};
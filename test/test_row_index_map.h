@@ -0,0 +1,184 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <row_index_map.h>
+#include <QRandomGenerator>
+#include <QtTest/QTest>
+#include <map>
+
+using namespace Skywalker;
+
+class TestRowIndexMap : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertAndFind()
+    {
+        RowIndexMap<QString> map;
+        QVERIFY(map.empty());
+
+        map.insert(10, "a");
+        map.insert(5, "b");
+        QCOMPARE((int)map.size(), 2);
+        QCOMPARE(*map.find(10), QString("a"));
+        QCOMPARE(*map.find(5), QString("b"));
+        QVERIFY(!map.find(7));
+        QCOMPARE((int)map.lastRow(), 10);
+        QCOMPARE(map.last(), QString("a"));
+        QCOMPARE((int)*map.lowerBound(6), 10);
+        QVERIFY(!map.lowerBound(11));
+    }
+
+    void shiftFromHead()
+    {
+        RowIndexMap<int> map;
+        map.insert(3, 1);
+        map.insert(8, 2);
+
+        map.shift(0, 5);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {8, 1}, {13, 2} }));
+
+        map.eraseUpTo(8);
+        map.shift(9, -9);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {4, 2} }));
+
+        map.insert(0, 3);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {0, 3}, {4, 2} }));
+    }
+
+    void shiftFromMiddle()
+    {
+        RowIndexMap<int> map;
+        map.insert(1, 1);
+        map.insert(10, 2);
+        map.insert(20, 3);
+        map.insert(90, 4);
+
+        // Moves the rows before
+        map.shift(15, 3);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {1, 1}, {10, 2}, {23, 3}, {93, 4} }));
+
+        // Moves the rows after
+        map.shift(80, -2);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {1, 1}, {10, 2}, {23, 3}, {91, 4} }));
+
+        // The moved entry replaces the entry at the same row
+        map.shift(11, -1);
+        map.shift(11, -12);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {1, 1}, {10, 3}, {78, 4} }));
+    }
+
+    void erase()
+    {
+        RowIndexMap<int> map;
+
+        for (int i = 0; i < 10; ++i)
+            map.insert(i * 10, i);
+
+        map.shift(0, 1);
+        map.eraseUpTo(21);
+        map.eraseFrom(71);
+        map.eraseAfter(60);
+        map.erase(41);
+        QCOMPARE(toStdMap(map), (std::map<size_t, int>{ {31, 3}, {51, 5} }));
+        QCOMPARE((int)*map.findRow([](size_t, int value){ return value == 5; }), 51);
+        QVERIFY(!map.findRow([](size_t, int value){ return value == 4; }));
+
+        map.clear();
+        QVERIFY(map.empty());
+    }
+
+    void compareToShiftingAllRows()
+    {
+        RowIndexMap<int> map;
+        std::map<size_t, int> expected;
+        auto* random = QRandomGenerator::global();
+        size_t rowCount = 0;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const size_t row = random->bounded(int(rowCount) + 1);
+
+            switch (random->bounded(4))
+            {
+            case 0:
+            {
+                // Insert rows and attach a value to the last inserted row.
+                const int size = random->bounded(1, 50);
+                map.shift(row, size);
+                expected = shiftAll(expected, row, size);
+                map.insert(row + size - 1, i);
+                expected[row + size - 1] = i;
+                rowCount += size;
+                break;
+            }
+            case 1:
+            {
+                // Remove rows that have no value attached.
+                const auto next = expected.lower_bound(row);
+                const size_t end = next == expected.end() ? rowCount : next->first;
+                const int size = int(end - row);
+
+                if (size > 0)
+                {
+                    map.shift(row, -size);
+                    expected = shiftAll(expected, row, -size);
+                    rowCount -= size;
+                }
+
+                break;
+            }
+            case 2:
+                map.eraseUpTo(row);
+                expected.erase(expected.begin(), expected.upper_bound(row));
+                break;
+            case 3:
+                map.eraseFrom(row);
+                expected.erase(expected.lower_bound(row), expected.end());
+                break;
+            }
+
+            QCOMPARE(toStdMap(map), expected);
+        }
+    }
+
+    void benchmarkPrepend()
+    {
+        // A page of 50 posts prepended to a full timeline
+        RowIndexMap<QString> map;
+
+        for (int i = 0; i < 5000; i += 50)
+            map.insert(i + 49, QString("cursor%1").arg(i));
+
+        QBENCHMARK {
+            map.shift(0, 50);
+            map.insert(49, "head");
+            map.shift(0, -50);
+        }
+    }
+
+private:
+    template<typename T>
+    static std::map<size_t, T> toStdMap(const RowIndexMap<T>& map)
+    {
+        std::map<size_t, T> result;
+        map.forEach([&result](size_t row, const T& value){ result[row] = value; });
+        return result;
+    }
+
+    // Shifting as done before the row index map
+    static std::map<size_t, int> shiftAll(const std::map<size_t, int>& map, size_t startRow, int offset)
+    {
+        std::map<size_t, int> result;
+
+        for (const auto& [row, value] : map)
+        {
+            if (row >= startRow)
+                result[row + offset] = value;
+            else
+                result[row] = value;
+        }
+
+        return result;
+    }
+};
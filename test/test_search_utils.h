@@ -2,6 +2,9 @@
 // License: GPLv3
 #pragma once
 #include <search_utils.h>
+#include <atproto/lib/rich_text_master.h>
+#include <QRandomGenerator>
+#include <QTextBoundaryFinder>
 #include <QtTest/QTest>
 
 using namespace Skywalker;
@@ -50,4 +53,92 @@ private slots:
         QFETCH(std::vector<QString>, output);
         QCOMPARE(SearchUtils::getNormalizedWords(input), output);
     }
+
+    void asciiWords_data()
+    {
+        QTest::addColumn<QString>("input");
+        QTest::newRow("apostrophe") << "don't stop";
+        QTest::newRow("abbreviation") << "e.g. i.e.";
+        QTest::newRow("numbers") << "1,000.5 3;4 5'6 7:8";
+        QTest::newRow("colon") << "a:b a::b";
+        QTest::newRow("underscore") << "_hidden snake_case __init__ a_1";
+        QTest::newRow("link") << "https://bsky.app/profile/me.bsky.social?x=1&y=2#tag";
+        QTest::newRow("mention") << "@alice.bsky.social #hashtag";
+        QTest::newRow("trailing separator") << "end. end' end: 1, 1.";
+    }
+
+    void asciiWords()
+    {
+        // Differential test against the boundary finder
+        QFETCH(QString, input);
+        QCOMPARE(SearchUtils::getWords(input), getBoundaryFinderWords(input));
+    }
+
+    void randomAsciiWords()
+    {
+        const QString chars = "aZ09_.,;:' -@#\"\r\n/";
+        QRandomGenerator generator(11);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            QString text;
+            const int length = generator.bounded(1, 20);
+
+            for (int j = 0; j < length; ++j)
+                text += chars[generator.bounded(chars.size())];
+
+            QCOMPARE(SearchUtils::getWords(text), getBoundaryFinderWords(text));
+        }
+    }
+
+    void asciiNormalizeText()
+    {
+        // Differential test against the full normalization
+        QString text;
+
+        for (char16_t c = 0; c < 0x80; ++c)
+            text += QChar(c);
+
+        QCOMPARE(SearchUtils::normalizeText(text), ATProto::RichTextMaster::normalizeText(text));
+    }
+
+    void benchmarkNormalizedWords()
+    {
+        const QString text = QString("The quick brown fox jumps over the lazy dog, doesn't it? ").repeated(10);
+        size_t count = 0;
+
+        QBENCHMARK {
+            count += SearchUtils::getNormalizedWords(text).size();
+        }
+
+        QVERIFY(count > 0);
+    }
+
+private:
+    // The algorithm for non-ASCII text
+    static std::vector<QString> getBoundaryFinderWords(const QString& text)
+    {
+        std::vector<QString> words;
+        QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Word, text);
+        int startWordPos = 0;
+
+        while (!(boundaryFinder.boundaryReasons() & QTextBoundaryFinder::StartOfItem) && startWordPos != -1)
+            startWordPos = boundaryFinder.toNextBoundary();
+
+        while (startWordPos != -1)
+        {
+            const int endWordPos = boundaryFinder.toNextBoundary();
+
+            if (endWordPos == -1)
+                break;
+
+            words.push_back(text.sliced(startWordPos, endWordPos - startWordPos));
+
+            startWordPos = boundaryFinder.toNextBoundary();
+            while (!(boundaryFinder.boundaryReasons() & QTextBoundaryFinder::StartOfItem) && startWordPos != -1)
+                startWordPos = boundaryFinder.toNextBoundary();
+        }
+
+        return words;
+    }
 };
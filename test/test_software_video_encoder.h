@@ -0,0 +1,93 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <software_video_encoder.h>
+#include <QDataStream>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestSoftwareVideoEncoder : public QObject
+{
+    Q_OBJECT
+private slots:
+    void compressFrame()
+    {
+        QImage frame(64, 48, QImage::Format_ARGB32);
+        frame.fill(Qt::red);
+        const QByteArray jpg = SoftwareVideoEncoder::compressFrame(frame);
+        QVERIFY(jpg.startsWith("\xFF\xD8"));
+
+        QImage decoded;
+        QVERIFY(decoded.loadFromData(jpg, "jpg"));
+        QCOMPARE(decoded.size(), frame.size());
+    }
+
+    void writeMovie()
+    {
+        QTemporaryDir dir;
+        const QString fileName = dir.filePath("video.mov");
+        SoftwareVideoEncoder encoder;
+        QVERIFY(encoder.open(fileName, 64, 48, 10));
+
+        std::vector<QByteArray> frames;
+
+        for (const auto color : { Qt::red, Qt::green, Qt::blue })
+        {
+            QImage frame(64, 48, QImage::Format_RGB32);
+            frame.fill(color);
+            frames.push_back(SoftwareVideoEncoder::compressFrame(frame));
+            QVERIFY(encoder.push(frames.back()));
+        }
+
+        QVERIFY(!encoder.push({}));
+        QCOMPARE(encoder.getFrameCount(), 3);
+        QVERIFY(encoder.close());
+        QVERIFY(!encoder.isOpen());
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray data = file.readAll();
+
+        // Top level atoms must cover the whole file
+        QStringList types;
+        qsizetype pos = 0;
+
+        while (pos < data.size())
+        {
+            const quint32 size = readUint32(data, pos);
+            QVERIFY(size >= 8);
+            types.push_back(QString::fromLatin1(data.mid(pos + 4, 4)));
+            pos += size;
+        }
+
+        QCOMPARE(pos, data.size());
+        QCOMPARE(types, QStringList({ "ftyp", "mdat", "moov" }));
+
+        // The sample tables must point to the frames
+        const qsizetype stsz = data.indexOf("stsz");
+        QVERIFY(stsz > 0);
+        QCOMPARE(readUint32(data, stsz + 12), 3u);
+
+        const qsizetype stco = data.indexOf("stco");
+        QVERIFY(stco > 0);
+        QCOMPARE(readUint32(data, stco + 8), 3u);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const quint32 size = readUint32(data, stsz + 16 + i * 4);
+            const quint32 offset = readUint32(data, stco + 12 + i * 4);
+            QCOMPARE(data.mid(offset, size), frames[i]);
+        }
+    }
+
+private:
+    static quint32 readUint32(const QByteArray& data, qsizetype pos)
+    {
+        QDataStream in(data.mid(pos, 4));
+        quint32 value = 0;
+        in >> value;
+        return value;
+    }
+};
@@ -0,0 +1,201 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <timeline_store.h>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+using namespace std::chrono_literals;
+
+class TestTimelineStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init()
+    {
+        mDir = std::make_unique<QTemporaryDir>();
+        QVERIFY(mDir->isValid());
+        mStore = std::make_unique<TimelineStore>(mDir->path());
+        QVERIFY(mStore->open(TEST_DID));
+    }
+
+    void cleanup()
+    {
+        mStore = nullptr;
+        mDir = nullptr;
+        mNextPostId = 1;
+    }
+
+    void emptyStore()
+    {
+        QVERIFY(mStore->load().empty());
+        QCOMPARE(mStore->getSegmentCount(), 0);
+    }
+
+    void appendAndLoad()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        QVERIFY(mStore->append(TimelineStore::SegmentType::PREPEND, *getFeed(2, TEST_DATE + 1h)));
+        QVERIFY(mStore->append(TimelineStore::SegmentType::GAP_FILL, *getFeed(1, TEST_DATE + 1s), "GAP1"));
+        QCOMPARE(mStore->getSegmentCount(), 3);
+
+        reopen();
+        QCOMPARE(mStore->getSegmentCount(), 3);
+        const auto segments = mStore->load();
+        QCOMPARE((int)segments.size(), 3);
+
+        QCOMPARE(segments[0].mType, TimelineStore::SegmentType::APPEND);
+        QCOMPARE((int)segments[0].mFeed->mFeed.size(), 3);
+        QCOMPARE(segments[0].mFeed->mFeed[0]->mPost->mCid, "cid1");
+        QCOMPARE(*segments[0].mFeed->mCursor, "CUR1");
+
+        QCOMPARE(segments[1].mType, TimelineStore::SegmentType::PREPEND);
+        QCOMPARE((int)segments[1].mFeed->mFeed.size(), 2);
+        QVERIFY(!segments[1].mFeed->mCursor);
+
+        QCOMPARE(segments[2].mType, TimelineStore::SegmentType::GAP_FILL);
+        QCOMPARE(segments[2].mGapCursor, "GAP1");
+        QCOMPARE(segments[2].mFeed->mFeed[0]->mPost->mCid, "cid6");
+    }
+
+    void truncatedSegment()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE - 1h, "CUR2")));
+        const qint64 size = mStore->getSize();
+        mStore->close();
+
+        QFile file(getFileName());
+        QVERIFY(file.resize(size - 10));
+
+        QVERIFY(mStore->open(TEST_DID));
+        QCOMPARE(mStore->getSegmentCount(), 1);
+        QCOMPARE((int)mStore->load().size(), 1);
+
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(1, TEST_DATE - 2h)));
+        reopen();
+        QCOMPARE((int)mStore->load().size(), 2);
+    }
+
+    void versionMismatch()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        mStore->close();
+
+        QFile file(getFileName());
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        file.seek(4);
+        const quint32 version = qToLittleEndian(TimelineStore::VERSION + 1);
+        file.write((const char*)&version, sizeof(version));
+        file.close();
+
+        QVERIFY(mStore->open(TEST_DID));
+        QVERIFY(mStore->load().empty());
+    }
+
+    void compact()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE - 1h, "CUR2")));
+
+        const std::vector<TimelineStore::Segment> compacted{
+            { TimelineStore::SegmentType::APPEND, {}, getFeed(2, TEST_DATE + 1h, "GAP1") },
+            { TimelineStore::SegmentType::GAP, "GAP1", std::make_shared<ATProto::AppBskyFeed::OutputFeed>() },
+            { TimelineStore::SegmentType::APPEND, {}, getFeed(2, TEST_DATE, "CUR3") }
+        };
+        QVERIFY(mStore->compact(compacted));
+        QCOMPARE(mStore->getSegmentCount(), 3);
+
+        reopen();
+        const auto segments = mStore->load();
+        QCOMPARE((int)segments.size(), 3);
+        QCOMPARE((int)segments[0].mFeed->mFeed.size(), 2);
+        QCOMPARE(*segments[0].mFeed->mCursor, "GAP1");
+        QCOMPARE(segments[1].mType, TimelineStore::SegmentType::GAP);
+        QCOMPARE(segments[1].mGapCursor, "GAP1");
+        QVERIFY(segments[1].mFeed->mFeed.empty());
+        QCOMPARE(*segments[2].mFeed->mCursor, "CUR3");
+    }
+
+    void remove()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        QVERIFY(QFile::exists(getFileName()));
+
+        mStore->remove(TEST_DID);
+        QVERIFY(!mStore->isOpen());
+        QVERIFY(!QFile::exists(getFileName()));
+    }
+
+    void clear()
+    {
+        QVERIFY(mStore->append(TimelineStore::SegmentType::APPEND, *getFeed(3, TEST_DATE, "CUR1")));
+        mStore->clear();
+        QCOMPARE(mStore->getSegmentCount(), 0);
+        reopen();
+        QVERIFY(mStore->load().empty());
+    }
+
+private:
+    static constexpr char const* TEST_DID = "did:plc:foo";
+
+    static constexpr char const* POST_TEMPLATE = R"##({
+        "post": {
+            "uri": "at://did:plc:foo/app.bsky.feed.post/r%1",
+            "cid": "cid%1",
+            "author": {
+                "did": "did:plc:foo",
+                "handle": "foo.bsky.social"
+            },
+            "record": {
+                "$type": "app.bsky.feed.post",
+                "text": "Hello world!",
+                "createdAt": "%2"
+            },
+            "indexedAt": "%2"
+        }
+    })##";
+
+    const QDateTime TEST_DATE = QDateTime::fromString("2023-11-20T18:46:00.000Z", Qt::ISODateWithMs);
+
+    void reopen()
+    {
+        mStore->close();
+        QVERIFY(mStore->open(TEST_DID));
+    }
+
+    QString getFileName() const
+    {
+        return QString("%1/did_plc_foo.tl").arg(mDir->path());
+    }
+
+    ATProto::AppBskyFeed::OutputFeed::SharedPtr getFeed(int numPosts, QDateTime startTime, const std::optional<QString>& cursor = {})
+    {
+        QString feedData = R"###({ "feed": [)###";
+
+        for (int i = 1; i <= numPosts; ++i)
+        {
+            auto postTime = startTime - (i-1) * 1s;
+            QString postData = QString(POST_TEMPLATE).arg(QString::number(mNextPostId++),
+                                                          postTime.toString(Qt::ISODateWithMs));
+            feedData += postData;
+
+            if (i < numPosts)
+                feedData += ',';
+        }
+
+        feedData += "]}";
+
+        auto json = QJsonDocument::fromJson(feedData.toUtf8());
+        auto feed = ATProto::AppBskyFeed::OutputFeed::fromJson(json);
+        feed->mCursor = cursor;
+        return feed;
+    }
+
+    std::unique_ptr<QTemporaryDir> mDir;
+    std::unique_ptr<TimelineStore> mStore;
+    int mNextPostId = 1;
+};
@@ -2,6 +2,8 @@
 // License: GPLv3
 #pragma once
 #include <unicode_fonts.h>
+#include <QRandomGenerator>
+#include <QTextBoundaryFinder>
 #include <QtTest/QTest>
 
 using namespace Skywalker;
@@ -74,5 +76,58 @@ private slots:
         QFETCH(QStringList, output);
         QCOMPARE(UnicodeFonts::splitText(text, 3, 0, maxParts), output);
     }
-};
 
+    void isAscii()
+    {
+        QVERIFY(UnicodeFonts::isAscii(u""));
+        QVERIFY(UnicodeFonts::isAscii(u"Hello, world!\r\n"));
+        QVERIFY(!UnicodeFonts::isAscii(u"caf\u00E9"));
+        QVERIFY(UnicodeFonts::isLatin1(u"caf\u00E9"));
+        QVERIFY(!UnicodeFonts::isLatin1(u"caf\u0065\u0301"));
+        QVERIFY(!UnicodeFonts::isLatin1(u"smile \U0001F600"));
+    }
+
+    void graphemeLengthLatin1()
+    {
+        // Differential test against the boundary finder
+        const QString chars = QString("aZ09 ,.'\r\n\t\u00A0\u00AD\u00B4\u00E9\u00FF");
+        QRandomGenerator generator(7);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            QString text;
+            const int length = generator.bounded(30);
+
+            for (int j = 0; j < length; ++j)
+                text += chars[generator.bounded(chars.size())];
+
+            QVERIFY(UnicodeFonts::isLatin1(text));
+            QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, text);
+            std::vector<int> expected = {0, };
+            int next;
+
+            while ((next = boundaryFinder.toNextBoundary()) != -1)
+                expected.push_back(next);
+
+            QCOMPARE(UnicodeFonts::graphemeLength(text), (int)expected.size() - 1);
+
+            const auto info = UnicodeFonts::getGraphemeInfo(text);
+            QCOMPARE(info.getLength(), (int)expected.size() - 1);
+
+            for (int k = 0; k < (int)expected.size(); ++k)
+                QCOMPARE(info.getCharPos(k), expected[k]);
+        }
+    }
+
+    void benchmarkGraphemeLength()
+    {
+        const QString text = QString("The quick brown fox jumps over the lazy dog. ").repeated(20);
+        int length = 0;
+
+        QBENCHMARK {
+            length += UnicodeFonts::graphemeLength(text);
+        }
+
+        QVERIFY(length > 0);
+    }
+};
@@ -0,0 +1,57 @@
+// Copyright (C) 2024 Michel de Boer
+// License: GPLv3
+#pragma once
+#include <word_index_cache.h>
+#include <QtTest/QTest>
+
+using namespace Skywalker;
+
+class TestWordIndexCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void hitAndMiss()
+    {
+        WordIndexCache cache(10);
+        QVERIFY(!cache.get("cid1"));
+        cache.put("cid1", makeIndices(1));
+        QCOMPARE(cache.get("cid1")->mNormalizedWords[0], 1u);
+        QCOMPARE((int)cache.getHits(), 1);
+        QCOMPARE((int)cache.getMisses(), 1);
+        QCOMPARE(cache.getHitRate(), 0.5);
+    }
+
+    void evictLeastRecentlyUsed()
+    {
+        WordIndexCache cache(2);
+        cache.put("cid1", makeIndices(1));
+        cache.put("cid2", makeIndices(2));
+        QVERIFY(cache.get("cid1"));
+
+        cache.put("cid3", makeIndices(3));
+        QCOMPARE((int)cache.size(), 2);
+        QCOMPARE((int)cache.getEvictions(), 1);
+        QVERIFY(cache.get("cid1"));
+        QVERIFY(!cache.get("cid2"));
+        QVERIFY(cache.get("cid3"));
+    }
+
+    void clear()
+    {
+        WordIndexCache cache(2);
+        cache.put("cid1", makeIndices(1));
+        QVERIFY(cache.get("cid1"));
+        cache.clear();
+        QCOMPARE((int)cache.size(), 0);
+        QCOMPARE((int)cache.getHits(), 0);
+        QVERIFY(!cache.get("cid1"));
+    }
+
+private:
+    static NormalizedWordIndex::Indices::SharedPtr makeIndices(WordToken token)
+    {
+        auto indices = std::make_shared<NormalizedWordIndex::Indices>();
+        indices->mNormalizedWords.push_back(token);
+        return indices;
+    }
+};